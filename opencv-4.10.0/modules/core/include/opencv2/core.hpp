@@ -2293,6 +2293,58 @@ the convolution sample in dft description.
 */
 CV_EXPORTS_W void idft(InputArray src, OutputArray dst, int flags = 0, int nonzeroRows = 0);
 
+/** @brief Precomputed Discrete Fourier Transform of a fixed size, type and set of flags.
+
+cv::dft prepares the transform (factorization of the array size, twiddle factors, work buffers) on
+every call. When many arrays of the same size are transformed, e.g. in the correlation filter based
+trackers, this setup can be done once by creating a DFTPlan and reused by calling DFTPlan::execute,
+which produces the same result as cv::dft called with the same parameters.
+
+The plan keeps work buffers, so an instance (or its copies, which share the plan) must not be used
+from several threads at the same time. Only Mat based transforms are handled.
+@sa dft, idft
+*/
+class CV_EXPORTS DFTPlan
+{
+public:
+    /** @brief Creates an empty plan */
+    DFTPlan();
+    /** @overload
+    @param size size of the input array.
+    @param type type of the input array: CV_32FC1, CV_32FC2, CV_64FC1 or CV_64FC2.
+    @param flags transformation flags, representing a combination of the #DftFlags.
+    @param nonzeroRows see dft.
+    */
+    DFTPlan(Size size, int type, int flags = 0, int nonzeroRows = 0);
+    ~DFTPlan();
+
+    /** @brief Prepares the transform.
+
+    The function does nothing if the plan has already been created with the same parameters.
+    The parameters are the same as in the constructor.
+    */
+    void create(Size size, int type, int flags = 0, int nonzeroRows = 0);
+
+    /** @brief Computes the transform of src, which must have the size and type of the plan.
+    @param src input array.
+    @param dst output array, it is reallocated only if it does not have the size and type
+    cv::dft would produce.
+    */
+    void execute(InputArray src, OutputArray dst);
+
+    /** @brief Releases the plan */
+    void release();
+
+    bool empty() const;
+    Size size() const;
+    int type() const;
+    int flags() const;
+
+    struct Impl;
+protected:
+    Ptr<Impl> p;
+};
+
 /** @brief Performs a forward or inverse discrete Cosine transform of 1D or 2D array.
 
 The function cv::dct performs a forward or inverse discrete Cosine transform (DCT) of a 1D or 2D
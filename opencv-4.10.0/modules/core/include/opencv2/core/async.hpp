@@ -9,6 +9,7 @@
 
 //#include <future>
 #include <chrono>
+#include <functional>
 
 namespace cv {
 
@@ -82,6 +83,18 @@ public:
         return wait_for((int64)(std::chrono::nanoseconds(timeout).count()));
     }
 
+    /** Chains continuation of the asynchronous operation
+    @param fn function which receives result of this operation and produces the new result.
+    Exception of this operation or of the function is stored as the new result.
+
+    Continuation is executed by cv::async() threads when the result is ready.
+    The result is passed to the continuation: this object becomes invalid (see valid()),
+    so its result can't be fetched via get() and then() can't be called again.
+
+    @returns result of the continuation
+    */
+    AsyncArray then(const std::function<void(InputArray src, OutputArray dst)>& fn) const;
+
 #if 0
     std::future<Mat> getFutureMat() const;
     std::future<UMat> getFutureUMat() const;
@@ -96,6 +109,48 @@ protected:
 };
 
 
+/** @brief Runs function asynchronously
+
+Function is executed by one of the asynchronous execution threads. OpenCV functions called from it
+use parallel_for_() thread pool as usual and follow parallel::ExecutionContext of the calling thread.
+Exception thrown by the function is stored as the result.
+@code
+AsyncArray blurred = cv::async([&](OutputArray dst) { cv::GaussianBlur(frame, dst, Size(5, 5), 0); })
+        .then([](InputArray src, OutputArray dst) { cv::threshold(src, dst, 128, 255, THRESH_BINARY); });
+...
+Mat result;
+blurred.get(result);
+@endcode
+
+If queue of waiting functions is full (see setAsyncQueueSize()), the call blocks until one of them is
+started. Continuations and calls from the asynchronous execution threads don't wait (the latter run
+the function immediately).
+
+@param fn function which produces the result into its argument
+@returns asynchronous result
+*/
+CV_EXPORTS AsyncArray async(const std::function<void(OutputArray dst)>& fn);
+
+/** @brief Sets number of asynchronous execution threads
+
+Default value is 4 (or the number of CPUs if it is less), it can be changed via `OPENCV_ASYNC_THREADS`
+environment variable. 0 runs cv::async() functions and continuations synchronously.
+*/
+CV_EXPORTS void setAsyncNumThreads(int nthreads);
+
+/** @brief Returns number of asynchronous execution threads */
+CV_EXPORTS int getAsyncNumThreads();
+
+/** @brief Sets maximal number of waiting cv::async() functions
+
+Default value is 64, it can be changed via `OPENCV_ASYNC_QUEUE_SIZE` environment variable. 0 means unlimited queue.
+*/
+CV_EXPORTS void setAsyncQueueSize(int size);
+
+/** @brief Returns maximal number of waiting cv::async() functions */
+CV_EXPORTS int getAsyncQueueSize();
+
+
 //! @}
 } // namespace
 #endif // OPENCV_CORE_ASYNC_HPP
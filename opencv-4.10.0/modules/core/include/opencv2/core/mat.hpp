@@ -2148,6 +2148,16 @@ public:
     MatAllocator* allocator;
     //! and the standard allocator
     static MatAllocator* getStdAllocator();
+    /** @brief Allocator which keeps released buffers for reuse
+
+    Released buffers are cached per thread in size classes and shared between threads via
+    the process-wide reclaim lists (see cv::utils::getMatPoolAllocatorStatistics()). The thread
+    caches take no lock, only moving buffers between a cache and a reclaim list locks the mutex
+    of that size class.
+    It is used by default if `OPENCV_MAT_ALLOCATOR=pool` environment variable is set.
+    Reserved memory is controlled via getBufferPoolController().
+    */
+    static MatAllocator* getPoolAllocator();
     static MatAllocator* getDefaultAllocator();
     static void setDefaultAllocator(MatAllocator* allocator);
 
@@ -3565,6 +3575,13 @@ real-valued scalar ( double )):
 @note Comma-separated initializers and probably some other operations may require additional
 explicit Mat() or Mat_<T>() constructor calls to resolve a possible ambiguity.
 
+Element-wise operations (addition, subtraction, scaling, per-element multiplication and division,
+abs, min, max and comparison) on CV_32F or CV_64F matrices of the same size and type are fused with
+the operations of their operand expressions: expressions like `A*alpha + B*beta - C` or `(X - M)/S`
+are computed in a single pass instead of through a temporary matrix. As the temporary matrix, the
+fused result is computed when the expression is built. Matrices of other types are computed
+operation by operation.
+
 Here are examples of matrix expressions:
 @code
     // compute pseudo-inverse of A, equivalent to A.inv(DECOMP_SVD)
@@ -3683,6 +3700,11 @@ MatExpr operator / (const Matx<_Tp, m, n>& a, const Mat& b) { return Mat(a) / b;
 CV_EXPORTS MatExpr operator < (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator < (const Mat& a, double s);
 CV_EXPORTS MatExpr operator < (double s, const Mat& a);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator < (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator < (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator < (const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr operator < (const Mat& a, const Matx<_Tp, m, n>& b) { return a < Mat(b); }
 template<typename _Tp, int m, int n> static inline
@@ -3691,6 +3713,11 @@ MatExpr operator < (const Matx<_Tp, m, n>& a, const Mat& b) { return Mat(a) < b;
 CV_EXPORTS MatExpr operator <= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator <= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator <= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator <= (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator <= (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr operator <= (const Mat& a, const Matx<_Tp, m, n>& b) { return a <= Mat(b); }
 template<typename _Tp, int m, int n> static inline
@@ -3699,6 +3726,11 @@ MatExpr operator <= (const Matx<_Tp, m, n>& a, const Mat& b) { return Mat(a) <=
 CV_EXPORTS MatExpr operator == (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator == (const Mat& a, double s);
 CV_EXPORTS MatExpr operator == (double s, const Mat& a);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator == (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator == (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator == (const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr operator == (const Mat& a, const Matx<_Tp, m, n>& b) { return a == Mat(b); }
 template<typename _Tp, int m, int n> static inline
@@ -3707,6 +3739,11 @@ MatExpr operator == (const Matx<_Tp, m, n>& a, const Mat& b) { return Mat(a) ==
 CV_EXPORTS MatExpr operator != (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator != (const Mat& a, double s);
 CV_EXPORTS MatExpr operator != (double s, const Mat& a);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator != (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator != (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator != (const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr operator != (const Mat& a, const Matx<_Tp, m, n>& b) { return a != Mat(b); }
 template<typename _Tp, int m, int n> static inline
@@ -3715,6 +3752,11 @@ MatExpr operator != (const Matx<_Tp, m, n>& a, const Mat& b) { return Mat(a) !=
 CV_EXPORTS MatExpr operator >= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator >= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator >= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator >= (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator >= (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr operator >= (const Mat& a, const Matx<_Tp, m, n>& b) { return a >= Mat(b); }
 template<typename _Tp, int m, int n> static inline
@@ -3723,6 +3765,11 @@ MatExpr operator >= (const Matx<_Tp, m, n>& a, const Mat& b) { return Mat(a) >=
 CV_EXPORTS MatExpr operator > (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator > (const Mat& a, double s);
 CV_EXPORTS MatExpr operator > (double s, const Mat& a);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator > (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator > (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator > (const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr operator > (const Mat& a, const Matx<_Tp, m, n>& b) { return a > Mat(b); }
 template<typename _Tp, int m, int n> static inline
@@ -3757,6 +3804,11 @@ CV_EXPORTS MatExpr operator ~(const Mat& m);
 CV_EXPORTS MatExpr min(const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr min(const Mat& a, double s);
 CV_EXPORTS MatExpr min(double s, const Mat& a);
+CV_EXPORTS MatExpr min(const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr min(const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr min(const MatExpr& e, double s);
+CV_EXPORTS MatExpr min(double s, const MatExpr& e);
+CV_EXPORTS MatExpr min(const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr min (const Mat& a, const Matx<_Tp, m, n>& b) { return min(a, Mat(b)); }
 template<typename _Tp, int m, int n> static inline
@@ -3765,6 +3817,11 @@ MatExpr min (const Matx<_Tp, m, n>& a, const Mat& b) { return min(Mat(a), b); }
 CV_EXPORTS MatExpr max(const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr max(const Mat& a, double s);
 CV_EXPORTS MatExpr max(double s, const Mat& a);
+CV_EXPORTS MatExpr max(const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr max(const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr max(const MatExpr& e, double s);
+CV_EXPORTS MatExpr max(double s, const MatExpr& e);
+CV_EXPORTS MatExpr max(const MatExpr& e1, const MatExpr& e2);
 template<typename _Tp, int m, int n> static inline
 MatExpr max (const Mat& a, const Matx<_Tp, m, n>& b) { return max(a, Mat(b)); }
 template<typename _Tp, int m, int n> static inline
@@ -7,6 +7,8 @@
 
 #include "opencv2/core/cvdef.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace cv { namespace parallel {
 #ifndef CV_API_CALL
@@ -85,6 +87,85 @@ CV_EXPORTS void setParallelForBackend(const std::shared_ptr<ParallelForAPI>& api
  */
 CV_EXPORTS_W bool setParallelForBackend(const std::string& backendName, bool propagateNumThreads = true);
 
+/** @brief Parallel execution settings of a thread
+ *
+ * Context limits `parallel_for_()` calls of the bound thread (and nested calls from their bodies)
+ * independently from the process-wide cv::setNumThreads() value, so different pipelines can share
+ * CPU cores without over-subscription:
+ * @code
+ * cv::parallel::ExecutionContext ctx = cv::parallel::ExecutionContext::create(2, {0, 1});
+ * cv::parallel::ExecutionContextScope scope(ctx);
+ * cv::GaussianBlur(src, dst, Size(5, 5), 0);  // 2 threads: the calling thread and a worker pinned to cores 0 and 1
+ * @endcode
+ *
+ * Thread number limit is honored by the built-in thread pool, TBB (via own task arena) and OpenMP
+ * (via `num_threads` clause). Other backends receive no more tasks than allowed threads.
+ * CPU affinity is supported by the built-in thread pool: context with CPU set owns isolated
+ * worker threads pinned to these CPUs. The calling thread is not pinned, and it processes a part of
+ * the range too, so bind the context from a thread with the same affinity to keep all work on these CPUs.
+ */
+class CV_EXPORTS ExecutionContext
+{
+public:
+    ExecutionContext() = default;
+    ~ExecutionContext() = default;
+
+    ExecutionContext(const ExecutionContext&) = default;
+    ExecutionContext(ExecutionContext&&) = default;
+
+    ExecutionContext& operator=(const ExecutionContext&) = default;
+    ExecutionContext& operator=(ExecutionContext&&) = default;
+
+    /** @brief Creates execution context
+     *
+     * @param numThreads maximal number of threads (including the calling thread) for parallel regions.
+     * 0 and 1 disable parallel execution, negative value uses cv::getNumThreads() of the process or
+     * the number of CPUs in the set.
+     * @param cpus CPU indexes for worker threads (empty - no affinity).
+     * @param backend parallel_for backend of the context (empty - the backend of the process).
+     */
+    static ExecutionContext create(int numThreads, const std::vector<int>& cpus = std::vector<int>(),
+                                   const std::shared_ptr<ParallelForAPI>& backend = std::shared_ptr<ParallelForAPI>());
+
+    /** Maximal number of threads of the context, negative value means the process settings */
+    int getNumThreads() const;
+    const std::vector<int>& getCPUs() const;
+    const std::shared_ptr<ParallelForAPI>& getBackend() const;
+
+    /** Get execution context of current thread (can be empty) */
+    static ExecutionContext& getCurrentRef();
+
+    /** Bind this execution context to current thread.
+     *
+     * Binding of empty context restores the process settings for current thread.
+     */
+    void bind() const;
+
+    struct Impl;
+    inline bool empty() const { return !p; }
+    inline Impl* getImpl() const { return p.get(); }
+    void release();
+protected:
+    std::shared_ptr<Impl> p;
+};
+
+/** @brief Binds execution context to current thread until the end of the scope */
+class ExecutionContextScope
+{
+    ExecutionContext ctx_;
+public:
+    inline explicit ExecutionContextScope(const ExecutionContext& ctx)
+    {
+        ctx_ = ExecutionContext::getCurrentRef();
+        ctx.bind();
+    }
+
+    inline ~ExecutionContextScope()
+    {
+        ctx_.bind();
+    }
+};
+
 //! @}
 }}  // namespace
 #endif  // OPENCV_CORE_PARALLEL_BACKEND_HPP
@@ -24,6 +24,40 @@ public:
     virtual void resetPeakUsage() = 0;
 };
 
+/** @brief Statistics of allocator which reuses released buffers
+
+Each allocation is either a hit (buffer is taken from the cache of the calling thread),
+a reclaim (buffer is taken from the process-wide list of buffers released by other threads)
+or a miss (new buffer is allocated):
+`getNumberOfAllocations() == getNumberOfHits() + getNumberOfReclaims() + getNumberOfMisses()`.
+*/
+class PoolAllocatorStatisticsInterface : public AllocatorStatisticsInterface
+{
+protected:
+    PoolAllocatorStatisticsInterface() {}
+    virtual ~PoolAllocatorStatisticsInterface() {}
+public:
+    virtual uint64_t getNumberOfHits() const = 0;
+    virtual uint64_t getNumberOfReclaims() const = 0;
+    virtual uint64_t getNumberOfMisses() const = 0;
+
+    /** size of released buffers kept for reuse */
+    virtual uint64_t getReservedSize() const = 0;
+
+    /** reset number of allocations, hits, reclaims and misses */
+    virtual void resetCounters() = 0;
+
+    /** part of allocations served without new buffers */
+    double getHitRate() const
+    {
+        uint64_t allocs = getNumberOfAllocations();
+        return allocs ? (double)(getNumberOfHits() + getNumberOfReclaims()) / (double)allocs : 0.0;
+    }
+};
+
+/** @brief Statistics of cv::Mat::getPoolAllocator() */
+CV_EXPORTS PoolAllocatorStatisticsInterface& getMatPoolAllocatorStatistics();
+
 }} // namespace
 
 #endif // OPENCV_CORE_ALLOCATOR_STATS_HPP
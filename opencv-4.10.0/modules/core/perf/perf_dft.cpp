@@ -36,6 +36,44 @@ PERF_TEST_P(Size_MatType_FlagsType_NzeroRows, dft, TEST_MATS_DFT)
     SANITY_CHECK(dst, 1e-5, ERROR_RELATIVE);
 }
 
+///////////////////////////////////////////////////////DFTPlan//////////////////////////////////////////////////
+
+// small transforms repeated many times, where the preparation of the transform is noticeable
+CV_ENUM(PlanFlagsType, DFT_COMPLEX_OUTPUT, DFT_INVERSE|DFT_SCALE|DFT_REAL_OUTPUT)
+#define TEST_MATS_DFT_PLAN testing::Combine(testing::Values(cv::Size(31, 31), cv::Size(50, 50), cv::Size(64, 64)), PlanFlagsType::all())
+
+typedef tuple<Size, PlanFlagsType> Size_PlanFlagsType_t;
+typedef perf::TestBaseWithParam<Size_PlanFlagsType_t> Size_PlanFlagsType;
+
+PERF_TEST_P(Size_PlanFlagsType, dft_small, TEST_MATS_DFT_PLAN)
+{
+    Size sz = get<0>(GetParam());
+    int flags = get<1>(GetParam());
+    int type = (flags & DFT_INVERSE) ? CV_32FC2 : CV_32FC1;
+
+    Mat src(sz, type), dst;
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE_MULTIRUN(100) dft(src, dst, flags);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_PlanFlagsType, dft_plan, TEST_MATS_DFT_PLAN)
+{
+    Size sz = get<0>(GetParam());
+    int flags = get<1>(GetParam());
+    int type = (flags & DFT_INVERSE) ? CV_32FC2 : CV_32FC1;
+
+    Mat src(sz, type), dst;
+    declare.in(src, WARMUP_RNG);
+
+    DFTPlan plan(sz, type, flags);
+    TEST_CYCLE_MULTIRUN(100) plan.execute(src, dst);
+
+    SANITY_CHECK_NOTHING();
+}
+
 ///////////////////////////////////////////////////////dct//////////////////////////////////////////////////////
 
 CV_ENUM(DCT_FlagsType, 0, DCT_INVERSE , DCT_ROWS, DCT_INVERSE|DCT_ROWS)
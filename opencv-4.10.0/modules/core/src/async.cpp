@@ -7,6 +7,8 @@
 #include "opencv2/core/detail/async_promise.hpp"
 
 #include "opencv2/core/cvstd.hpp"
+#include "opencv2/core/parallel/parallel_backend.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
 
 #include <opencv2/core/utils/logger.defines.hpp>
 #undef CV_LOG_STRIP_LEVEL
@@ -18,6 +20,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <deque>
+#include <thread>
 
 namespace cv {
 
@@ -53,12 +57,18 @@ struct AsyncArray::Impl
 
     bool future_is_returned;
 
+    bool result_is_consumed; // result is passed to a continuation
+
+    typedef std::function<void(const AsyncArray&)> Continuation;
+    std::vector<Continuation> continuations;
+
     Impl()
         : refcount(1), refcount_future(0), refcount_promise(1)
         , has_result(false)
         , has_exception(false)
         , result_is_fetched(false)
         , future_is_returned(false)
+        , result_is_consumed(false)
     {
         // nothing
     }
@@ -71,9 +81,11 @@ struct AsyncArray::Impl
         }
     }
 
-    bool get(OutputArray dst, int64 timeoutNs) const
+    bool get(OutputArray dst, int64 timeoutNs, bool by_continuation = false) const
     {
         CV_Assert(!result_is_fetched);
+        if (result_is_consumed && !by_continuation)
+            CV_Error(Error::StsError, "AsyncArray: result is consumed by a continuation");
         if (!has_result)
         {
             if(refcount_promise == 0)
@@ -119,7 +131,7 @@ struct AsyncArray::Impl
 
     bool valid() const CV_NOEXCEPT
     {
-        if (result_is_fetched)
+        if (result_is_fetched || result_is_consumed)
             return false;
         if (refcount_promise == 0 && !has_result)
             return false;
@@ -158,9 +170,8 @@ struct AsyncArray::Impl
 
     void setValue(InputArray value)
     {
-        if (future_is_returned && refcount_future == 0)
-            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
         std::unique_lock<std::mutex> lock(mtx);
+        checkConsumer_();
         CV_Assert(!has_result);
         int k = value.kind();
         if (k == _InputArray::UMAT)
@@ -173,34 +184,86 @@ struct AsyncArray::Impl
             result_mat = makePtr<Mat>();
             value.copyTo(*result_mat.get());
         }
-        has_result = true;
-        cond_var.notify_all();
+        setResult_(lock);
+    }
+
+    void moveValue(Mat& value)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        checkConsumer_();
+        CV_Assert(!has_result);
+        result_mat = makePtr<Mat>();
+        std::swap(*result_mat.get(), value);
+        setResult_(lock);
     }
 
 #if CV__EXCEPTION_PTR
     void setException(std::exception_ptr e)
     {
-        if (future_is_returned && refcount_future == 0)
-            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
         std::unique_lock<std::mutex> lock(mtx);
+        checkConsumer_();
         CV_Assert(!has_result);
         has_exception = true;
         exception = e;
-        has_result = true;
-        cond_var.notify_all();
+        setResult_(lock);
     }
 #endif
 
     void setException(const cv::Exception e)
     {
-        if (future_is_returned && refcount_future == 0)
-            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
         std::unique_lock<std::mutex> lock(mtx);
+        checkConsumer_();
         CV_Assert(!has_result);
         has_exception = true;
         cv_exception = e;
+        setResult_(lock);
+    }
+
+    /** Calls function with the result when it is ready */
+    void onResult(const Continuation& fn)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            CV_Assert(!result_is_fetched);
+            if (result_is_consumed)
+                CV_Error(Error::StsError, "AsyncArray: result is already passed to a continuation");
+            result_is_consumed = true;
+            if (!has_result)
+            {
+                continuations.push_back(fn);
+                return;
+            }
+        }
+        fn(makeArrayResult_());
+    }
+
+protected:
+    // locked
+    void checkConsumer_() const
+    {
+        if (future_is_returned && refcount_future == 0 && continuations.empty())
+            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
+    }
+
+    void setResult_(std::unique_lock<std::mutex>& lock)
+    {
         has_result = true;
         cond_var.notify_all();
+        if (continuations.empty())
+            return;
+        std::vector<Continuation> fns;
+        fns.swap(continuations);
+        lock.unlock();
+        for (size_t i = 0; i < fns.size(); i++)
+            fns[i](makeArrayResult_());
+    }
+
+    AsyncArray makeArrayResult_()
+    {
+        AsyncArray result;
+        addrefFuture();
+        result.p = this;
+        return result;
     }
 };
 
@@ -237,12 +300,18 @@ struct AsyncArray::Impl
 
     bool future_is_returned;
 
+    bool result_is_consumed; // result is passed to a continuation
+
+    typedef std::function<void(const AsyncArray&)> Continuation;
+    std::vector<Continuation> continuations;
+
     Impl()
         : refcount(1), refcount_future(0), refcount_promise(1)
         , has_result(false)
         , has_exception(false)
         , result_is_fetched(false)
         , future_is_returned(false)
+        , result_is_consumed(false)
     {
         // nothing
     }
@@ -255,9 +324,11 @@ struct AsyncArray::Impl
         }
     }
 
-    bool get(OutputArray dst, int64 timeoutNs) const
+    bool get(OutputArray dst, int64 timeoutNs, bool by_continuation = false) const
     {
         CV_Assert(!result_is_fetched);
+        if (result_is_consumed && !by_continuation)
+            CV_Error(Error::StsError, "AsyncArray: result is consumed by a continuation");
         if (!has_result)
         {
             CV_UNUSED(timeoutNs);
@@ -295,7 +366,7 @@ struct AsyncArray::Impl
 
     bool valid() const CV_NOEXCEPT
     {
-        if (result_is_fetched)
+        if (result_is_fetched || result_is_consumed)
             return false;
         if (refcount_promise == 0 && !has_result)
             return false;
@@ -324,8 +395,7 @@ struct AsyncArray::Impl
 
     void setValue(InputArray value)
     {
-        if (future_is_returned && refcount_future == 0)
-            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
+        checkConsumer_();
         CV_Assert(!has_result);
         int k = value.kind();
         if (k == _InputArray::UMAT)
@@ -338,29 +408,75 @@ struct AsyncArray::Impl
             result_mat = makePtr<Mat>();
             value.copyTo(*result_mat.get());
         }
-        has_result = true;
+        setResult_();
+    }
+
+    void moveValue(Mat& value)
+    {
+        checkConsumer_();
+        CV_Assert(!has_result);
+        result_mat = makePtr<Mat>();
+        std::swap(*result_mat.get(), value);
+        setResult_();
     }
 
 #if CV__EXCEPTION_PTR
     void setException(std::exception_ptr e)
     {
-        if (future_is_returned && refcount_future == 0)
-            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
+        checkConsumer_();
         CV_Assert(!has_result);
         has_exception = true;
         exception = e;
-        has_result = true;
+        setResult_();
     }
 #endif
 
     void setException(const cv::Exception e)
     {
-        if (future_is_returned && refcount_future == 0)
-            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
+        checkConsumer_();
         CV_Assert(!has_result);
         has_exception = true;
         cv_exception = e;
+        setResult_();
+    }
+
+    /** Calls function with the result when it is ready */
+    void onResult(const Continuation& fn)
+    {
+        CV_Assert(!result_is_fetched);
+        if (result_is_consumed)
+            CV_Error(Error::StsError, "AsyncArray: result is already passed to a continuation");
+        result_is_consumed = true;
+        if (!has_result)
+        {
+            continuations.push_back(fn);
+            return;
+        }
+        fn(makeArrayResult_());
+    }
+
+protected:
+    void checkConsumer_() const
+    {
+        if (future_is_returned && refcount_future == 0 && continuations.empty())
+            CV_Error(Error::StsError, "Associated AsyncArray has been destroyed");
+    }
+
+    void setResult_()
+    {
         has_result = true;
+        std::vector<Continuation> fns;
+        fns.swap(continuations);
+        for (size_t i = 0; i < fns.size(); i++)
+            fns[i](makeArrayResult_());
+    }
+
+    AsyncArray makeArrayResult_()
+    {
+        AsyncArray result;
+        addrefFuture();
+        result.p = this;
+        return result;
     }
 };
 
@@ -496,4 +612,307 @@ void AsyncPromise::setException(std::exception_ptr exception)
 }
 #endif
 
+
+//
+// Asynchronous execution
+//
+
+namespace {
+
+struct AsyncTask
+{
+    std::function<void()> fn;
+    parallel::ExecutionContext ctx;  // of the submitting thread
+
+    void run()
+    {
+        parallel::ExecutionContextScope scope(ctx);
+        fn();
+    }
+};
+
+static int defaultAsyncNumThreads()
+{
+    return (int)utils::getConfigurationParameterSizeT("OPENCV_ASYNC_THREADS", (size_t)std::max(1, std::min(4, getNumberOfCPUs())));
+}
+
+static int defaultAsyncQueueSize()
+{
+    return (int)utils::getConfigurationParameterSizeT("OPENCV_ASYNC_QUEUE_SIZE", 64);
+}
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+
+/** Threads executing cv::async() functions and continuations from the FIFO queue */
+class AsyncExecutor
+{
+public:
+    AsyncExecutor()
+        : num_threads(defaultAsyncNumThreads())
+        , queue_size(defaultAsyncQueueSize())
+    {
+        // nothing
+    }
+
+    // never destroyed: threads are not joined at process exit
+    ~AsyncExecutor() {}
+
+    static AsyncExecutor& instance()
+    {
+        CV_SINGLETON_LAZY_INIT_REF(AsyncExecutor, new AsyncExecutor())
+    }
+
+    /** @param bounded wait for free space in the queue (cv::async() calls) */
+    void submit(AsyncTask& task, bool bounded)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (num_threads == 0)
+        {
+            lock.unlock();
+            task.run();
+            return;
+        }
+        if (bounded)
+        {
+            while (queue_size > 0 && tasks.size() >= queue_size)
+            {
+                if (isWorkerThread_())
+                {
+                    lock.unlock();
+                    task.run();
+                    return;
+                }
+                cond_space.wait(lock);
+            }
+        }
+        tasks.push_back(AsyncTask());
+        std::swap(tasks.back(), task);
+        if (threads.size() < num_threads)
+            threads.push_back(std::thread(&AsyncExecutor::workerBody, this, (unsigned)threads.size()));
+        else
+            cond_task.notify_one();
+    }
+
+    void setNumThreads(unsigned n)
+    {
+        std::vector<std::thread> finished;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (isWorkerThread_())
+                CV_Error(Error::StsError, "Number of asynchronous threads can't be changed from asynchronous function");
+            num_threads = n;
+            if (threads.size() > n)
+            {
+                for (size_t i = n; i < threads.size(); i++)
+                    finished.push_back(std::move(threads[i]));
+                threads.resize(n);
+                cond_task.notify_all();
+            }
+            // tasks are waiting for new threads
+            while (threads.size() < std::min((size_t)n, tasks.size()))
+                threads.push_back(std::thread(&AsyncExecutor::workerBody, this, (unsigned)threads.size()));
+        }
+        for (size_t i = 0; i < finished.size(); i++)
+            finished[i].join();
+        if (n == 0)
+        {
+            // nobody executes the rest of the queue
+            std::deque<AsyncTask> rest;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                rest.swap(tasks);
+                cond_space.notify_all();
+            }
+            for (size_t i = 0; i < rest.size(); i++)
+                rest[i].run();
+        }
+    }
+
+    unsigned getNumThreads()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        return num_threads;
+    }
+
+    void setQueueSize(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        queue_size = n;
+        cond_space.notify_all();
+    }
+
+    size_t getQueueSize()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        return queue_size;
+    }
+
+protected:
+    void workerBody(unsigned id)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;)
+        {
+            while (tasks.empty() && id < num_threads)
+                cond_task.wait(lock);
+            if (id >= num_threads)
+                break;
+            AsyncTask task;
+            std::swap(task, tasks.front());
+            tasks.pop_front();
+            cond_space.notify_one();
+            lock.unlock();
+            task.run();
+            task = AsyncTask();  // release captured state before waiting for the next task
+            lock.lock();
+        }
+    }
+
+    // locked
+    bool isWorkerThread_() const
+    {
+        const std::thread::id id = std::this_thread::get_id();
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            if (threads[i].get_id() == id)
+                return true;
+        }
+        return false;
+    }
+
+    std::mutex mtx;
+    std::condition_variable cond_task;
+    std::condition_variable cond_space;
+    std::deque<AsyncTask> tasks;
+    std::vector<std::thread> threads;
+    unsigned num_threads;
+    size_t queue_size;
+};
+
+#else  // OPENCV_DISABLE_THREAD_SUPPORT
+
+// no threading: functions are executed immediately
+class AsyncExecutor
+{
+public:
+    AsyncExecutor()
+        : num_threads(defaultAsyncNumThreads())
+        , queue_size(defaultAsyncQueueSize())
+    {
+        // nothing
+    }
+
+    static AsyncExecutor& instance()
+    {
+        CV_SINGLETON_LAZY_INIT_REF(AsyncExecutor, new AsyncExecutor())
+    }
+
+    void submit(AsyncTask& task, bool /*bounded*/) { task.run(); }
+    void setNumThreads(unsigned n) { num_threads = n; }
+    unsigned getNumThreads() { return num_threads; }
+    void setQueueSize(size_t n) { queue_size = n; }
+    size_t getQueueSize() { return queue_size; }
+
+protected:
+    unsigned num_threads;
+    size_t queue_size;
+};
+
+#endif  // OPENCV_DISABLE_THREAD_SUPPORT
+
+static void runAsyncFunction(AsyncPromise& promise, const std::function<void(OutputArray)>& fn)
+{
+    try
+    {
+        try
+        {
+            Mat dst;
+            fn(dst);
+            static_cast<AsyncArray::Impl*>(promise._getImpl())->moveValue(dst);
+        }
+#if CV__EXCEPTION_PTR
+        catch (...)
+        {
+            promise.setException(std::current_exception());
+        }
+#else
+        catch (const cv::Exception& e)
+        {
+            promise.setException(e);
+        }
+        catch (const std::exception& e)
+        {
+            promise.setException(cv::Exception(Error::StsError, e.what(), CV_Func, __FILE__, __LINE__));
+        }
+#endif
+    }
+    catch (const cv::Exception& e)
+    {
+        // nobody waits for the result
+        CV_LOG_DEBUG(NULL, "Result of asynchronous function is dropped: " << e.what());
+    }
+}
+
+static void submitAsyncFunction(const Ptr<AsyncPromise>& promise, const std::function<void(OutputArray)>& fn, bool bounded)
+{
+    AsyncTask task;
+    task.fn = [promise, fn]() { runAsyncFunction(*promise, fn); };
+    task.ctx = parallel::ExecutionContext::getCurrentRef();
+    AsyncExecutor::instance().submit(task, bounded);
+}
+
+}  // namespace
+
+AsyncArray async(const std::function<void(OutputArray)>& fn)
+{
+    CV_Assert(fn);
+    Ptr<AsyncPromise> promise = makePtr<AsyncPromise>();
+    AsyncArray result = promise->getArrayResult();
+    submitAsyncFunction(promise, fn, true);
+    return result;
+}
+
+AsyncArray AsyncArray::then(const std::function<void(InputArray, OutputArray)>& fn) const
+{
+    CV_Assert(p);
+    CV_Assert(fn);
+    Ptr<AsyncPromise> promise = makePtr<AsyncPromise>();
+    AsyncArray result = promise->getArrayResult();
+    const parallel::ExecutionContext ctx = parallel::ExecutionContext::getCurrentRef();
+    p->onResult([promise, fn, ctx](const AsyncArray& src)
+    {
+        // bind execution context of the then() caller while the task is submitted
+        parallel::ExecutionContextScope scope(ctx);
+        submitAsyncFunction(promise, [src, fn](OutputArray dst)
+        {
+            Mat value;
+            src.p->get(value, -1, true);
+            fn(value, dst);
+        }, false);
+    });
+    return result;
+}
+
+void setAsyncNumThreads(int nthreads)
+{
+    CV_Assert(nthreads >= 0);
+    AsyncExecutor::instance().setNumThreads((unsigned)nthreads);
+}
+
+int getAsyncNumThreads()
+{
+    return (int)AsyncExecutor::instance().getNumThreads();
+}
+
+void setAsyncQueueSize(int size)
+{
+    CV_Assert(size >= 0);
+    AsyncExecutor::instance().setQueueSize((size_t)size);
+}
+
+int getAsyncQueueSize()
+{
+    return (int)AsyncExecutor::instance().getQueueSize();
+}
+
 } // namespace
@@ -3483,6 +3483,45 @@ Ptr<DFT2D> DFT2D::create(int width, int height, int depth,
 } // cv::
 
 
+namespace cv {
+
+static void checkDftArgs(int type, int flags)
+{
+    CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
+
+    // Fail if DFT_COMPLEX_INPUT is specified, but src is not 2 channels.
+    CV_Assert( !((flags & DFT_COMPLEX_INPUT) && CV_MAT_CN(type) != 2) );
+}
+
+static int getDftOutputType(int type, int flags)
+{
+    bool inv = (flags & DFT_INVERSE) != 0;
+    int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    if( !inv && cn == 1 && (flags & DFT_COMPLEX_OUTPUT) )
+        return CV_MAKETYPE(depth, 2);
+    if( inv && cn == 2 && (flags & DFT_REAL_OUTPUT) )
+        return depth;
+    return type;
+}
+
+static int getHalDftFlags(int flags, bool isContinuous, bool isInplace)
+{
+    int f = 0;
+    if (isContinuous)
+        f |= CV_HAL_DFT_IS_CONTINUOUS;
+    if (flags & DFT_INVERSE)
+        f |= CV_HAL_DFT_INVERSE;
+    if (flags & DFT_ROWS)
+        f |= CV_HAL_DFT_ROWS;
+    if (flags & DFT_SCALE)
+        f |= CV_HAL_DFT_SCALE;
+    if (isInplace)
+        f |= CV_HAL_DFT_IS_INPLACE;
+    return f;
+}
+
+} // cv::
+
 void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
 {
     CV_INSTRUMENT_REGION();
@@ -3499,35 +3538,16 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
 #endif
 
     Mat src0 = _src0.getMat(), src = src0;
-    bool inv = (flags & DFT_INVERSE) != 0;
     int type = src.type();
     int depth = src.depth();
 
-    CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
+    checkDftArgs(type, flags);
 
-    // Fail if DFT_COMPLEX_INPUT is specified, but src is not 2 channels.
-    CV_Assert( !((flags & DFT_COMPLEX_INPUT) && src.channels() != 2) );
-
-    if( !inv && src.channels() == 1 && (flags & DFT_COMPLEX_OUTPUT) )
-        _dst.create( src.size(), CV_MAKETYPE(depth, 2) );
-    else if( inv && src.channels() == 2 && (flags & DFT_REAL_OUTPUT) )
-        _dst.create( src.size(), depth );
-    else
-        _dst.create( src.size(), type );
+    _dst.create( src.size(), getDftOutputType(type, flags) );
 
     Mat dst = _dst.getMat();
 
-    int f = 0;
-    if (src.isContinuous() && dst.isContinuous())
-        f |= CV_HAL_DFT_IS_CONTINUOUS;
-    if (inv)
-        f |= CV_HAL_DFT_INVERSE;
-    if (flags & DFT_ROWS)
-        f |= CV_HAL_DFT_ROWS;
-    if (flags & DFT_SCALE)
-        f |= CV_HAL_DFT_SCALE;
-    if (src.data == dst.data)
-        f |= CV_HAL_DFT_IS_INPLACE;
+    int f = getHalDftFlags(flags, src.isContinuous() && dst.isContinuous(), src.data == dst.data);
     Ptr<hal::DFT2D> c = hal::DFT2D::create(src.cols, src.rows, depth, src.channels(), dst.channels(), f, nonzero_rows);
     c->apply(src.data, src.step, dst.data, dst.step);
 }
@@ -3540,6 +3560,105 @@ void cv::idft( InputArray src, OutputArray dst, int flags, int nonzero_rows )
     dft( src, dst, flags | DFT_INVERSE, nonzero_rows );
 }
 
+//================== DFTPlan ======================
+
+namespace cv {
+
+struct DFTPlan::Impl
+{
+    Impl(Size size_, int type_, int flags_, int nonzeroRows_) :
+        size(size_), type(type_), flags(flags_), nonzeroRows(nonzeroRows_)
+    {}
+
+    // the transform depends on the continuity of the arrays and on whether it is done in-place
+    hal::DFT2D* getTransform(int halFlags)
+    {
+        int idx = ((halFlags & CV_HAL_DFT_IS_CONTINUOUS) ? 1 : 0) + ((halFlags & CV_HAL_DFT_IS_INPLACE) ? 2 : 0);
+        if (!transforms[idx])
+            transforms[idx] = hal::DFT2D::create(size.width, size.height, CV_MAT_DEPTH(type), CV_MAT_CN(type),
+                                                 CV_MAT_CN(getDftOutputType(type, flags)), halFlags, nonzeroRows);
+        return transforms[idx].get();
+    }
+
+    Size size;
+    int type;
+    int flags;
+    int nonzeroRows;
+    Ptr<hal::DFT2D> transforms[4];
+};
+
+DFTPlan::DFTPlan()
+{
+}
+
+DFTPlan::DFTPlan(Size size, int type, int flags, int nonzeroRows)
+{
+    create(size, type, flags, nonzeroRows);
+}
+
+DFTPlan::~DFTPlan()
+{
+}
+
+void DFTPlan::create(Size size, int type, int flags, int nonzeroRows)
+{
+    CV_INSTRUMENT_REGION();
+
+    if (p && p->size == size && p->type == type && p->flags == flags && p->nonzeroRows == nonzeroRows)
+        return;
+
+    CV_Assert(size.width > 0 && size.height > 0);
+    checkDftArgs(type, flags);
+
+    Ptr<Impl> impl = makePtr<Impl>(size, type, flags, nonzeroRows);
+    // prepare the most common case, continuous arrays and out-of-place transform
+    impl->getTransform(getHalDftFlags(flags, true, false));
+    p = impl;
+}
+
+void DFTPlan::execute(InputArray _src, OutputArray _dst)
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_Assert(!empty());
+    Mat src = _src.getMat();
+    CV_Assert(src.size() == p->size && src.type() == p->type);
+
+    _dst.create(src.size(), getDftOutputType(p->type, p->flags));
+    Mat dst = _dst.getMat();
+
+    hal::DFT2D* c = p->getTransform(getHalDftFlags(p->flags, src.isContinuous() && dst.isContinuous(),
+                                                    src.data == dst.data));
+    c->apply(src.data, src.step, dst.data, dst.step);
+}
+
+void DFTPlan::release()
+{
+    p.release();
+}
+
+bool DFTPlan::empty() const
+{
+    return !p;
+}
+
+Size DFTPlan::size() const
+{
+    return p ? p->size : Size();
+}
+
+int DFTPlan::type() const
+{
+    return p ? p->type : -1;
+}
+
+int DFTPlan::flags() const
+{
+    return p ? p->flags : 0;
+}
+
+} // cv::
+
 #ifdef HAVE_OPENCL
 
 namespace cv {
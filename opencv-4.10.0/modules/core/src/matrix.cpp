@@ -4,6 +4,8 @@
 
 #include "precomp.hpp"
 #include "bufferpool.impl.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
+#include <opencv2/core/utils/logger.hpp>
 
 namespace cv {
 
@@ -176,10 +178,21 @@ public:
     }
 };
 
+static
+MatAllocator* createDefaultAllocator()
+{
+    const std::string name = utils::getConfigurationParameterString("OPENCV_MAT_ALLOCATOR", "");
+    if (name == "pool")
+        return Mat::getPoolAllocator();
+    if (!name.empty() && name != "std")
+        CV_LOG_WARNING(NULL, "Unknown OPENCV_MAT_ALLOCATOR value: '" << name << "'. Supported values: std, pool");
+    return Mat::getStdAllocator();
+}
+
 static
 MatAllocator*& getDefaultAllocatorMatRef()
 {
-    static MatAllocator* g_matAllocator = Mat::getStdAllocator();
+    static MatAllocator* g_matAllocator = createDefaultAllocator();
     return g_matAllocator;
 }
 
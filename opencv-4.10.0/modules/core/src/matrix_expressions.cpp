@@ -200,6 +200,25 @@ static MatOp_Initializer* getGlobalMatOpInitializer()
     CV_SINGLETON_LAZY_INIT(MatOp_Initializer, new MatOp_Initializer())
 }
 
+enum FusedOpCode
+{
+    FUSED_ADDW = 0,  // x*alpha + y*beta + s
+    FUSED_MUL,       // x*y*alpha
+    FUSED_DIV,       // x*alpha/y
+    FUSED_RECIP,     // alpha/x
+    FUSED_ABSDIFF,   // |x - y|
+    FUSED_MIN,       // min(x, y)
+    FUSED_MAX,       // max(x, y)
+    FUSED_CMP        // x cmpop y, 8U mask (the last operation only)
+};
+
+// Where an operation would evaluate its operand expressions into temporary matrices, the operands
+// and the operation are computed in a single pass over floating-point arrays of the same size and type.
+// As with the temporaries, the result is computed when the expression is built, res is its identity
+// expression. Returns false if the operands can't be fused (caller should use the regular expression).
+static bool makeFusedExpr(MatExpr& res, int code, const MatExpr& e1, const MatExpr* e2,
+                          double alpha=1, double beta=0, const Scalar& s=Scalar(), int cmpop=0);
+
 static inline bool isIdentity(const MatExpr& e) { return e.op == &g_MatOp_Identity; }
 static inline bool isAddEx(const MatExpr& e) { return e.op == &g_MatOp_AddEx; }
 static inline bool isScaled(const MatExpr& e) { return isAddEx(e) && (!e.b.data || e.beta == 0) && e.s == Scalar(); }
@@ -213,6 +232,11 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == getGlobalMatOpInitializer(); }
 
+// operands which MatOp::add() and MatOp::subtract() merge into MatOp_AddEx without evaluation
+static inline bool isAddOperand(const MatExpr& e) { return isIdentity(e) || (isAddEx(e) && (!e.b.data || e.beta == 0)); }
+// operands which MatOp::multiply() and MatOp::divide() merge into MatOp_Bin without evaluation
+static inline bool isMulOperand(const MatExpr& e) { return isIdentity(e) || isScaled(e); }
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
 MatOp::MatOp() {}
@@ -329,6 +353,10 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
     if( this == e2.op )
     {
+        if( !(isAddOperand(e1) && isAddOperand(e2)) &&
+            makeFusedExpr(res, FUSED_ADDW, e1, &e2, 1, 1) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -360,6 +388,9 @@ void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( !isIdentity(expr1) && makeFusedExpr(res, FUSED_ADDW, expr1, 0, 1, 0, s) )
+        return;
+
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -372,6 +403,10 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
     if( this == e2.op )
     {
+        if( !(isAddOperand(e1) && isAddOperand(e2)) &&
+            makeFusedExpr(res, FUSED_ADDW, e1, &e2, 1, -1) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -403,6 +438,9 @@ void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( !isIdentity(expr) && makeFusedExpr(res, FUSED_ADDW, expr, 0, -1, 0, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -415,6 +453,11 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
     if( this == e2.op )
     {
+        if( !((isMulOperand(e1) && (isMulOperand(e2) || isReciprocal(e2))) ||
+              (isReciprocal(e1) && isMulOperand(e2))) &&
+            makeFusedExpr(res, FUSED_MUL, e1, &e2, scale) )
+            return;
+
         Mat m1, m2;
 
         if( isReciprocal(e1) )
@@ -466,6 +509,9 @@ void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( !isIdentity(expr) && makeFusedExpr(res, FUSED_ADDW, expr, 0, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -480,6 +526,9 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
     {
         if( isReciprocal(e1) && isReciprocal(e2) )
             MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
+        else if( !(isMulOperand(e1) && (isMulOperand(e2) || isReciprocal(e2))) &&
+                 makeFusedExpr(res, FUSED_DIV, e1, &e2, scale) )
+            return;
         else
         {
             Mat m1, m2;
@@ -518,6 +567,9 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( !isIdentity(expr) && makeFusedExpr(res, FUSED_RECIP, expr, 0, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
@@ -528,6 +580,9 @@ void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION();
 
+    if( !isIdentity(expr) && makeFusedExpr(res, FUSED_ABSDIFF, expr, 0) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -942,6 +997,50 @@ MatExpr operator / (const MatExpr& e1, const MatExpr& e2)
     return en;
 }
 
+static void makeCmpExpr(MatExpr& res, int cmpop, const MatExpr& e1, const MatExpr& e2)
+{
+    if( (isIdentity(e1) && isIdentity(e2)) ||
+        !makeFusedExpr(res, FUSED_CMP, e1, &e2, 1, 0, Scalar(), cmpop) )
+    {
+        Mat m1 = e1, m2 = e2;
+        checkOperandsExist(m1, m2);
+        MatOp_Cmp::makeExpr(res, cmpop, m1, m2);
+    }
+}
+
+static void makeCmpExpr(MatExpr& res, int cmpop, const MatExpr& e, double s)
+{
+    if( isIdentity(e) ||
+        !makeFusedExpr(res, FUSED_CMP, e, 0, 1, 0, Scalar::all(s), cmpop) )
+    {
+        Mat m = e;
+        checkOperandsExist(m);
+        MatOp_Cmp::makeExpr(res, cmpop, m, s);
+    }
+}
+
+static void makeMinMaxExpr(MatExpr& res, char op, const MatExpr& e1, const MatExpr& e2)
+{
+    if( (isIdentity(e1) && isIdentity(e2)) ||
+        !makeFusedExpr(res, op == 'm' ? FUSED_MIN : FUSED_MAX, e1, &e2) )
+    {
+        Mat m1 = e1, m2 = e2;
+        checkOperandsExist(m1, m2);
+        MatOp_Bin::makeExpr(res, op, m1, m2);
+    }
+}
+
+static void makeMinMaxExpr(MatExpr& res, char op, const MatExpr& e, double s)
+{
+    if( isIdentity(e) ||
+        !makeFusedExpr(res, op == 'n' ? FUSED_MIN : FUSED_MAX, e, 0, 1, 0, Scalar::all(s)) )
+    {
+        Mat m = e;
+        checkOperandsExist(m);
+        MatOp_Bin::makeExpr(res, op, m, s);
+    }
+}
+
 MatExpr operator < (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -966,6 +1065,41 @@ MatExpr operator < (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator < (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator < (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator < (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, s);
+    return en;
+}
+
+MatExpr operator < (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, s);
+    return en;
+}
+
+MatExpr operator < (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e1, e2);
+    return en;
+}
+
 MatExpr operator <= (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -990,6 +1124,41 @@ MatExpr operator <= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator <= (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator <= (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator <= (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, s);
+    return en;
+}
+
+MatExpr operator <= (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, s);
+    return en;
+}
+
+MatExpr operator <= (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e1, e2);
+    return en;
+}
+
 MatExpr operator == (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -1014,6 +1183,41 @@ MatExpr operator == (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator == (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator == (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator == (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, s);
+    return en;
+}
+
+MatExpr operator == (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, s);
+    return en;
+}
+
+MatExpr operator == (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e1, e2);
+    return en;
+}
+
 MatExpr operator != (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -1038,6 +1242,41 @@ MatExpr operator != (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator != (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator != (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator != (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, s);
+    return en;
+}
+
+MatExpr operator != (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, s);
+    return en;
+}
+
+MatExpr operator != (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e1, e2);
+    return en;
+}
+
 MatExpr operator >= (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -1062,6 +1301,41 @@ MatExpr operator >= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator >= (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator >= (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator >= (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, s);
+    return en;
+}
+
+MatExpr operator >= (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, s);
+    return en;
+}
+
+MatExpr operator >= (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e1, e2);
+    return en;
+}
+
 MatExpr operator > (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -1086,6 +1360,41 @@ MatExpr operator > (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator > (const MatExpr& e, const Mat& m)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, MatExpr(m));
+    return en;
+}
+
+MatExpr operator > (const Mat& m, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, MatExpr(m), e);
+    return en;
+}
+
+MatExpr operator > (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, s);
+    return en;
+}
+
+MatExpr operator > (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, s);
+    return en;
+}
+
+MatExpr operator > (const MatExpr& e1, const MatExpr& e2)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e1, e2);
+    return en;
+}
+
 MatExpr min(const Mat& a, const Mat& b)
 {
     CV_INSTRUMENT_REGION();
@@ -1116,6 +1425,51 @@ MatExpr min(double s, const Mat& a)
     return e;
 }
 
+MatExpr min(const MatExpr& e, const Mat& m)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', e, MatExpr(m));
+    return en;
+}
+
+MatExpr min(const Mat& m, const MatExpr& e)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', MatExpr(m), e);
+    return en;
+}
+
+MatExpr min(const MatExpr& e, double s)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'n', e, s);
+    return en;
+}
+
+MatExpr min(double s, const MatExpr& e)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'n', e, s);
+    return en;
+}
+
+MatExpr min(const MatExpr& e1, const MatExpr& e2)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'm', e1, e2);
+    return en;
+}
+
 MatExpr max(const Mat& a, const Mat& b)
 {
     CV_INSTRUMENT_REGION();
@@ -1146,6 +1500,51 @@ MatExpr max(double s, const Mat& a)
     return e;
 }
 
+MatExpr max(const MatExpr& e, const Mat& m)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', e, MatExpr(m));
+    return en;
+}
+
+MatExpr max(const Mat& m, const MatExpr& e)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', MatExpr(m), e);
+    return en;
+}
+
+MatExpr max(const MatExpr& e, double s)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'N', e, s);
+    return en;
+}
+
+MatExpr max(double s, const MatExpr& e)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'N', e, s);
+    return en;
+}
+
+MatExpr max(const MatExpr& e1, const MatExpr& e2)
+{
+    CV_INSTRUMENT_REGION();
+
+    MatExpr en;
+    makeMinMaxExpr(en, 'M', e1, e2);
+    return en;
+}
+
 MatExpr operator & (const Mat& a, const Mat& b)
 {
     checkOperandsExist(a, b);
@@ -1714,6 +2113,408 @@ inline void MatOp_Initializer::makeExpr(MatExpr& res, int method, int ndims, con
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+enum
+{
+    FUSED_MAX_INPUTS = 8,
+    FUSED_MAX_OPS = 16,
+    FUSED_BLOCK_SIZE = 384  // elements, multiple of channels number and vector width
+};
+
+struct FusedOp
+{
+    int code;
+    int src1, src2;  // input index, FUSED_MAX_INPUTS + index of previous operation or -1 (use s)
+    int cmpop;
+    double alpha, beta;
+    Scalar s;        // per-channel addend of FUSED_ADDW or the second operand of other operations
+};
+
+struct FusedExpr
+{
+    std::vector<Mat> inputs;
+    std::vector<FusedOp> ops;
+
+    int type() const
+    {
+        int t = inputs[0].type();
+        return ops.back().code == FUSED_CMP ? CV_MAKETYPE(CV_8U, CV_MAT_CN(t)) : t;
+    }
+
+    int addInput(const Mat& m);
+    int addOp(int code, int src1, int src2, double alpha=1, double beta=0, const Scalar& s=Scalar(), int cmpop=0);
+    int append(const MatExpr& e);
+};
+
+// scalar term of MatOp_AddEx::assign(): real scalar is added to all channels by some of its branches
+static Scalar getAddExScalar(const MatExpr& e)
+{
+    if( !e.s.isReal() )
+        return e.s;
+    if( e.b.data ? e.s != Scalar() : fabs(e.alpha) != 1 )
+        return Scalar::all(e.s[0]);
+    return e.s;
+}
+
+int FusedExpr::addInput(const Mat& m)
+{
+    if( m.empty() || (m.depth() != CV_32F && m.depth() != CV_64F) )
+        return -1;
+    for( size_t i = 0; i < inputs.size(); i++ )
+    {
+        const Mat& x = inputs[i];
+        bool same = x.data == m.data && x.type() == m.type() && x.size == m.size;
+        for( int k = 0; k < x.dims && same; k++ )
+            same = x.step[k] == m.step[k];
+        if( same )
+            return (int)i;
+    }
+    if( !inputs.empty() && (m.type() != inputs[0].type() || m.size != inputs[0].size) )
+        return -1;
+    if( inputs.size() >= (size_t)FUSED_MAX_INPUTS )
+        return -1;
+    inputs.push_back(m);
+    return (int)inputs.size() - 1;
+}
+
+int FusedExpr::addOp(int code, int src1, int src2, double alpha, double beta, const Scalar& s, int cmpop)
+{
+    if( src1 < 0 || ops.size() >= (size_t)FUSED_MAX_OPS )
+        return -1;
+    FusedOp op;
+    op.code = code;
+    op.src1 = src1;
+    op.src2 = src2;
+    op.cmpop = cmpop;
+    op.alpha = alpha;
+    op.beta = beta;
+    op.s = s;
+    ops.push_back(op);
+    return FUSED_MAX_INPUTS + (int)ops.size() - 1;
+}
+
+// adds evaluation of e to the program, returns index of the result or -1
+int FusedExpr::append(const MatExpr& e)
+{
+    if( isIdentity(e) )
+        return addInput(e.a);
+
+    if( isAddEx(e) )
+    {
+        int x = addInput(e.a), y = e.b.data ? addInput(e.b) : -1;
+        if( x < 0 || (e.b.data && y < 0) )
+            return -1;
+        return addOp(FUSED_ADDW, x, y, e.alpha, e.beta, getAddExScalar(e));
+    }
+
+    if( e.op == &g_MatOp_Bin )
+    {
+        int x = addInput(e.a), y = e.b.data ? addInput(e.b) : -1;
+        if( x < 0 || (e.b.data && y < 0) )
+            return -1;
+        switch( e.flags )
+        {
+        case '*':
+            return addOp(FUSED_MUL, x, y, e.alpha);
+        case '/':
+            return e.b.data ? addOp(FUSED_DIV, x, y, e.alpha) : addOp(FUSED_RECIP, x, -1, e.alpha);
+        case 'm':
+            return addOp(FUSED_MIN, x, y);
+        case 'M':
+            return addOp(FUSED_MAX, x, y);
+        case 'n':
+        case 'N':
+            // cv::min(Mat, double) and cv::max(Mat, double) are defined for single-channel arrays only
+            if( e.a.channels() != 1 )
+                return -1;
+            return addOp(e.flags == 'n' ? FUSED_MIN : FUSED_MAX, x, -1, 1, 0, Scalar::all(e.s[0]));
+        case 'a':
+            return addOp(FUSED_ABSDIFF, x, y, 1, 0, e.s);
+        default:
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+template<typename T> struct FusedVec { enum { enabled = 0 }; };
+
+template<typename T> static inline
+int fusedOpSIMD(int, const T*, const T*, const T*, T*, int, T, T, std::false_type) { return 0; }
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+template<> struct FusedVec<float>
+{
+    enum { enabled = 1 };
+    typedef v_float32 vec_type;
+    static inline v_float32 setall(float v) { return vx_setall_f32(v); }
+};
+
+#if (CV_SIMD_64F || CV_SIMD_SCALABLE_64F)
+template<> struct FusedVec<double>
+{
+    enum { enabled = 1 };
+    typedef v_float64 vec_type;
+    static inline v_float64 setall(double v) { return vx_setall_f64(v); }
+};
+#endif
+
+template<typename T> static
+int fusedOpSIMD(int code, const T* x, const T* y, const T* s, T* d, int n, T alpha, T beta, std::true_type)
+{
+    typedef typename FusedVec<T>::vec_type VT;
+    const int vlanes = VTraits<VT>::vlanes();
+    const VT va = FusedVec<T>::setall(alpha), vb = FusedVec<T>::setall(beta);
+    int i = 0;
+
+    switch( code )
+    {
+    case FUSED_ADDW:
+        if( y )
+            for( ; i <= n - vlanes; i += vlanes )
+                v_store(d + i, v_add(v_add(v_mul(vx_load(x + i), va), v_mul(vx_load(y + i), vb)), vx_load(s + i)));
+        else
+            for( ; i <= n - vlanes; i += vlanes )
+                v_store(d + i, v_add(v_mul(vx_load(x + i), va), vx_load(s + i)));
+        break;
+    case FUSED_MUL:
+        for( ; i <= n - vlanes; i += vlanes )
+            v_store(d + i, v_mul(v_mul(vx_load(x + i), vx_load(y + i)), va));
+        break;
+    case FUSED_DIV:
+        for( ; i <= n - vlanes; i += vlanes )
+            v_store(d + i, v_div(v_mul(vx_load(x + i), va), vx_load(y + i)));
+        break;
+    case FUSED_RECIP:
+        for( ; i <= n - vlanes; i += vlanes )
+            v_store(d + i, v_div(va, vx_load(x + i)));
+        break;
+    case FUSED_ABSDIFF:
+        for( ; i <= n - vlanes; i += vlanes )
+            v_store(d + i, v_absdiff(vx_load(x + i), vx_load(y + i)));
+        break;
+    case FUSED_MIN:
+        for( ; i <= n - vlanes; i += vlanes )
+            v_store(d + i, v_min(vx_load(x + i), vx_load(y + i)));
+        break;
+    case FUSED_MAX:
+        for( ; i <= n - vlanes; i += vlanes )
+            v_store(d + i, v_max(vx_load(x + i), vx_load(y + i)));
+        break;
+    default:
+        break;
+    }
+    vx_cleanup();
+    return i;
+}
+
+struct FusedCmpLT { inline v_float32 operator()(const v_float32& a, const v_float32& b) const { return v_lt(a, b); } };
+struct FusedCmpLE { inline v_float32 operator()(const v_float32& a, const v_float32& b) const { return v_le(a, b); } };
+struct FusedCmpEQ { inline v_float32 operator()(const v_float32& a, const v_float32& b) const { return v_eq(a, b); } };
+struct FusedCmpNE { inline v_float32 operator()(const v_float32& a, const v_float32& b) const { return v_ne(a, b); } };
+
+template<class Cmp> static
+int fusedCompareSIMD_(const float* x, const float* y, uchar* d, int n, const Cmp& cmp)
+{
+    const int vlanes = VTraits<v_float32>::vlanes();
+    int i = 0;
+    for( ; i <= n - vlanes*4; i += vlanes*4 )
+    {
+        v_uint32 m0 = v_reinterpret_as_u32(cmp(vx_load(x + i), vx_load(y + i)));
+        v_uint32 m1 = v_reinterpret_as_u32(cmp(vx_load(x + i + vlanes), vx_load(y + i + vlanes)));
+        v_uint32 m2 = v_reinterpret_as_u32(cmp(vx_load(x + i + vlanes*2), vx_load(y + i + vlanes*2)));
+        v_uint32 m3 = v_reinterpret_as_u32(cmp(vx_load(x + i + vlanes*3), vx_load(y + i + vlanes*3)));
+        v_store(d + i, v_pack_b(m0, m1, m2, m3));
+    }
+    vx_cleanup();
+    return i;
+}
+
+static int fusedCompareSIMD(int cmpop, const float* x, const float* y, uchar* d, int n)
+{
+    switch( cmpop )
+    {
+    case CMP_LT: return fusedCompareSIMD_(x, y, d, n, FusedCmpLT());
+    case CMP_LE: return fusedCompareSIMD_(x, y, d, n, FusedCmpLE());
+    case CMP_EQ: return fusedCompareSIMD_(x, y, d, n, FusedCmpEQ());
+    case CMP_NE: return fusedCompareSIMD_(x, y, d, n, FusedCmpNE());
+    default: return 0;
+    }
+}
+#else
+static inline int fusedCompareSIMD(int, const float*, const float*, uchar*, int) { return 0; }
+#endif
+
+static inline int fusedCompareSIMD(int, const double*, const double*, uchar*, int) { return 0; }
+
+template<typename T> static
+void fusedOp(const FusedOp& op, const T* x, const T* y, const T* s, T* d, int n)
+{
+    const T alpha = saturate_cast<T>(op.alpha), beta = saturate_cast<T>(op.beta);
+    int i = fusedOpSIMD(op.code, x, y, s, d, n, alpha, beta,
+                        std::integral_constant<bool, FusedVec<T>::enabled != 0>());
+
+    switch( op.code )
+    {
+    case FUSED_ADDW:
+        if( y )
+            for( ; i < n; i++ )
+                d[i] = x[i]*alpha + y[i]*beta + s[i];
+        else
+            for( ; i < n; i++ )
+                d[i] = x[i]*alpha + s[i];
+        break;
+    case FUSED_MUL:
+        for( ; i < n; i++ )
+            d[i] = x[i]*y[i]*alpha;
+        break;
+    case FUSED_DIV:
+        for( ; i < n; i++ )
+            d[i] = x[i]*alpha/y[i];
+        break;
+    case FUSED_RECIP:
+        for( ; i < n; i++ )
+            d[i] = alpha/x[i];
+        break;
+    case FUSED_ABSDIFF:
+        for( ; i < n; i++ )
+            d[i] = std::abs(x[i] - y[i]);
+        break;
+    case FUSED_MIN:
+        for( ; i < n; i++ )
+            d[i] = std::min(x[i], y[i]);
+        break;
+    case FUSED_MAX:
+        for( ; i < n; i++ )
+            d[i] = std::max(x[i], y[i]);
+        break;
+    default:
+        CV_Error(Error::StsError, "Unknown operation");
+    }
+}
+
+template<typename T> static
+void fusedCompare(int cmpop, const T* x, const T* y, uchar* d, int n)
+{
+    if( cmpop == CMP_GT || cmpop == CMP_GE )
+    {
+        std::swap(x, y);
+        cmpop = cmpop == CMP_GT ? CMP_LT : CMP_LE;
+    }
+    int i = fusedCompareSIMD(cmpop, x, y, d, n);
+
+    switch( cmpop )
+    {
+    case CMP_LT:
+        for( ; i < n; i++ )
+            d[i] = (uchar)-(int)(x[i] < y[i]);
+        break;
+    case CMP_LE:
+        for( ; i < n; i++ )
+            d[i] = (uchar)-(int)(x[i] <= y[i]);
+        break;
+    case CMP_EQ:
+        for( ; i < n; i++ )
+            d[i] = (uchar)-(int)(x[i] == y[i]);
+        break;
+    case CMP_NE:
+        for( ; i < n; i++ )
+            d[i] = (uchar)-(int)(x[i] != y[i]);
+        break;
+    default:
+        CV_Error(Error::StsBadArg, "Unknown comparison method");
+    }
+}
+
+// Evaluates the program over blocks of FUSED_BLOCK_SIZE elements: intermediate results stay
+// in the cache and only the last operation writes to the destination.
+template<typename T> static
+void evalFusedExpr(const FusedExpr& fe, Mat& dst)
+{
+    const int ninputs = (int)fe.inputs.size(), nops = (int)fe.ops.size();
+    const int cn = fe.inputs[0].channels();
+
+    // unrolled per-channel constants of the operations, then their results
+    AutoBuffer<T> _buf((size_t)FUSED_BLOCK_SIZE*nops*2);
+    T* consts = _buf.data();
+    T* results = consts + FUSED_BLOCK_SIZE*nops;
+    for( int j = 0; j < nops; j++ )
+        for( int i = 0; i < FUSED_BLOCK_SIZE; i++ )
+            consts[FUSED_BLOCK_SIZE*j + i] = saturate_cast<T>(fe.ops[j].s[i % cn]);
+
+    const Mat* arrays[FUSED_MAX_INPUTS + 2];
+    uchar* ptrs[FUSED_MAX_INPUTS + 1];
+    for( int k = 0; k < ninputs; k++ )
+        arrays[k] = &fe.inputs[k];
+    arrays[ninputs] = &dst;
+    arrays[ninputs + 1] = 0;
+    NAryMatIterator it(arrays, ptrs, ninputs + 1);
+    const size_t total = it.size*cn;
+    const T* regs[FUSED_MAX_INPUTS + FUSED_MAX_OPS];
+
+    for( size_t p = 0; p < it.nplanes; p++, ++it )
+    {
+        for( size_t ofs = 0; ofs < total; ofs += FUSED_BLOCK_SIZE )
+        {
+            int len = (int)std::min(total - ofs, (size_t)FUSED_BLOCK_SIZE);
+            for( int k = 0; k < ninputs; k++ )
+                regs[k] = (const T*)ptrs[k] + ofs;
+
+            for( int j = 0; j < nops; j++ )
+            {
+                const FusedOp& op = fe.ops[j];
+                const T* s = consts + FUSED_BLOCK_SIZE*j;
+                const T* x = regs[op.src1];
+                const T* y = op.src2 >= 0 ? regs[op.src2] : op.code == FUSED_ADDW ? 0 : s;
+
+                if( op.code == FUSED_CMP )
+                {
+                    fusedCompare(op.cmpop, x, y, ptrs[ninputs] + ofs, len);
+                    break;
+                }
+
+                T* d = j == nops - 1 ? (T*)ptrs[ninputs] + ofs : results + FUSED_BLOCK_SIZE*j;
+                fusedOp(op, x, y, s, d, len);
+                regs[FUSED_MAX_INPUTS + j] = d;
+            }
+        }
+    }
+}
+
+static bool makeFusedExpr(MatExpr& res, int code, const MatExpr& e1, const MatExpr* e2,
+                          double alpha, double beta, const Scalar& s, int cmpop)
+{
+    int depth = CV_MAT_DEPTH(e1.type());
+    if( depth != CV_32F && depth != CV_64F )
+        return false;
+
+    FusedExpr fe;
+    int x = fe.append(e1), y = e2 ? fe.append(*e2) : -1;
+    if( x < 0 || (e2 && y < 0) )
+        return false;
+    // scalar operands have up to 4 channels and are replicated over a block,
+    // which must hold a whole number of pixels
+    int cn = fe.inputs[0].channels();
+    if( cn > 4 || FUSED_BLOCK_SIZE % cn != 0 )
+        return false;
+    // comparisons and min/max with a scalar are fused for single-channel arrays only
+    if( (code == FUSED_CMP || ((code == FUSED_MIN || code == FUSED_MAX) && !e2)) && cn != 1 )
+        return false;
+    if( fe.addOp(code, x, y, alpha, beta, s, cmpop) < 0 )
+        return false;
+
+    const Mat& src = fe.inputs[0];
+    Mat dst(src.dims, src.size.p, fe.type());
+    if( depth == CV_32F )
+        evalFusedExpr<float>(fe, dst);
+    else
+        evalFusedExpr<double>(fe, dst);
+    res = MatExpr(dst);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 MatExpr Mat::t() const
 {
     CV_INSTRUMENT_REGION();
@@ -0,0 +1,522 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include "opencv2/core/bufferpool.hpp"
+#include "opencv2/core/utils/allocator_stats.impl.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
+#include "opencv2/core/utils/tls.hpp"
+
+#include <atomic>
+
+namespace cv {
+
+namespace {
+
+// Buffers are rounded up to size classes: 64 bytes, then each (2^k, 2^(k+1)] range is split into 4 classes
+// (less than 25% of memory overhead).
+static const int MIN_BLOCK_SIZE_LOG2 = 6;
+static const int MAX_BLOCK_SIZE_LOG2 = 30;
+static const int SUBCLASSES_LOG2 = 2;
+static const int MAX_CLASSES = 1 + ((MAX_BLOCK_SIZE_LOG2 - MIN_BLOCK_SIZE_LOG2) << SUBCLASSES_LOG2);
+
+static inline int highestBit(size_t v)
+{
+    CV_DbgAssert(v > 0);
+#if defined __GNUC__
+    return (int)(sizeof(unsigned long long) * 8 - 1) - __builtin_clzll((unsigned long long)v);
+#else
+    int r = 0;
+    while (v >>= 1)
+        r++;
+    return r;
+#endif
+}
+
+static inline int sizeToClass(size_t size)
+{
+    if (size <= ((size_t)1 << MIN_BLOCK_SIZE_LOG2))
+        return 0;
+    const int lg = highestBit(size - 1);
+    const int sub = (int)((size - 1) >> (lg - SUBCLASSES_LOG2)) & ((1 << SUBCLASSES_LOG2) - 1);
+    return 1 + ((lg - MIN_BLOCK_SIZE_LOG2) << SUBCLASSES_LOG2) + sub;
+}
+
+static inline size_t classToSize(int idx)
+{
+    CV_DbgAssert(0 <= idx && idx < MAX_CLASSES);
+    if (idx == 0)
+        return (size_t)1 << MIN_BLOCK_SIZE_LOG2;
+    const int lg = MIN_BLOCK_SIZE_LOG2 + ((idx - 1) >> SUBCLASSES_LOG2);
+    const size_t sub = (size_t)((idx - 1) & ((1 << SUBCLASSES_LOG2) - 1));
+    return (((size_t)1 << SUBCLASSES_LOG2) + sub + 1) << (lg - SUBCLASSES_LOG2);
+}
+
+// released buffers keep the link to the next buffer of the list in their first bytes
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct FreeList
+{
+    FreeBlock* head;
+    size_t count;
+
+    inline void push(void* ptr)
+    {
+        FreeBlock* block = (FreeBlock*)ptr;
+        block->next = head;
+        head = block;
+        count++;
+    }
+
+    inline void* pop()
+    {
+        FreeBlock* block = head;
+        CV_DbgAssert(block);
+        head = block->next;
+        count--;
+        return block;
+    }
+
+    /** detaches up to n first buffers, returns number of detached buffers */
+    inline size_t cut(size_t n, FreeBlock*& first)
+    {
+        first = head;
+        size_t i = 0;
+        FreeBlock* last = NULL;
+        for (FreeBlock* b = head; b && i < n; b = b->next, i++)
+            last = b;
+        if (last)
+        {
+            head = last->next;
+            last->next = NULL;
+        }
+        count -= i;
+        return i;
+    }
+};
+
+class MatPoolStatistics CV_FINAL : public utils::PoolAllocatorStatisticsInterface
+{
+protected:
+    typedef OPENCV_ALLOCATOR_STATS_COUNTER_TYPE counter_t;
+    std::atomic<counter_t> curr, total, total_allocs, peak;
+    std::atomic<counter_t> hits, reclaims, misses, reserved;
+public:
+    MatPoolStatistics() : curr(0), total(0), total_allocs(0), peak(0), hits(0), reclaims(0), misses(0), reserved(0) {}
+    ~MatPoolStatistics() CV_OVERRIDE {}
+
+    uint64_t getCurrentUsage() const CV_OVERRIDE { return (uint64_t)curr.load(); }
+    uint64_t getTotalUsage() const CV_OVERRIDE { return (uint64_t)total.load(); }
+    uint64_t getNumberOfAllocations() const CV_OVERRIDE { return (uint64_t)total_allocs.load(); }
+    uint64_t getPeakUsage() const CV_OVERRIDE { return (uint64_t)peak.load(); }
+    void resetPeakUsage() CV_OVERRIDE { peak.store(curr.load()); }
+
+    uint64_t getNumberOfHits() const CV_OVERRIDE { return (uint64_t)hits.load(); }
+    uint64_t getNumberOfReclaims() const CV_OVERRIDE { return (uint64_t)reclaims.load(); }
+    uint64_t getNumberOfMisses() const CV_OVERRIDE { return (uint64_t)misses.load(); }
+    uint64_t getReservedSize() const CV_OVERRIDE { return (uint64_t)reserved.load(); }
+
+    void resetCounters() CV_OVERRIDE
+    {
+        total_allocs.store(0);
+        hits.store(0);
+        reclaims.store(0);
+        misses.store(0);
+    }
+
+    void onAllocate(size_t sz, std::atomic<counter_t>& kind)
+    {
+        counter_t new_curr = curr.fetch_add((counter_t)sz, std::memory_order_relaxed) + (counter_t)sz;
+        counter_t prev_peak = peak.load(std::memory_order_relaxed);
+        while (prev_peak < new_curr)
+        {
+            if (peak.compare_exchange_weak(prev_peak, new_curr))
+                break;
+        }
+        total.fetch_add((counter_t)sz, std::memory_order_relaxed);
+        total_allocs.fetch_add(1, std::memory_order_relaxed);
+        kind.fetch_add(1, std::memory_order_relaxed);
+    }
+    void onHit(size_t sz) { onAllocate(sz, hits); }
+    void onReclaim(size_t sz) { onAllocate(sz, reclaims); }
+    void onMiss(size_t sz) { onAllocate(sz, misses); }
+    void onFree(size_t sz) { curr.fetch_sub((counter_t)sz, std::memory_order_relaxed); }
+
+    void onReserve(size_t sz) { reserved.fetch_add((counter_t)sz, std::memory_order_relaxed); }
+    void onUnreserve(size_t sz) { reserved.fetch_sub((counter_t)sz, std::memory_order_relaxed); }
+};
+
+// never destroyed: caches of threads are released at process exit too
+static MatPoolStatistics& getMatPoolStatistics()
+{
+    CV_SINGLETON_LAZY_INIT_REF(MatPoolStatistics, new MatPoolStatistics())
+}
+
+class PoolMatAllocator;
+
+struct ThreadCache
+{
+    ThreadCache() : pool(NULL), size(0), generation(0)
+    {
+        memset(lists, 0, sizeof(lists));
+    }
+    ~ThreadCache();
+
+    PoolMatAllocator* pool;
+    FreeList lists[MAX_CLASSES];
+    size_t size;  // bytes in all lists
+    unsigned generation;  // freeAllReservedBuffers() calls seen by this thread
+};
+
+// shared reclaim list of one size class
+struct SharedList
+{
+    SharedList() { memset(&list, 0, sizeof(list)); }
+
+    Mutex mutex;
+    FreeList list;
+};
+
+/** @brief MatAllocator with per-thread caches of released buffers
+
+Allocation and release of pooled buffers touch the cache of the calling thread only and take no lock.
+Caches overflow into the shared reclaim lists which serve the threads with empty caches, so buffers
+released by consumer threads are reused by producer threads. Every size class has its own reclaim
+list and mutex, which is taken only to move a batch of buffers between a thread cache and the list;
+the reserved size of the lists is an atomic counter. Buffers above `OPENCV_MAT_POOL_MAX_BLOCK_SIZE`
+bypass the pool.
+*/
+class PoolMatAllocator CV_FINAL : public MatAllocator, public BufferPoolController
+{
+public:
+    PoolMatAllocator()
+        : maxBlockSize(std::min(utils::getConfigurationParameterSizeT("OPENCV_MAT_POOL_MAX_BLOCK_SIZE", (size_t)64 << 20),
+                                (size_t)1 << MAX_BLOCK_SIZE_LOG2)),
+          threadCacheLimit(utils::getConfigurationParameterSizeT("OPENCV_MAT_POOL_THREAD_LIMIT", (size_t)32 << 20)),
+          threadCacheBlocks(std::max(utils::getConfigurationParameterSizeT("OPENCV_MAT_POOL_THREAD_BLOCKS", 8), (size_t)1)),
+          reservedSize(0),
+          maxReservedSize(utils::getConfigurationParameterSizeT("OPENCV_MAT_POOL_LIMIT", (size_t)256 << 20)),
+          generation(0),
+          stats(getMatPoolStatistics())
+    {
+    }
+
+    // the allocator is a never destroyed singleton: buffers of live Mat objects may outlive any other owner
+    ~PoolMatAllocator() CV_OVERRIDE {}
+
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, AccessFlag /*flags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+            {
+                if( data0 && step[i] != CV_AUTOSTEP )
+                {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                }
+                else
+                    step[i] = total;
+            }
+            total *= sizes[i];
+        }
+        int allocatorFlags = 0;
+        uchar* data = data0 ? (uchar*)data0 : (uchar*)const_cast<PoolMatAllocator*>(this)->allocateBlock(total, allocatorFlags);
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        u->allocatorFlags_ = allocatorFlags;
+        if(data0)
+            u->flags |= UMatData::USER_ALLOCATED;
+
+        return u;
+    }
+
+    bool allocate(UMatData* u, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        if(!u) return false;
+        return true;
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if( !(u->flags & UMatData::USER_ALLOCATED) )
+        {
+            const_cast<PoolMatAllocator*>(this)->releaseBlock(u->origdata, u->size, u->allocatorFlags_);
+            u->origdata = 0;
+        }
+        delete u;
+    }
+
+    BufferPoolController* getBufferPoolController(const char* /*id*/) const CV_OVERRIDE
+    {
+        return const_cast<PoolMatAllocator*>(this);
+    }
+
+    // BufferPoolController
+    size_t getReservedSize() const CV_OVERRIDE
+    {
+        return (size_t)stats.getReservedSize();
+    }
+
+    size_t getMaxReservedSize() const CV_OVERRIDE
+    {
+        return maxReservedSize.load();
+    }
+
+    void setMaxReservedSize(size_t size) CV_OVERRIDE
+    {
+        maxReservedSize.store(size);
+        for (int idx = MAX_CLASSES - 1; idx >= 0 && reservedSize.load() > size; idx--)
+        {
+            const size_t blockSize = classToSize(idx);
+            SharedList& shared = sharedLists[idx];
+            AutoLock lock(shared.mutex);
+            while (shared.list.head && reservedSize.load() > size)
+            {
+                freeBlock(shared.list.pop(), blockSize);
+                reservedSize.fetch_sub(blockSize);
+            }
+        }
+    }
+
+    /** Releases the shared reclaim lists and the cache of the calling thread.
+     * Caches of other threads are released on their next allocation or release call.
+     */
+    void freeAllReservedBuffers() CV_OVERRIDE
+    {
+        generation++;
+        for (int idx = 0; idx < MAX_CLASSES; idx++)
+        {
+            const size_t blockSize = classToSize(idx);
+            SharedList& shared = sharedLists[idx];
+            AutoLock lock(shared.mutex);
+            while (shared.list.head)
+            {
+                freeBlock(shared.list.pop(), blockSize);
+                reservedSize.fetch_sub(blockSize);
+            }
+        }
+        getThreadCache();
+    }
+
+    void releaseThreadCache(ThreadCache& cache, bool toSharedList)
+    {
+        for (int idx = 0; idx < MAX_CLASSES; idx++)
+        {
+            FreeList& list = cache.lists[idx];
+            if (!list.head)
+                continue;
+            if (toSharedList)
+                moveToSharedList(cache, idx, list.count);
+            else
+            {
+                const size_t blockSize = classToSize(idx);
+                while (list.head)
+                    freeBlock(list.pop(), blockSize);
+            }
+        }
+        cache.size = 0;
+    }
+
+protected:
+    void* allocateBlock(size_t size, int& allocatorFlags)
+    {
+        if (size > maxBlockSize)
+        {
+            allocatorFlags = 0;
+            void* ptr = fastMalloc(size);
+            stats.onMiss(size);
+            return ptr;
+        }
+
+        const int idx = sizeToClass(size);
+        const size_t blockSize = classToSize(idx);
+        allocatorFlags = idx + 1;
+
+        ThreadCache& cache = getThreadCache();
+        FreeList& list = cache.lists[idx];
+        if (list.head)
+        {
+            cache.size -= blockSize;
+            stats.onUnreserve(blockSize);
+            stats.onHit(blockSize);
+            return list.pop();
+        }
+
+        if (void* ptr = takeFromSharedList(cache, idx))
+        {
+            stats.onReclaim(blockSize);
+            return ptr;
+        }
+
+        void* ptr = fastMalloc(blockSize);
+        stats.onMiss(blockSize);
+        return ptr;
+    }
+
+    void releaseBlock(void* ptr, size_t size, int allocatorFlags)
+    {
+        if (allocatorFlags == 0)
+        {
+            stats.onFree(size);
+            fastFree(ptr);
+            return;
+        }
+
+        const int idx = allocatorFlags - 1;
+        CV_DbgAssert(idx == sizeToClass(size));
+        const size_t blockSize = classToSize(idx);
+        stats.onFree(blockSize);
+
+        ThreadCache& cache = getThreadCache();
+        FreeList& list = cache.lists[idx];
+        list.push(ptr);
+        cache.size += blockSize;
+        stats.onReserve(blockSize);
+
+        if (cache.size > threadCacheLimit)
+            moveToSharedList(cache, idx, list.count);
+        else if (list.count > threadCacheBlocks)
+            moveToSharedList(cache, idx, list.count / 2);
+    }
+
+    ThreadCache& getThreadCache()
+    {
+        ThreadCache& cache = threadCaches.getRef();
+        const unsigned currentGeneration = generation.load(std::memory_order_relaxed);
+        if (!cache.pool)
+        {
+            cache.pool = this;
+            cache.generation = currentGeneration;
+        }
+        else if (cache.generation != currentGeneration)
+        {
+            releaseThreadCache(cache, false);
+            cache.generation = currentGeneration;
+        }
+        return cache;
+    }
+
+    // takes one buffer for the caller and refills the thread cache with up to a half of its capacity
+    void* takeFromSharedList(ThreadCache& cache, int idx)
+    {
+        const size_t blockSize = classToSize(idx);
+        FreeBlock* first = NULL;
+        size_t n = 0;
+        {
+            SharedList& shared = sharedLists[idx];
+            AutoLock lock(shared.mutex);
+            if (!shared.list.head)
+                return NULL;
+            size_t maxBlocks = 1 + std::min((threadCacheBlocks + 1) / 2, (threadCacheLimit - std::min(threadCacheLimit, cache.size)) / blockSize);
+            n = shared.list.cut(maxBlocks, first);
+        }
+        reservedSize.fetch_sub(n * blockSize);
+        CV_DbgAssert(n > 0 && first);
+        stats.onUnreserve(blockSize);
+
+        void* ptr = first;
+        FreeList& list = cache.lists[idx];
+        for (FreeBlock* b = first->next; b; )
+        {
+            FreeBlock* next = b->next;
+            list.push(b);
+            b = next;
+        }
+        cache.size += (n - 1) * blockSize;
+        return ptr;
+    }
+
+    void moveToSharedList(ThreadCache& cache, int idx, size_t n)
+    {
+        const size_t blockSize = classToSize(idx);
+        FreeBlock* first = NULL;
+        n = cache.lists[idx].cut(n, first);
+        cache.size -= n * blockSize;
+
+        FreeBlock* overflow = first;
+        {
+            SharedList& shared = sharedLists[idx];
+            AutoLock lock(shared.mutex);
+            while (overflow && reserveShared(blockSize))
+            {
+                FreeBlock* next = overflow->next;
+                shared.list.push(overflow);
+                overflow = next;
+            }
+        }
+        while (overflow)
+        {
+            FreeBlock* next = overflow->next;
+            freeBlock(overflow, blockSize);
+            overflow = next;
+        }
+    }
+
+    // accounts a block moved to a shared list, fails if the lists would exceed maxReservedSize
+    bool reserveShared(size_t blockSize)
+    {
+        const size_t limit = maxReservedSize.load(std::memory_order_relaxed);
+        size_t prev = reservedSize.load(std::memory_order_relaxed);
+        do
+        {
+            if (prev + blockSize > limit)
+                return false;
+        } while (!reservedSize.compare_exchange_weak(prev, prev + blockSize));
+        return true;
+    }
+
+    void freeBlock(void* ptr, size_t blockSize)
+    {
+        stats.onUnreserve(blockSize);
+        fastFree(ptr);
+    }
+
+    const size_t maxBlockSize;
+    const size_t threadCacheLimit;
+    const size_t threadCacheBlocks;
+
+    SharedList sharedLists[MAX_CLASSES];
+    std::atomic<size_t> reservedSize;  // bytes in shared lists
+    std::atomic<size_t> maxReservedSize;
+    std::atomic<unsigned> generation;
+
+    TLSData<ThreadCache> threadCaches;
+    MatPoolStatistics& stats;
+};
+
+ThreadCache::~ThreadCache()
+{
+    if (pool)
+        pool->releaseThreadCache(*this, true);
+}
+
+} // namespace
+
+MatAllocator* Mat::getPoolAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new PoolMatAllocator())
+}
+
+namespace utils {
+
+PoolAllocatorStatisticsInterface& getMatPoolAllocatorStatistics()
+{
+    return getMatPoolStatistics();
+}
+
+} // namespace
+
+} // namespace
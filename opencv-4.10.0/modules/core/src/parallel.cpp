@@ -135,10 +135,14 @@
 
 #if defined HAVE_TBB
 #  define CV_PARALLEL_FRAMEWORK "tbb"
+#  if TBB_INTERFACE_VERSION >= 8000
+#    define CV_PARALLEL_FRAMEWORK_THREADS_LIMIT  // execution contexts own task arenas
+#  endif
 #elif defined HAVE_HPX
 #  define CV_PARALLEL_FRAMEWORK "hpx"
 #elif defined HAVE_OPENMP
 #  define CV_PARALLEL_FRAMEWORK "openmp"
+#  define CV_PARALLEL_FRAMEWORK_THREADS_LIMIT  // num_threads clause
 #elif defined HAVE_GCD
 #  define CV_PARALLEL_FRAMEWORK "gcd"
 #elif defined WINRT
@@ -147,6 +151,8 @@
 #  define CV_PARALLEL_FRAMEWORK "ms-concurrency"
 #elif defined HAVE_PTHREADS_PF
 #  define CV_PARALLEL_FRAMEWORK "pthreads"
+#  define CV_PARALLEL_FRAMEWORK_THREADS_LIMIT  // per-job threads limit
+#  define CV_PARALLEL_FRAMEWORK_CONCURRENT_JOBS  // built-in thread pool runs concurrent and nested jobs
 #endif
 
 #include <atomic>
@@ -197,8 +203,9 @@ namespace {
     class ParallelLoopBodyWrapperContext
     {
     public:
-        ParallelLoopBodyWrapperContext(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes) :
-            is_rng_used(false), hasException(false)
+        ParallelLoopBodyWrapperContext(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes,
+                                       const ExecutionContext& _execCtx) :
+            execCtx(_execCtx), is_rng_used(false), hasException(false)
         {
 
             body = &_body;
@@ -256,6 +263,7 @@ namespace {
         const cv::ParallelLoopBody* body;
         cv::Range wholeRange;
         int nstripes;
+        ExecutionContext execCtx;
         cv::RNG rng;
         mutable bool is_rng_used;
 #ifdef OPENCV_TRACE
@@ -337,6 +345,15 @@ namespace {
 #if OPENCV_SUPPORTS_FP_DENORMALS_HINT && OPENCV_IMPL_FP_HINTS
             FPDenormalsIgnoreHintScope fp_denormals_scope(ctx.fp_denormals_base_state);
 #endif
+            // nested parallel regions of worker threads follow the caller's limits
+            ExecutionContext& threadExecCtx = ExecutionContext::getCurrentRef();
+            ExecutionContext prevExecCtx;
+            const bool bindExecCtx = threadExecCtx.getImpl() != ctx.execCtx.getImpl();
+            if (bindExecCtx)
+            {
+                prevExecCtx = threadExecCtx;
+                threadExecCtx = ctx.execCtx;
+            }
 
             cv::Range r;
             cv::Range wholeRange = ctx.wholeRange;
@@ -375,6 +392,9 @@ namespace {
             }
 #endif
 
+            if (bindExecCtx)
+                threadExecCtx = prevExecCtx;
+
             if (!ctx.is_rng_used && !(cv::theRNG() == ctx.rng))
                 ctx.is_rng_used = true;
         }
@@ -496,9 +516,111 @@ static SchedPtr pplScheduler;
 
 } // namespace anon
 
+/* ================================   ExecutionContext  ================================ */
+
+namespace parallel {
+
+struct ExecutionContext::Impl
+{
+    Impl(int numThreads_, const std::vector<int>& cpus_, const std::shared_ptr<ParallelForAPI>& backend_) :
+        numThreads(numThreads_), cpus(cpus_), backend(backend_)
+#ifdef CV_PARALLEL_FRAMEWORK_THREADS_LIMIT
+#if defined HAVE_TBB
+        , arena(numThreads_ > 0 ? numThreads_ : (int)tbb::task_arena::automatic)
+#endif
+#endif
+    {
+        // nothing
+    }
+
+    const int numThreads;  // negative value means the process settings
+    const std::vector<int> cpus;
+    const std::shared_ptr<ParallelForAPI> backend;
+
+#ifdef CV_PARALLEL_FRAMEWORK_THREADS_LIMIT
+#if defined HAVE_TBB
+    tbb::task_arena arena;
+#endif
+#endif
+#ifdef CV_PARALLEL_FRAMEWORK_CONCURRENT_JOBS
+    std::shared_ptr<ThreadPool> pool;  // isolated workers pinned to the cpus
+#endif
+};
+
+ExecutionContext ExecutionContext::create(int nThreads, const std::vector<int>& cpus, const std::shared_ptr<ParallelForAPI>& backend)
+{
+    for (size_t i = 0; i < cpus.size(); i++)
+        CV_CheckGE(cpus[i], 0, "Invalid CPU index");
+    if (nThreads < 0 && !cpus.empty())
+        nThreads = (int)cpus.size();
+
+    ExecutionContext ctx;
+    ctx.p = std::make_shared<Impl>(nThreads, cpus, backend);
+    if (!cpus.empty())
+    {
+#ifdef CV_PARALLEL_FRAMEWORK_CONCURRENT_JOBS
+        if (!backend)
+        {
+            ctx.p->pool = parallel_pthreads_create_pool((unsigned)std::max(1, nThreads), cpus);
+            return ctx;
+        }
+#endif
+        CV_LOG_WARNING(NULL, "core(parallel): CPU affinity of execution context is supported by the built-in thread pool only");
+    }
+    return ctx;
+}
+
+int ExecutionContext::getNumThreads() const
+{
+    CV_Assert(p);
+    return p->numThreads;
+}
+
+const std::vector<int>& ExecutionContext::getCPUs() const
+{
+    CV_Assert(p);
+    return p->cpus;
+}
+
+const std::shared_ptr<ParallelForAPI>& ExecutionContext::getBackend() const
+{
+    CV_Assert(p);
+    return p->backend;
+}
+
+static TLSData<ExecutionContext>& getExecutionContextTLS()
+{
+    CV_SINGLETON_LAZY_INIT_REF(TLSData<ExecutionContext>, new TLSData<ExecutionContext>())
+}
+
+ExecutionContext& ExecutionContext::getCurrentRef()
+{
+    return getExecutionContextTLS().getRef();
+}
+
+void ExecutionContext::bind() const
+{
+    getCurrentRef() = *this;
+}
+
+void ExecutionContext::release()
+{
+    p.reset();
+}
+
+static inline
+const std::shared_ptr<ParallelForAPI>& getParallelForAPI(const ExecutionContext::Impl* execImpl)
+{
+    if (execImpl && execImpl->backend)
+        return execImpl->backend;
+    return getCurrentParallelForAPI();
+}
+
+}  // namespace parallel
+
 /* ================================   parallel_for_  ================================ */
 
-static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes); // forward declaration
+static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes, const ExecutionContext& execCtx); // forward declaration
 
 void parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
 {
@@ -513,6 +635,16 @@ void parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, dou
     if (range.empty())
         return;
 
+    const ExecutionContext execCtx = ExecutionContext::getCurrentRef();  // a copy, body may re-bind the context
+
+#ifdef CV_PARALLEL_FRAMEWORK_CONCURRENT_JOBS
+    if (!getParallelForAPI(execCtx.getImpl()))
+    {
+        parallel_for_impl(range, body, nstripes, execCtx);
+        return;
+    }
+#endif
+
     static std::atomic<bool> flagNestedParallelFor(false);
     bool isNotNestedRegion = !flagNestedParallelFor.load();
     if (isNotNestedRegion)
@@ -521,7 +653,7 @@ void parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, dou
     {
         try
         {
-            parallel_for_impl(range, body, nstripes);
+            parallel_for_impl(range, body, nstripes, execCtx);
             flagNestedParallelFor = false;
         }
         catch (...)
@@ -545,12 +677,22 @@ void parallel_for_cb(int start, int end, void* data)
     body(Range(start, end));
 }
 
-static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
+static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes, const ExecutionContext& execCtx)
 {
     using namespace cv::parallel;
-    if ((numThreads < 0 || numThreads > 1) && range.end - range.start > 1)
+    ExecutionContext::Impl* execImpl = execCtx.getImpl();
+    const int threads = execImpl && execImpl->numThreads >= 0 ? execImpl->numThreads : numThreads;
+    if ((threads < 0 || threads > 1) && range.end - range.start > 1)
     {
-        ParallelLoopBodyWrapperContext ctx(body, range, nstripes);
+        const std::shared_ptr<ParallelForAPI>& api = getParallelForAPI(execImpl);
+        bool limitStripes = execImpl && threads > 1;
+#ifdef CV_PARALLEL_FRAMEWORK_THREADS_LIMIT
+        limitStripes = limitStripes && api;
+#endif
+        if (limitStripes)  // backend can't limit threads of a single call, so there are no more tasks than threads
+            nstripes = std::min(nstripes <= 0 ? (double)range.size() : nstripes, (double)threads);
+
+        ParallelLoopBodyWrapperContext ctx(body, range, nstripes, execCtx);
         ProxyLoopBody pbody(ctx);
         cv::Range stripeRange = pbody.stripeRange();
         if( stripeRange.end - stripeRange.start == 1 )
@@ -559,7 +701,6 @@ static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody
             return;
         }
 
-        std::shared_ptr<ParallelForAPI>& api = getCurrentParallelForAPI();
         if (api)
         {
             CV_CheckEQ(stripeRange.start, 0, "");
@@ -572,7 +713,10 @@ static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody
 #if defined HAVE_TBB
 
 #if TBB_INTERFACE_VERSION >= 8000
-        tbbArena.execute(pbody);
+        if (execImpl && threads > 0)
+            execImpl->arena.execute(pbody);
+        else
+            tbbArena.execute(pbody);
 #else
         pbody();
 #endif
@@ -582,7 +726,7 @@ static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody
 
 #elif defined HAVE_OPENMP
 
-        #pragma omp parallel for schedule(dynamic) num_threads(numThreads > 0 ? numThreads : numThreadsMax)
+        #pragma omp parallel for schedule(dynamic) num_threads(threads > 0 ? threads : numThreadsMax)
         for (int i = stripeRange.start; i < stripeRange.end; ++i)
             pbody(Range(i, i + 1));
 
@@ -610,7 +754,8 @@ static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody
 
 #elif defined HAVE_PTHREADS_PF
 
-        parallel_for_pthreads(pbody.stripeRange(), pbody, pbody.stripeRange().size());
+        parallel_for_pthreads(execImpl ? execImpl->pool.get() : NULL, (unsigned)(execImpl ? std::max(0, execImpl->numThreads) : 0),
+                              pbody.stripeRange(), pbody, pbody.stripeRange().size());
 
 #else
 
@@ -629,7 +774,13 @@ static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody
 
 int getNumThreads(void)
 {
-    std::shared_ptr<ParallelForAPI>& api = getCurrentParallelForAPI();
+    const ExecutionContext::Impl* execImpl = ExecutionContext::getCurrentRef().getImpl();
+    if (execImpl && execImpl->numThreads >= 0)
+    {
+        return std::max(1, execImpl->numThreads);
+    }
+
+    const std::shared_ptr<ParallelForAPI>& api = getParallelForAPI(execImpl);
     if (api)
     {
         return api->getNumThreads();
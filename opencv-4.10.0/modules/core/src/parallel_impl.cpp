@@ -25,6 +25,14 @@
 
 #include <atomic>
 
+#if defined _GNU_SOURCE \
+    && !defined(__MINGW32__) \
+    && !defined(__EMSCRIPTEN__) \
+    && !defined(__ANDROID__)
+#include <sched.h>
+#define CV_HAVE_THREAD_AFFINITY 1
+#endif
+
 // Spin lock's OS-level yield
 #ifdef DECLARE_CV_YIELD
 DECLARE_CV_YIELD
@@ -79,9 +87,29 @@ static int CV_MAIN_THREAD_ACTIVE_WAIT = (int)utils::getConfigurationParameterSiz
 
 static int CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT = (int)utils::getConfigurationParameterSizeT("OPENCV_THREAD_POOL_ACTIVE_WAIT_THREADS_LIMIT", 0); // number of real cores
 
+static inline void activeWaitStep(int i)
+{
+    if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
+        CV_PAUSE(16);
+    else
+        CV_YIELD();
+}
+
 class WorkerThread;
 class ParallelJob;
 
+/*
+ The pool runs any number of jobs at once: each parallel_for_ call (from application threads
+ or nested into bodies of other jobs) publishes its job, executes it together with the idle
+ workers and then waits only for the parts taken by other threads.
+
+ A job is split into per-thread task queues (slots). A thread consumes its own slot from the
+ front and steals a half of the largest remaining slot from the back when its slot is empty.
+ Idle workers join the published job with the fewest participating threads, so concurrent
+ callers share the pool fairly.
+
+ Besides the process pool, execution contexts may own isolated pools with pinned workers.
+*/
 class ThreadPool
 {
 public:
@@ -100,27 +128,38 @@ public:
     {
         if (new_threads_count == threads.size())
             return;
+        std::vector< Ptr<WorkerThread> > release_threads;
         pthread_mutex_lock(&mutex);
-        reconfigure_(new_threads_count);
+        if (!isWorkerThread_())  // worker can't join itself
+            reconfigure_(new_threads_count, release_threads);
         pthread_mutex_unlock(&mutex);
+        release_threads.clear();  // calls thread_join, stopped workers may need the mutex to leave their jobs
     }
-    bool reconfigure_(unsigned new_threads_count); // internal implementation
+    void reconfigure_(unsigned new_threads_count, std::vector< Ptr<WorkerThread> >& release_threads); // internal implementation
+    bool isWorkerThread_() const;
 
-    void run(const Range& range, const ParallelLoopBody& body, double nstripes);
+    void run(const Range& range, const ParallelLoopBody& body, double nstripes, unsigned max_threads = 0);
 
     size_t getNumOfThreads();
 
     void setNumOfThreads(unsigned n);
 
+    Ptr<ParallelJob> joinJob_(unsigned& slot);  // called under mutex
+    bool hasLessLoadedJob(const ParallelJob& job);
+    void removeJob(const ParallelJob* job);
+
     ThreadPool();
+    ThreadPool(unsigned num_threads_, const std::vector<int>& cpus_);
 
     ~ThreadPool();
 
     unsigned num_threads;
+    const std::vector<int> cpus;  // affinity of worker threads
 
-    pthread_mutex_t mutex;  // guards fields (job/threads) from non-worker threads (concurrent parallel_for calls)
+    pthread_mutex_t mutex;  // guards threads/jobs lists
 #if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    pthread_cond_t cond_thread_wake;
+    pthread_cond_t cond_thread_wake;  // signals sleeping workers about new jobs
+    unsigned num_sleeping_threads;
 #endif
 
     pthread_mutex_t mutex_notify;
@@ -128,9 +167,13 @@ public:
 
     std::vector< Ptr<WorkerThread> > threads;
 
-    Ptr<ParallelJob> job;
+    std::vector< Ptr<ParallelJob> > jobs;  // published jobs, which may still have free tasks
+    std::atomic<unsigned> jobs_version;  // incremented on each published job
+    std::atomic<int> jobs_count;
+    size_t next_job;  // round-robin position for workers looking for a job
 
 #ifdef CV_PROFILE_THREADS
+    // statistics of the last job, they are mixed if several jobs run at once
     double tickFreq;
     int64 jobSubmitTime;
     struct ThreadStatistics
@@ -189,7 +232,6 @@ public:
     };
     ThreadStatistics threads_stat[CV_PROFILE_THREADS]; // 0 - main thread, 1..N - worker threads
 #endif
-
 };
 
 class WorkerThread
@@ -202,13 +244,10 @@ public:
 
     std::atomic<bool> stop_thread;
 
-    std::atomic<bool> has_wake_signal;
-
-    Ptr<ParallelJob> job;
-
-    pthread_mutex_t mutex;
 #if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    volatile bool isActive;
+    pthread_mutex_t mutex;  // guards isActive/has_wake_signal
+    bool isActive;
+    bool has_wake_signal;
     pthread_cond_t cond_thread_wake;
 #endif
 
@@ -217,20 +256,21 @@ public:
         id(id_),
         posix_thread(0),
         is_created(false),
-        stop_thread(false),
-        has_wake_signal(false)
+        stop_thread(false)
 #if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         , isActive(true)
+        , has_wake_signal(false)
 #endif
     {
         CV_LOG_VERBOSE(NULL, 1, "MainThread: initializing new worker: " << id);
-        int res = pthread_mutex_init(&mutex, NULL);
+        int res = 0;
+#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
+        res = pthread_mutex_init(&mutex, NULL);
         if (res != 0)
         {
             CV_LOG_ERROR(NULL, id << ": Can't create thread mutex: res = " << res);
             return;
         }
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         res = pthread_cond_init(&cond_thread_wake, NULL);
         if (res != 0)
         {
@@ -256,21 +296,43 @@ public:
         {
             if (!stop_thread)
             {
-                pthread_mutex_lock(&mutex);  // to avoid signal miss due pre-check
-                stop_thread = true;
-                pthread_mutex_unlock(&mutex);
 #if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
+                pthread_mutex_lock(&thread_pool.mutex);  // to avoid signal miss due pre-check
+                stop_thread = true;
+                pthread_mutex_unlock(&thread_pool.mutex);
                 pthread_cond_broadcast(&thread_pool.cond_thread_wake);
 #else
-                pthread_cond_signal(&cond_thread_wake);
+                wake(true);
 #endif
             }
             pthread_join(posix_thread, NULL);
         }
 #if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         pthread_cond_destroy(&cond_thread_wake);
-#endif
         pthread_mutex_destroy(&mutex);
+#endif
+    }
+
+#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
+    // wakes the sleeping worker, returns false if it is active or already woken
+    bool wake(bool stop)
+    {
+        pthread_mutex_lock(&mutex);  // to avoid signal miss due pre-check
+        if (stop)
+            stop_thread = true;
+        bool sleeping = !isActive && !has_wake_signal;
+        if (sleeping)
+            has_wake_signal = true;
+        pthread_mutex_unlock(&mutex);
+        if (sleeping)
+            pthread_cond_signal(&cond_thread_wake);
+        return sleeping;
+    }
+#endif
+
+    bool shouldLeave(const ParallelJob& job) const
+    {
+        return stop_thread || (thread_pool.jobs_count > 1 && thread_pool.hasLessLoadedJob(job));
     }
 
     void thread_body();
@@ -287,18 +349,23 @@ public:
 class ParallelJob
 {
 public:
-    ParallelJob(const ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, int nstripes_) :
+    ParallelJob(ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, unsigned nslots) :
         thread_pool(thread_pool_),
         body(body_),
         range(range_),
-        nstripes((unsigned)nstripes_),
+        slots(nslots),
         is_completed(false)
     {
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::ParallelJob(" << (void*)this << ")");
-        current_task.store(0, std::memory_order_relaxed);
+        const uint64 task_count = (uint64)range.size();
+        for (unsigned i = 0; i < nslots; i++)
+        {
+            slots[i].tasks.store(packTasks((unsigned)(task_count * i / nslots), (unsigned)(task_count * (i + 1) / nslots)), std::memory_order_relaxed);
+            slots[i].owned.store(false, std::memory_order_relaxed);
+        }
+        remaining_tasks.store(range.size(), std::memory_order_relaxed);
         active_thread_count.store(0, std::memory_order_relaxed);
-        completed_thread_count.store(0, std::memory_order_relaxed);
-        dummy0_[0] = 0, dummy1_[0] = 0, dummy2_[0] = 0; // compiler warning
+        dummy0_[0] = 0, dummy1_[0] = 0; // compiler warning
     }
 
     ~ParallelJob()
@@ -306,75 +373,181 @@ public:
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::~ParallelJob(" << (void*)this << ")");
     }
 
-    unsigned execute(bool is_worker_thread)
+    static uint64 packTasks(unsigned begin, unsigned end) { return ((uint64)end << 32) | begin; }
+    static unsigned tasksBegin(uint64 tasks) { return (unsigned)tasks; }
+    static unsigned tasksEnd(uint64 tasks) { return (unsigned)(tasks >> 32); }
+    static unsigned tasksSize(uint64 tasks) { return tasksEnd(tasks) > tasksBegin(tasks) ? tasksEnd(tasks) - tasksBegin(tasks) : 0; }
+
+    // takes the next chunk (a quarter) from the front of the own slot
+    bool popTasks(unsigned slot, Range& r)
     {
-        unsigned executed_tasks = 0;
-        const int task_count = range.size();
-        const int remaining_multiplier = std::min(nstripes,
-                std::max(
-                        std::min(100u, thread_pool.num_threads * 4),
-                        thread_pool.num_threads * 2
-                ));  // experimental value
+        std::atomic<uint64>& tasks = slots[slot].tasks;
+        uint64 v = tasks.load(std::memory_order_acquire);
         for (;;)
         {
-            int chunk_size = std::max(1, (task_count - current_task) / remaining_multiplier);
-            int id = current_task.fetch_add(chunk_size, std::memory_order_seq_cst);
-            if (id >= task_count)
-                break; // no more free tasks
+            unsigned size = tasksSize(v);
+            if (size == 0)
+                return false;
+            unsigned begin = tasksBegin(v), chunk_size = (size + 3) / 4;
+            if (tasks.compare_exchange_weak(v, packTasks(begin + chunk_size, tasksEnd(v)), std::memory_order_acq_rel))
+            {
+                r = Range((int)begin, (int)(begin + chunk_size));
+                return true;
+            }
+        }
+    }
 
-            executed_tasks += chunk_size;
-            int start_id = id;
-            int end_id = std::min(task_count, id + chunk_size);
-            CV_LOG_VERBOSE(NULL, 9, "Thread: job " << start_id << "-" << end_id);
+    // moves a half of the largest slot of other threads into the own (empty) slot
+    bool stealTasks(unsigned slot)
+    {
+        for (;;)
+        {
+            unsigned victim = slot, victim_size = 0;
+            uint64 v = 0;
+            for (unsigned i = 0; i < slots.size(); i++)
+            {
+                uint64 tasks = slots[i].tasks.load(std::memory_order_acquire);
+                if (i != slot && tasksSize(tasks) > victim_size)
+                {
+                    victim = i;
+                    victim_size = tasksSize(tasks);
+                    v = tasks;
+                }
+            }
+            if (victim_size == 0)
+                return false; // no more free tasks
+            unsigned end = tasksEnd(v), steal_size = (victim_size + 1) / 2;
+            if (slots[victim].tasks.compare_exchange_strong(v, packTasks(tasksBegin(v), end - steal_size), std::memory_order_acq_rel))
+            {
+                CV_LOG_VERBOSE(NULL, 9, "Thread: steal " << (end - steal_size) << "-" << end << " from slot " << victim);
+                slots[slot].tasks.store(packTasks(end - steal_size, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
 
-            //TODO: if (not pending exception)
+    bool hasFreeTasks() const
+    {
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (tasksSize(slots[i].tasks.load(std::memory_order_acquire)) > 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool hasFreeSlot() const
+    {
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            if (!slots[i].owned.load(std::memory_order_acquire))
+                return true;
+        }
+        return false;
+    }
+
+    // claims a slot without owner preferring the largest one, called under the pool mutex
+    bool join(unsigned& slot)
+    {
+        unsigned best_size = 0;
+        bool found = false;
+        for (unsigned i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].owned.load(std::memory_order_acquire))
+                continue;
+            unsigned size = tasksSize(slots[i].tasks.load(std::memory_order_acquire));
+            if (!found || size > best_size)
             {
-                body.operator()(Range(range.start + start_id, range.start + end_id));
+                slot = i;
+                best_size = size;
+                found = true;
             }
-            if (is_worker_thread && is_completed)
+        }
+        if (!found)
+            return false;
+        slots[slot].owned.store(true, std::memory_order_release);
+        active_thread_count.fetch_add(1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    int leave(unsigned slot)
+    {
+        slots[slot].owned.store(false, std::memory_order_release);
+        return active_thread_count.fetch_sub(1, std::memory_order_seq_cst) - 1;
+    }
+
+    unsigned execute(unsigned slot, const WorkerThread* worker)
+    {
+        unsigned executed_tasks = 0;
+        for (;;)
+        {
+            Range r;
+            if (!popTasks(slot, r))
             {
-                CV_LOG_ERROR(NULL, "\t\t\t\tBUG! Job: " << (void*)this << " " << id << " " << active_thread_count << " " << completed_thread_count);
-                CV_Assert(!is_completed); // TODO Dbg this
+                if (worker && worker->shouldLeave(*this))
+                    break;
+                if (!stealTasks(slot))
+                    break;
+                continue;
+            }
+            CV_LOG_VERBOSE(NULL, 9, "Thread: job " << r.start << "-" << r.end);
+            body.operator()(Range(range.start + r.start, range.start + r.end));
+            executed_tasks += r.size();
+            if (remaining_tasks.fetch_sub(r.size(), std::memory_order_acq_rel) == r.size())
+            {
+                CV_LOG_VERBOSE(NULL, 5, "Thread: job finished => notifying the waiting thread");
+                is_completed = true;
+                pthread_mutex_lock(&thread_pool.mutex_notify);  // to avoid signal miss due pre-check condition
+                // empty
+                pthread_mutex_unlock(&thread_pool.mutex_notify);
+                pthread_cond_broadcast(&thread_pool.cond_thread_task_complete);
             }
         }
         return executed_tasks;
     }
 
-    const ThreadPool& thread_pool;
+    ThreadPool& thread_pool;
     const ParallelLoopBody& body;
     const Range range;
-    const unsigned nstripes;
 
-    std::atomic<int> current_task;  // next free part of job
+    struct Slot
+    {
+        std::atomic<uint64> tasks;  // [begin; end) offsets of the free tasks
+        std::atomic<bool> owned;
+        int64 dummy_[7];  // avoid cache-line reusing for the neighbour slots
+    };
+    std::vector<Slot> slots;
+
+    std::atomic<int> remaining_tasks;  // number of not finished tasks
     int64 dummy0_[8];  // avoid cache-line reusing for the same atomics
 
-    std::atomic<int> active_thread_count;  // number of threads worked on this job
+    std::atomic<int> active_thread_count;  // number of threads owning a slot of this job
     int64 dummy1_[8];  // avoid cache-line reusing for the same atomics
 
-    std::atomic<int> completed_thread_count;  // number of threads completed any activities on this job
-    int64 dummy2_[8];  // avoid cache-line reusing for the same atomics
-
     std::atomic<bool> is_completed;
-
-    // TODO exception handling
 };
 
 
-// Disable thread sanitization check when CV_USE_GLOBAL_WORKERS_COND_VAR is not
-// set because it triggers as the main thread reads isActive while the children
-// thread writes it (but it all works out because a mutex is locked in the main
-// thread and isActive re-checked).
-// This is to solve issue #19463.
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR) && defined(__clang__) && defined(__has_feature)
-#if __has_feature(thread_sanitizer)
-__attribute__((no_sanitize("thread")))
-#endif
-#endif
 void WorkerThread::thread_body()
 {
     (void)cv::utils::getThreadID(); // notify OpenCV about new thread
     CV_LOG_VERBOSE(NULL, 5, "Thread: new thread: " << id);
 
+    if (!thread_pool.cpus.empty())
+    {
+#ifdef CV_HAVE_THREAD_AFFINITY
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (size_t i = 0; i < thread_pool.cpus.size(); i++)
+            CPU_SET(thread_pool.cpus[i], &cpu_set);
+        int res = sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+        if (res != 0)
+            CV_LOG_WARNING(NULL, id << ": Can't set thread affinity: res = " << res);
+#else
+        CV_LOG_ONCE_WARNING(NULL, "Thread affinity is not supported on this platform");
+#endif
+    }
+
     bool allow_active_wait = true;
 
 #ifdef CV_PROFILE_THREADS
@@ -383,102 +556,97 @@ void WorkerThread::thread_body()
 
     while (!stop_thread)
     {
-        CV_LOG_VERBOSE(NULL, 5, "Thread: ... loop iteration: allow_active_wait=" << allow_active_wait << "   has_wake_signal=" << has_wake_signal);
+        unsigned slot = 0, jobs_version = 0;
+        pthread_mutex_lock(&thread_pool.mutex);
+        Ptr<ParallelJob> j = thread_pool.joinJob_(slot);
+        if (!j)
+            jobs_version = thread_pool.jobs_version;
+        pthread_mutex_unlock(&thread_pool.mutex);
+
+        if (j)
+        {
+            CV_LOG_VERBOSE(NULL, 5, "Thread: processing job " << (void*)j.get() << " slot=" << slot);
+#ifdef CV_PROFILE_THREADS
+            stat.threadExecuteStart = getTickCount();
+            stat.executedTasks = j->execute(slot, this);
+            stat.threadExecuteStop = getTickCount();
+#else
+            j->execute(slot, this);
+#endif
+            int active = j->leave(slot);
+            if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT > 0)
+            {
+                allow_active_wait = true;
+                if (active >= CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT && (id & 1) == 0) // turn off a half of threads
+                    allow_active_wait = false;
+            }
+            CV_LOG_VERBOSE(NULL, 5, "Thread: left job processing: active=" << active);
+#ifdef CV_PROFILE_THREADS
+            stat.threadFree = getTickCount();
+            stat.keepActive = allow_active_wait;
+#endif
+            continue;
+        }
+
+        CV_LOG_VERBOSE(NULL, 5, "Thread: no jobs: allow_active_wait=" << allow_active_wait);
         if (allow_active_wait && CV_WORKER_ACTIVE_WAIT > 0)
         {
             allow_active_wait = false;
             for (int i = 0; i < CV_WORKER_ACTIVE_WAIT; i++)
             {
-                if (has_wake_signal)
+                if (thread_pool.jobs_version != jobs_version || stop_thread)
                     break;
-                if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
-                    CV_PAUSE(16);
-                else
-                    CV_YIELD();
+                activeWaitStep(i);
             }
         }
-        pthread_mutex_lock(&mutex);
 #ifdef CV_PROFILE_THREADS
         stat.threadWait = getTickCount();
 #endif
-        while (!has_wake_signal) // to handle spurious wakeups
-        {
-            //CV_LOG_VERBOSE(NULL, 5, "Thread: wait (sleep) ...");
 #if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_cond_wait(&thread_pool.cond_thread_wake, &mutex);
+        pthread_mutex_lock(&thread_pool.mutex);
+        while (thread_pool.jobs_version == jobs_version && !stop_thread) // to handle spurious wakeups
+        {
+            thread_pool.num_sleeping_threads++;
+            pthread_cond_wait(&thread_pool.cond_thread_wake, &thread_pool.mutex);
+            thread_pool.num_sleeping_threads--;
+            CV_LOG_VERBOSE(NULL, 5, "Thread: wake ... (stop_thread=" << stop_thread << ")")
+        }
+        pthread_mutex_unlock(&thread_pool.mutex);
 #else
+        // jobs published after the check see the inactive thread and wake it
+        pthread_mutex_lock(&mutex);
+        while (!has_wake_signal && thread_pool.jobs_version == jobs_version && !stop_thread) // to handle spurious wakeups
+        {
             isActive = false;
             pthread_cond_wait(&cond_thread_wake, &mutex);
             isActive = true;
-#endif
             CV_LOG_VERBOSE(NULL, 5, "Thread: wake ... (has_wake_signal=" << has_wake_signal << " stop_thread=" << stop_thread << ")")
         }
+        has_wake_signal = false;
+        pthread_mutex_unlock(&mutex);
+#endif
 #ifdef CV_PROFILE_THREADS
         stat.threadWake = getTickCount();
 #endif
-
-        CV_LOG_VERBOSE(NULL, 5, "Thread: checking for new job");
         if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT == 0)
             allow_active_wait = true;
-        Ptr<ParallelJob> j_ptr; swap(j_ptr, job);
-        has_wake_signal = false;
-        pthread_mutex_unlock(&mutex);
-
-        if (!stop_thread)
-        {
-            ParallelJob* j = j_ptr;
-            if (j)
-            {
-                CV_LOG_VERBOSE(NULL, 5, "Thread: job size=" << j->range.size() << " done=" << j->current_task);
-                if (j->current_task < j->range.size())
-                {
-                    int other = j->active_thread_count.fetch_add(1, std::memory_order_seq_cst);
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: processing new job (with " << other << " other threads)"); CV_UNUSED(other);
-#ifdef CV_PROFILE_THREADS
-                    stat.threadExecuteStart = getTickCount();
-                    stat.executedTasks = j->execute(true);
-                    stat.threadExecuteStop = getTickCount();
-#else
-                    j->execute(true);
-#endif
-                    int completed = j->completed_thread_count.fetch_add(1, std::memory_order_seq_cst) + 1;
-                    int active = j->active_thread_count.load(std::memory_order_acquire);
-                    if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT > 0)
-                    {
-                        allow_active_wait = true;
-                        if (active >= CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT && (id & 1) == 0) // turn off a half of threads
-                            allow_active_wait = false;
-                    }
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: completed job processing: " << active << " " << completed);
-                    if (active == completed)
-                    {
-                        bool need_signal = !j->is_completed;
-                        j->is_completed = true;
-                        j = NULL; j_ptr.release();
-                        if (need_signal)
-                        {
-                            CV_LOG_VERBOSE(NULL, 5, "Thread: job finished => notifying the main thread");
-                            pthread_mutex_lock(&thread_pool.mutex_notify);  // to avoid signal miss due pre-check condition
-                            // empty
-                            pthread_mutex_unlock(&thread_pool.mutex_notify);
-                            pthread_cond_broadcast/*pthread_cond_signal*/(&thread_pool.cond_thread_task_complete);
-                        }
-                    }
-                }
-                else
-                {
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: no free job tasks");
-                }
-            }
-        }
-#ifdef CV_PROFILE_THREADS
-        stat.threadFree = getTickCount();
-        stat.keepActive = allow_active_wait;
-#endif
     }
 }
 
-ThreadPool::ThreadPool()
+ThreadPool::ThreadPool() :
+    ThreadPool(defaultNumberOfThreads(), std::vector<int>())
+{
+}
+
+ThreadPool::ThreadPool(unsigned num_threads_, const std::vector<int>& cpus_) :
+    num_threads(num_threads_),
+    cpus(cpus_),
+#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
+    num_sleeping_threads(0),
+#endif
+    jobs_version(0),
+    jobs_count(0),
+    next_job(0)
 {
 #ifdef CV_PROFILE_THREADS
     tickFreq = getTickFrequency();
@@ -496,38 +664,41 @@ ThreadPool::ThreadPool()
     {
         CV_LOG_FATAL(NULL, "Failed to initialize ThreadPool (pthreads)");
     }
-    num_threads = defaultNumberOfThreads();
 }
 
-bool ThreadPool::reconfigure_(unsigned new_threads_count)
+bool ThreadPool::isWorkerThread_() const
+{
+    pthread_t self = pthread_self();
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        if (threads[i]->is_created && pthread_equal(threads[i]->posix_thread, self))
+            return true;
+    }
+    return false;
+}
+
+void ThreadPool::reconfigure_(unsigned new_threads_count, std::vector< Ptr<WorkerThread> >& release_threads)
 {
     if (new_threads_count == threads.size())
-        return false;
+        return;
 
     if (new_threads_count < threads.size())
     {
         CV_LOG_VERBOSE(NULL, 1, "MainThread: reduce worker pool: " << threads.size() << " => " << new_threads_count);
-        std::vector< Ptr<WorkerThread> > release_threads(threads.size() - new_threads_count);
         for (size_t i = new_threads_count; i < threads.size(); ++i)
         {
-            pthread_mutex_lock(&threads[i]->mutex);  // to avoid signal miss due pre-check
+#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
             threads[i]->stop_thread = true;
-            threads[i]->has_wake_signal = true;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_mutex_unlock(&threads[i]->mutex);
-            pthread_cond_broadcast/*pthread_cond_signal*/(&threads[i]->cond_thread_wake); // wake thread
 #else
-            pthread_mutex_unlock(&threads[i]->mutex);
+            threads[i]->wake(true);
 #endif
-            std::swap(threads[i], release_threads[i - new_threads_count]);
+            release_threads.push_back(threads[i]);
         }
+        threads.resize(new_threads_count);
 #if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         CV_LOG_VERBOSE(NULL, 1, "MainThread: notify worker threads about termination...");
         pthread_cond_broadcast(&cond_thread_wake); // wake all threads
 #endif
-        threads.resize(new_threads_count);
-        release_threads.clear();  // calls thread_join which want to lock mutex
-        return false;
     }
     else
     {
@@ -537,7 +708,6 @@ bool ThreadPool::reconfigure_(unsigned new_threads_count)
             threads.push_back(Ptr<WorkerThread>(new WorkerThread(*this, (unsigned)i))); // spawn more threads
         }
     }
-    return false;
 }
 
 ThreadPool::~ThreadPool()
@@ -551,164 +721,161 @@ ThreadPool::~ThreadPool()
     pthread_mutex_destroy(&mutex_notify);
 }
 
-void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double nstripes)
+Ptr<ParallelJob> ThreadPool::joinJob_(unsigned& slot)
+{
+    // drop exhausted jobs, their remaining tasks are already taken by other threads
+    size_t n = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        if (jobs[i]->hasFreeTasks())
+            jobs[n++] = jobs[i];
+    }
+    jobs.resize(n);
+    jobs_count = (int)n;
+    if (n == 0)
+        return Ptr<ParallelJob>();
+
+    // the job with the fewest participating threads, round-robin between equal ones
+    size_t best = n;
+    for (size_t k = 0; k < n; ++k)
+    {
+        size_t i = (next_job + k) % n;
+        if (jobs[i]->hasFreeSlot() && (best == n || jobs[i]->active_thread_count < jobs[best]->active_thread_count))
+            best = i;
+    }
+    if (best == n)
+        return Ptr<ParallelJob>();
+    next_job++;
+    CV_Assert(jobs[best]->join(slot));  // slots are claimed under the mutex only
+    return jobs[best];
+}
+
+bool ThreadPool::hasLessLoadedJob(const ParallelJob& job)
+{
+    bool res = false;
+    pthread_mutex_lock(&mutex);
+    for (size_t i = 0; i < jobs.size() && !res; ++i)
+    {
+        const ParallelJob& j = *jobs[i];
+        res = &j != &job && j.active_thread_count + 1 < job.active_thread_count && j.hasFreeSlot() && j.hasFreeTasks();
+    }
+    pthread_mutex_unlock(&mutex);
+    return res;
+}
+
+void ThreadPool::removeJob(const ParallelJob* job)
+{
+    pthread_mutex_lock(&mutex);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        if (jobs[i].get() == job)
+        {
+            jobs.erase(jobs.begin() + i);
+            break;
+        }
+    }
+    jobs_count = (int)jobs.size();
+    pthread_mutex_unlock(&mutex);
+}
+
+void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double nstripes, unsigned max_threads)
 {
-    CV_LOG_VERBOSE(NULL, 1, "MainThread: new parallel job: num_threads=" << num_threads << "   range=" << range.size() << "   nstripes=" << nstripes << "   job=" << (void*)job);
+    const unsigned threads_num = num_threads;
+    const unsigned job_threads = max_threads > 0 ? std::min(max_threads, threads_num) : threads_num;
+    CV_LOG_VERBOSE(NULL, 1, "MainThread: new parallel job: num_threads=" << threads_num << "   max_threads=" << max_threads << "   range=" << range.size() << "   nstripes=" << nstripes);
 #ifdef CV_PROFILE_THREADS
     jobSubmitTime = getTickCount();
     threads_stat[0].reset();
     threads_stat[0].threadWait = jobSubmitTime;
     threads_stat[0].threadWake = jobSubmitTime;
 #endif
-    if (getNumOfThreads() > 1 &&
-        job == NULL &&
+    if (job_threads > 1 &&
         (range.size() * nstripes >= 2 || (range.size() > 1 && nstripes <= 0))
     )
     {
+        // a job never runs on more threads than it has slots
+        const unsigned nslots = std::min((unsigned)range.size(), job_threads);
+        Ptr<ParallelJob> job(new ParallelJob(*this, range, body, nslots));
+        const unsigned slot = 0;
+        job->slots[slot].owned = true;  // the calling thread
+        job->active_thread_count = 1;
+
+        std::vector< Ptr<WorkerThread> > release_threads;
         pthread_mutex_lock(&mutex);
-        if (job != NULL)
-        {
-            pthread_mutex_unlock(&mutex);
-            body(range);
-            return;
-        }
-        reconfigure_(num_threads - 1);
-
+        if (!isWorkerThread_())  // nested jobs of workers don't change the pool
+            reconfigure_(threads_num - 1, release_threads);
+        CV_LOG_VERBOSE(NULL, 1, "MainThread: publish parallel job: " << range.size() << " (" << jobs.size() << " other jobs)");
+        jobs.push_back(job);
+        jobs_count = (int)jobs.size();
+        jobs_version++;
+#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
+        unsigned num_threads_to_wake = std::min(num_sleeping_threads, nslots - 1);
+#else
+        unsigned num_threads_to_wake = 0;
+        for (size_t i = 0; i < threads.size() && num_threads_to_wake < nslots - 1; ++i)
         {
-            CV_LOG_VERBOSE(NULL, 1, "MainThread: initialize parallel job: " << range.size());
-            job = Ptr<ParallelJob>(new ParallelJob(*this, range, body, nstripes));
-            pthread_mutex_unlock(&mutex);
-
-            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads...");
-            size_t num_threads_to_wake = std::min(static_cast<size_t>(range.size()), threads.size());
-            for (size_t i = 0; i < num_threads_to_wake; ++i)
+            if (threads[i]->wake(false))
             {
-                if (job->current_task >= job->range.size())
-                    break;
-                WorkerThread& thread = *(threads[i].get());
-                if (
-#if defined(__clang__) && defined(__has_feature)
-#if __has_feature(thread_sanitizer)
-                        1 ||  // Robust workaround to avoid data race warning of `thread.job`
-#endif
-#endif
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                        thread.isActive ||
-#endif
-                        thread.has_wake_signal
-                        || !thread.job.empty()  // #10881
-                )
-                {
-                    pthread_mutex_lock(&thread.mutex);
-                    thread.job = job;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    bool isActive = thread.isActive;
-#endif
-                    thread.has_wake_signal = true;
+                num_threads_to_wake++;
 #ifdef CV_PROFILE_THREADS
-                    threads_stat[i + 1].reset();
-#endif
-                    pthread_mutex_unlock(&thread.mutex);
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    if (!isActive)
-                    {
-                        pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
-                    }
+                threads_stat[i + 1].reset();
 #endif
-                }
-                else
-                {
-                    CV_Assert(thread.job.empty());
-                    thread.job = job;
-                    thread.has_wake_signal = true;
-#ifdef CV_PROFILE_THREADS
-                    threads_stat[i + 1].reset();
-#endif
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
-#endif
-                }
             }
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadPing = getTickCount();
+        }
 #endif
+        pthread_mutex_unlock(&mutex);
+        release_threads.clear();
+
+        CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads: " << num_threads_to_wake);
 #if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_cond_broadcast(&cond_thread_wake); // wake all threads
+        for (unsigned i = 0; i < num_threads_to_wake; ++i)
+            pthread_cond_signal(&cond_thread_wake);
 #endif
 #ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadWake = getTickCount();
+        threads_stat[0].threadPing = getTickCount();
+        threads_stat[0].threadWake = threads_stat[0].threadPing;
+        threads_stat[0].threadExecuteStart = getTickCount();
+        threads_stat[0].executedTasks = job->execute(slot, NULL);
+        threads_stat[0].threadExecuteStop = getTickCount();
+#else
+        job->execute(slot, NULL);
 #endif
-            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads... (done)");
+        job->leave(slot);
+        removeJob(job.get());
 
+        CV_LOG_VERBOSE(NULL, 5, "MainThread: complete self-tasks: " << job->remaining_tasks << " tasks are in progress");
+        if (!job->is_completed && CV_MAIN_THREAD_ACTIVE_WAIT > 0)
+        {
+            for (int i = 0; i < CV_MAIN_THREAD_ACTIVE_WAIT; i++)  // don't spin too much in any case (inaccurate getTickCount())
             {
-                ParallelJob& j = *(this->job);
-#ifdef CV_PROFILE_THREADS
-                threads_stat[0].threadExecuteStart = getTickCount();
-                threads_stat[0].executedTasks = j.execute(false);
-                threads_stat[0].threadExecuteStop = getTickCount();
-#else
-                j.execute(false);
-#endif
-                CV_Assert(j.current_task >= j.range.size());
-                CV_LOG_VERBOSE(NULL, 5, "MainThread: complete self-tasks: " << j.active_thread_count << " " << j.completed_thread_count);
-                if (job->is_completed || j.active_thread_count == 0)
+                if (job->is_completed)
                 {
-                    job->is_completed = true;
-                    CV_LOG_VERBOSE(NULL, 5, "MainThread: no WIP worker threads");
-                }
-                else
-                {
-                    if (CV_MAIN_THREAD_ACTIVE_WAIT > 0)
-                    {
-                        for (int i = 0; i < CV_MAIN_THREAD_ACTIVE_WAIT; i++)  // don't spin too much in any case (inaccurate getTickCount())
-                        {
-                            if (job->is_completed)
-                            {
-                                CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (active wait) " << j.active_thread_count << " " << j.completed_thread_count);
-                                break;
-                            }
-                            if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
-                                CV_PAUSE(16);
-                            else
-                                CV_YIELD();
-                        }
-                    }
-                    if (!job->is_completed)
-                    {
-                        CV_LOG_VERBOSE(NULL, 5, "MainThread: prepare wait " << j.active_thread_count << " " << j.completed_thread_count);
-                        pthread_mutex_lock(&mutex_notify);
-                        for (;;)
-                        {
-                            if (job->is_completed)
-                            {
-                                CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (wait) " << j.active_thread_count << " " << j.completed_thread_count);
-                                break;
-                            }
-                            CV_LOG_VERBOSE(NULL, 5, "MainThread: wait completion (sleep) ...");
-                            pthread_cond_wait(&cond_thread_task_complete, &mutex_notify);
-                            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake");
-                        }
-                        pthread_mutex_unlock(&mutex_notify);
-                    }
+                    CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (active wait)");
+                    break;
                 }
+                activeWaitStep(i);
             }
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadFree = getTickCount();
-            std::cout << "Job: sz=" << range.size() << " nstripes=" << nstripes << "    Time: " << (threads_stat[0].threadFree - jobSubmitTime) / tickFreq * 1e6 << " usec" << std::endl;
-            for (int i = 0; i < (int)threads.size() + 1; i++)
-            {
-                threads_stat[i].dump(i - 1, jobSubmitTime, tickFreq);
-            }
-#endif
-            if (job)
+        }
+        if (!job->is_completed)
+        {
+            CV_LOG_VERBOSE(NULL, 5, "MainThread: prepare wait");
+            pthread_mutex_lock(&mutex_notify);
+            while (!job->is_completed)
             {
-                pthread_mutex_lock(&mutex);
-                CV_LOG_VERBOSE(NULL, 5, "MainThread: job release");
-                CV_Assert(job->is_completed);
-                job.release();
-                pthread_mutex_unlock(&mutex);
+                CV_LOG_VERBOSE(NULL, 5, "MainThread: wait completion (sleep) ...");
+                pthread_cond_wait(&cond_thread_task_complete, &mutex_notify);
+                CV_LOG_VERBOSE(NULL, 5, "MainThread: wake");
             }
+            pthread_mutex_unlock(&mutex_notify);
         }
+#ifdef CV_PROFILE_THREADS
+        threads_stat[0].threadFree = getTickCount();
+        std::cout << "Job: sz=" << range.size() << " nstripes=" << nstripes << "    Time: " << (threads_stat[0].threadFree - jobSubmitTime) / tickFreq * 1e6 << " usec" << std::endl;
+        for (int i = 0; i < (int)threads.size() + 1; i++)
+        {
+            threads_stat[i].dump(i - 1, jobSubmitTime, tickFreq);
+        }
+#endif
     }
     else
     {
@@ -727,7 +894,7 @@ void ThreadPool::setNumOfThreads(unsigned n)
     {
         num_threads = n;
         if (n == 1)
-           if (job == NULL) reconfigure(0);  // stop worker threads immediately
+            if (jobs_count == 0) reconfigure(0);  // stop worker threads immediately
     }
 }
 
@@ -753,6 +920,16 @@ void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, dou
     ThreadPool::instance().run(range, body, nstripes);
 }
 
+void parallel_for_pthreads(ThreadPool* pool, unsigned max_threads, const Range& range, const ParallelLoopBody& body, double nstripes)
+{
+    (pool ? *pool : ThreadPool::instance()).run(range, body, nstripes, max_threads);
+}
+
+std::shared_ptr<ThreadPool> parallel_pthreads_create_pool(unsigned num_threads, const std::vector<int>& cpus)
+{
+    return std::make_shared<ThreadPool>(std::max(1u, num_threads), cpus);
+}
+
 }
 
 #endif
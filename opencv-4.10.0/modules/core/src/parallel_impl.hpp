@@ -12,6 +12,14 @@ void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, dou
 size_t parallel_pthreads_get_threads_num();
 void parallel_pthreads_set_threads_num(int num);
 
+class ThreadPool;
+
+/** Runs the job with at most max_threads threads (0 - the pool limit) in the pool (NULL - the process pool) */
+void parallel_for_pthreads(ThreadPool* pool, unsigned max_threads, const Range& range, const ParallelLoopBody& body, double nstripes);
+
+/** Creates isolated pool of num_threads threads (including the calling thread), workers are pinned to the cpus (if not empty) */
+std::shared_ptr<ThreadPool> parallel_pthreads_create_pool(unsigned num_threads, const std::vector<int>& cpus);
+
 }
 
 #endif // OPENCV_CORE_PARALLEL_IMPL_HPP
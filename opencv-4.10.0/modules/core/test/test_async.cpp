@@ -6,9 +6,12 @@
 #include <opencv2/core/detail/async_promise.hpp>
 
 #include <opencv2/core/bindings_utils.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
 
 #if !defined(OPENCV_DISABLE_THREAD_SUPPORT)
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <chrono>
 #endif
 
@@ -150,6 +153,162 @@ TEST(Core_Async, AsyncThread_DetachedResult)
     EXPECT_TRUE(exception_ok);
 }
 
+TEST(Core_Async, AsyncFunction)
+{
+    Mat src(480, 640, CV_8UC3);
+    randu(src, 0, 256);
+    Mat expected;
+    cv::add(src, Scalar::all(10), expected);
+    cv::bitwise_not(expected, expected);
+
+    std::vector<AsyncArray> results;
+    for (int i = 0; i < 8; i++)
+    {
+        results.push_back(cv::async([&](OutputArray dst) { cv::add(src, Scalar::all(10), dst); })
+                .then([](InputArray a, OutputArray dst) { cv::bitwise_not(a, dst); }));
+    }
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        Mat dst;
+        results[i].get(dst);
+        EXPECT_EQ(0, cvtest::norm(expected, dst, NORM_INF));
+        EXPECT_FALSE(results[i].valid());
+    }
+}
+
+TEST(Core_Async, AsyncFunction_Exception)
+{
+    AsyncArray r = cv::async([](OutputArray) { CV_Error(Error::StsBadArg, "Test: async error"); })
+            .then([](InputArray a, OutputArray dst) { a.copyTo(dst); });
+    try
+    {
+        Mat dst;
+        r.get(dst);
+        FAIL() << "Exception is expected";
+    }
+    catch (const cv::Exception& e)
+    {
+        EXPECT_EQ(Error::StsBadArg, e.code) << e.what();
+    }
+
+    // result is not fetched
+    cv::async([](OutputArray) { CV_Error(Error::StsBadArg, "Test: dropped async error"); });
+}
+
+TEST(Core_Async, AsyncFunction_ThenReadyResult)
+{
+    Mat m(3, 3, CV_32FC1, Scalar::all(5.0f));
+    AsyncPromise p;
+    AsyncArray r = p.getArrayResult();
+    p.setValue(m);
+    Mat dst;
+    AsyncArray r2 = r.then([](InputArray a, OutputArray b) { cv::multiply(a, 2, b); });
+
+    // the result is consumed by the continuation
+    EXPECT_FALSE(r.valid());
+    EXPECT_THROW(r.then([](InputArray a, OutputArray b) { a.copyTo(b); }), cv::Exception);
+    EXPECT_THROW(r.get(dst), cv::Exception);
+
+    r2.get(dst);
+    EXPECT_EQ(0, cvtest::norm(Mat(3, 3, CV_32FC1, Scalar::all(10.0f)), dst, NORM_INF));
+}
+
+TEST(Core_Async, AsyncFunction_BoundedQueue)
+{
+    const int prevThreads = getAsyncNumThreads(), prevQueueSize = getAsyncQueueSize();
+    setAsyncNumThreads(1);
+    setAsyncQueueSize(2);
+
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool started = false, unblocked = false;
+    AsyncArray blocking = cv::async([&](OutputArray dst) {
+        std::unique_lock<std::mutex> lock(mtx);
+        started = true;
+        cond.notify_all();
+        cond.wait(lock, [&] { return unblocked; });
+        Mat(1, 1, CV_32SC1, Scalar::all(-1)).copyTo(dst);
+    });
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [&] { return started; });
+    }
+
+    // the queue is full after two functions, the next calls return only after the blocking function has started
+    std::vector<AsyncArray> results(4);
+    std::vector<int> returned_unblocked(results.size(), -1);
+    int submitted = 0;
+    std::thread producer([&] {
+        for (int i = 0; i < (int)results.size(); i++)
+        {
+            results[i] = cv::async([i](OutputArray dst) { Mat(1, 1, CV_32SC1, Scalar::all(i)).copyTo(dst); });
+            std::unique_lock<std::mutex> lock(mtx);
+            returned_unblocked[i] = unblocked ? 1 : 0;
+            submitted++;
+            cond.notify_all();
+        }
+    });
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [&] { return submitted == 2; });
+        unblocked = true;
+        cond.notify_all();
+    }
+    producer.join();
+    EXPECT_EQ(0, returned_unblocked[0]);
+    EXPECT_EQ(0, returned_unblocked[1]);
+    EXPECT_EQ(1, returned_unblocked[2]);
+    EXPECT_EQ(1, returned_unblocked[3]);
+
+    Mat dst;
+    blocking.get(dst);
+    EXPECT_EQ(-1, dst.at<int>(0));
+    for (int i = 0; i < (int)results.size(); i++)
+    {
+        results[i].get(dst);
+        EXPECT_EQ(i, dst.at<int>(0));
+    }
+
+    setAsyncQueueSize(prevQueueSize);
+    setAsyncNumThreads(prevThreads);
+}
+
+TEST(Core_Async, AsyncFunction_Synchronous)
+{
+    const int prevThreads = getAsyncNumThreads();
+    setAsyncNumThreads(0);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id executor;
+    AsyncArray r = cv::async([&](OutputArray dst) {
+        executor = std::this_thread::get_id();
+        Mat(1, 1, CV_8UC1, Scalar::all(1)).copyTo(dst);
+    });
+    setAsyncNumThreads(prevThreads);
+    EXPECT_TRUE(r.wait_for((int64)0));
+    EXPECT_EQ(caller, executor);
+}
+
+TEST(Core_Async, AsyncFunction_ExecutionContext)
+{
+    parallel::ExecutionContext ctx = parallel::ExecutionContext::create(1);
+    AsyncArray r;
+    {
+        parallel::ExecutionContextScope scope(ctx);
+        r = cv::async([](OutputArray dst) {
+            Mat(1, 1, CV_32SC1, Scalar::all(cv::getNumThreads())).copyTo(dst);
+        }).then([](InputArray a, OutputArray dst) {
+            Mat res;
+            cv::hconcat(a, Mat(1, 1, CV_32SC1, Scalar::all(cv::getNumThreads())), res);
+            res.copyTo(dst);
+        });
+    }
+    Mat dst;
+    r.get(dst);
+    EXPECT_EQ(1, dst.at<int>(0));
+    EXPECT_EQ(1, dst.at<int>(1));
+}
+
 #endif
 
+
 }} // namespace
@@ -983,4 +983,76 @@ protected:
 TEST(Core_DFT, reverse) { Core_DXTReverseTest test(Core_DXTReverseTest::ModeDFT); test.safe_run(); }
 TEST(Core_DCT, reverse) { Core_DXTReverseTest test(Core_DXTReverseTest::ModeDCT); test.safe_run(); }
 
+TEST(Core_DFTPlan, same_result_as_dft)
+{
+    const int types[] = { CV_32FC1, CV_32FC2, CV_64FC1, CV_64FC2 };
+    const int flags[] = { 0, DFT_COMPLEX_OUTPUT, DFT_ROWS | DFT_COMPLEX_OUTPUT, DFT_SCALE,
+                          DFT_INVERSE | DFT_SCALE, DFT_INVERSE | DFT_REAL_OUTPUT, DFT_INVERSE | DFT_ROWS };
+    const Size sizes[] = { Size(31, 24), Size(64, 1), Size(1, 17), Size(50, 51) };
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); si++)
+    for (size_t ti = 0; ti < sizeof(types) / sizeof(types[0]); ti++)
+    for (size_t fi = 0; fi < sizeof(flags) / sizeof(flags[0]); fi++)
+    {
+        const Size sz = sizes[si];
+        const int type = types[ti], flag = flags[fi];
+        SCOPED_TRACE(cv::format("size=%dx%d type=%s flags=%d", sz.width, sz.height, typeToString(type).c_str(), flag));
+
+        Mat big(sz.height + 2, sz.width + 2, type);
+        randu(big, -1., 1.);
+        Mat src = big(Rect(Point(1, 1), sz)).clone(), roi = big(Rect(Point(1, 1), sz));
+
+        DFTPlan plan(sz, type, flag);
+        EXPECT_FALSE(plan.empty());
+        EXPECT_EQ(sz, plan.size());
+        EXPECT_EQ(type, plan.type());
+        EXPECT_EQ(flag, plan.flags());
+
+        Mat ref, dst;
+        dft(src, ref, flag);
+        // repeated executions reuse the same plan and output buffer
+        for (int iter = 0; iter < 2; iter++)
+        {
+            plan.execute(src, dst);
+            EXPECT_EQ(ref.type(), dst.type());
+            EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+        }
+
+        // non-continuous input
+        dft(roi, ref, flag);
+        plan.execute(roi, dst);
+        EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+
+        // in-place transform
+        if (ref.type() == type)
+        {
+            Mat inplace_ref = src.clone(), inplace = src.clone();
+            dft(inplace_ref, inplace_ref, flag);
+            plan.execute(inplace, inplace);
+            EXPECT_EQ(0, cvtest::norm(inplace_ref, inplace, NORM_INF));
+        }
+    }
+}
+
+TEST(Core_DFTPlan, create_and_bad_args)
+{
+    DFTPlan plan;
+    EXPECT_TRUE(plan.empty());
+    Mat src(16, 16, CV_32FC1, Scalar::all(1)), dst;
+    EXPECT_ANY_THROW(plan.execute(src, dst));
+
+    plan.create(src.size(), CV_32FC1, DFT_COMPLEX_OUTPUT);
+    plan.execute(src, dst);
+    EXPECT_EQ(CV_32FC2, dst.type());
+    EXPECT_EQ(256.f, dst.at<Vec2f>(0, 0)[0]);
+
+    // the plan is created only for the given size and type
+    EXPECT_ANY_THROW(plan.execute(Mat(16, 17, CV_32FC1, Scalar::all(1)), dst));
+    EXPECT_ANY_THROW(plan.execute(Mat(16, 16, CV_64FC1, Scalar::all(1)), dst));
+    EXPECT_ANY_THROW(plan.create(Size(16, 16), CV_8UC1));
+    EXPECT_ANY_THROW(plan.create(Size(16, 16), CV_32FC1, DFT_COMPLEX_INPUT));
+
+    plan.release();
+    EXPECT_TRUE(plan.empty());
+}
+
 }} // namespace
@@ -10,6 +10,9 @@
 #endif
 
 #include "opencv2/core/cuda.hpp"
+#include "opencv2/core/utils/allocator_stats.hpp"
+
+#include <thread>
 
 namespace opencv_test { namespace {
 
@@ -2598,4 +2601,100 @@ TEST(Mat, Recreate1DMatWithSameMeta)
     EXPECT_NO_THROW(m.create(dims, depth));
 }
 
+static Mat createPooledMat(int rows, int cols, int type)
+{
+    Mat m;
+    m.allocator = Mat::getPoolAllocator();
+    m.create(rows, cols, type);
+    return m;
+}
+
+TEST(Mat, pool_allocator_reuses_buffers)
+{
+    utils::PoolAllocatorStatisticsInterface& stats = utils::getMatPoolAllocatorStatistics();
+    Mat::getPoolAllocator()->getBufferPoolController()->freeAllReservedBuffers();
+    stats.resetCounters();
+
+    const uchar* data = NULL;
+    for (int i = 0; i < 10; i++)
+    {
+        Mat m = createPooledMat(480, 640, CV_8UC3);
+        if (i == 0)
+            data = m.data;
+        EXPECT_EQ(data, m.data);
+        m.setTo(Scalar::all(i));
+        EXPECT_EQ(0, cvtest::norm(m, Mat(m.size(), m.type(), Scalar::all(i)), NORM_INF));
+    }
+    EXPECT_EQ(10u, stats.getNumberOfAllocations());
+    EXPECT_EQ(1u, stats.getNumberOfMisses());
+    EXPECT_EQ(9u, stats.getNumberOfHits());
+    EXPECT_DOUBLE_EQ(0.9, stats.getHitRate());
+    EXPECT_GE(stats.getReservedSize(), 480u * 640 * 3);
+
+    // sizes of the same class share buffers, ROI/step are not affected
+    {
+        Mat m = createPooledMat(481, 639, CV_8UC3);
+        EXPECT_EQ(data, m.data);
+        EXPECT_TRUE(m.isContinuous());
+        EXPECT_EQ((size_t)639 * 3, m.step[0]);
+    }
+    // small and large buffers
+    {
+        Mat small = createPooledMat(1, 1, CV_8U);
+        Mat large = createPooledMat(4100, 4100, CV_32FC1);  // above the pooled size limit
+        large.row(4099).setTo(Scalar::all(1));
+        EXPECT_EQ(3u, stats.getNumberOfMisses());
+    }
+
+    // caches of other threads are released on their next use
+    Mat::getPoolAllocator()->getBufferPoolController()->freeAllReservedBuffers();
+    EXPECT_LT(stats.getReservedSize(), 480u * 640 * 3);
+    Mat m = createPooledMat(480, 640, CV_8UC3);
+    EXPECT_EQ(4u, stats.getNumberOfMisses());
+}
+
+TEST(Mat, pool_allocator_reclaims_buffers_of_other_threads)
+{
+    utils::PoolAllocatorStatisticsInterface& stats = utils::getMatPoolAllocatorStatistics();
+    Mat::getPoolAllocator()->getBufferPoolController()->freeAllReservedBuffers();
+    stats.resetCounters();
+
+    // released buffers of the finished thread are moved to the shared list
+    std::vector<Mat> frames(4);
+    std::thread producer([&]()
+    {
+        for (size_t i = 0; i < frames.size(); i++)
+            frames[i] = createPooledMat(240, 320, CV_16UC1);
+        for (int i = 0; i < 3; i++)
+            createPooledMat(100, 100, CV_32FC1).setTo(Scalar::all(1));
+    });
+    producer.join();
+    EXPECT_EQ(5u, stats.getNumberOfMisses());
+    EXPECT_EQ(2u, stats.getNumberOfHits());
+
+    Mat m = createPooledMat(100, 100, CV_32FC1);
+    EXPECT_EQ(1u, stats.getNumberOfReclaims());
+
+    // consumer releases buffers, producer reuses them
+    std::thread([&]() { frames.clear(); }).join();
+    for (int i = 0; i < 4; i++)
+        frames.push_back(createPooledMat(240, 320, CV_16UC1));
+    EXPECT_EQ(5u, stats.getNumberOfMisses());
+    EXPECT_EQ(2u, stats.getNumberOfReclaims());
+
+    // concurrent use
+    parallel_for_(Range(0, 64), [&](const Range& r)
+    {
+        for (int i = r.start; i < r.end; i++)
+        {
+            Mat a = createPooledMat(10 + i % 7, 20 + i % 5, CV_32SC1);
+            a.setTo(Scalar::all(i));
+            Mat b = createPooledMat(a.rows, a.cols, a.type());
+            a.copyTo(b);
+            ASSERT_EQ(0, cvtest::norm(b, Mat(a.size(), a.type(), Scalar::all(i)), NORM_INF));
+        }
+    });
+    EXPECT_EQ(stats.getNumberOfAllocations(), stats.getNumberOfHits() + stats.getNumberOfReclaims() + stats.getNumberOfMisses());
+}
+
 }} // namespace
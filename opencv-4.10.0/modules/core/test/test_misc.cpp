@@ -7,6 +7,7 @@
 #include "opencv2/core/utils/logger.hpp"
 
 #include <opencv2/core/utils/fp_control_utils.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
 
 #include <chrono>
 #include <thread>
@@ -304,6 +305,175 @@ TEST(Core_Parallel, propagate_fp_denormals_ignore_hint)
     }
 }
 
+// checks that every iteration is executed once and counts jobs which have been run by several threads
+class ThreadsCheckerParallelLoopBody : public cv::ParallelLoopBody
+{
+public:
+    ThreadsCheckerParallelLoopBody(std::vector<int>& counters_, int& parallelJobs_, int nestedSize_ = 0)
+        : counters(counters_), parallelJobs(parallelJobs_), nestedSize(nestedSize_) {}
+    void operator()(const cv::Range& r) const CV_OVERRIDE
+    {
+        if (nestedSize > 0)
+        {
+            for (int i = r.start; i < r.end; i++)
+            {
+                std::vector<int> nestedCounters(nestedSize, 0);
+                int nestedParallelJobs = 0;
+                parallel_for_(cv::Range(0, nestedSize), ThreadsCheckerParallelLoopBody(nestedCounters, nestedParallelJobs));
+                cv::AutoLock lock(mutex);
+                counters[i] += countNonZero(Mat(nestedCounters) != 1) == 0 ? 1 : 100;
+                parallelJobs += nestedParallelJobs;
+            }
+            return;
+        }
+        {
+            cv::AutoLock lock(mutex);
+            for (int i = r.start; i < r.end; i++)
+                counters[i]++;
+            threads.insert(cv::utils::getThreadID());
+            if (threads.size() == 2)
+                parallelJobs++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+protected:
+    std::vector<int>& counters;
+    int& parallelJobs;
+    int nestedSize;
+    mutable cv::Mutex mutex;
+    mutable std::set<int> threads;
+};
+
+static bool isBuiltinThreadPoolUsed()
+{
+    const char* framework = cv::currentParallelFramework();
+    return framework && std::string(framework) == "pthreads" && cv::getNumThreads() > 2;
+}
+
+TEST(Core_Parallel, concurrent_calls)
+{
+    const int nCallers = 3, nJobs = 5, size = std::max(1, cv::getNumThreads()) * 8;
+    std::vector< std::vector<int> > counters(nCallers, std::vector<int>(nJobs * size, 0));
+    std::vector<int> parallelJobs(nCallers, 0);
+    std::vector<std::thread> callers;
+    for (int c = 0; c < nCallers; c++)
+    {
+        callers.push_back(std::thread([&, c]() {
+            for (int j = 0; j < nJobs; j++)
+                parallel_for_(cv::Range(j * size, (j + 1) * size), ThreadsCheckerParallelLoopBody(counters[c], parallelJobs[c]));
+        }));
+    }
+    for (size_t c = 0; c < callers.size(); c++)
+        callers[c].join();
+
+    for (int c = 0; c < nCallers; c++)
+    {
+        EXPECT_EQ(0, countNonZero(Mat(counters[c]) != 1)) << "caller " << c;
+        if (isBuiltinThreadPoolUsed())
+        {
+            EXPECT_GT(parallelJobs[c], 0) << "caller " << c;
+        }
+    }
+}
+
+TEST(Core_Parallel, nested_calls)
+{
+    const int size = 4, nestedSize = std::max(1, cv::getNumThreads()) * 4;
+    std::vector<int> counters(size, 0);
+    int parallelJobs = 0;
+    parallel_for_(cv::Range(0, size), ThreadsCheckerParallelLoopBody(counters, parallelJobs, nestedSize));
+
+    EXPECT_EQ(0, countNonZero(Mat(counters) != 1));
+    if (isBuiltinThreadPoolUsed())
+    {
+        EXPECT_GT(parallelJobs, 0);
+    }
+}
+
+static std::set<int> runAndCollectThreads(int size, int* nestedNumThreads = NULL)
+{
+    cv::Mutex mutex;
+    std::set<int> threads;
+    parallel_for_(cv::Range(0, size), [&](const cv::Range& r) {
+        {
+            cv::AutoLock lock(mutex);
+            threads.insert(cv::utils::getThreadID());
+            if (nestedNumThreads)
+                *nestedNumThreads = std::max(*nestedNumThreads, cv::getNumThreads());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(r.size()));
+    });
+    return threads;
+}
+
+TEST(Core_Parallel, execution_context_limits_threads)
+{
+    const int numThreads = cv::getNumThreads();
+    {
+        cv::parallel::ExecutionContextScope scope(cv::parallel::ExecutionContext::create(2));
+        EXPECT_EQ(2, cv::getNumThreads());
+        int nestedNumThreads = 0;
+        EXPECT_GE(2u, runAndCollectThreads(64, &nestedNumThreads).size());
+        EXPECT_EQ(2, nestedNumThreads);
+        {
+            cv::parallel::ExecutionContextScope serial(cv::parallel::ExecutionContext::create(1));
+            EXPECT_EQ(1, cv::getNumThreads());
+            EXPECT_EQ(1u, runAndCollectThreads(16).size());
+        }
+        EXPECT_EQ(2, cv::getNumThreads());
+    }
+    EXPECT_TRUE(cv::parallel::ExecutionContext::getCurrentRef().empty());
+    EXPECT_EQ(numThreads, cv::getNumThreads());
+}
+
+TEST(Core_Parallel, execution_context_per_thread)
+{
+    const int numThreads = cv::getNumThreads();
+    cv::parallel::ExecutionContextScope scope(cv::parallel::ExecutionContext::create(1));
+    int otherNumThreads = 0;
+    std::thread other([&]() { otherNumThreads = cv::getNumThreads(); });
+    other.join();
+    EXPECT_EQ(numThreads, otherNumThreads);
+    EXPECT_EQ(1, cv::getNumThreads());
+}
+
+#if defined __linux__ && defined _GNU_SOURCE
+TEST(Core_Parallel, execution_context_affinity)
+{
+    if (!isBuiltinThreadPoolUsed())
+        throw SkipTestException("Built-in thread pool is not used");
+    cpu_set_t cpu_set;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(cpu_set), &cpu_set));
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &cpu_set))
+        cpu++;
+
+    const std::vector<int> cpus(1, cpu);
+    cv::parallel::ExecutionContext ctx = cv::parallel::ExecutionContext::create(3, cpus);
+    ASSERT_EQ(3, ctx.getNumThreads());
+    ASSERT_EQ(cpus, ctx.getCPUs());
+    cv::parallel::ExecutionContextScope scope(ctx);
+
+    const int callerThread = cv::utils::getThreadID();
+    cv::Mutex mutex;
+    int workerTasks = 0, pinnedTasks = 0;
+    parallel_for_(cv::Range(0, 32), [&](const cv::Range&) {
+        cpu_set_t thread_set;
+        bool pinned = sched_getaffinity(0, sizeof(thread_set), &thread_set) == 0 &&
+                      CPU_COUNT(&thread_set) == 1 && CPU_ISSET(cpu, &thread_set);
+        cv::AutoLock lock(mutex);
+        if (cv::utils::getThreadID() != callerThread)
+        {
+            workerTasks++;
+            pinnedTasks += pinned ? 1 : 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    EXPECT_GT(workerTasks, 0);
+    EXPECT_EQ(workerTasks, pinnedTasks);
+}
+#endif
+
 TEST(Core_Version, consistency)
 {
     // this test verifies that OpenCV version loaded in runtime
@@ -1560,6 +1560,142 @@ TEST(Core_MatExpr, empty_check_15760)
     EXPECT_THROW(Mat c = Mat().cross(Mat()), cv::Exception);
 }
 
+typedef testing::TestWithParam<perf::MatType> Core_MatExpr_Fused;
+
+TEST_P(Core_MatExpr_Fused, accuracy)
+{
+    const int type = GetParam();
+    const double eps = CV_MAT_DEPTH(type) == CV_32F ? 1e-5 : 1e-12;
+    RNG& rng = theRNG();
+    Mat big_a(40, 60, type), big_b(40, 60, type), big_c(40, 60, type);
+    rng.fill(big_a, RNG::UNIFORM, -10, 10);
+    rng.fill(big_b, RNG::UNIFORM, -10, 10);
+    rng.fill(big_c, RNG::UNIFORM, 1, 10);
+
+    // continuous and non-continuous operands
+    for (int iter = 0; iter < 2; iter++)
+    {
+        Rect roi = iter == 0 ? Rect(0, 0, 60, 40) : Rect(3, 2, 37, 33);
+        Mat a = big_a(roi), b = big_b(roi), c = big_c(roi);
+        Mat t, ref;
+
+        cv::addWeighted(a, 2.5, b, -0.5, 0, t);
+        cv::subtract(t, c, ref);
+        EXPECT_LE(cvtest::norm(Mat(a*2.5 + b*(-0.5) - c), ref, NORM_INF), eps*100);
+
+        cv::subtract(a, b, t);
+        cv::divide(t, c, ref);
+        EXPECT_LE(cvtest::norm(Mat((a - b)/c), ref, NORM_INF), eps*10);
+
+        cv::add(a, b, t);
+        cv::multiply(t, c - a, ref, 0.5);
+        EXPECT_LE(cvtest::norm(Mat((a + b).mul(c - a, 0.5)), ref, NORM_INF), eps*1000);
+
+        cv::add(a, c, t);
+        cv::divide(2.0, t, t);
+        cv::subtract(Scalar(1), t, ref);  // scalar is added to the first channel
+        EXPECT_LE(cvtest::norm(Mat(1 - 2.0/(a + c)), ref, NORM_INF), eps*100);
+
+        cv::scaleAdd(b, 0.5, a, t);
+        cv::absdiff(t, Scalar::all(0), ref);
+        cv::min(ref, c, ref);
+        EXPECT_LE(cvtest::norm(Mat(min(abs(a + b*0.5), c)), ref, NORM_INF), eps*100);
+
+        cv::add(a, b, t);
+        cv::max(t, a - c, ref);
+        EXPECT_LE(cvtest::norm(Mat(max(a + b, a - c)), ref, NORM_INF), eps*100);
+
+        // expression ROI
+        cv::add(a, b, t);
+        cv::multiply(t, c, ref);
+        Rect r(1, 2, 10, 7);
+        EXPECT_LE(cvtest::norm(Mat(((a + b).mul(c))(r)), ref(r), NORM_INF), eps*1000);
+        EXPECT_LE(cvtest::norm(Mat(((a + b).mul(c)).row(5)), ref.row(5), NORM_INF), eps*1000);
+
+        if (CV_MAT_CN(type) == 1)
+        {
+            // comparison of exactly computable values
+            cv::addWeighted(a, 2, b, 1, 0, t);
+            cv::compare(t, c, ref, CMP_GT);
+            MatExpr e = a*2 + b > c;
+            EXPECT_EQ(CV_8UC1, e.type());
+            EXPECT_EQ(0, cvtest::norm(Mat(e), ref, NORM_INF));
+
+            cv::compare(t, 1.0, ref, CMP_LE);
+            EXPECT_EQ(0, cvtest::norm(Mat(1.0 >= a*2 + b), ref, NORM_INF));
+
+            cv::max(t, 0.5, ref);
+            EXPECT_LE(cvtest::norm(Mat(max(a*2 + b, 0.5)), ref, NORM_INF), eps*100);
+        }
+
+        // in-place evaluation
+        cv::add(a, b, t);
+        cv::subtract(t, c, ref);
+        Mat d = a.clone();
+        d = d + b - c;
+        EXPECT_LE(cvtest::norm(d, ref, NORM_INF), eps*100);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Core_MatExpr_Fused, testing::Values(CV_32FC1, CV_32FC3, CV_64FC1, CV_64FC4));
+
+TEST(Core_MatExpr, fused_operands_written_after_build)
+{
+    RNG& rng = theRNG();
+    Mat a(5, 7, CV_32FC1), b(a.size(), a.type()), c(a.size(), a.type());
+    rng.fill(a, RNG::UNIFORM, -10, 10);
+    rng.fill(b, RNG::UNIFORM, -10, 10);
+    rng.fill(c, RNG::UNIFORM, 1, 10);
+
+    Mat t, ref1, ref2;
+    cv::addWeighted(a, 2, b, 3, 0, t);
+    cv::subtract(t, c, ref1);
+    cv::subtract(a, b, t);
+    cv::divide(t, c, ref2);
+
+    // the operands are read when the expression is built, as the per-operation temporaries are
+    MatExpr e1 = a*2 + b*3 - c;
+    MatExpr e2 = (a - b)/c;
+    a.setTo(Scalar::all(100));
+    b.setTo(Scalar::all(-100));
+
+    Mat res1 = e1, res2 = e2;
+    EXPECT_LE(cvtest::norm(res1, ref1, NORM_INF), 1e-4);
+    EXPECT_LE(cvtest::norm(res2, ref2, NORM_INF), 1e-5);
+}
+
+TEST(Core_MatExpr, fused_integer_saturation)
+{
+    Mat a(1, 3, CV_8UC1), b(1, 3, CV_8UC1), c(1, 3, CV_8UC1);
+    a.at<uchar>(0) = 200; b.at<uchar>(0) = 100; c.at<uchar>(0) = 100;
+    a.at<uchar>(1) = 10;  b.at<uchar>(1) = 20;  c.at<uchar>(1) = 50;
+    a.at<uchar>(2) = 5;   b.at<uchar>(2) = 6;   c.at<uchar>(2) = 7;
+
+    // each operation saturates the result (integer chains are evaluated operation by operation)
+    Mat res = a + b - c;
+    EXPECT_EQ(155, res.at<uchar>(0));
+    EXPECT_EQ(0, res.at<uchar>(1));
+    EXPECT_EQ(4, res.at<uchar>(2));
+}
+
+TEST(Core_MatExpr, fused_many_channels)
+{
+    Mat a(7, 100, CV_32FC(5)), b(a.size(), a.type()), c(a.size(), a.type());
+    RNG& rng = theRNG();
+    rng.fill(a, RNG::UNIFORM, -10, 10);
+    rng.fill(b, RNG::UNIFORM, -10, 10);
+    rng.fill(c, RNG::UNIFORM, -10, 10);
+
+    Mat res = a.mul(b)*2 + c - a, ref, t;
+    cv::multiply(a, b, t, 2);
+    cv::add(t, c, t);
+    cv::subtract(t, a, ref);
+    EXPECT_LE(cvtest::norm(res, ref, NORM_INF), 1e-4);
+
+    // a scalar has 4 channels at most, as for cv::add
+    EXPECT_THROW(res = a.mul(b) + Scalar(1, 2, 3, 4), cv::Exception);
+}
+
 TEST(Core_Arithm, scalar_handling_19599)  // https://github.com/opencv/opencv/issues/19599 (OpenCV 4.x+ only)
 {
     Mat a(1, 1, CV_32F, Scalar::all(1));
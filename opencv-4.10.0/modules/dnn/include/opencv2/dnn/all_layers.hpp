@@ -292,6 +292,7 @@ CV__DNN_INLINE_NS_BEGIN
         bool fusedActivation = false;
         bool fusedAdd = false;
         bool useWinograd = true; // Flag whether to use Winograd to speed up 3x3 convolution.
+        bool constantWeights = false; // Flag whether the weights input is unchanged since the previous call, set by the network.
     };
 
     class CV_EXPORTS ConvolutionLayerInt8 : public BaseConvolutionLayer
@@ -730,6 +730,19 @@ CV__DNN_INLINE_NS_BEGIN
         CV_WRAP void setInput(InputArray blob, const String& name = "",
                               double scalefactor = 1.0, const Scalar& mean = Scalar());
 
+        /** @brief Marks the network input as constant between the forward passes.
+         *  @param name     A name of input layer.
+         *  @param constant Whether the input is constant.
+         *
+         *  The layers which depend only on the constant inputs are computed once and their outputs
+         *  are kept, the following forward passes compute only the rest of the network. The kept
+         *  outputs are recomputed after a new value of any constant input is set by setInput().
+         *  It is useful for the networks with an input that rarely changes, e.g. the template of
+         *  a tracker. Applies to DNN_BACKEND_OPENCV with CPU targets, other configurations compute
+         *  the whole network as usual.
+         */
+        CV_WRAP void setInputConstant(const String& name, bool constant = true);
+
         /** @brief Sets the new value for the learned param of the layer.
          *  @param layer name or id of the layer.
          *  @param numParam index of the layer parameter in the Layer::blobs array.
@@ -1219,9 +1219,11 @@ public:
         bool variableWeight = false;
         if (blobs.empty())
         {
-            variableWeight = true;
+            // The weights computed by the constant layers of the network (e.g. the template branch
+            // of a tracker) are kept between the calls, the packed weights are reused then.
+            variableWeight = !fastConvImpl || !constantWeights;
             Mat wm = inputs[1].reshape(1, outCn);
-            if (wm.data != weightsMat.data)
+            if (variableWeight && wm.data != weightsMat.data)
             {
                 int newcols = (int)alignSize(wm.step1(), VEC_ALIGN);
                 Mat wm_buffer = Mat(numOutput, newcols, wm.type());
@@ -180,6 +180,14 @@ void Net::setInput(InputArray blob, const String& name, double scalefactor, cons
     return impl->setInput(blob, name, scalefactor, mean);
 }
 
+void Net::setInputConstant(const String& name, bool constant)
+{
+    CV_TRACE_FUNCTION();
+    CV_TRACE_ARG_VALUE(name, "name", name.c_str());
+    CV_Assert(impl);
+    return impl->setInputConstant(name, constant);
+}
+
 Mat Net::getParam(int layer, int numParam) const
 {
     CV_Assert(impl);
@@ -135,7 +135,10 @@ void Net::Impl::setUpNet(const std::vector<LayerPin>& blobsToKeep_)
 
     validateBackendAndTarget();
 
-    if (!netWasAllocated || this->blobsToKeep != blobsToKeep_)
+    std::vector<LayerPin> pinsToKeep(blobsToKeep_);
+    findConstantLayers(pinsToKeep);
+
+    if (!netWasAllocated || this->blobsToKeep != pinsToKeep)
     {
         if (preferableBackend == DNN_BACKEND_OPENCV && IS_DNN_OPENCL_TARGET(preferableTarget))
 #ifndef HAVE_OPENCL
@@ -194,15 +197,18 @@ void Net::Impl::setUpNet(const std::vector<LayerPin>& blobsToKeep_)
             updateLayersShapes();
         }
 
-        this->blobsToKeep = blobsToKeep_;
+        this->blobsToKeep = pinsToKeep;
 
-        allocateLayers(blobsToKeep_);
+        allocateLayers(pinsToKeep);
 
         MapIdToLayerData::iterator it = layers.find(0);
         CV_Assert(it != layers.end());
         it->second.skip = netInputLayer->skip;
 
-        initBackend(blobsToKeep_);
+        initBackend(pinsToKeep);
+
+        // allocation marks all of the layers, the constant ones must be computed by the next pass
+        resetConstantLayers();
 
         if (!netWasAllocated)
         {
@@ -221,6 +227,93 @@ void Net::Impl::setUpNet(const std::vector<LayerPin>& blobsToKeep_)
             dumpNetworkToFile();
         }
     }
+
+    markConstantWeights();
+}
+
+
+void Net::Impl::findConstantLayers(std::vector<LayerPin>& pinsToKeep)
+{
+    constantLayers.clear();
+    if (constantInputs.empty() || preferableBackend != DNN_BACKEND_OPENCV ||
+        (preferableTarget != DNN_TARGET_CPU && preferableTarget != DNN_TARGET_CPU_FP16))
+        return;
+
+    // The layers are computed in the order of their ids, so the inputs of a layer are classified before it.
+    // The layers without inputs are computed on every pass, they don't make their consumers variable.
+    std::set<int> sourceLayers;
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        if (ld.id == 0)
+            continue;
+        if (ld.inputBlobsId.empty())
+        {
+            sourceLayers.insert(ld.id);
+            continue;
+        }
+        bool constant = true, dependsOnInput = false;
+        for (size_t i = 0; i < ld.inputBlobsId.size() && constant; i++)
+        {
+            const LayerPin& pin = ld.inputBlobsId[i];
+            if (pin.lid == 0)
+            {
+                constant = constantInputs.count(pin.oid) != 0;
+                dependsOnInput = true;
+            }
+            else if (constantLayers.count(pin.lid) != 0)
+                dependsOnInput = true;
+            else
+                constant = sourceLayers.count(pin.lid) != 0;
+        }
+        if (constant && dependsOnInput)
+            constantLayers.insert(ld.id);
+    }
+
+    // The outputs consumed by the rest of the network must survive the memory reuse
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        if (ld.id == 0 || constantLayers.count(ld.id) != 0)
+            continue;
+        for (size_t i = 0; i < ld.inputBlobsId.size(); i++)
+        {
+            const LayerPin& pin = ld.inputBlobsId[i];
+            if (constantLayers.count(pin.lid) != 0 &&
+                std::find(pinsToKeep.begin(), pinsToKeep.end(), pin) == pinsToKeep.end())
+                pinsToKeep.push_back(pin);
+        }
+    }
+}
+
+
+void Net::Impl::resetConstantLayers()
+{
+    for (std::set<int>::const_iterator it = constantLayers.begin(); it != constantLayers.end(); ++it)
+        layers[*it].flag = 0;
+}
+
+
+void Net::Impl::markConstantWeights()
+{
+    // The constant layers which were computed by the previous passes keep their outputs,
+    // the convolutions taking the weights from them don't have to pack the weights again.
+    for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        LayerData& ld = it->second;
+        if (ld.type != "Convolution" || ld.inputBlobsId.size() < 2)
+            continue;
+        Ptr<ConvolutionLayer> convLayer = ld.layerInstance.dynamicCast<ConvolutionLayer>();
+        if (convLayer.empty())
+            continue;
+        bool constantWeights = true;
+        for (size_t i = 1; i < ld.inputBlobsId.size() && constantWeights; i++)
+        {
+            int lid = ld.inputBlobsId[i].lid;
+            constantWeights = constantLayers.count(lid) != 0 && layers[lid].flag != 0;
+        }
+        convLayer->constantWeights = constantWeights;
+    }
 }
 
 
@@ -864,8 +957,10 @@ void Net::Impl::forwardToLayer(LayerData& ld, bool clearFlags)
 
     if (clearFlags)
     {
+        // the constant layers keep the results of the previous passes
         for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); it++)
-            it->second.flag = 0;
+            if (constantLayers.count(it->first) == 0)
+                it->second.flag = 0;
     }
 
     // already was forwarded
@@ -1447,6 +1542,28 @@ void Net::Impl::setInput(InputArray blob, const String& name, double scalefactor
     netInputLayer->scaleFactors[pin.oid] = scalefactor;
     netInputLayer->means[pin.oid] = mean;
     netWasAllocated = netWasAllocated && oldShape;
+    if (constantInputs.count(pin.oid) != 0)
+        resetConstantLayers();
+}
+
+
+void Net::Impl::setInputConstant(const String& name, bool constant)
+{
+    LayerPin pin;
+    pin.lid = 0;
+    pin.oid = resolvePinOutputName(getLayerData(pin.lid), name);
+
+    if (!pin.valid())
+        CV_Error(Error::StsObjectNotFound, "Requested blob \"" + name + "\" not found");
+
+    if (constant)
+        constantInputs.insert(pin.oid);
+    else
+        constantInputs.erase(pin.oid);
+
+    // the next pass classifies the layers again and computes all of them
+    for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); it++)
+        it->second.flag = 0;
 }
 
 
@@ -1467,6 +1584,7 @@ void Net::Impl::setParam(int layer, int numParam, const Mat& blob)
     CV_Assert(numParam < (int)layerBlobs.size());
     // we don't make strong checks, use this function carefully
     layerBlobs[numParam] = blob;
+    resetConstantLayers();
 }
 
 
@@ -68,6 +68,11 @@ struct Net::Impl : public detail::NetImplBase
     bool useWinograd;
     std::vector<int64> layersTimings;
 
+    // Outputs of the netInputLayer marked by setInputConstant(), and the layers which depend only on them.
+    // The constant layers keep their outputs (and their "forwarded" flag) between the forward passes.
+    std::set<int> constantInputs;
+    std::set<int> constantLayers;
+
 
     virtual bool empty() const;
     virtual void setPreferableBackend(Net& net, int backendId);
@@ -83,6 +88,9 @@ struct Net::Impl : public detail::NetImplBase
     virtual void validateBackendAndTarget();
 
     void setUpNet(const std::vector<LayerPin>& blobsToKeep_ = std::vector<LayerPin>());
+    void findConstantLayers(std::vector<LayerPin>& pinsToKeep);
+    void resetConstantLayers();
+    void markConstantWeights();
 
 
     virtual Ptr<Layer> createLayerInstance(const LayerData& ld) const
@@ -154,6 +162,7 @@ struct Net::Impl : public detail::NetImplBase
     void setInputsNames(const std::vector<String>& inputBlobNames);
     void setInputShape(const String& inputName, const MatShape& shape);
     virtual void setInput(InputArray blob, const String& name, double scalefactor, const Scalar& mean);
+    void setInputConstant(const String& name, bool constant);
     Mat getParam(int layer, int numParam) const;
     void setParam(int layer, int numParam, const Mat& blob);
     std::vector<Ptr<Layer>> getLayerInputs(int layerId) const;
@@ -261,6 +261,11 @@ void Net::Impl::fuseLayers(const std::vector<LayerPin>& blobsToKeep_)
                     if (!biasLayerData)
                         break;
 
+                    // The fused convolution writes into the output of the bias layer. A constant layer keeps
+                    // its output between the passes, so both of them must be constant or both variable.
+                    if (constantLayers.count(ld.id) != constantLayers.count(biasLayerData->id))
+                        break;
+
                     // We check if the bias output shape and the ld output shape are the same.
                     MatShape biasOutShape = shape(biasLayerData->outputBlobs[0]);
                     MatShape ldOutShape = shape(ld.outputBlobs[0]);
@@ -466,6 +471,9 @@ void Net::Impl::fuseLayers(const std::vector<LayerPin>& blobsToKeep_)
                         }
                     }
                     CV_Assert(biasLayerData);
+                    // the constant layers keep their outputs between the passes, see the CPU fusion above
+                    if (constantLayers.count(ld.id) != constantLayers.count(biasLayerData->id))
+                        break;
                     {
                         // fuse eltwise + activation layer
                         // bias must already be computed to fuse => bias layer must appear before convolution
@@ -727,6 +735,9 @@ void Net::Impl::fuseLayers(const std::vector<LayerPin>& blobsToKeep_)
 
                     if(inp_i_data->skip || inp_i_data->consumers.size() != 1)
                         break;
+                    // the output of a constant layer is written once, the concat output buffer may be reused
+                    if (constantLayers.count(pin.lid) != 0)
+                        break;
 #ifdef HAVE_CUDA
                     /* Risk: Not every operation in "NaryEltwise" is supported in the CUDA backend. There is a chance
                              that Concat's output is filled with data in both host and device, leading to data missing.
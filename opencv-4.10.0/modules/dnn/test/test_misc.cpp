@@ -418,6 +418,219 @@ TEST(LayerFactory, custom_layers)
     LayerFactory::unregisterLayer("CustomType");
 }
 
+class CountingCopyLayer CV_FINAL : public Layer
+{
+public:
+    CountingCopyLayer(const LayerParams &params) : Layer(params) {}
+
+    static Ptr<Layer> create(LayerParams& params)
+    {
+        return Ptr<Layer>(new CountingCopyLayer(params));
+    }
+
+    void forward(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr, OutputArrayOfArrays) CV_OVERRIDE
+    {
+        std::vector<Mat> inputs, outputs;
+        inputs_arr.getMatVector(inputs);
+        outputs_arr.getMatVector(outputs);
+        inputs[0].copyTo(outputs[0]);
+        counter++;
+    }
+
+    static int counter;
+};
+int CountingCopyLayer::counter = 0;
+
+TEST(Net, setInputConstant)
+{
+    CV_DNN_REGISTER_LAYER_CLASS(CountingCopy, CountingCopyLayer);
+
+    Net net;
+    LayerParams lp;
+    lp.name = "template_branch";
+    lp.type = "CountingCopy";
+    int branchId = net.addLayerToPrev(lp.name, lp.type, lp);  // connect to the first input
+
+    LayerParams eltwise;
+    eltwise.name = "sum";
+    eltwise.type = "Eltwise";
+    eltwise.set("operation", "sum");
+    int sumId = net.addLayer(eltwise.name, eltwise.type, eltwise);
+    net.connect(branchId, 0, sumId, 0);
+    net.connect(0, 1, sumId, 1);
+
+    std::vector<String> inputNames;
+    inputNames.push_back("template");
+    inputNames.push_back("search");
+    net.setInputsNames(inputNames);
+    net.setInputConstant("template");
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    int shape[] = {1, 2, 3, 4};
+    Mat templ(4, shape, CV_32F), search(4, shape, CV_32F);
+    randu(templ, -1, 1);
+    CountingCopyLayer::counter = 0;
+    net.setInput(templ, "template");
+    for (int i = 0; i < 3; i++)
+    {
+        randu(search, -1, 1);
+        net.setInput(search, "search");
+        Mat out = net.forward();
+        normAssert(out, templ + search, format("frame %d", i).c_str());
+    }
+    EXPECT_EQ(1, CountingCopyLayer::counter);
+
+    // a new template recomputes the branch
+    randu(templ, -1, 1);
+    net.setInput(templ, "template");
+    Mat out = net.forward();
+    normAssert(out, templ + search, "new template");
+    EXPECT_EQ(2, CountingCopyLayer::counter);
+
+    net.setInputConstant("template", false);
+    out = net.forward();
+    normAssert(out, templ + search, "not constant");
+    EXPECT_EQ(3, CountingCopyLayer::counter);
+    out = net.forward();
+    EXPECT_EQ(4, CountingCopyLayer::counter);
+
+    LayerFactory::unregisterLayer("CountingCopy");
+}
+
+// The convolution fused with Add writes into the output of the other branch,
+// a constant branch must not be fused with a variable one
+TEST(Net, setInputConstant_conv_add)
+{
+    CV_DNN_REGISTER_LAYER_CLASS(CountingCopy, CountingCopyLayer);
+
+    const int C = 3, H = 5, W = 6;
+    int shape[] = {1, C, H, W};
+    int weightsShape[] = {C, C, 1, 1};
+    Mat weights(4, weightsShape, CV_32F);
+    randu(weights, -1, 1);
+
+    for (int constantConv = 0; constantConv < 2; constantConv++)
+    {
+        // the Add branch is computed before the convolution
+        Net net;
+        LayerParams lp;
+        lp.name = "branch";
+        lp.type = "CountingCopy";
+        int branchId = net.addLayer(lp.name, lp.type, lp);
+        net.connect(0, constantConv ? 1 : 0, branchId, 0);
+
+        LayerParams conv;
+        conv.name = "conv";
+        conv.type = "Convolution";
+        conv.set("kernel_size", 1);
+        conv.set("num_output", C);
+        conv.set("bias_term", false);
+        conv.blobs.push_back(weights);
+        int convId = net.addLayer(conv.name, conv.type, conv);
+        net.connect(0, constantConv ? 0 : 1, convId, 0);
+
+        LayerParams add;
+        add.name = "add";
+        add.type = "NaryEltwise";
+        add.set("operation", "add");
+        int addId = net.addLayer(add.name, add.type, add);
+        net.connect(convId, 0, addId, 0);
+        net.connect(branchId, 0, addId, 1);
+
+        std::vector<String> inputNames;
+        inputNames.push_back("template");
+        inputNames.push_back("search");
+        net.setInputsNames(inputNames);
+        net.setInputConstant("template");
+        net.setPreferableBackend(DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(DNN_TARGET_CPU);
+
+        Mat templ(4, shape, CV_32F), search(4, shape, CV_32F);
+        randu(templ, -1, 1);
+        net.setInput(templ, "template");
+        for (int i = 0; i < 3; i++)
+        {
+            randu(search, -1, 1);
+            net.setInput(search, "search");
+            Mat out = net.forward();
+
+            const Mat& convInput = constantConv ? templ : search;
+            const Mat& branchInput = constantConv ? search : templ;
+            Mat ref = weights.reshape(1, C) * convInput.reshape(1, C) + branchInput.reshape(1, C);
+            normAssert(out.reshape(1, C), ref, format("constantConv=%d, frame %d", constantConv, i).c_str());
+        }
+    }
+
+    LayerFactory::unregisterLayer("CountingCopy");
+}
+
+// The weights packed for the previous call are reused only while the weights are computed by the kept constant layers
+TEST(Net, convolution_weights_input)
+{
+    CV_DNN_REGISTER_LAYER_CLASS(CountingCopy, CountingCopyLayer);
+
+    const int C = 3, K = 4, H = 5, W = 6;
+
+    for (int constantWeights = 0; constantWeights < 2; constantWeights++)
+    {
+        Net net;
+        int branchId = 0;
+        if (constantWeights)
+        {
+            LayerParams branch;
+            branch.name = "weights_branch";
+            branch.type = "CountingCopy";
+            branchId = net.addLayer(branch.name, branch.type, branch);
+            net.connect(0, 1, branchId, 0);
+        }
+
+        LayerParams lp;
+        lp.name = "conv";
+        lp.type = "Convolution";
+        lp.set("kernel_size", 1);
+        lp.set("num_output", K);
+        lp.set("bias_term", false);
+        int convId = net.addLayer(lp.name, lp.type, lp);
+        net.connect(0, 0, convId, 0);
+        net.connect(branchId, constantWeights ? 0 : 1, convId, 1);
+
+        std::vector<String> inputNames;
+        inputNames.push_back("data");
+        inputNames.push_back("weights");
+        net.setInputsNames(inputNames);
+        if (constantWeights)
+            net.setInputConstant("weights");
+        net.setPreferableBackend(DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(DNN_TARGET_CPU);
+
+        int dataShape[] = {1, C, H, W};
+        int weightsShape[] = {K, C, 1, 1};
+        Mat data(4, dataShape, CV_32F), weights(4, weightsShape, CV_32F);
+        CountingCopyLayer::counter = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            randu(data, -1, 1);
+            net.setInput(data, "data");
+            // the constant weights are set only when they change
+            if (i != 1 || !constantWeights)
+            {
+                if (i != 1)
+                    randu(weights, -1, 1);
+                net.setInput(weights, "weights");
+            }
+            Mat out = net.forward();
+
+            Mat ref = weights.reshape(1, K) * data.reshape(1, C);
+            normAssert(out.reshape(1, K), ref, format("constantWeights=%d, call %d", constantWeights, i).c_str());
+        }
+        if (constantWeights)
+            EXPECT_EQ(3, CountingCopyLayer::counter);
+    }
+
+    LayerFactory::unregisterLayer("CountingCopy");
+}
+
 typedef testing::TestWithParam<tuple<float, Vec3f, int, tuple<Backend, Target> > > setInput;
 TEST_P(setInput, normalization)
 {
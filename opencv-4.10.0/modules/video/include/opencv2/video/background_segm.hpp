@@ -196,6 +196,22 @@ public:
     */
     CV_WRAP virtual void setShadowThreshold(double threshold) = 0;
 
+    /** @brief Returns true if the background model is kept in the compact format
+    */
+    CV_WRAP virtual bool getCompactModel() const;
+    /** @brief Selects the compact format of the background model
+
+    The compact model keeps the weights, the variances and the means of the gaussian components in
+    16-bit fixed point, each parameter of each component in a separate plane. It takes about half of
+    the memory of the default floating-point model and is updated with vector instructions. The
+    variances and the means are limited to \f$[0,255]\f$, and small changes of the model are lost
+    to the rounding, so the segmentation is slightly different from the one of the default model.
+    Only 8-bit frames and positive varInit and varMax are supported.
+    Changing the format reinitializes the model. The OpenCL implementation always uses the default
+    model.
+     */
+    CV_WRAP virtual void setCompactModel(bool compact);
+
     /** @brief Computes a foreground mask.
 
     @param image Next video frame. Floating point frame will be used without scaling and should be in range \f$[0,255]\f$.
@@ -206,6 +222,39 @@ public:
     is completely reinitialized from the last frame.
      */
     CV_WRAP virtual void apply(InputArray image, OutputArray fgmask, double learningRate=-1) CV_OVERRIDE = 0;
+    /** @brief Computes a foreground mask for a part of the frame.
+
+    Only the pixels where updateMask is non-zero are classified and update the background model. The
+    model of the other pixels is kept as is, and they are marked as background in fgmask. This is
+    useful when only some areas of the frame, e.g. the ones around the tracked objects, need to be
+    segmented.
+
+    @param image Next video frame.
+    @param updateMask 8-bit single-channel mask of the frame size selecting the pixels to process.
+    @param fgmask The output foreground mask as an 8-bit binary image.
+    @param learningRate The learning rate, see apply.
+     */
+    CV_WRAP virtual void applyMasked(InputArray image, InputArray updateMask, OutputArray fgmask, double learningRate=-1);
+    /** @brief Computes a foreground mask inside the given rectangles.
+
+    The same as applyMasked, with the update mask made of the rectangles (clipped to the frame).
+     */
+    CV_WRAP virtual void applyRegions(InputArray image, const std::vector<Rect>& rois, OutputArray fgmask, double learningRate=-1);
+
+    /** @brief Returns the grid step of the coarse-to-fine mode
+
+    1 (the default value) means that the mode is disabled.
+     */
+    CV_WRAP virtual int getCoarseStep() const;
+    /** @brief Sets the grid step of the coarse-to-fine mode
+
+    With step > 1, apply() first processes one pixel in each step x step cell of the frame. The
+    cells where this grid detects foreground, together with their neighbour cells, are then processed
+    at the full resolution, while the other pixels are reported as background. The grid is shifted
+    every frame, so the model of the static background is still updated, once in step*step frames.
+    The first frame after the model (re)initialization is processed completely.
+     */
+    CV_WRAP virtual void setCoarseStep(int step);
 };
 
 /** @brief Creates MOG2 Background Subtractor
@@ -296,6 +345,39 @@ public:
     /** @brief Sets the shadow threshold
      */
     CV_WRAP virtual void setShadowThreshold(double threshold) = 0;
+    /** @brief Computes a foreground mask for a part of the frame.
+
+    Only the pixels where updateMask is non-zero are classified and update the background model. The
+    model of the other pixels is kept as is, and they are marked as background in fgmask. This is
+    useful when only some areas of the frame, e.g. the ones around the tracked objects, need to be
+    segmented.
+
+    @param image Next video frame.
+    @param updateMask 8-bit single-channel mask of the frame size selecting the pixels to process.
+    @param fgmask The output foreground mask as an 8-bit binary image.
+    @param learningRate The learning rate, see apply.
+     */
+    CV_WRAP virtual void applyMasked(InputArray image, InputArray updateMask, OutputArray fgmask, double learningRate=-1);
+    /** @brief Computes a foreground mask inside the given rectangles.
+
+    The same as applyMasked, with the update mask made of the rectangles (clipped to the frame).
+     */
+    CV_WRAP virtual void applyRegions(InputArray image, const std::vector<Rect>& rois, OutputArray fgmask, double learningRate=-1);
+
+    /** @brief Returns the grid step of the coarse-to-fine mode
+
+    1 (the default value) means that the mode is disabled.
+     */
+    CV_WRAP virtual int getCoarseStep() const;
+    /** @brief Sets the grid step of the coarse-to-fine mode
+
+    With step > 1, apply() first processes one pixel in each step x step cell of the frame. The
+    cells where this grid detects foreground, together with their neighbour cells, are then processed
+    at the full resolution, while the other pixels are reported as background. The grid is shifted
+    every frame, so the model of the static background is still updated, once in step*step frames.
+    The first frame after the model (re)initialization is processed completely.
+     */
+    CV_WRAP virtual void setCoarseStep(int step);
 };
 
 /** @brief Creates KNN Background Subtractor
@@ -409,6 +409,80 @@ public:
     Mat temp5;
 };
 
+/** @brief Kalman filters of many tracks sharing one model.
+
+The class runs the same computations as KalmanFilter for a number of tracks that share the
+transition, control, measurement and noise matrices, as the tracks of a multi-object tracker
+usually do. The per-track data is stored in structure-of-arrays form: the column n of statePre,
+statePost, errorCovPre, errorCovPost and gain belongs to the track n, and a row holds one element
+for all of the tracks, so predict() and correct() process the tracks in SIMD lanes instead of
+calling gemm for every small matrix. The element (i, j) of a covariance matrix of size DPxDP is
+stored in the row i*DP + j, the element (i, j) of the gain (DPxMP) in the row i*MP + j.
+
+Only CV_32F matrices are supported. The measurement noise covariance must be positive definite,
+the innovation covariance is inverted with the Cholesky decomposition.
+ */
+class CV_EXPORTS_W BatchKalmanFilter
+{
+public:
+    CV_WRAP BatchKalmanFilter();
+    /** @overload
+    @param count Number of the tracks.
+    @param dynamParams Dimensionality of the state.
+    @param measureParams Dimensionality of the measurement.
+    @param controlParams Dimensionality of the control vector.
+    */
+    CV_WRAP BatchKalmanFilter( int count, int dynamParams, int measureParams, int controlParams = 0 );
+
+    /** @brief Re-initializes the filters. The previous content is destroyed.
+
+    The states and the error covariances of all of the tracks are set to zero, the model matrices
+    are initialized as in KalmanFilter::init.
+     */
+    void init( int count, int dynamParams, int measureParams, int controlParams = 0 );
+
+    /** @brief Sets the state and the error covariance of a track, e.g. when a new object is found.
+
+    @param track Index of the track.
+    @param state State vector, DPx1.
+    @param errorCov Error covariance, DPxDP. When empty, the covariance of the track is not changed.
+     */
+    CV_WRAP void setTrack( int track, InputArray state, InputArray errorCov = noArray() );
+
+    /** @brief Returns the corrected state and error covariance of a track.
+     */
+    CV_WRAP void getTrack( int track, OutputArray state, OutputArray errorCov = noArray() ) const;
+
+    /** @brief Computes the predicted states.
+
+    @param control The optional control vectors, CPxN, one column per track.
+    @param mask The optional 8-bit mask of N elements, the tracks with zero mask are left unchanged.
+     */
+    CV_WRAP void predict( InputArray control = noArray(), InputArray mask = noArray() );
+
+    /** @brief Updates the predicted states from the measurements.
+
+    @param measurement The measurements, MPxN, one column per track.
+    @param mask The optional 8-bit mask of N elements. The tracks with zero mask had no measurement
+    (missed detection) and are left unchanged, their corrected state remains the predicted one.
+     */
+    CV_WRAP void correct( InputArray measurement, InputArray mask = noArray() );
+
+    /** @brief Returns the number of the tracks */
+    CV_WRAP int getCount() const { return statePost.cols; }
+
+    CV_PROP_RW Mat statePre;           //!< predicted states, DPxN
+    CV_PROP_RW Mat statePost;          //!< corrected states, DPxN
+    CV_PROP_RW Mat transitionMatrix;   //!< state transition matrix (A), shared by the tracks
+    CV_PROP_RW Mat controlMatrix;      //!< control matrix (B), shared by the tracks (not used if there is no control)
+    CV_PROP_RW Mat measurementMatrix;  //!< measurement matrix (H), shared by the tracks
+    CV_PROP_RW Mat processNoiseCov;    //!< process noise covariance matrix (Q), shared by the tracks
+    CV_PROP_RW Mat measurementNoiseCov;//!< measurement noise covariance matrix (R), shared by the tracks
+    CV_PROP_RW Mat errorCovPre;        //!< priori error estimate covariance matrices, (DP*DP)xN
+    CV_PROP_RW Mat gain;               //!< Kalman gain matrices, (DP*MP)xN
+    CV_PROP_RW Mat errorCovPost;       //!< posteriori error estimate covariance matrices, (DP*DP)xN
+};
+
 
 /** @brief Read a .flo file
 
@@ -683,6 +757,50 @@ public:
     CV_WRAP static Ptr<DISOpticalFlow> create(int preset = DISOpticalFlow::PRESET_FAST);
 };
 
+/** @brief Optical flow pyramids of the recent frames, shared by several sparse optical flow users.
+
+Every frame is added once, with an identifier chosen by the caller (a frame index or a timestamp), and
+its pyramid is built right away together with the Scharr derivatives of every level, as
+buildOpticalFlowPyramid does. SparsePyrLKOpticalFlow::calcWithCache then takes the stored pyramids of
+the two frames instead of building them in every call. Only the last `capacity` frames are kept.
+
+The users must have a window not larger than the window of the cache, and at most maxLevel pyramid
+levels are available to them. The methods may be called from several threads.
+
+@sa SparsePyrLKOpticalFlow::calcWithCache
+*/
+class CV_EXPORTS_W FramePyramidCache
+{
+public:
+    virtual ~FramePyramidCache();
+
+    /** @brief Builds and stores the pyramid of a frame
+    @param frameId Identifier of the frame. If a frame with the same identifier is stored, it is replaced.
+    @param image 8-bit input image. The image is copied, so its buffer may be reused afterwards.
+    */
+    CV_WRAP virtual void addFrame(int64 frameId, InputArray image) = 0;
+
+    /** @brief Returns the pyramid of a stored frame
+    @param frameId Identifier of the frame
+    @param pyramid The pyramid in the format of buildOpticalFlowPyramid with the derivatives
+    @return false if the frame is not stored (it was not added or it was dropped)
+    */
+    CV_WRAP virtual bool getPyramid(int64 frameId, CV_OUT std::vector<Mat>& pyramid) const = 0;
+
+    /** @brief Drops all of the stored frames */
+    CV_WRAP virtual void clear() = 0;
+
+    CV_WRAP virtual Size getWinSize() const = 0;
+    CV_WRAP virtual int getMaxLevel() const = 0;
+
+    /** @brief Creates the cache
+    @param winSize The largest window size of the users, it defines the padding of the pyramid levels
+    @param maxLevel 0-based maximal pyramid level number
+    @param capacity The number of the most recent frames that are kept
+    */
+    CV_WRAP static Ptr<FramePyramidCache> create(Size winSize = Size(21, 21), int maxLevel = 3, int capacity = 2);
+};
+
 /** @brief Class used for calculating a sparse optical flow.
 
 The class can calculate an optical flow for a sparse feature set using the
@@ -709,6 +827,22 @@ public:
     CV_WRAP virtual double getMinEigThreshold() const = 0;
     CV_WRAP virtual void setMinEigThreshold(double minEigThreshold) = 0;
 
+    /** @brief Calculates a sparse optical flow between two frames stored in a FramePyramidCache.
+
+    The pyramids and the derivatives of the frames are taken from the cache, so the users of the same
+    cache build them once per frame. The result is the same as the one of calc() with these pyramids.
+    @param cache The cache holding both frames, its window must not be smaller than getWinSize()
+    @param prevFrameId Identifier of the first frame
+    @param nextFrameId Identifier of the second frame
+    @param prevPts Vector of 2D points for which the flow needs to be found.
+    @param nextPts Output vector of 2D points containing the calculated new positions of input features in the second image.
+    @param status Output status vector, see calc()
+    @param err Optional output vector that contains error response for each point.
+    */
+    CV_WRAP void calcWithCache(const Ptr<FramePyramidCache>& cache, int64 prevFrameId, int64 nextFrameId,
+                               InputArray prevPts, InputOutputArray nextPts,
+                               OutputArray status, OutputArray err = cv::noArray());
+
     CV_WRAP static Ptr<SparsePyrLKOpticalFlow> create(
             Size winSize = Size(21, 21),
             int maxLevel = 3, TermCriteria crit =
@@ -895,6 +1029,19 @@ public:
     */
     CV_WRAP virtual float getTrackingScore() = 0;
 
+    /** @brief Updates several trackers on the same frame
+
+    The search regions of all of the targets are passed through the backbone as one batch, and the
+    neckhead then runs per target with its template features. The trackers must be initialized and
+    created with the same backbone, backend and target, otherwise they are updated one by one. If the
+    backbone model does not accept a batch of several crops, the search regions are passed through it
+    one by one.
+    @param image The current frame
+    @param trackers Initialized trackers
+    @param boundingBoxes The new locations of the targets, one per tracker
+    */
+    static void updateBatch(InputArray image, const std::vector<Ptr<TrackerNano> >& trackers, CV_OUT std::vector<Rect>& boundingBoxes);
+
     //void init(InputArray image, const Rect& boundingBox) CV_OVERRIDE;
     //bool update(InputArray image, CV_OUT Rect& boundingBox) CV_OVERRIDE;
 };
@@ -932,6 +1079,19 @@ public:
     */
     CV_WRAP virtual float getTrackingScore() = 0;
 
+    /** @brief Updates several trackers on the same frame
+
+    The template and search inputs of all of the targets are stacked and the network runs once.
+    The stacked templates are kept while the same trackers are passed in the same order. The trackers
+    must be initialized and created with the same network, backend and target, otherwise they are
+    updated one by one. If the model does not accept a batch of several targets, the trackers are
+    updated one by one as well.
+    @param image The current frame
+    @param trackers Initialized trackers
+    @param boundingBoxes The new locations of the targets, one per tracker
+    */
+    static void updateBatch(InputArray image, const std::vector<Ptr<TrackerVit> >& trackers, CV_OUT std::vector<Rect>& boundingBoxes);
+
     // void init(InputArray image, const Rect& boundingBox) CV_OVERRIDE;
     // bool update(InputArray image, CV_OUT Rect& boundingBox) CV_OVERRIDE;
 };
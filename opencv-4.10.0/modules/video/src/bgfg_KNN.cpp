@@ -43,6 +43,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_video.hpp"
+#include "bgfg_region.hpp"
 
 namespace cv
 {
@@ -90,6 +91,7 @@ public:
     nShadowDetection =  defaultnShadowDetection2;
     fTau = defaultfTau;// Tau - shadow threshold
     name_ = "BackgroundSubtractor.KNN";
+    coarseStep = 1;
     nLongCounter = 0;
     nMidCounter = 0;
     nShortCounter = 0;
@@ -120,6 +122,7 @@ public:
     nShadowDetection =  defaultnShadowDetection2;
     fTau = defaultfTau;
     name_ = "BackgroundSubtractor.KNN";
+    coarseStep = 1;
     nLongCounter = 0;
     nMidCounter = 0;
     nShortCounter = 0;
@@ -131,6 +134,8 @@ public:
     ~BackgroundSubtractorKNNImpl() CV_OVERRIDE {}
     //! the update operator
     void apply(InputArray image, OutputArray fgmask, double learningRate) CV_OVERRIDE;
+    //! the update operator processing only the pixels selected by the mask
+    void applyMasked(InputArray image, InputArray updateMask, OutputArray fgmask, double learningRate) CV_OVERRIDE;
 
     //! computes a background image which are the mean of all background gaussians
     virtual void getBackgroundImage(OutputArray backgroundImage) const CV_OVERRIDE;
@@ -249,6 +254,13 @@ public:
     virtual double getShadowThreshold() const CV_OVERRIDE { return fTau; }
     virtual void setShadowThreshold(double value) CV_OVERRIDE { fTau = (float)value; }
 
+    virtual int getCoarseStep() const CV_OVERRIDE { return coarseStep; }
+    virtual void setCoarseStep(int step) CV_OVERRIDE
+    {
+        CV_Assert(step >= 1);
+        coarseStep = step;
+    }
+
     virtual void write(FileStorage& fs) const CV_OVERRIDE
     {
         writeFormat(fs);
@@ -259,7 +271,8 @@ public:
         << "dist2Threshold" << fTb
         << "detectShadows" << (int)bShadowDetection
         << "shadowValue" << (int)nShadowDetection
-        << "shadowThreshold" << fTau;
+        << "shadowThreshold" << fTau
+        << "coarseStep" << coarseStep;
     }
 
     virtual void read(const FileNode& fn) CV_OVERRIDE
@@ -272,6 +285,7 @@ public:
         bShadowDetection = (int)fn["detectShadows"] != 0;
         nShadowDetection = saturate_cast<uchar>((int)fn["shadowValue"]);
         fTau = (float)fn["shadowThreshold"];
+        coarseStep = fn["coarseStep"].empty() ? 1 : std::max((int)fn["coarseStep"], 1);
     }
 
 protected:
@@ -317,6 +331,9 @@ protected:
     Mat nNextMidUpdate;
     Mat nNextLongUpdate;
 
+    int coarseStep; //!< grid step of the coarse-to-fine mode, 1 if disabled
+    Mat coarseMask;
+
 #ifdef HAVE_OPENCL
     mutable bool opencl_ON;
 
@@ -335,6 +352,9 @@ protected:
 
     String name_;
 
+    void update(InputArray image, const Mat& updateMask, OutputArray fgmask, double learningRate);
+    void updatePixels(const Mat& image, Mat& fgmask, const Mat* updateMask);
+
 #ifdef HAVE_OPENCL
     bool ocl_getBackgroundImage(OutputArray backgroundImage) const;
     bool ocl_apply(InputArray _image, OutputArray _fgmask, double learningRate=-1);
@@ -526,10 +546,12 @@ public:
                int _nkNN,
                float _fTau,
                bool _bShadowDetection,
-               uchar _nShadowDetection)
+               uchar _nShadowDetection,
+               const Mat* _updateMask = 0)
     {
         src = &_src;
         dst = &_dst;
+        updateMask = _updateMask;
         m_aModel0 = _bgmodel;
         m_nNextLongUpdate0 = _nNextLongUpdate;
         m_nNextMidUpdate0 = _nNextMidUpdate;
@@ -556,6 +578,10 @@ public:
 
         for ( int y = y0; y < y1; y++ )
         {
+            const uchar* process = updateMask ? updateMask->ptr(y) : 0;
+            if ( process && !detail::bgfgRowHasNonZero(process, ncols) )
+                continue;
+
             const uchar* data = src->ptr(y);
             uchar* m_aModel = m_aModel0 + ncols*m_nN*3*ndata*y;
             uchar* m_nNextLongUpdate = m_nNextLongUpdate0 + ncols*y;
@@ -566,8 +592,10 @@ public:
             uchar* m_aModelIndexShort = m_aModelIndexShort0 + ncols*y;
             uchar* mask = dst->ptr(y);
 
-            for ( int x = 0; x < ncols; x++ )
+            for ( int x = 0; x < ncols; x++, data += nchannels, m_aModel += m_nN*3*ndata )
             {
+                if ( process && !process[x] )
+                    continue;
 
                 //update model+ background subtract
                 uchar include=0;
@@ -602,14 +630,13 @@ public:
                         mask[x] = m_nShadowDetection;
                         break;
                 }
-                data += nchannels;
-                m_aModel += m_nN*3*ndata;
             }
         }
     }
 
     const Mat* src;
     Mat* dst;
+    const Mat* updateMask;
     uchar* m_aModel0;
     uchar* m_nNextLongUpdate0;
     uchar* m_nNextMidUpdate0;
@@ -728,18 +755,57 @@ void BackgroundSubtractorKNNImpl::create_ocl_apply_kernel()
 
 #endif
 
+void BackgroundSubtractorKNN::applyMasked(InputArray, InputArray, OutputArray, double)
+{
+    CV_Error(Error::StsNotImplemented, "Masked update is not supported by this implementation");
+}
+
+void BackgroundSubtractorKNN::applyRegions(InputArray image, const std::vector<Rect>& rois, OutputArray fgmask, double learningRate)
+{
+    Mat updateMask;
+    detail::bgfgRegionsToMask(image.size(), rois, updateMask);
+    applyMasked(image, updateMask, fgmask, learningRate);
+}
+
+int BackgroundSubtractorKNN::getCoarseStep() const
+{
+    return 1;
+}
+
+void BackgroundSubtractorKNN::setCoarseStep(int step)
+{
+    if (step != 1)
+        CV_Error(Error::StsNotImplemented, "Coarse-to-fine mode is not supported by this implementation");
+}
+
 void BackgroundSubtractorKNNImpl::apply(InputArray _image, OutputArray _fgmask, double learningRate)
 {
     CV_INSTRUMENT_REGION();
 
+    update(_image, Mat(), _fgmask, learningRate);
+}
+
+void BackgroundSubtractorKNNImpl::applyMasked(InputArray _image, InputArray _updateMask, OutputArray _fgmask, double learningRate)
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat updateMask = _updateMask.getMat();
+    CV_Assert(updateMask.type() == CV_8UC1 && updateMask.size() == _image.size());
+    update(_image, updateMask, _fgmask, learningRate);
+}
+
+void BackgroundSubtractorKNNImpl::update(InputArray _image, const Mat& updateMask, OutputArray _fgmask, double learningRate)
+{
 #ifdef HAVE_OPENCL
     if (opencl_ON)
     {
+        // the OpenCL kernel always processes the whole frame
+        bool fullFrame = updateMask.empty() && coarseStep == 1;
 #ifndef __APPLE__
-        CV_OCL_RUN(_fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel() || _image.channels() == 1),
+        CV_OCL_RUN(fullFrame && _fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel() || _image.channels() == 1),
                    ocl_apply(_image, _fgmask, learningRate))
 #else
-        CV_OCL_RUN(_fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel()),
+        CV_OCL_RUN(fullFrame && _fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel()),
                    ocl_apply(_image, _fgmask, learningRate))
 #endif
 
@@ -774,25 +840,26 @@ void BackgroundSubtractorKNNImpl::apply(InputArray _image, OutputArray _fgmask,
     int nMidUpdate = (Kmid/nN)+1;
     int nLongUpdate = (Klong/nN)+1;
 
-    parallel_for_(Range(0, image.rows),
-                  KNNInvoker(image, fgmask,
-                             bgmodel.ptr(),
-                             nNextLongUpdate.ptr(),
-                             nNextMidUpdate.ptr(),
-                             nNextShortUpdate.ptr(),
-                             aModelIndexLong.ptr(),
-                             aModelIndexMid.ptr(),
-                             aModelIndexShort.ptr(),
-                             nLongCounter,
-                             nMidCounter,
-                             nShortCounter,
-                             nN,
-                             fTb,
-                             nkNN,
-                             fTau,
-                             bShadowDetection,
-                             nShadowDetection),
-                             image.total()/(double)(1 << 16));
+    if( coarseStep > 1 && nframes > 1 )
+    {
+        fgmask = Scalar::all(0);
+        detail::bgfgCoarseGridMask(image.size(), coarseStep, nframes, coarseMask);
+        if( !updateMask.empty() )
+            bitwise_and(coarseMask, updateMask, coarseMask);
+        updatePixels(image, fgmask, &coarseMask);
+
+        detail::bgfgCoarseRefineMask(fgmask, coarseStep, nframes, coarseMask);
+        if( !updateMask.empty() )
+            bitwise_and(coarseMask, updateMask, coarseMask);
+        updatePixels(image, fgmask, &coarseMask);
+    }
+    else if( !updateMask.empty() )
+    {
+        fgmask = Scalar::all(0);
+        updatePixels(image, fgmask, &updateMask);
+    }
+    else
+        updatePixels(image, fgmask, 0);
 
     nShortCounter++;//0,1,...,nShortUpdate-1
     nMidCounter++;
@@ -814,6 +881,30 @@ void BackgroundSubtractorKNNImpl::apply(InputArray _image, OutputArray _fgmask,
     }
 }
 
+void BackgroundSubtractorKNNImpl::updatePixels(const Mat& image, Mat& fgmask, const Mat* updateMask)
+{
+    parallel_for_(Range(0, image.rows),
+                  KNNInvoker(image, fgmask,
+                             bgmodel.ptr(),
+                             nNextLongUpdate.ptr(),
+                             nNextMidUpdate.ptr(),
+                             nNextShortUpdate.ptr(),
+                             aModelIndexLong.ptr(),
+                             aModelIndexMid.ptr(),
+                             aModelIndexShort.ptr(),
+                             nLongCounter,
+                             nMidCounter,
+                             nShortCounter,
+                             nN,
+                             fTb,
+                             nkNN,
+                             fTau,
+                             bShadowDetection,
+                             nShadowDetection,
+                             updateMask),
+                             image.total()/(double)(1 << 16));
+}
+
 void BackgroundSubtractorKNNImpl::getBackgroundImage(OutputArray backgroundImage) const
 {
     CV_INSTRUMENT_REGION();
@@ -84,6 +84,8 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_video.hpp"
+#include "bgfg_region.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -142,6 +144,8 @@ public:
         fCT = defaultfCT2;
         nShadowDetection =  defaultnShadowDetection2;
         fTau = defaultfTau;
+        coarseStep = 1;
+        compactModel = false;
 #ifdef HAVE_OPENCL
         opencl_ON = true;
 #endif
@@ -168,6 +172,8 @@ public:
         fCT = defaultfCT2;
         nShadowDetection =  defaultnShadowDetection2;
         fTau = defaultfTau;
+        coarseStep = 1;
+        compactModel = false;
         name_ = "BackgroundSubtractor.MOG2";
 #ifdef HAVE_OPENCL
         opencl_ON = true;
@@ -177,6 +183,8 @@ public:
     ~BackgroundSubtractorMOG2Impl() CV_OVERRIDE {}
     //! the update operator
     void apply(InputArray image, OutputArray fgmask, double learningRate) CV_OVERRIDE;
+    //! the update operator processing only the pixels selected by the mask
+    void applyMasked(InputArray image, InputArray updateMask, OutputArray fgmask, double learningRate) CV_OVERRIDE;
 
     //! computes a background image which are the mean of all background gaussians
     virtual void getBackgroundImage(OutputArray backgroundImage) const CV_OVERRIDE;
@@ -191,9 +199,11 @@ public:
         int nchannels = CV_MAT_CN(frameType);
         CV_Assert( nchannels <= CV_CN_MAX );
         CV_Assert( nmixtures <= 255);
+        // the means of the compact model are limited to [0,255]
+        CV_Assert( !compactModel || CV_MAT_DEPTH(frameType) == CV_8U );
 
 #ifdef HAVE_OPENCL
-        if (ocl::isOpenCLActivated() && opencl_ON)
+        if (ocl::isOpenCLActivated() && opencl_ON && !compactModel)
         {
             create_ocl_apply_kernel();
 
@@ -225,11 +235,22 @@ public:
         else
 #endif
         {
-            // for each gaussian mixture of each pixel bg model we store ...
-            // the mixture weight (w),
-            // the mean (nchannels values) and
-            // the covariance
-            bgmodel.create( 1, frameSize.height*frameSize.width*nmixtures*(2 + nchannels), CV_32F );
+            if (compactModel)
+            {
+                // the weights, the variances and the means of all the modes in separate planes,
+                // i.e. the plane of the c-th mean channel of the k-th mode is 2*nmixtures + k*nchannels + c
+                compactBgmodel.create( frameSize.height*nmixtures*(2 + nchannels), frameSize.width, CV_16U );
+                bgmodel.release();
+            }
+            else
+            {
+                // for each gaussian mixture of each pixel bg model we store ...
+                // the mixture weight (w),
+                // the mean (nchannels values) and
+                // the covariance
+                bgmodel.create( 1, frameSize.height*frameSize.width*nmixtures*(2 + nchannels), CV_32F );
+                compactBgmodel.release();
+            }
             //make the array for keeping track of the used modes per pixel - all zeros at start
             bgmodelUsedModes.create(frameSize,CV_8U);
             bgmodelUsedModes = Scalar::all(0);
@@ -286,6 +307,22 @@ public:
     virtual double getShadowThreshold() const CV_OVERRIDE { return fTau; }
     virtual void setShadowThreshold(double value) CV_OVERRIDE { fTau = (float)value; }
 
+    virtual bool getCompactModel() const CV_OVERRIDE { return compactModel; }
+    virtual void setCompactModel(bool compact) CV_OVERRIDE
+    {
+        if (compactModel == compact)
+            return;
+        compactModel = compact;
+        nframes = 0; // the model is reinitialized in the new format by the next frame
+    }
+
+    virtual int getCoarseStep() const CV_OVERRIDE { return coarseStep; }
+    virtual void setCoarseStep(int step) CV_OVERRIDE
+    {
+        CV_Assert(step >= 1);
+        coarseStep = step;
+    }
+
     virtual void write(FileStorage& fs) const CV_OVERRIDE
     {
         writeFormat(fs);
@@ -301,7 +338,9 @@ public:
         << "complexityReductionThreshold" << fCT
         << "detectShadows" << (int)bShadowDetection
         << "shadowValue" << (int)nShadowDetection
-        << "shadowThreshold" << fTau;
+        << "shadowThreshold" << fTau
+        << "coarseStep" << coarseStep
+        << "compactModel" << (int)compactModel;
     }
 
     virtual void read(const FileNode& fn) CV_OVERRIDE
@@ -319,6 +358,8 @@ public:
         bShadowDetection = (int)fn["detectShadows"] != 0;
         nShadowDetection = saturate_cast<uchar>((int)fn["shadowValue"]);
         fTau = (float)fn["shadowThreshold"];
+        coarseStep = fn["coarseStep"].empty() ? 1 : std::max((int)fn["coarseStep"], 1);
+        setCompactModel(!fn["compactModel"].empty() && (int)fn["compactModel"] != 0);
     }
 
 protected:
@@ -327,6 +368,12 @@ protected:
     Mat bgmodel;
     Mat bgmodelUsedModes;//keep track of number of modes per pixel
 
+    int coarseStep; //!< grid step of the coarse-to-fine mode, 1 if disabled
+    Mat coarseMask;
+
+    bool compactModel; //!< the model is kept in 16-bit planes (compactBgmodel) instead of bgmodel
+    Mat compactBgmodel;
+
 #ifdef HAVE_OPENCL
     //for OCL
 
@@ -395,6 +442,9 @@ protected:
     template <typename T, int CN>
     void getBackgroundImage_intern(OutputArray backgroundImage) const;
 
+    void update(InputArray image, const Mat& updateMask, OutputArray fgmask, double learningRate);
+    void updatePixels(const Mat& image, Mat& fgmask, double learningRate, const Mat* updateMask);
+
 #ifdef HAVE_OPENCL
     bool ocl_getBackgroundImage(OutputArray backgroundImage) const;
     bool ocl_apply(InputArray _image, OutputArray _fgmask, double learningRate=-1);
@@ -536,23 +586,15 @@ detectShadowGMM(const float* data, int nchannels, int nmodes,
 //IEEE Trans. on Pattern Analysis and Machine Intelligence, vol.26, no.5, pages 651-656, 2004
 //http://www.zoranz.net/Publications/zivkovic2004PAMI.pdf
 
-class MOG2Invoker : public ParallelLoopBody
+//the parameters of the GMM update and the update of a single pixel model
+struct MOG2PixelUpdater
 {
-public:
-    MOG2Invoker(const Mat& _src, Mat& _dst,
-                GMM* _gmm, float* _mean,
-                uchar* _modesUsed,
-                int _nmixtures, float _alphaT,
-                float _Tb, float _TB, float _Tg,
-                float _varInit, float _varMin, float _varMax,
-                float _prune, float _tau, bool _detectShadows,
-                uchar _shadowVal)
+    MOG2PixelUpdater(int _nmixtures, float _alphaT,
+                     float _Tb, float _TB, float _Tg,
+                     float _varInit, float _varMin, float _varMax,
+                     float _prune, float _tau, bool _detectShadows,
+                     uchar _shadowVal)
     {
-        src = &_src;
-        dst = &_dst;
-        gmm0 = _gmm;
-        mean0 = _mean;
-        modesUsed0 = _modesUsed;
         nmixtures = _nmixtures;
         alphaT = _alphaT;
         Tb = _Tb;
@@ -567,16 +609,213 @@ public:
         shadowVal = _shadowVal;
     }
 
+    //updates the modes of the pixel and returns its value in the foreground mask
+    uchar operator()(const float* data, int nchannels, GMM* gmm, float* mean, uchar& modesUsed) const
+    {
+        float alpha1 = 1.f - alphaT;
+        float dData[CV_CN_MAX];
+
+        //calculate distances to the modes (+ sort)
+        //here we need to go in descending order!!!
+        bool background = false;//return value -> true - the pixel classified as background
+
+        //internal:
+        bool fitsPDF = false;//if it remains zero a new GMM mode will be added
+        int nmodes = modesUsed;//current number of modes in GMM
+        float totalWeight = 0.f;
+
+        float* mean_m = mean;
+
+        //////
+        //go through all modes
+        for( int mode = 0; mode < nmodes; mode++, mean_m += nchannels )
+        {
+            float weight = alpha1*gmm[mode].weight + prune;//need only weight if fit is found
+            int swap_count = 0;
+            ////
+            //fit not found yet
+            if( !fitsPDF )
+            {
+                //check if it belongs to some of the remaining modes
+                float var = gmm[mode].variance;
+
+                //calculate difference and distance
+                float dist2;
+
+                if( nchannels == 3 )
+                {
+                    dData[0] = mean_m[0] - data[0];
+                    dData[1] = mean_m[1] - data[1];
+                    dData[2] = mean_m[2] - data[2];
+                    dist2 = dData[0]*dData[0] + dData[1]*dData[1] + dData[2]*dData[2];
+                }
+                else
+                {
+                    dist2 = 0.f;
+                    for( int c = 0; c < nchannels; c++ )
+                    {
+                        dData[c] = mean_m[c] - data[c];
+                        dist2 += dData[c]*dData[c];
+                    }
+                }
+
+                //background? - Tb - usually larger than Tg
+                if( totalWeight < TB && dist2 < Tb*var )
+                    background = true;
+
+                //check fit
+                if( dist2 < Tg*var )
+                {
+                    /////
+                    //belongs to the mode
+                    fitsPDF = true;
+
+                    //update distribution
+
+                    //update weight
+                    weight += alphaT;
+                    float k = alphaT/weight;
+
+                    //update mean
+                    for( int c = 0; c < nchannels; c++ )
+                        mean_m[c] -= k*dData[c];
+
+                    //update variance
+                    float varnew = var + k*(dist2-var);
+                    //limit the variance
+                    varnew = MAX(varnew, varMin);
+                    varnew = MIN(varnew, varMax);
+                    gmm[mode].variance = varnew;
+
+                    //sort
+                    //all other weights are at the same place and
+                    //only the matched (iModes) is higher -> just find the new place for it
+                    for( int i = mode; i > 0; i-- )
+                    {
+                        //check one up
+                        if( weight < gmm[i-1].weight )
+                            break;
+
+                        swap_count++;
+                        //swap one up
+                        std::swap(gmm[i], gmm[i-1]);
+                        for( int c = 0; c < nchannels; c++ )
+                            std::swap(mean[i*nchannels + c], mean[(i-1)*nchannels + c]);
+                    }
+                    //belongs to the mode - bFitsPDF becomes 1
+                    /////
+                }
+            }//!bFitsPDF)
+
+            //check prune
+            if( weight < -prune )
+            {
+                weight = 0.0;
+                nmodes--;
+            }
+
+            gmm[mode-swap_count].weight = weight;//update weight by the calculated value
+            totalWeight += weight;
+        }
+        //go through all modes
+        //////
+
+        // Renormalize weights. In the special case that the pixel does
+        // not agree with any modes, set weights to zero (a new mode will be added below).
+        float invWeight = 0.f;
+        if (std::abs(totalWeight) > FLT_EPSILON) {
+            invWeight = 1.f/totalWeight;
+        }
+
+        for( int mode = 0; mode < nmodes; mode++ )
+        {
+            gmm[mode].weight *= invWeight;
+        }
+
+        //make new mode if needed and exit
+        if( !fitsPDF && alphaT > 0.f )
+        {
+            // replace the weakest or add a new one
+            int mode = nmodes == nmixtures ? nmixtures-1 : nmodes++;
+
+            if (nmodes==1)
+                gmm[mode].weight = 1.f;
+            else
+            {
+                gmm[mode].weight = alphaT;
+
+                // renormalize all other weights
+                for( int i = 0; i < nmodes-1; i++ )
+                    gmm[i].weight *= alpha1;
+            }
+
+            // init
+            for( int c = 0; c < nchannels; c++ )
+                mean[mode*nchannels + c] = data[c];
+
+            gmm[mode].variance = varInit;
+
+            //sort
+            //find the new place for it
+            for( int i = nmodes - 1; i > 0; i-- )
+            {
+                // check one up
+                if( alphaT < gmm[i-1].weight )
+                    break;
+
+                // swap one up
+                std::swap(gmm[i], gmm[i-1]);
+                for( int c = 0; c < nchannels; c++ )
+                    std::swap(mean[i*nchannels + c], mean[(i-1)*nchannels + c]);
+            }
+        }
+
+        //set the number of modes
+        modesUsed = uchar(nmodes);
+        return background ? 0 :
+            detectShadows && detectShadowGMM(data, nchannels, nmodes, gmm, mean, Tb, TB, tau) ?
+            shadowVal : 255;
+    }
+
+    int nmixtures;
+    float alphaT, Tb, TB, Tg;
+    float varInit, varMin, varMax, prune, tau;
+
+    bool detectShadows;
+    uchar shadowVal;
+};
+
+class MOG2Invoker : public ParallelLoopBody
+{
+public:
+    MOG2Invoker(const Mat& _src, Mat& _dst,
+                GMM* _gmm, float* _mean,
+                uchar* _modesUsed,
+                const MOG2PixelUpdater& _updater,
+                const Mat* _updateMask = 0)
+        : updater(_updater)
+    {
+        src = &_src;
+        dst = &_dst;
+        updateMask = _updateMask;
+        gmm0 = _gmm;
+        mean0 = _mean;
+        modesUsed0 = _modesUsed;
+    }
+
     void operator()(const Range& range) const CV_OVERRIDE
     {
         int y0 = range.start, y1 = range.end;
         int ncols = src->cols, nchannels = src->channels();
+        int nmixtures = updater.nmixtures;
         AutoBuffer<float> buf(src->cols*nchannels);
-        float alpha1 = 1.f - alphaT;
-        float dData[CV_CN_MAX];
 
         for( int y = y0; y < y1; y++ )
         {
+            const uchar* process = updateMask ? updateMask->ptr(y) : 0;
+            if( process && !detail::bgfgRowHasNonZero(process, ncols) )
+                continue;
+
             const float* data = buf.data();
             if( src->depth() != CV_32F )
                 src->row(y).convertTo(Mat(1, ncols, CV_32FC(nchannels), (void*)data), CV_32F);
@@ -590,182 +829,377 @@ public:
 
             for( int x = 0; x < ncols; x++, data += nchannels, gmm += nmixtures, mean += nmixtures*nchannels )
             {
-                //calculate distances to the modes (+ sort)
-                //here we need to go in descending order!!!
-                bool background = false;//return value -> true - the pixel classified as background
+                if( process && !process[x] )
+                    continue;
 
-                //internal:
-                bool fitsPDF = false;//if it remains zero a new GMM mode will be added
-                int nmodes = modesUsed[x];//current number of modes in GMM
-                float totalWeight = 0.f;
+                mask[x] = updater(data, nchannels, gmm, mean, modesUsed[x]);
+            }
+        }
+    }
 
-                float* mean_m = mean;
+    const Mat* src;
+    Mat* dst;
+    const Mat* updateMask;
+    GMM* gmm0;
+    float* mean0;
+    uchar* modesUsed0;
 
-                //////
-                //go through all modes
-                for( int mode = 0; mode < nmodes; mode++, mean_m += nchannels )
-                {
-                    float weight = alpha1*gmm[mode].weight + prune;//need only weight if fit is found
-                    int swap_count = 0;
-                    ////
-                    //fit not found yet
-                    if( !fitsPDF )
-                    {
-                        //check if it belongs to some of the remaining modes
-                        float var = gmm[mode].variance;
-
-                        //calculate difference and distance
-                        float dist2;
-
-                        if( nchannels == 3 )
-                        {
-                            dData[0] = mean_m[0] - data[0];
-                            dData[1] = mean_m[1] - data[1];
-                            dData[2] = mean_m[2] - data[2];
-                            dist2 = dData[0]*dData[0] + dData[1]*dData[1] + dData[2]*dData[2];
-                        }
-                        else
-                        {
-                            dist2 = 0.f;
-                            for( int c = 0; c < nchannels; c++ )
-                            {
-                                dData[c] = mean_m[c] - data[c];
-                                dist2 += dData[c]*dData[c];
-                            }
-                        }
-
-                        //background? - Tb - usually larger than Tg
-                        if( totalWeight < TB && dist2 < Tb*var )
-                            background = true;
-
-                        //check fit
-                        if( dist2 < Tg*var )
-                        {
-                            /////
-                            //belongs to the mode
-                            fitsPDF = true;
-
-                            //update distribution
-
-                            //update weight
-                            weight += alphaT;
-                            float k = alphaT/weight;
-
-                            //update mean
-                            for( int c = 0; c < nchannels; c++ )
-                                mean_m[c] -= k*dData[c];
-
-                            //update variance
-                            float varnew = var + k*(dist2-var);
-                            //limit the variance
-                            varnew = MAX(varnew, varMin);
-                            varnew = MIN(varnew, varMax);
-                            gmm[mode].variance = varnew;
-
-                            //sort
-                            //all other weights are at the same place and
-                            //only the matched (iModes) is higher -> just find the new place for it
-                            for( int i = mode; i > 0; i-- )
-                            {
-                                //check one up
-                                if( weight < gmm[i-1].weight )
-                                    break;
-
-                                swap_count++;
-                                //swap one up
-                                std::swap(gmm[i], gmm[i-1]);
-                                for( int c = 0; c < nchannels; c++ )
-                                    std::swap(mean[i*nchannels + c], mean[(i-1)*nchannels + c]);
-                            }
-                            //belongs to the mode - bFitsPDF becomes 1
-                            /////
-                        }
-                    }//!bFitsPDF)
-
-                    //check prune
-                    if( weight < -prune )
-                    {
-                        weight = 0.0;
-                        nmodes--;
-                    }
+    MOG2PixelUpdater updater;
+};
 
-                    gmm[mode-swap_count].weight = weight;//update weight by the calculated value
-                    totalWeight += weight;
-                }
-                //go through all modes
-                //////
-
-                // Renormalize weights. In the special case that the pixel does
-                // not agree with any modes, set weights to zero (a new mode will be added below).
-                float invWeight = 0.f;
-                if (std::abs(totalWeight) > FLT_EPSILON) {
-                    invWeight = 1.f/totalWeight;
-                }
+//the compact model keeps every parameter of the modes in its own 16-bit plane:
+//the weights in [0,1] scaled to 65535, the variances and the means with 8 fractional bits
+static const float compactWeightScale = 65535.f;
+static const float compactValueScale = 256.f;
+static const float compactMaxValue = 65535.f/compactValueScale;
+//the largest number of modes handled by the vectorized update, more modes use the per-pixel one
+static const int compactMaxVecModes = 8;
+
+static inline float decodeCompactWeight(ushort v) { return v*(1.f/compactWeightScale); }
+static inline float decodeCompactValue(ushort v) { return v*(1.f/compactValueScale); }
+static inline ushort encodeCompactWeight(float v) { return saturate_cast<ushort>(v*compactWeightScale); }
+static inline ushort encodeCompactValue(float v) { return saturate_cast<ushort>(v*compactValueScale); }
+
+class MOG2CompactInvoker : public ParallelLoopBody
+{
+public:
+    MOG2CompactInvoker(const Mat& _src, Mat& _dst,
+                       Mat& _model, uchar* _modesUsed,
+                       const MOG2PixelUpdater& _updater,
+                       const Mat* _updateMask = 0)
+        : updater(_updater)
+    {
+        src = &_src;
+        dst = &_dst;
+        model = &_model;
+        modesUsed0 = _modesUsed;
+        updateMask = _updateMask;
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        int y0 = range.start, y1 = range.end;
+        int nrows = src->rows, ncols = src->cols, nchannels = src->channels();
+        int nmixtures = updater.nmixtures;
+        int nplanes = nmixtures*(2 + nchannels);
+        AutoBuffer<float> buf(ncols*nchannels);
+        AutoBuffer<ushort*> planes(nplanes);
+        AutoBuffer<GMM> gmm(nmixtures);
+        AutoBuffer<float> mean(nmixtures*nchannels);
 
+        for( int y = y0; y < y1; y++ )
+        {
+            const uchar* process = updateMask ? updateMask->ptr(y) : 0;
+            if( process && !detail::bgfgRowHasNonZero(process, ncols) )
+                continue;
+
+            const float* data = buf.data();
+            if( src->depth() != CV_32F )
+                src->row(y).convertTo(Mat(1, ncols, CV_32FC(nchannels), (void*)data), CV_32F);
+            else
+                data = src->ptr<float>(y);
+
+            for( int p = 0; p < nplanes; p++ )
+                planes[p] = model->ptr<ushort>(p*nrows + y);
+            ushort** weights = planes.data();
+            ushort** variances = weights + nmixtures;
+            ushort** means = variances + nmixtures;
+            uchar* modesUsed = modesUsed0 + ncols*y;
+            uchar* mask = dst->ptr(y);
+
+            int x = 0;
+#if CV_SIMD
+            if( nmixtures <= compactMaxVecModes )
+            {
+                if( nchannels == 1 )
+                    x = updateRow<1>(data, weights, variances, means, modesUsed, mask, process, ncols);
+                else if( nchannels == 3 )
+                    x = updateRow<3>(data, weights, variances, means, modesUsed, mask, process, ncols);
+            }
+#endif
+            for( ; x < ncols; x++ )
+            {
+                if( process && !process[x] )
+                    continue;
+
+                const float* pixel = data + x*nchannels;
+                int nmodes = modesUsed[x];
                 for( int mode = 0; mode < nmodes; mode++ )
                 {
-                    gmm[mode].weight *= invWeight;
+                    gmm[mode].weight = decodeCompactWeight(weights[mode][x]);
+                    gmm[mode].variance = decodeCompactValue(variances[mode][x]);
+                    for( int c = 0; c < nchannels; c++ )
+                        mean[mode*nchannels + c] = decodeCompactValue(means[mode*nchannels + c][x]);
                 }
 
-                //make new mode if needed and exit
-                if( !fitsPDF && alphaT > 0.f )
+                mask[x] = updater(pixel, nchannels, gmm.data(), mean.data(), modesUsed[x]);
+
+                nmodes = modesUsed[x];
+                for( int mode = 0; mode < nmodes; mode++ )
                 {
-                    // replace the weakest or add a new one
-                    int mode = nmodes == nmixtures ? nmixtures-1 : nmodes++;
+                    weights[mode][x] = encodeCompactWeight(gmm[mode].weight);
+                    variances[mode][x] = encodeCompactValue(gmm[mode].variance);
+                    for( int c = 0; c < nchannels; c++ )
+                        means[mode*nchannels + c][x] = encodeCompactValue(mean[mode*nchannels + c]);
+                }
+            }
+        }
+    }
 
-                    if (nmodes==1)
-                        gmm[mode].weight = 1.f;
-                    else
-                    {
-                        gmm[mode].weight = alphaT;
+#if CV_SIMD
+    //the same update as MOG2PixelUpdater for a vector of pixels; the matched mode is sorted
+    //after the pass over the modes, which gives the same order as the per-pixel code
+    template<int CN>
+    int updateRow(const float* data, ushort** weights, ushort** variances, ushort** means,
+                  uchar* modesUsed, uchar* mask, const uchar* process, int ncols) const
+    {
+        const int VECSZ = VTraits<v_float32>::vlanes();
+        const int nmixtures = updater.nmixtures;
+        const float alphaT = updater.alphaT, alpha1 = 1.f - alphaT;
+
+        const v_float32 v_alphaT = vx_setall_f32(alphaT), v_alpha1 = vx_setall_f32(alpha1);
+        const v_float32 v_prune = vx_setall_f32(updater.prune), v_negPrune = vx_setall_f32(-updater.prune);
+        const v_float32 v_Tb = vx_setall_f32(updater.Tb), v_TB = vx_setall_f32(updater.TB), v_Tg = vx_setall_f32(updater.Tg);
+        const v_float32 v_varInit = vx_setall_f32(updater.varInit);
+        const v_float32 v_varMin = vx_setall_f32(updater.varMin), v_varMax = vx_setall_f32(updater.varMax);
+        const v_float32 v_tau = vx_setall_f32(updater.tau), v_eps = vx_setall_f32(FLT_EPSILON);
+        const v_float32 v_zero = vx_setzero_f32(), v_one = vx_setall_f32(1.f);
+        const v_float32 v_allOnes = v_reinterpret_as_f32(vx_setall_s32(-1));
+        const v_float32 v_weightScale = vx_setall_f32(compactWeightScale);
+        const v_float32 v_invWeightScale = vx_setall_f32(1.f/compactWeightScale);
+        const v_float32 v_valueScale = vx_setall_f32(compactValueScale);
+        const v_float32 v_invValueScale = vx_setall_f32(1.f/compactValueScale);
+        const v_int32 v_oneI = vx_setall_s32(1), v_nmixtures = vx_setall_s32(nmixtures);
+
+        v_float32 w[compactMaxVecModes], var[compactMaxVecModes], mu[compactMaxVecModes][CN];
+        int CV_DECL_ALIGNED(CV_SIMD_WIDTH) nmodesBuf[VTraits<v_int32>::max_nlanes];
+        int CV_DECL_ALIGNED(CV_SIMD_WIDTH) maskBuf[VTraits<v_int32>::max_nlanes];
+
+        int x = 0;
+        for( ; x <= ncols - VECSZ; x += VECSZ )
+        {
+            v_float32 proc = v_allOnes;
+            if( process )
+            {
+                proc = v_reinterpret_as_f32(v_ne(vx_load_expand_q(process + x), vx_setzero_u32()));
+                if( !v_check_any(proc) )
+                    continue;
+            }
 
-                        // renormalize all other weights
-                        for( int i = 0; i < nmodes-1; i++ )
-                            gmm[i].weight *= alpha1;
-                    }
+            v_float32 d[CN];
+            loadPixels(data + x*CN, d);
 
-                    // init
-                    for( int c = 0; c < nchannels; c++ )
-                        mean[mode*nchannels + c] = data[c];
+            v_int32 nmodes = v_reinterpret_as_s32(vx_load_expand_q(modesUsed + x));
 
-                    gmm[mode].variance = varInit;
+            // only the used modes and the place of a new one are loaded and stored
+            int nm = std::min(v_reduce_max(nmodes) + 1, nmixtures);
+            for( int k = 0; k < nm; k++ )
+            {
+                w[k] = v_mul(v_cvt_f32(v_reinterpret_as_s32(vx_load_expand(weights[k] + x))), v_invWeightScale);
+                var[k] = v_mul(v_cvt_f32(v_reinterpret_as_s32(vx_load_expand(variances[k] + x))), v_invValueScale);
+                for( int c = 0; c < CN; c++ )
+                    mu[k][c] = v_mul(v_cvt_f32(v_reinterpret_as_s32(vx_load_expand(means[k*CN + c] + x))), v_invValueScale);
+            }
 
-                    //sort
-                    //find the new place for it
-                    for( int i = nmodes - 1; i > 0; i-- )
+            v_float32 fits = v_zero, background = v_zero, totalWeight = v_zero;
+            v_int32 matched = vx_setall_s32(-1);
+            for( int k = 0; k < nm; k++ )
+            {
+                v_int32 v_k = vx_setall_s32(k);
+                v_float32 active = v_and(v_reinterpret_as_f32(v_lt(v_k, nmodes)), proc);
+                if( !v_check_any(active) )
+                    break;
+
+                v_float32 weight = v_add(v_mul(v_alpha1, w[k]), v_prune);
+                v_float32 check = v_and(active, notMask(fits));
+                if( v_check_any(check) )
+                {
+                    v_float32 dd[CN];
+                    v_float32 dist2 = v_zero;
+                    for( int c = 0; c < CN; c++ )
                     {
-                        // check one up
-                        if( alphaT < gmm[i-1].weight )
-                            break;
+                        dd[c] = v_sub(mu[k][c], d[c]);
+                        dist2 = c == 0 ? v_mul(dd[c], dd[c]) : v_add(dist2, v_mul(dd[c], dd[c]));
+                    }
 
-                        // swap one up
-                        std::swap(gmm[i], gmm[i-1]);
-                        for( int c = 0; c < nchannels; c++ )
-                            std::swap(mean[i*nchannels + c], mean[(i-1)*nchannels + c]);
+                    background = v_or(background, v_and(check, v_and(v_lt(totalWeight, v_TB), v_lt(dist2, v_mul(v_Tb, var[k])))));
+                    v_float32 match = v_and(check, v_lt(dist2, v_mul(v_Tg, var[k])));
+                    if( v_check_any(match) )
+                    {
+                        fits = v_or(fits, match);
+                        v_float32 wm = v_add(weight, v_alphaT);
+                        v_float32 kk = v_div(v_alphaT, wm);
+                        for( int c = 0; c < CN; c++ )
+                            mu[k][c] = v_select(match, v_sub(mu[k][c], v_mul(kk, dd[c])), mu[k][c]);
+                        v_float32 varnew = v_add(var[k], v_mul(kk, v_sub(dist2, var[k])));
+                        varnew = v_min(v_max(varnew, v_varMin), v_varMax);
+                        var[k] = v_select(match, varnew, var[k]);
+                        weight = v_select(match, wm, weight);
+                        matched = v_select(v_reinterpret_as_s32(match), v_k, matched);
                     }
                 }
 
-                //set the number of modes
-                modesUsed[x] = uchar(nmodes);
-                mask[x] = background ? 0 :
-                    detectShadows && detectShadowGMM(data, nchannels, nmodes, gmm, mean, Tb, TB, tau) ?
-                    shadowVal : 255;
+                v_float32 pruned = v_and(active, v_lt(weight, v_negPrune));
+                weight = v_select(pruned, v_zero, weight);
+                nmodes = v_sub(nmodes, v_and(v_reinterpret_as_s32(pruned), v_oneI));
+
+                w[k] = v_select(active, weight, w[k]);
+                totalWeight = v_add(totalWeight, v_and(active, weight));
+            }
+
+            // move the matched mode up while its weight is not less than the previous one
+            for( int i = nm - 1; i > 0; i-- )
+            {
+                v_int32 v_i = vx_setall_s32(i);
+                v_float32 up = v_and(v_reinterpret_as_f32(v_eq(matched, v_i)), notMask(v_lt(w[i], w[i-1])));
+                if( !v_check_any(up) )
+                    continue;
+                swapModes<CN>(up, w[i], var[i], mu[i], w[i-1], var[i-1], mu[i-1]);
+                matched = v_select(v_reinterpret_as_s32(up), vx_setall_s32(i - 1), matched);
+            }
+
+            // renormalize the weights
+            v_float32 invWeight = v_select(v_gt(v_abs(totalWeight), v_eps), v_div(v_one, totalWeight), v_zero);
+            for( int k = 0; k < nm; k++ )
+            {
+                v_float32 used = v_reinterpret_as_f32(v_lt(vx_setall_s32(k), nmodes));
+                w[k] = v_select(used, v_mul(w[k], invWeight), w[k]);
+            }
+
+            // add a new mode, replacing the weakest one if there is no free place
+            v_float32 added = alphaT > 0.f ? v_and(proc, notMask(fits)) : v_zero;
+            if( v_check_any(added) )
+            {
+                v_int32 addedI = v_reinterpret_as_s32(added);
+                v_int32 full = v_eq(nmodes, v_nmixtures);
+                v_int32 newMode = v_select(full, vx_setall_s32(nmixtures - 1), nmodes);
+                nmodes = v_add(nmodes, v_and(v_and(addedI, v_not(full)), v_oneI));
+                v_float32 single = v_reinterpret_as_f32(v_eq(nmodes, v_oneI));
+                v_float32 newWeight = v_select(single, v_one, v_alphaT);
+                for( int k = 0; k < nm; k++ )
+                {
+                    v_int32 v_k = vx_setall_s32(k);
+                    v_float32 isNew = v_and(added, v_reinterpret_as_f32(v_eq(v_k, newMode)));
+                    v_float32 isOld = v_and(v_and(added, v_reinterpret_as_f32(v_lt(v_k, v_sub(nmodes, v_oneI)))), notMask(single));
+                    w[k] = v_select(isNew, newWeight, v_select(isOld, v_mul(w[k], v_alpha1), w[k]));
+                    var[k] = v_select(isNew, v_varInit, var[k]);
+                    for( int c = 0; c < CN; c++ )
+                        mu[k][c] = v_select(isNew, d[c], mu[k][c]);
+                }
+
+                for( int i = nm - 1; i > 0; i-- )
+                {
+                    v_int32 v_i = vx_setall_s32(i);
+                    v_float32 up = v_and(v_and(added, v_reinterpret_as_f32(v_eq(newMode, v_i))), notMask(v_lt(v_alphaT, w[i-1])));
+                    if( !v_check_any(up) )
+                        continue;
+                    swapModes<CN>(up, w[i], var[i], mu[i], w[i-1], var[i-1], mu[i-1]);
+                    newMode = v_select(v_reinterpret_as_s32(up), vx_setall_s32(i - 1), newMode);
+                }
+            }
+
+            v_float32 shadow = v_zero;
+            if( updater.detectShadows )
+                shadow = detectShadows<CN>(v_and(proc, notMask(background)), d, nmodes, w, var, mu, v_Tb, v_TB, v_tau);
+
+            v_int32 maskVal = v_select(v_reinterpret_as_s32(background), vx_setzero_s32(),
+                                       v_select(v_reinterpret_as_s32(shadow), vx_setall_s32(updater.shadowVal), vx_setall_s32(255)));
+            v_store_aligned(nmodesBuf, nmodes);
+            v_store_aligned(maskBuf, maskVal);
+            for( int i = 0; i < VECSZ; i++ )
+            {
+                if( process && !process[x + i] )
+                    continue;
+                modesUsed[x + i] = (uchar)nmodesBuf[i];
+                mask[x + i] = (uchar)maskBuf[i];
+            }
+
+            for( int k = 0; k < nm; k++ )
+            {
+                storeCompact(weights[k] + x, v_mul(w[k], v_weightScale), proc, process);
+                storeCompact(variances[k] + x, v_mul(var[k], v_valueScale), proc, process);
+                for( int c = 0; c < CN; c++ )
+                    storeCompact(means[k*CN + c] + x, v_mul(mu[k][c], v_valueScale), proc, process);
             }
         }
+        vx_cleanup();
+        return x;
     }
 
+    static inline v_float32 notMask(const v_float32& m) { return v_reinterpret_as_f32(v_not(v_reinterpret_as_s32(m))); }
+    static inline void loadPixels(const float* ptr, v_float32 (&d)[1]) { d[0] = vx_load(ptr); }
+    static inline void loadPixels(const float* ptr, v_float32 (&d)[3]) { v_load_deinterleave(ptr, d[0], d[1], d[2]); }
+
+    template<int CN>
+    static inline void swapModes(const v_float32& sel, v_float32& w0, v_float32& var0, v_float32* mu0,
+                                 v_float32& w1, v_float32& var1, v_float32* mu1)
+    {
+        v_float32 t = v_select(sel, w1, w0); w1 = v_select(sel, w0, w1); w0 = t;
+        t = v_select(sel, var1, var0); var1 = v_select(sel, var0, var1); var0 = t;
+        for( int c = 0; c < CN; c++ )
+        {
+            t = v_select(sel, mu1[c], mu0[c]); mu1[c] = v_select(sel, mu0[c], mu1[c]); mu0[c] = t;
+        }
+    }
+
+    //the vector version of detectShadowGMM for the lanes selected by check
+    template<int CN>
+    inline v_float32 detectShadows(v_float32 check, const v_float32* d, const v_int32& nmodes,
+                                   const v_float32* w, const v_float32* var, const v_float32 (*mu)[CN],
+                                   const v_float32& v_Tb, const v_float32& v_TB, const v_float32& v_tau) const
+    {
+        v_float32 shadow = vx_setzero_f32(), tWeight = vx_setzero_f32();
+        for( int k = 0; k < updater.nmixtures; k++ )
+        {
+            check = v_and(check, v_reinterpret_as_f32(v_lt(vx_setall_s32(k), nmodes)));
+            if( !v_check_any(check) )
+                break;
+
+            v_float32 numerator = v_mul(d[0], mu[k][0]), denominator = v_mul(mu[k][0], mu[k][0]);
+            for( int c = 1; c < CN; c++ )
+            {
+                numerator = v_add(numerator, v_mul(d[c], mu[k][c]));
+                denominator = v_add(denominator, v_mul(mu[k][c], mu[k][c]));
+            }
+            check = v_and(check, notMask(v_eq(denominator, vx_setzero_f32())));
+
+            v_float32 cand = v_and(check, v_and(v_le(numerator, denominator), v_ge(numerator, v_mul(v_tau, denominator))));
+            if( v_check_any(cand) )
+            {
+                v_float32 a = v_div(numerator, denominator);
+                v_float32 dist2a = vx_setzero_f32();
+                for( int c = 0; c < CN; c++ )
+                {
+                    v_float32 dD = v_sub(v_mul(a, mu[k][c]), d[c]);
+                    dist2a = c == 0 ? v_mul(dD, dD) : v_add(dist2a, v_mul(dD, dD));
+                }
+                v_float32 hit = v_and(cand, v_lt(dist2a, v_mul(v_mul(v_mul(v_Tb, var[k]), a), a)));
+                shadow = v_or(shadow, hit);
+                check = v_and(check, notMask(hit));
+            }
+
+            tWeight = v_add(tWeight, w[k]);
+            check = v_and(check, notMask(v_gt(tWeight, v_TB)));
+        }
+        return shadow;
+    }
+
+    static inline void storeCompact(ushort* ptr, const v_float32& val, const v_float32& proc, const uchar* process)
+    {
+        v_int32 ival = v_round(val);
+        if( process )
+            ival = v_select(v_reinterpret_as_s32(proc), ival, v_reinterpret_as_s32(vx_load_expand(ptr)));
+        v_pack_u_store(ptr, ival);
+    }
+#endif
+
     const Mat* src;
     Mat* dst;
-    GMM* gmm0;
-    float* mean0;
+    Mat* model;
     uchar* modesUsed0;
+    const Mat* updateMask;
 
-    int nmixtures;
-    float alphaT, Tb, TB, Tg;
-    float varInit, varMin, varMax, prune, tau;
-
-    bool detectShadows;
-    uchar shadowVal;
+    MOG2PixelUpdater updater;
 };
 
 #ifdef HAVE_OPENCL
@@ -844,14 +1278,63 @@ void BackgroundSubtractorMOG2Impl::create_ocl_apply_kernel()
 
 #endif
 
+void BackgroundSubtractorMOG2::applyMasked(InputArray, InputArray, OutputArray, double)
+{
+    CV_Error(Error::StsNotImplemented, "Masked update is not supported by this implementation");
+}
+
+void BackgroundSubtractorMOG2::applyRegions(InputArray image, const std::vector<Rect>& rois, OutputArray fgmask, double learningRate)
+{
+    Mat updateMask;
+    detail::bgfgRegionsToMask(image.size(), rois, updateMask);
+    applyMasked(image, updateMask, fgmask, learningRate);
+}
+
+bool BackgroundSubtractorMOG2::getCompactModel() const
+{
+    return false;
+}
+
+void BackgroundSubtractorMOG2::setCompactModel(bool compact)
+{
+    if (compact)
+        CV_Error(Error::StsNotImplemented, "Compact model is not supported by this implementation");
+}
+
+int BackgroundSubtractorMOG2::getCoarseStep() const
+{
+    return 1;
+}
+
+void BackgroundSubtractorMOG2::setCoarseStep(int step)
+{
+    if (step != 1)
+        CV_Error(Error::StsNotImplemented, "Coarse-to-fine mode is not supported by this implementation");
+}
+
 void BackgroundSubtractorMOG2Impl::apply(InputArray _image, OutputArray _fgmask, double learningRate)
 {
     CV_INSTRUMENT_REGION();
 
+    update(_image, Mat(), _fgmask, learningRate);
+}
+
+void BackgroundSubtractorMOG2Impl::applyMasked(InputArray _image, InputArray _updateMask, OutputArray _fgmask, double learningRate)
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat updateMask = _updateMask.getMat();
+    CV_Assert(updateMask.type() == CV_8UC1 && updateMask.size() == _image.size());
+    update(_image, updateMask, _fgmask, learningRate);
+}
+
+void BackgroundSubtractorMOG2Impl::update(InputArray _image, const Mat& updateMask, OutputArray _fgmask, double learningRate)
+{
 #ifdef HAVE_OPENCL
     if (opencl_ON)
     {
-        CV_OCL_RUN(_fgmask.isUMat(), ocl_apply(_image, _fgmask, learningRate))
+        // the OpenCL kernel always processes the whole frame with the floating-point model
+        CV_OCL_RUN(_fgmask.isUMat() && updateMask.empty() && coarseStep == 1 && !compactModel, ocl_apply(_image, _fgmask, learningRate))
 
         opencl_ON = false;
         nframes = 0;
@@ -871,16 +1354,56 @@ void BackgroundSubtractorMOG2Impl::apply(InputArray _image, OutputArray _fgmask,
     learningRate = learningRate >= 0 && nframes > 1 ? learningRate : 1./std::min( 2*nframes, history );
     CV_Assert(learningRate >= 0);
 
-    parallel_for_(Range(0, image.rows),
-                  MOG2Invoker(image, fgmask,
-                              bgmodel.ptr<GMM>(),
-                              (float*)(bgmodel.ptr() + sizeof(GMM)*nmixtures*image.rows*image.cols),
-                              bgmodelUsedModes.ptr(), nmixtures, (float)learningRate,
-                              (float)varThreshold,
-                              backgroundRatio, varThresholdGen,
-                              fVarInit, fVarMin, fVarMax, float(-learningRate*fCT), fTau,
-                              bShadowDetection, nShadowDetection),
-                              image.total()/(double)(1 << 16));
+    if( coarseStep > 1 && nframes > 1 )
+    {
+        fgmask = Scalar::all(0);
+        detail::bgfgCoarseGridMask(image.size(), coarseStep, nframes, coarseMask);
+        if( !updateMask.empty() )
+            bitwise_and(coarseMask, updateMask, coarseMask);
+        updatePixels(image, fgmask, learningRate, &coarseMask);
+
+        detail::bgfgCoarseRefineMask(fgmask, coarseStep, nframes, coarseMask);
+        if( !updateMask.empty() )
+            bitwise_and(coarseMask, updateMask, coarseMask);
+        updatePixels(image, fgmask, learningRate, &coarseMask);
+    }
+    else if( !updateMask.empty() )
+    {
+        fgmask = Scalar::all(0);
+        updatePixels(image, fgmask, learningRate, &updateMask);
+    }
+    else
+        updatePixels(image, fgmask, learningRate, 0);
+}
+
+void BackgroundSubtractorMOG2Impl::updatePixels(const Mat& image, Mat& fgmask, double learningRate, const Mat* updateMask)
+{
+    // the variances of the compact model are positive and can't exceed its value range
+    float varInit = fVarInit, varMin = fVarMin, varMax = fVarMax;
+    if( compactModel )
+    {
+        CV_Assert( varInit > 0 && varMax > 0 );
+        varInit = std::min(varInit, compactMaxValue);
+        varMin = std::min(varMin, compactMaxValue);
+        varMax = std::min(varMax, compactMaxValue);
+    }
+    MOG2PixelUpdater updater(nmixtures, (float)learningRate,
+                             (float)varThreshold,
+                             backgroundRatio, varThresholdGen,
+                             varInit, varMin, varMax, float(-learningRate*fCT), fTau,
+                             bShadowDetection, nShadowDetection);
+
+    if( compactModel )
+        parallel_for_(Range(0, image.rows),
+                      MOG2CompactInvoker(image, fgmask, compactBgmodel, bgmodelUsedModes.ptr(), updater, updateMask),
+                      image.total()/(double)(1 << 16));
+    else
+        parallel_for_(Range(0, image.rows),
+                      MOG2Invoker(image, fgmask,
+                                  bgmodel.ptr<GMM>(),
+                                  (float*)(bgmodel.ptr() + sizeof(GMM)*nmixtures*image.rows*image.cols),
+                                  bgmodelUsedModes.ptr(), updater, updateMask),
+                      image.total()/(double)(1 << 16));
 }
 
 template <typename T, int CN>
@@ -890,8 +1413,8 @@ void BackgroundSubtractorMOG2Impl::getBackgroundImage_intern(OutputArray backgro
 
     Mat meanBackground(frameSize, frameType, Scalar::all(0));
     int firstGaussianIdx = 0;
-    const GMM* gmm = bgmodel.ptr<GMM>();
-    const float* mean = reinterpret_cast<const float*>(gmm + frameSize.width*frameSize.height*nmixtures);
+    const GMM* gmm = compactModel ? 0 : bgmodel.ptr<GMM>();
+    const float* mean = gmm ? reinterpret_cast<const float*>(gmm + frameSize.width*frameSize.height*nmixtures) : 0;
     Vec<float,CN> meanVal(0.f);
     for(int row=0; row<meanBackground.rows; row++)
     {
@@ -901,13 +1424,28 @@ void BackgroundSubtractorMOG2Impl::getBackgroundImage_intern(OutputArray backgro
             float totalWeight = 0.f;
             for(int gaussianIdx = firstGaussianIdx; gaussianIdx < firstGaussianIdx + nmodes; gaussianIdx++)
             {
-                GMM gaussian = gmm[gaussianIdx];
-                size_t meanPosition = gaussianIdx*CN;
-                for(int chn = 0; chn < CN; chn++)
+                float weight;
+                if (compactModel)
+                {
+                    int mode = gaussianIdx - firstGaussianIdx;
+                    weight = decodeCompactWeight(compactBgmodel.at<ushort>(mode*frameSize.height + row, col));
+                    for(int chn = 0; chn < CN; chn++)
+                    {
+                        int plane = 2*nmixtures + mode*CN + chn;
+                        meanVal(chn) += weight * decodeCompactValue(compactBgmodel.at<ushort>(plane*frameSize.height + row, col));
+                    }
+                }
+                else
                 {
-                    meanVal(chn) += gaussian.weight * mean[meanPosition + chn];
+                    GMM gaussian = gmm[gaussianIdx];
+                    size_t meanPosition = gaussianIdx*CN;
+                    for(int chn = 0; chn < CN; chn++)
+                    {
+                        meanVal(chn) += gaussian.weight * mean[meanPosition + chn];
+                    }
+                    weight = gaussian.weight;
                 }
-                totalWeight += gaussian.weight;
+                totalWeight += weight;
 
                 if(totalWeight > backgroundRatio)
                     break;
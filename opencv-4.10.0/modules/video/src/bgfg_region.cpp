@@ -0,0 +1,77 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "bgfg_region.hpp"
+
+namespace cv
+{
+namespace detail
+{
+
+void bgfgRegionsToMask(Size size, const std::vector<Rect>& rois, Mat& mask)
+{
+    mask.create(size, CV_8U);
+    mask = Scalar::all(0);
+    const Rect frame(Point(), size);
+    for (size_t i = 0; i < rois.size(); i++)
+    {
+        Rect r = rois[i] & frame;
+        if (!r.empty())
+            mask(r) = Scalar::all(255);
+    }
+}
+
+static inline Point gridOffset(int step, int frameIdx)
+{
+    CV_DbgAssert(step > 1 && frameIdx >= 0);
+    return Point(frameIdx % step, (frameIdx / step) % step);
+}
+
+void bgfgCoarseGridMask(Size size, int step, int frameIdx, Mat& mask)
+{
+    const Point ofs = gridOffset(step, frameIdx);
+    mask.create(size, CV_8U);
+    mask = Scalar::all(0);
+    for (int y = ofs.y; y < size.height; y += step)
+    {
+        uchar* row = mask.ptr(y);
+        for (int x = ofs.x; x < size.width; x += step)
+            row[x] = 255;
+    }
+}
+
+void bgfgCoarseRefineMask(const Mat& fgmask, int step, int frameIdx, Mat& mask)
+{
+    CV_Assert(fgmask.type() == CV_8UC1);
+    const Size size = fgmask.size();
+    const Point ofs = gridOffset(step, frameIdx);
+
+    // the foreground of the grid, one element per cell, grown by one cell
+    Mat cells((size.height + step - 1) / step, (size.width + step - 1) / step, CV_8U, Scalar::all(0));
+    for (int j = 0, y = ofs.y; y < size.height; j++, y += step)
+    {
+        const uchar* src = fgmask.ptr(y);
+        uchar* dst = cells.ptr(j);
+        for (int i = 0, x = ofs.x; x < size.width; i++, x += step)
+            dst[i] = src[x] ? 255 : 0;
+    }
+    dilate(cells, cells, Mat());
+
+    mask.create(size, CV_8U);
+    for (int y = 0; y < size.height; y++)
+    {
+        const uchar* src = cells.ptr(y / step);
+        uchar* dst = mask.ptr(y);
+        for (int i = 0, x = 0; x < size.width; i++, x += step)
+            memset(dst + x, src[i], std::min(step, size.width - x));
+        if ((y - ofs.y) % step == 0 && y >= ofs.y)
+        {
+            for (int x = ofs.x; x < size.width; x += step)
+                dst[x] = 0;
+        }
+    }
+}
+
+}} // namespace
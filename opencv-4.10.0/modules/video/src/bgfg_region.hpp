@@ -0,0 +1,30 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#pragma once
+
+namespace cv
+{
+namespace detail
+{
+
+//! Rasterizes the rectangles, clipped to the frame, into an 8-bit update mask
+void bgfgRegionsToMask(Size size, const std::vector<Rect>& rois, Mat& mask);
+
+//! Selects one pixel of each step x step cell, the position in the cell changes with the frame index
+void bgfgCoarseGridMask(Size size, int step, int frameIdx, Mat& mask);
+
+//! Selects the cells where the grid pixel of the cell or of a neighbour cell is foreground in fgmask,
+//! except the grid pixels themselves, which are already processed
+void bgfgCoarseRefineMask(const Mat& fgmask, int step, int frameIdx, Mat& mask);
+
+static inline bool bgfgRowHasNonZero(const uchar* row, int len)
+{
+    for (int x = 0; x < len; x++)
+        if (row[x])
+            return true;
+    return false;
+}
+
+}} // namespace
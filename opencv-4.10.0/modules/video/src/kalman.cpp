@@ -39,6 +39,7 @@
 //
 //M*/
 #include "precomp.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -131,4 +132,436 @@ const Mat& KalmanFilter::correct(const Mat& measurement)
     return statePost;
 }
 
+//
+// BatchKalmanFilter
+//
+
+namespace {
+
+// The rows of the structure-of-arrays matrices hold one element of all of the tracks,
+// the operations below combine such rows lane by lane
+
+static void rowSet(float* dst, float value, int n)
+{
+    for (int i = 0; i < n; i++)
+        dst[i] = value;
+}
+
+// dst += a*x
+static void rowAxpy(float* dst, float a, const float* x, int n)
+{
+    if (a == 0.f)
+        return;
+    int i = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    const v_float32 va = vx_setall_f32(a);
+    for (; i <= n - vlanes; i += vlanes)
+        v_store(dst + i, v_fma(va, vx_load(x + i), vx_load(dst + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] += a * x[i];
+}
+
+// dst += x*y
+static void rowMulAdd(float* dst, const float* x, const float* y, int n)
+{
+    int i = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    for (; i <= n - vlanes; i += vlanes)
+        v_store(dst + i, v_fma(vx_load(x + i), vx_load(y + i), vx_load(dst + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] += x[i] * y[i];
+}
+
+// dst -= x*y
+static void rowMulSub(float* dst, const float* x, const float* y, int n)
+{
+    int i = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    for (; i <= n - vlanes; i += vlanes)
+        v_store(dst + i, v_sub(vx_load(dst + i), v_mul(vx_load(x + i), vx_load(y + i))));
+#endif
+    for (; i < n; i++)
+        dst[i] -= x[i] * y[i];
+}
+
+// dst *= x
+static void rowMul(float* dst, const float* x, int n)
+{
+    int i = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    for (; i <= n - vlanes; i += vlanes)
+        v_store(dst + i, v_mul(vx_load(dst + i), vx_load(x + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] *= x[i];
+}
+
+// dst = 1/sqrt(x)
+static void rowInvSqrt(float* dst, const float* x, int n)
+{
+    int i = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    const v_float32 v_one = vx_setall_f32(1.f);
+    for (; i <= n - vlanes; i += vlanes)
+        v_store(dst + i, v_div(v_one, v_sqrt(vx_load(x + i))));
+#endif
+    for (; i < n; i++)
+        dst[i] = 1.f / std::sqrt(x[i]);
+}
+
+// dst = mask ? x : y, the whole x without the mask
+static void rowStore(float* dst, const float* x, const float* y, const uchar* mask, int n)
+{
+    if (!mask)
+    {
+        if (dst != x)
+            memcpy(dst, x, n * sizeof(float));
+        return;
+    }
+    for (int i = 0; i < n; i++)
+        dst[i] = mask[i] ? x[i] : y[i];
+}
+
+static const int KALMAN_BATCH_BLOCK = 128;
+
+class BatchKalmanPredictInvoker : public ParallelLoopBody
+{
+public:
+    BatchKalmanPredictInvoker(BatchKalmanFilter& kf_, const Mat& control_, const uchar* mask_) :
+        kf(kf_), control(control_), mask(mask_)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const int DP = kf.statePost.rows, CP = control.empty() ? 0 : control.rows;
+        const int count = kf.getCount();
+        AutoBuffer<float> buf((DP + 2 * DP * DP) * KALMAN_BATCH_BLOCK);
+
+        for (int block = range.start; block < range.end; block++)
+        {
+            const int n0 = block * KALMAN_BATCH_BLOCK, len = std::min(KALMAN_BATCH_BLOCK, count - n0);
+            float* x = buf.data();
+            float* T = x + DP * len;
+            float* P = T + DP * DP * len;
+            const uchar* m = mask ? mask + n0 : 0;
+
+            // x'(k) = A*x(k) + B*u(k)
+            for (int i = 0; i < DP; i++)
+            {
+                float* xi = x + i * len;
+                rowSet(xi, 0.f, len);
+                for (int k = 0; k < DP; k++)
+                    rowAxpy(xi, kf.transitionMatrix.at<float>(i, k), kf.statePost.ptr<float>(k) + n0, len);
+                for (int c = 0; c < CP; c++)
+                    rowAxpy(xi, kf.controlMatrix.at<float>(i, c), control.ptr<float>(c) + n0, len);
+            }
+
+            // T = A*P(k)
+            for (int i = 0; i < DP; i++)
+                for (int j = 0; j < DP; j++)
+                {
+                    float* t = T + (i * DP + j) * len;
+                    rowSet(t, 0.f, len);
+                    for (int k = 0; k < DP; k++)
+                        rowAxpy(t, kf.transitionMatrix.at<float>(i, k), kf.errorCovPost.ptr<float>(k * DP + j) + n0, len);
+                }
+
+            // P'(k) = T*At + Q
+            for (int i = 0; i < DP; i++)
+                for (int j = 0; j < DP; j++)
+                {
+                    float* p = P + (i * DP + j) * len;
+                    rowSet(p, kf.processNoiseCov.at<float>(i, j), len);
+                    for (int k = 0; k < DP; k++)
+                        rowAxpy(p, kf.transitionMatrix.at<float>(j, k), T + (i * DP + k) * len, len);
+                }
+
+            // the corrected state is the predicted one until a measurement comes
+            for (int i = 0; i < DP; i++)
+            {
+                float* pre = kf.statePre.ptr<float>(i) + n0;
+                rowStore(pre, x + i * len, pre, m, len);
+                float* post = kf.statePost.ptr<float>(i) + n0;
+                rowStore(post, x + i * len, post, m, len);
+            }
+            for (int i = 0; i < DP * DP; i++)
+            {
+                float* pre = kf.errorCovPre.ptr<float>(i) + n0;
+                rowStore(pre, P + i * len, pre, m, len);
+                float* post = kf.errorCovPost.ptr<float>(i) + n0;
+                rowStore(post, P + i * len, post, m, len);
+            }
+        }
+    }
+
+private:
+    BatchKalmanFilter& kf;
+    const Mat& control;
+    const uchar* mask;
+};
+
+class BatchKalmanCorrectInvoker : public ParallelLoopBody
+{
+public:
+    BatchKalmanCorrectInvoker(BatchKalmanFilter& kf_, const Mat& measurement_, const uchar* mask_) :
+        kf(kf_), measurement(measurement_), mask(mask_)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const int DP = kf.statePost.rows, MP = measurement.rows;
+        const int count = kf.getCount();
+        AutoBuffer<float> buf((2 * MP * DP + MP * MP + 2 * MP + DP + DP * DP) * KALMAN_BATCH_BLOCK);
+
+        for (int block = range.start; block < range.end; block++)
+        {
+            const int n0 = block * KALMAN_BATCH_BLOCK, len = std::min(KALMAN_BATCH_BLOCK, count - n0);
+            float* HP = buf.data();
+            float* KT = HP + MP * DP * len;
+            float* S = KT + MP * DP * len;
+            float* invD = S + MP * MP * len;
+            float* r = invD + MP * len;
+            float* x = r + MP * len;
+            float* P = x + DP * len;
+            const uchar* m = mask ? mask + n0 : 0;
+
+            // HP = H*P'(k)
+            for (int i = 0; i < MP; i++)
+                for (int j = 0; j < DP; j++)
+                {
+                    float* hp = HP + (i * DP + j) * len;
+                    rowSet(hp, 0.f, len);
+                    for (int k = 0; k < DP; k++)
+                        rowAxpy(hp, kf.measurementMatrix.at<float>(i, k), kf.errorCovPre.ptr<float>(k * DP + j) + n0, len);
+                }
+
+            // S = HP*Ht + R, the lower triangle
+            for (int i = 0; i < MP; i++)
+                for (int j = 0; j <= i; j++)
+                {
+                    float* s = S + (i * MP + j) * len;
+                    rowSet(s, kf.measurementNoiseCov.at<float>(i, j), len);
+                    for (int k = 0; k < DP; k++)
+                        rowAxpy(s, kf.measurementMatrix.at<float>(j, k), HP + (i * DP + k) * len, len);
+                }
+
+            // S = L*Lt, L replaces the lower triangle of S, invD keeps the inverted diagonal of L
+            for (int j = 0; j < MP; j++)
+            {
+                float* sjj = S + (j * MP + j) * len;
+                for (int k = 0; k < j; k++)
+                    rowMulSub(sjj, S + (j * MP + k) * len, S + (j * MP + k) * len, len);
+                rowInvSqrt(invD + j * len, sjj, len);
+                for (int i = j + 1; i < MP; i++)
+                {
+                    float* sij = S + (i * MP + j) * len;
+                    for (int k = 0; k < j; k++)
+                        rowMulSub(sij, S + (i * MP + k) * len, S + (j * MP + k) * len, len);
+                    rowMul(sij, invD + j * len, len);
+                }
+            }
+
+            // Kt(k) = inv(S)*HP, column by column
+            for (int c = 0; c < DP; c++)
+            {
+                for (int i = 0; i < MP; i++)
+                {
+                    float* kt = KT + (i * DP + c) * len;
+                    memcpy(kt, HP + (i * DP + c) * len, len * sizeof(float));
+                    for (int k = 0; k < i; k++)
+                        rowMulSub(kt, S + (i * MP + k) * len, KT + (k * DP + c) * len, len);
+                    rowMul(kt, invD + i * len, len);
+                }
+                for (int i = MP - 1; i >= 0; i--)
+                {
+                    float* kt = KT + (i * DP + c) * len;
+                    for (int k = i + 1; k < MP; k++)
+                        rowMulSub(kt, S + (k * MP + i) * len, KT + (k * DP + c) * len, len);
+                    rowMul(kt, invD + i * len, len);
+                }
+            }
+
+            // r = z(k) - H*x'(k)
+            for (int i = 0; i < MP; i++)
+            {
+                float* ri = r + i * len;
+                memcpy(ri, measurement.ptr<float>(i) + n0, len * sizeof(float));
+                for (int k = 0; k < DP; k++)
+                    rowAxpy(ri, -kf.measurementMatrix.at<float>(i, k), kf.statePre.ptr<float>(k) + n0, len);
+            }
+
+            // x(k) = x'(k) + K(k)*r
+            for (int i = 0; i < DP; i++)
+            {
+                float* xi = x + i * len;
+                memcpy(xi, kf.statePre.ptr<float>(i) + n0, len * sizeof(float));
+                for (int k = 0; k < MP; k++)
+                    rowMulAdd(xi, KT + (k * DP + i) * len, r + k * len, len);
+            }
+
+            // P(k) = P'(k) - K(k)*HP
+            for (int i = 0; i < DP; i++)
+                for (int j = 0; j < DP; j++)
+                {
+                    float* p = P + (i * DP + j) * len;
+                    memcpy(p, kf.errorCovPre.ptr<float>(i * DP + j) + n0, len * sizeof(float));
+                    for (int k = 0; k < MP; k++)
+                        rowMulSub(p, KT + (k * DP + i) * len, HP + (k * DP + j) * len, len);
+                }
+
+            // the tracks without a measurement are not changed, predict() has set their corrected state
+            for (int i = 0; i < DP; i++)
+            {
+                float* post = kf.statePost.ptr<float>(i) + n0;
+                rowStore(post, x + i * len, post, m, len);
+            }
+            for (int i = 0; i < DP * DP; i++)
+            {
+                float* post = kf.errorCovPost.ptr<float>(i) + n0;
+                rowStore(post, P + i * len, post, m, len);
+            }
+            for (int i = 0; i < DP; i++)
+                for (int k = 0; k < MP; k++)
+                {
+                    float* g = kf.gain.ptr<float>(i * MP + k) + n0;
+                    rowStore(g, KT + (k * DP + i) * len, g, m, len);
+                }
+        }
+    }
+
+private:
+    BatchKalmanFilter& kf;
+    const Mat& measurement;
+    const uchar* mask;
+};
+
+static const uchar* getTrackMask(InputArray _mask, int count, Mat& mask)
+{
+    if (_mask.empty())
+        return 0;
+    mask = _mask.getMat();
+    CV_Assert(mask.type() == CV_8UC1 && (int)mask.total() == count && mask.isContinuous());
+    return mask.ptr();
+}
+
+} // namespace
+
+BatchKalmanFilter::BatchKalmanFilter() {}
+BatchKalmanFilter::BatchKalmanFilter(int count, int dynamParams, int measureParams, int controlParams)
+{
+    init(count, dynamParams, measureParams, controlParams);
+}
+
+void BatchKalmanFilter::init(int count, int DP, int MP, int CP)
+{
+    CV_Assert( count > 0 && DP > 0 && MP > 0 );
+    CP = std::max(CP, 0);
+
+    statePre = Mat::zeros(DP, count, CV_32F);
+    statePost = Mat::zeros(DP, count, CV_32F);
+    transitionMatrix = Mat::eye(DP, DP, CV_32F);
+
+    processNoiseCov = Mat::eye(DP, DP, CV_32F);
+    measurementMatrix = Mat::zeros(MP, DP, CV_32F);
+    measurementNoiseCov = Mat::eye(MP, MP, CV_32F);
+
+    errorCovPre = Mat::zeros(DP * DP, count, CV_32F);
+    errorCovPost = Mat::zeros(DP * DP, count, CV_32F);
+    gain = Mat::zeros(DP * MP, count, CV_32F);
+
+    if( CP > 0 )
+        controlMatrix = Mat::zeros(DP, CP, CV_32F);
+    else
+        controlMatrix.release();
+}
+
+void BatchKalmanFilter::setTrack(int track, InputArray _state, InputArray _errorCov)
+{
+    const int DP = statePost.rows;
+    CV_Assert( 0 <= track && track < getCount() );
+    Mat state;
+    _state.getMat().convertTo(state, CV_32F);
+    CV_Assert( (int)state.total() == DP );
+    state = state.reshape(1, DP);
+    state.copyTo(statePre.col(track));
+    state.copyTo(statePost.col(track));
+
+    if( !_errorCov.empty() )
+    {
+        Mat errorCov;
+        _errorCov.getMat().convertTo(errorCov, CV_32F);
+        CV_Assert( errorCov.rows == DP && errorCov.cols == DP );
+        for( int i = 0; i < DP; i++ )
+            for( int j = 0; j < DP; j++ )
+                errorCovPre.at<float>(i * DP + j, track) = errorCovPost.at<float>(i * DP + j, track) = errorCov.at<float>(i, j);
+    }
+}
+
+void BatchKalmanFilter::getTrack(int track, OutputArray state, OutputArray _errorCov) const
+{
+    const int DP = statePost.rows;
+    CV_Assert( 0 <= track && track < getCount() );
+    statePost.col(track).copyTo(state);
+
+    if( _errorCov.needed() )
+    {
+        _errorCov.create(DP, DP, CV_32F);
+        Mat errorCov = _errorCov.getMat();
+        for( int i = 0; i < DP; i++ )
+            for( int j = 0; j < DP; j++ )
+                errorCov.at<float>(i, j) = errorCovPost.at<float>(i * DP + j, track);
+    }
+}
+
+void BatchKalmanFilter::predict(InputArray _control, InputArray _mask)
+{
+    CV_INSTRUMENT_REGION();
+
+    const int DP = statePost.rows, count = getCount();
+    CV_Assert( count > 0 );
+    CV_Assert( statePre.size() == statePost.size() && errorCovPost.rows == DP * DP && errorCovPost.cols == count );
+    CV_Assert( errorCovPre.size() == errorCovPost.size() );
+    CV_Assert( transitionMatrix.type() == CV_32F && transitionMatrix.rows == DP && transitionMatrix.cols == DP );
+    CV_Assert( processNoiseCov.type() == CV_32F && processNoiseCov.rows == DP && processNoiseCov.cols == DP );
+
+    Mat control = _control.getMat(), mask;
+    if( !control.empty() )
+    {
+        CV_Assert( control.type() == CV_32F && control.cols == count );
+        CV_Assert( controlMatrix.type() == CV_32F && controlMatrix.rows == DP && controlMatrix.cols == control.rows );
+    }
+    const uchar* maskPtr = getTrackMask(_mask, count, mask);
+
+    const int blocks = (count + KALMAN_BATCH_BLOCK - 1) / KALMAN_BATCH_BLOCK;
+    parallel_for_(Range(0, blocks), BatchKalmanPredictInvoker(*this, control, maskPtr));
+}
+
+void BatchKalmanFilter::correct(InputArray _measurement, InputArray _mask)
+{
+    CV_INSTRUMENT_REGION();
+
+    const int DP = statePost.rows, count = getCount();
+    Mat measurement = _measurement.getMat(), mask;
+    CV_Assert( count > 0 && measurement.type() == CV_32F && measurement.cols == count );
+    CV_Assert( statePre.size() == statePost.size() && errorCovPre.rows == DP * DP && errorCovPre.cols == count );
+    CV_Assert( errorCovPre.size() == errorCovPost.size() );
+    const int MP = measurement.rows;
+    CV_Assert( measurementMatrix.type() == CV_32F && measurementMatrix.rows == MP && measurementMatrix.cols == DP );
+    CV_Assert( measurementNoiseCov.type() == CV_32F && measurementNoiseCov.rows == MP && measurementNoiseCov.cols == MP );
+    CV_Assert( gain.rows == DP * MP && gain.cols == count );
+    const uchar* maskPtr = getTrackMask(_mask, count, mask);
+
+    const int blocks = (count + KALMAN_BATCH_BLOCK - 1) / KALMAN_BATCH_BLOCK;
+    parallel_for_(Range(0, blocks), BatchKalmanCorrectInvoker(*this, measurement, maskPtr));
+}
+
 }
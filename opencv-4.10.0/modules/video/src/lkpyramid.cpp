@@ -42,6 +42,7 @@
 #include "precomp.hpp"
 #include <float.h>
 #include <stdio.h>
+#include <deque>
 #include "lkpyramid.hpp"
 #include "opencl_kernels_video.hpp"
 #include "opencv2/core/hal/intrin.hpp"
@@ -1361,15 +1362,17 @@ void SparsePyrLKOpticalFlowImpl::calc( InputArray _prevImg, InputArray _nextImg,
     if (levels2 < 0)
         maxLevel = buildOpticalFlowPyramid(_nextImg, nextPyr, winSize, maxLevel, false);
 
-    if( (criteria.type & TermCriteria::COUNT) == 0 )
-        criteria.maxCount = 30;
+    // the member criteria are kept intact, the same object is called for every frame
+    TermCriteria crit = criteria;
+    if( (crit.type & TermCriteria::COUNT) == 0 )
+        crit.maxCount = 30;
     else
-        criteria.maxCount = std::min(std::max(criteria.maxCount, 0), 100);
-    if( (criteria.type & TermCriteria::EPS) == 0 )
-        criteria.epsilon = 0.01;
+        crit.maxCount = std::min(std::max(crit.maxCount, 0), 100);
+    if( (crit.type & TermCriteria::EPS) == 0 )
+        crit.epsilon = 0.01;
     else
-        criteria.epsilon = std::min(std::max(criteria.epsilon, 0.), 10.);
-    criteria.epsilon *= criteria.epsilon;
+        crit.epsilon = std::min(std::max(crit.epsilon, 0.), 10.);
+    crit.epsilon *= crit.epsilon;
 
     // dI/dx ~ Ix, dI/dy ~ Iy
     Mat derivIBuf;
@@ -1398,13 +1401,100 @@ void SparsePyrLKOpticalFlowImpl::calc( InputArray _prevImg, InputArray _nextImg,
         parallel_for_(Range(0, npoints), LKTrackerInvoker(prevPyr[level * lvlStep1], derivI,
                                                           nextPyr[level * lvlStep2], prevPts, nextPts,
                                                           status, err,
-                                                          winSize, criteria, level, maxLevel,
+                                                          winSize, crit, level, maxLevel,
                                                           flags, (float)minEigThreshold));
     }
 }
 
+class FramePyramidCacheImpl CV_FINAL : public FramePyramidCache
+{
+public:
+    FramePyramidCacheImpl(Size winSize_, int maxLevel_, int capacity_) :
+        winSize(winSize_), maxLevel(maxLevel_), capacity(capacity_)
+    {
+        CV_Assert(winSize.width > 2 && winSize.height > 2);
+        CV_Assert(maxLevel >= 0 && capacity > 0);
+    }
+
+    virtual void addFrame(int64 frameId, InputArray image) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION();
+
+        // the pyramid is built out of the lock, so the users of the stored frames are not blocked;
+        // level 0 is never shared with the image, the caller may reuse its buffer
+        std::vector<Mat> pyramid;
+        buildOpticalFlowPyramid(image, pyramid, winSize, maxLevel, true, BORDER_REFLECT_101, BORDER_CONSTANT, false);
+
+        AutoLock lock(mutex);
+        for (std::deque<Frame>::iterator it = frames.begin(); it != frames.end(); ++it)
+        {
+            if (it->first == frameId)
+            {
+                frames.erase(it);
+                break;
+            }
+        }
+        frames.push_back(Frame(frameId, pyramid));
+        while ((int)frames.size() > capacity)
+            frames.pop_front();
+    }
+
+    virtual bool getPyramid(int64 frameId, std::vector<Mat>& pyramid) const CV_OVERRIDE
+    {
+        AutoLock lock(mutex);
+        for (std::deque<Frame>::const_iterator it = frames.begin(); it != frames.end(); ++it)
+        {
+            if (it->first == frameId)
+            {
+                pyramid = it->second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    virtual void clear() CV_OVERRIDE
+    {
+        AutoLock lock(mutex);
+        frames.clear();
+    }
+
+    virtual Size getWinSize() const CV_OVERRIDE { return winSize; }
+    virtual int getMaxLevel() const CV_OVERRIDE { return maxLevel; }
+
+private:
+    typedef std::pair<int64, std::vector<Mat> > Frame;
+
+    const Size winSize;
+    const int maxLevel;
+    const int capacity;
+    mutable Mutex mutex;
+    std::deque<Frame> frames;
+};
+
 } // namespace
 } // namespace cv
+cv::FramePyramidCache::~FramePyramidCache()
+{
+}
+cv::Ptr<cv::FramePyramidCache> cv::FramePyramidCache::create(Size winSize, int maxLevel, int capacity)
+{
+    return makePtr<FramePyramidCacheImpl>(winSize, maxLevel, capacity);
+}
+void cv::SparsePyrLKOpticalFlow::calcWithCache(const Ptr<FramePyramidCache>& cache, int64 prevFrameId, int64 nextFrameId,
+                                               InputArray prevPts, InputOutputArray nextPts,
+                                               OutputArray status, OutputArray err)
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_Assert(cache);
+    Size cacheWinSize = cache->getWinSize(), winSize = getWinSize();
+    CV_Assert(cacheWinSize.width >= winSize.width && cacheWinSize.height >= winSize.height);
+    std::vector<Mat> prevPyr, nextPyr;
+    if (!cache->getPyramid(prevFrameId, prevPyr) || !cache->getPyramid(nextFrameId, nextPyr))
+        CV_Error(Error::StsObjectNotFound, "The frame is not stored in the pyramid cache");
+    calc(prevPyr, nextPyr, prevPts, nextPts, status, err);
+}
 cv::Ptr<cv::SparsePyrLKOpticalFlow> cv::SparsePyrLKOpticalFlow::create(Size winSize, int maxLevel, TermCriteria crit, int flags, double minEigThreshold){
     return makePtr<SparsePyrLKOpticalFlowImpl>(winSize,maxLevel,crit,flags,minEigThreshold);
 }
@@ -87,7 +87,7 @@ class TrackerNanoImpl : public TrackerNano
 {
 public:
     TrackerNanoImpl(const TrackerNano::Params& parameters)
-        : params(parameters)
+        : batchBackbone(true), params(parameters)
     {
         backbone = dnn::readNet(params.backbone);
         neckhead = dnn::readNet(params.neckhead);
@@ -95,6 +95,9 @@ public:
         CV_Assert(!backbone.empty());
         CV_Assert(!neckhead.empty());
 
+        // the template features are set once per init(), the neckhead computes their branch once
+        neckhead.setInputConstant("input1");
+
         backbone.setPreferableBackend(params.backend);
         backbone.setPreferableTarget(params.target);
         neckhead.setPreferableBackend(params.backend);
@@ -105,10 +108,18 @@ public:
     bool update(InputArray image, Rect& boundingBox) CV_OVERRIDE;
     float getTrackingScore() CV_OVERRIDE;
 
+    // The two halves of update(), the backbone forward between them can be shared by several trackers.
+    float getSearchCrop(const Mat& frame, Mat& crop);
+    Mat forwardBackbone(const std::vector<Mat>& crops);
+    void locate(const Mat& xf, float scale_z, Rect& boundingBox);
+    bool canShareBackbone(const TrackerNanoImpl& other) const;
+
     // Save the target bounding box for each frame.
     std::vector<float> targetSz = {0, 0};  // H and W of bounding box
     std::vector<float> targetPos = {0, 0}; // center point of bounding box (x, y)
     float tracking_score;
+    // false once the backbone has failed on a batch of several crops, e.g. the model has a fixed batch size of 1
+    bool batchBackbone;
 
     TrackerNano::Params params;
 
@@ -233,9 +244,9 @@ void TrackerNanoImpl::getSubwindow(Mat& dstCrop, Mat& srcImg, int originalSz, in
     resize(cropImg, dstCrop, Size(resizeSz, resizeSz));
 }
 
-bool TrackerNanoImpl::update(InputArray image_, Rect &boundingBoxRes)
+float TrackerNanoImpl::getSearchCrop(const Mat& frame, Mat& crop)
 {
-    image = image_.getMat().clone();
+    image = frame;
     int targetSzSum = (int)(targetSz[0] + targetSz[1]);
 
     float wc = targetSz[0] + trackState.contextAmount * targetSzSum;
@@ -246,12 +257,35 @@ bool TrackerNanoImpl::update(InputArray image_, Rect &boundingBoxRes)
     targetSz[0] *= scale_z;
     targetSz[1] *= scale_z;
 
-    Mat crop;
     getSubwindow(crop, image, int(sx), instanceSize);
+    return scale_z;
+}
 
-    Mat blob = dnn::blobFromImage(crop, 1.0, Size(), Scalar(), trackState.swapRB);
+Mat TrackerNanoImpl::forwardBackbone(const std::vector<Mat>& crops)
+{
+    Mat blob = dnn::blobFromImages(crops, 1.0, Size(), Scalar(), trackState.swapRB);
     backbone.setInput(blob);
-    Mat xf = backbone.forward();
+    return backbone.forward();
+}
+
+bool TrackerNanoImpl::canShareBackbone(const TrackerNanoImpl& other) const
+{
+    return params.backbone == other.params.backbone &&
+           params.backend == other.params.backend &&
+           params.target == other.params.target;
+}
+
+bool TrackerNanoImpl::update(InputArray image_, Rect &boundingBoxRes)
+{
+    Mat crop;
+    float scale_z = getSearchCrop(image_.getMat().clone(), crop);
+    Mat xf = forwardBackbone(std::vector<Mat>(1, crop));
+    locate(xf, scale_z, boundingBoxRes);
+    return true;
+}
+
+void TrackerNanoImpl::locate(const Mat& xf, float scale_z, Rect &boundingBoxRes)
+{
     neckhead.setInput(xf, "input2");
     std::vector<String> outputName = {"output1", "output2"};
     std::vector<Mat> outs;
@@ -336,7 +370,6 @@ bool TrackerNanoImpl::update(InputArray image_, Rect &boundingBoxRes)
 
     // convert center to Rect.
     boundingBoxRes = { int(resX - resW/2), int(resY - resH/2), int(resW), int(resH)};
-    return true;
 }
 
 float TrackerNanoImpl::getTrackingScore()
@@ -349,11 +382,83 @@ Ptr<TrackerNano> TrackerNano::create(const TrackerNano::Params& parameters)
     return makePtr<TrackerNanoImpl>(parameters);
 }
 
+void TrackerNano::updateBatch(InputArray image_, const std::vector<Ptr<TrackerNano> >& trackers, std::vector<Rect>& boundingBoxes)
+{
+    CV_INSTRUMENT_REGION();
+
+    const int count = (int)trackers.size();
+    boundingBoxes.resize(count);
+    if (count == 0)
+        return;
+
+    std::vector<TrackerNanoImpl*> impls(count);
+    bool shared = true;
+    for (int i = 0; i < count; i++)
+    {
+        impls[i] = dynamic_cast<TrackerNanoImpl*>(trackers[i].get());
+        CV_Assert(impls[i]);
+        shared = shared && impls[i]->canShareBackbone(*impls[0]);
+    }
+
+    Mat image = image_.getMat().clone();
+    if (!shared || count == 1)
+    {
+        for (int i = 0; i < count; i++)
+            impls[i]->update(image, boundingBoxes[i]);
+        return;
+    }
+
+    // The backbone does not depend on the template, so the search crops of all of the targets
+    // are passed through it in one batch. The neckhead correlates with the template features
+    // of each target and runs per target.
+    std::vector<Mat> crops(count);
+    std::vector<float> scales(count);
+    for (int i = 0; i < count; i++)
+        scales[i] = impls[i]->getSearchCrop(image, crops[i]);
+
+    Mat xf;
+    if (impls[0]->batchBackbone)
+    {
+        try
+        {
+            xf = impls[0]->forwardBackbone(crops);
+        }
+        catch (const cv::Exception&)
+        {
+            xf.release();
+        }
+        // a model exported with a fixed batch size fails or returns fewer items, it is not batched again
+        if (xf.dims != 4 || xf.size[0] != count)
+        {
+            impls[0]->batchBackbone = false;
+            xf.release();
+        }
+    }
+
+    std::vector<Range> ranges(4, Range::all());
+    for (int i = 0; i < count; i++)
+    {
+        if (xf.empty())
+        {
+            impls[i]->locate(impls[i]->forwardBackbone(std::vector<Mat>(1, crops[i])), scales[i], boundingBoxes[i]);
+            continue;
+        }
+        ranges[0] = Range(i, i + 1);
+        impls[i]->locate(xf(ranges), scales[i], boundingBoxes[i]);
+    }
+}
+
 #else  // OPENCV_HAVE_DNN
 Ptr<TrackerNano> TrackerNano::create(const TrackerNano::Params& parameters)
 {
     CV_UNUSED(parameters);
     CV_Error(cv::Error::StsNotImplemented, "to use NanoTrack, the tracking module needs to be built with opencv_dnn !");
 }
+
+void TrackerNano::updateBatch(InputArray image, const std::vector<Ptr<TrackerNano> >& trackers, std::vector<Rect>& boundingBoxes)
+{
+    CV_UNUSED(image); CV_UNUSED(trackers); CV_UNUSED(boundingBoxes);
+    CV_Error(cv::Error::StsNotImplemented, "to use NanoTrack, the tracking module needs to be built with opencv_dnn !");
+}
 #endif  // OPENCV_HAVE_DNN
 }
@@ -41,10 +41,12 @@ class TrackerVitImpl : public TrackerVit
 {
 public:
     TrackerVitImpl(const TrackerVit::Params& parameters)
-        : params(parameters)
+        : batchNet(true), params(parameters)
     {
         net = dnn::readNet(params.net);
         CV_Assert(!net.empty());
+        // the template branch is computed once per init()
+        net.setInputConstant("template");
 
         net.setPreferableBackend(params.backend);
         net.setPreferableTarget(params.target);
@@ -54,7 +56,23 @@ public:
     bool update(InputArray image, Rect& boundingBox) CV_OVERRIDE;
     float getTrackingScore() CV_OVERRIDE;
 
+    // The steps of update(), the forward between them can be shared by several trackers.
+    void getSearchBlob(const Mat& frame, Mat& blob);
+    void setTemplate(const Mat& templ);
+    void setBatchTemplate(const std::vector<Mat>& templates);
+    void forward(const Mat& search, std::vector<Mat>& outs);
+    void locate(const Mat& confMap, const Mat& sizeMap, const Mat& offsetMap, Rect& boundingBox);
+    bool canShareNet(const TrackerVitImpl& other) const;
+
     Rect rect_last;
+    Mat templateBlob;
+    Mat netTemplate;  // the current template input of the net
+    // templates of the targets stacked into batchTemplate by the last updateBatch(), their
+    // references keep the data pointers unique while they are compared
+    std::vector<Mat> batchTemplates;
+    Mat batchTemplate;
+    // false once the net has failed on a batch of several targets, e.g. the model has a fixed batch size of 1
+    bool batchNet;
     float tracking_score;
 
     TrackerVit::Params params;
@@ -159,30 +177,59 @@ void TrackerVitImpl::init(InputArray image_, const Rect &boundingBox_)
     image = image_.getMat().clone();
     Mat crop;
     crop_image(image, crop, boundingBox_, 2);
-    Mat blob;
-    preprocess(crop, blob, templateSize);
-    net.setInput(blob, "template");
+    preprocess(crop, templateBlob, templateSize);
+    setTemplate(templateBlob);
     Size size(16, 16);
     hanningWindow = hann2d(size, true);
     rect_last = boundingBox_;
 }
 
-bool TrackerVitImpl::update(InputArray image_, Rect &boundingBoxRes)
+void TrackerVitImpl::getSearchBlob(const Mat& frame, Mat& blob)
 {
-    image = image_.getMat().clone();
+    image = frame;
     Mat crop;
     crop_image(image, crop, rect_last, 4);
-    Mat blob;
     preprocess(crop, blob, searchSize);
-    net.setInput(blob, "search");
+}
+
+void TrackerVitImpl::setTemplate(const Mat& templ)
+{
+    net.setInput(templ, "template");
+    netTemplate = templ;
+}
+
+void TrackerVitImpl::forward(const Mat& search, std::vector<Mat>& outs)
+{
+    net.setInput(search, "search");
     std::vector<String> outputName = {"output1", "output2", "output3"};
-    std::vector<Mat> outs;
     net.forward(outs, outputName);
     CV_Assert(outs.size() == 3);
+}
 
-    Mat conf_map = outs[0].reshape(0, {16, 16});
-    Mat size_map = outs[1].reshape(0, {2, 16, 16});
-    Mat offset_map = outs[2].reshape(0, {2, 16, 16});
+bool TrackerVitImpl::canShareNet(const TrackerVitImpl& other) const
+{
+    return params.net == other.params.net &&
+           params.backend == other.params.backend &&
+           params.target == other.params.target;
+}
+
+bool TrackerVitImpl::update(InputArray image_, Rect &boundingBoxRes)
+{
+    Mat blob;
+    getSearchBlob(image_.getMat().clone(), blob);
+    if (netTemplate.data != templateBlob.data)
+        setTemplate(templateBlob);
+    std::vector<Mat> outs;
+    forward(blob, outs);
+    locate(outs[0], outs[1], outs[2], boundingBoxRes);
+    return true;
+}
+
+void TrackerVitImpl::locate(const Mat& confMap, const Mat& sizeMap, const Mat& offsetMap, Rect &boundingBoxRes)
+{
+    Mat conf_map = confMap.reshape(0, {16, 16});
+    Mat size_map = sizeMap.reshape(0, {2, 16, 16});
+    Mat offset_map = offsetMap.reshape(0, {2, 16, 16});
 
     multiply(conf_map, hanningWindow, conf_map);
 
@@ -199,7 +246,6 @@ bool TrackerVitImpl::update(InputArray image_, Rect &boundingBoxRes)
     Rect finalres = returnfromcrop(cx - w / 2, cy - h / 2, w, h, rect_last);
     rect_last = finalres;
     boundingBoxRes = finalres;
-    return true;
 }
 
 float TrackerVitImpl::getTrackingScore()
@@ -212,11 +258,120 @@ Ptr<TrackerVit> TrackerVit::create(const TrackerVit::Params& parameters)
     return makePtr<TrackerVitImpl>(parameters);
 }
 
+// Concatenates 1xCxHxW blobs along the batch axis
+static Mat stackBlobs(const std::vector<Mat>& blobs)
+{
+    const Mat& first = blobs[0];
+    std::vector<int> shape(first.size.p, first.size.p + first.dims);
+    shape[0] = (int)blobs.size();
+    Mat batch(shape, first.type());
+
+    const size_t itemSize = first.total() * first.elemSize();
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        CV_Assert(blobs[i].isContinuous() && blobs[i].type() == first.type() && blobs[i].total() == first.total());
+        memcpy(batch.ptr() + i * itemSize, blobs[i].ptr(), itemSize);
+    }
+    return batch;
+}
+
+// The template is a constant input of the net, its branch is computed again whenever it is set,
+// so the stacked templates are set only if the targets or their templates have changed
+void TrackerVitImpl::setBatchTemplate(const std::vector<Mat>& templates)
+{
+    bool same = !batchTemplate.empty() && batchTemplates.size() == templates.size();
+    for (size_t i = 0; same && i < templates.size(); i++)
+        same = batchTemplates[i].data == templates[i].data;
+    if (!same)
+    {
+        batchTemplate = stackBlobs(templates);
+        batchTemplates = templates;
+    }
+    if (netTemplate.data != batchTemplate.data)
+        setTemplate(batchTemplate);
+}
+
+static Mat batchItem(const Mat& blob, int i)
+{
+    std::vector<Range> ranges(blob.dims, Range::all());
+    ranges[0] = Range(i, i + 1);
+    return blob(ranges);
+}
+
+void TrackerVit::updateBatch(InputArray image_, const std::vector<Ptr<TrackerVit> >& trackers, std::vector<Rect>& boundingBoxes)
+{
+    CV_INSTRUMENT_REGION();
+
+    const int count = (int)trackers.size();
+    boundingBoxes.resize(count);
+    if (count == 0)
+        return;
+
+    std::vector<TrackerVitImpl*> impls(count);
+    bool shared = true;
+    for (int i = 0; i < count; i++)
+    {
+        impls[i] = dynamic_cast<TrackerVitImpl*>(trackers[i].get());
+        CV_Assert(impls[i]);
+        shared = shared && impls[i]->canShareNet(*impls[0]);
+    }
+
+    Mat image = image_.getMat().clone();
+    if (!shared || count == 1 || !impls[0]->batchNet)
+    {
+        for (int i = 0; i < count; i++)
+            impls[i]->update(image, boundingBoxes[i]);
+        return;
+    }
+
+    // The template and the search region are both inputs of the network, so the pairs of all of
+    // the targets go through the net of the first tracker in one batch.
+    std::vector<Mat> templates(count), searches(count);
+    for (int i = 0; i < count; i++)
+    {
+        templates[i] = impls[i]->templateBlob;
+        impls[i]->getSearchBlob(image, searches[i]);
+    }
+
+    std::vector<Mat> outs;
+    try
+    {
+        impls[0]->setBatchTemplate(templates);
+        impls[0]->forward(stackBlobs(searches), outs);
+    }
+    catch (const cv::Exception&)
+    {
+        outs.clear();
+    }
+    // a model exported with a fixed batch size fails or returns fewer items, it is not batched again
+    bool batched = !outs.empty();
+    for (size_t k = 0; k < outs.size(); k++)
+        batched = batched && outs[k].size[0] == count;
+    if (!batched)
+    {
+        impls[0]->batchNet = false;
+        impls[0]->batchTemplates.clear();
+        impls[0]->batchTemplate.release();
+        for (int i = 0; i < count; i++)
+            impls[i]->update(image, boundingBoxes[i]);
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+        impls[i]->locate(batchItem(outs[0], i), batchItem(outs[1], i), batchItem(outs[2], i), boundingBoxes[i]);
+}
+
 #else  // OPENCV_HAVE_DNN
 Ptr<TrackerVit> TrackerVit::create(const TrackerVit::Params& parameters)
 {
     CV_UNUSED(parameters);
     CV_Error(Error::StsNotImplemented, "to use vittrack, the tracking module needs to be built with opencv_dnn !");
 }
+
+void TrackerVit::updateBatch(InputArray image, const std::vector<Ptr<TrackerVit> >& trackers, std::vector<Rect>& boundingBoxes)
+{
+    CV_UNUSED(image); CV_UNUSED(trackers); CV_UNUSED(boundingBoxes);
+    CV_Error(Error::StsNotImplemented, "to use vittrack, the tracking module needs to be built with opencv_dnn !");
+}
 #endif  // OPENCV_HAVE_DNN
 }
@@ -0,0 +1,234 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+static Mat makeBgfgFrame(const Mat& background, const Rect& object)
+{
+    Mat frame = background.clone();
+    if (!object.empty())
+        frame(object).setTo(Scalar(20, 230, 60));
+    return frame;
+}
+
+static Mat makeBgfgBackground()
+{
+    Mat background(120, 160, CV_8UC3);
+    RNG rng(7);
+    rng.fill(background, RNG::UNIFORM, 80, 160);
+    return background;
+}
+
+template<typename T>
+static void checkMaskedUpdate(const Ptr<T>& full, const Ptr<T>& masked)
+{
+    const Mat background = makeBgfgBackground();
+    const Rect roi(30, 20, 70, 60);
+    Mat updateMask(background.size(), CV_8U, Scalar::all(0));
+    updateMask(roi).setTo(Scalar::all(255));
+
+    Mat fgFull, fgMasked, fgRegions;
+    for (int i = 0; i < 30; i++)
+    {
+        const Mat frame = makeBgfgFrame(background, i < 20 ? Rect() : Rect(20 + 2 * i, 40, 30, 30));
+        theRNG().state = 12345;
+        full->apply(frame, fgFull);
+        theRNG().state = 12345;
+        if (i % 2)
+            masked->applyMasked(frame, updateMask, fgMasked);
+        else
+            masked->applyRegions(frame, std::vector<Rect>(1, roi), fgMasked);
+
+        ASSERT_EQ(0, cvtest::norm(fgFull(roi), fgMasked(roi), NORM_INF)) << "frame " << i;
+        fgMasked(roi).setTo(Scalar::all(0));
+        ASSERT_EQ(0, countNonZero(fgMasked)) << "frame " << i;
+    }
+}
+
+TEST(Video_BackgroundSubtractorMOG2, masked_update)
+{
+    checkMaskedUpdate(createBackgroundSubtractorMOG2(), createBackgroundSubtractorMOG2());
+}
+
+TEST(Video_BackgroundSubtractorKNN, masked_update)
+{
+    checkMaskedUpdate(createBackgroundSubtractorKNN(), createBackgroundSubtractorKNN());
+}
+
+TEST(Video_BackgroundSubtractorMOG2, masked_update_keeps_model)
+{
+    const Mat background = makeBgfgBackground();
+    Ptr<BackgroundSubtractorMOG2> mog2 = createBackgroundSubtractorMOG2();
+    Mat fgmask, bgImage;
+    mog2->apply(background, fgmask);
+
+    const Rect roi(0, 0, 80, 120);
+    Mat changed(background.size(), background.type(), Scalar::all(200));
+    for (int i = 0; i < 10; i++)
+        mog2->applyRegions(changed, std::vector<Rect>(1, roi), fgmask, 0.5);
+
+    mog2->getBackgroundImage(bgImage);
+    const Rect outside(80, 0, 80, 120);
+    EXPECT_EQ(0, cvtest::norm(bgImage(outside), background(outside), NORM_INF));
+    EXPECT_GE(10, cvtest::norm(bgImage(roi), changed(roi), NORM_INF));
+}
+
+template<typename T>
+static void checkCoarseToFine(const Ptr<T>& full, const Ptr<T>& coarse)
+{
+    coarse->setCoarseStep(4);
+    ASSERT_EQ(4, coarse->getCoarseStep());
+
+    const Mat background = makeBgfgBackground();
+    Mat fgFull, fgCoarse;
+    for (int i = 0; i < 60; i++)
+    {
+        const Mat frame = makeBgfgFrame(background, i < 50 ? Rect() : Rect(3 * i - 130, 40, 32, 32));
+        full->apply(frame, fgFull);
+        coarse->apply(frame, fgCoarse);
+        if (i < 50)
+            continue;
+
+        // every foreground area larger than the grid cell is found and refined at the full resolution
+        Mat diff = (fgFull == 255) != (fgCoarse == 255);
+        EXPECT_LE(countNonZero(diff), 0.01 * countNonZero(fgFull == 255)) << "frame " << i;
+        EXPECT_GT(countNonZero(fgCoarse == 255), 0) << "frame " << i;
+    }
+}
+
+TEST(Video_BackgroundSubtractorMOG2, coarse_to_fine)
+{
+    checkCoarseToFine(createBackgroundSubtractorMOG2(500, 16, false), createBackgroundSubtractorMOG2(500, 16, false));
+}
+
+typedef testing::TestWithParam<int> Video_BackgroundSubtractorMOG2_Compact;
+
+TEST_P(Video_BackgroundSubtractorMOG2_Compact, same_segmentation_as_float_model)
+{
+    const int cn = GetParam();
+    Ptr<BackgroundSubtractorMOG2> floatModel = createBackgroundSubtractorMOG2(100, 16, true);
+    Ptr<BackgroundSubtractorMOG2> compact = createBackgroundSubtractorMOG2(100, 16, true);
+    compact->setCompactModel(true);
+    ASSERT_TRUE(compact->getCompactModel());
+
+    // an odd width leaves a tail after the vectorized part of the rows
+    RNG rng(11);
+    Mat background(90, 157, CV_8UC(cn));
+    rng.fill(background, RNG::UNIFORM, 60, 200);
+    Mat fgFloat, fgCompact;
+    for (int i = 0; i < 60; i++)
+    {
+        Mat frame = background.clone(), noise(background.size(), background.type());
+        rng.fill(noise, RNG::NORMAL, 0, 4);
+        cv::add(frame, noise, frame);
+        if (i >= 40)
+        {
+            frame(Rect(3 * i - 100, 20, 30, 30)).setTo(Scalar::all(250));
+            frame(Rect(100, 50, 30, 30)) *= 0.7; // shadow
+        }
+        floatModel->apply(frame, fgFloat);
+        compact->apply(frame, fgCompact);
+        if (i < 40)
+            continue;
+
+        EXPECT_LE(countNonZero(fgFloat != fgCompact), 0.01 * frame.total()) << "frame " << i;
+        EXPECT_GT(countNonZero(fgCompact == 255), 0) << "frame " << i;
+    }
+
+    Mat bgFloat, bgCompact;
+    floatModel->getBackgroundImage(bgFloat);
+    compact->getBackgroundImage(bgCompact);
+    EXPECT_LE(cvtest::norm(bgFloat, bgCompact, NORM_INF), 2);
+}
+
+TEST_P(Video_BackgroundSubtractorMOG2_Compact, vectorized_same_as_per_pixel)
+{
+    const int cn = GetParam();
+    // the pixels are independent: a frame reshaped to a single column goes through the per-pixel update,
+    // the same frame reshaped to a single row through the vectorized one
+    Ptr<BackgroundSubtractorMOG2> rowModel = createBackgroundSubtractorMOG2(100, 16, true);
+    Ptr<BackgroundSubtractorMOG2> colModel = createBackgroundSubtractorMOG2(100, 16, true);
+    rowModel->setCompactModel(true);
+    colModel->setCompactModel(true);
+
+    RNG rng(11);
+    Mat background(48, 64, CV_8UC(cn));
+    rng.fill(background, RNG::UNIFORM, 60, 200);
+    Mat fgRow, fgCol;
+    int foreground = 0, shadows = 0;
+    for (int i = 0; i < 60; i++)
+    {
+        Mat frame = background.clone(), noise(background.size(), background.type());
+        rng.fill(noise, RNG::NORMAL, 0, 4);
+        cv::add(frame, noise, frame);
+        if (i >= 30)
+        {
+            frame(Rect(i - 30, 10, 16, 16)).setTo(Scalar::all(250));
+            frame(Rect(40, 30, 16, 12)) *= 0.7; // shadow
+        }
+        rowModel->apply(frame.reshape(0, 1), fgRow);
+        colModel->apply(frame.reshape(0, (int)frame.total()), fgCol);
+        ASSERT_EQ(0, cvtest::norm(fgRow.reshape(0, 1), fgCol.reshape(0, 1), NORM_INF)) << "frame " << i;
+        foreground += countNonZero(fgRow == 255);
+        shadows += countNonZero(fgRow == 127);
+    }
+    EXPECT_GT(foreground, 0);
+    EXPECT_GT(shadows, 0);
+
+    Mat bgRow, bgCol;
+    rowModel->getBackgroundImage(bgRow);
+    colModel->getBackgroundImage(bgCol);
+    EXPECT_EQ(0, cvtest::norm(bgRow.reshape(0, 1), bgCol.reshape(0, 1), NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Video_BackgroundSubtractorMOG2_Compact, testing::Values(1, 3));
+
+TEST(Video_BackgroundSubtractorMOG2, compact_model_parameters)
+{
+    Ptr<BackgroundSubtractorMOG2> mog2 = createBackgroundSubtractorMOG2();
+    Mat fgmask, gray(8, 8, CV_8UC1, Scalar::all(128));
+
+    // the compact model requires positive variances
+    mog2->setCompactModel(true);
+    mog2->setVarInit(-1);
+    EXPECT_THROW(mog2->apply(gray, fgmask), cv::Exception);
+    mog2->setVarInit(15);
+    mog2->setVarMax(0);
+    EXPECT_THROW(mog2->apply(gray, fgmask), cv::Exception);
+    mog2->setVarMax(75);
+    EXPECT_NO_THROW(mog2->apply(gray, fgmask));
+
+    // the compact model is limited to 8-bit frames
+    EXPECT_THROW(mog2->apply(Mat(8, 8, CV_32FC1, Scalar::all(0.5)), fgmask), cv::Exception);
+    mog2->setCompactModel(false);
+    EXPECT_NO_THROW(mog2->apply(Mat(8, 8, CV_32FC1, Scalar::all(0.5)), fgmask));
+
+    // variances beyond the range of the compact model
+    Ptr<BackgroundSubtractorMOG2> rowModel = createBackgroundSubtractorMOG2(100, 16, false);
+    Ptr<BackgroundSubtractorMOG2> colModel = createBackgroundSubtractorMOG2(100, 16, false);
+    rowModel->setCompactModel(true);
+    colModel->setCompactModel(true);
+    rowModel->setVarInit(400);
+    colModel->setVarInit(400);
+    rowModel->setVarMax(1000);
+    colModel->setVarMax(1000);
+    RNG rng(12);
+    Mat frame(16, 32, CV_8UC1), fgRow, fgCol;
+    for (int i = 0; i < 20; i++)
+    {
+        rng.fill(frame, RNG::UNIFORM, 0, 256);
+        rowModel->apply(frame.reshape(0, 1), fgRow);
+        colModel->apply(frame.reshape(0, (int)frame.total()), fgCol);
+        ASSERT_EQ(0, cvtest::norm(fgRow.reshape(0, 1), fgCol.reshape(0, 1), NORM_INF)) << "frame " << i;
+    }
+}
+
+TEST(Video_BackgroundSubtractorKNN, coarse_to_fine)
+{
+    checkCoarseToFine(createBackgroundSubtractorKNN(500, 400, false), createBackgroundSubtractorKNN(500, 400, false));
+}
+
+}} // namespace
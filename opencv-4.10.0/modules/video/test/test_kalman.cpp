@@ -109,5 +109,75 @@ void CV_KalmanTest::run( int )
 
 TEST(Video_Kalman, accuracy) { CV_KalmanTest test; test.safe_run(); }
 
+TEST(Video_BatchKalman, same_result_as_single_filters)
+{
+    const int count = 301, DP = 4, MP = 2, CP = 1;
+    RNG& rng = theRNG();
+
+    BatchKalmanFilter batch(count, DP, MP, CP);
+    batch.transitionMatrix = (Mat_<float>(DP, DP) << 1, 0, 1, 0,  0, 1, 0, 1,  0, 0, 1, 0,  0, 0, 0, 1);
+    batch.controlMatrix = (Mat_<float>(DP, CP) << 0, 0, 0.5f, 0.25f);
+    batch.measurementMatrix = (Mat_<float>(MP, DP) << 1, 0, 0, 0,  0, 1, 0, 0);
+    setIdentity(batch.processNoiseCov, Scalar::all(1e-2));
+    batch.measurementNoiseCov = (Mat_<float>(MP, MP) << 0.5f, 0.1f, 0.1f, 0.3f);
+
+    std::vector<KalmanFilter> singles(count);
+    for (int n = 0; n < count; n++)
+    {
+        KalmanFilter& kf = singles[n];
+        kf.init(DP, MP, CP, CV_32F);
+        batch.transitionMatrix.copyTo(kf.transitionMatrix);
+        batch.controlMatrix.copyTo(kf.controlMatrix);
+        batch.measurementMatrix.copyTo(kf.measurementMatrix);
+        batch.processNoiseCov.copyTo(kf.processNoiseCov);
+        batch.measurementNoiseCov.copyTo(kf.measurementNoiseCov);
+
+        Mat state(DP, 1, CV_32F), errorCov = Mat::eye(DP, DP, CV_32F) * (1 + n % 5);
+        rng.fill(state, RNG::UNIFORM, -10, 10);
+        state.copyTo(kf.statePost);
+        errorCov.copyTo(kf.errorCovPost);
+        batch.setTrack(n, state, errorCov);
+    }
+
+    Mat control(CP, count, CV_32F), measurement(MP, count, CV_32F);
+    Mat predictMask(1, count, CV_8U), correctMask(1, count, CV_8U);
+    for (int step = 0; step < 10; step++)
+    {
+        rng.fill(control, RNG::UNIFORM, -1, 1);
+        rng.fill(measurement, RNG::UNIFORM, -10, 10);
+        for (int n = 0; n < count; n++)
+        {
+            // some tracks are not updated at all, others miss the detection
+            predictMask.at<uchar>(n) = (n + step) % 7 != 0;
+            correctMask.at<uchar>(n) = predictMask.at<uchar>(n) && (n + 2 * step) % 3 != 0;
+        }
+
+        batch.predict(control, predictMask);
+        batch.correct(measurement, correctMask);
+
+        for (int n = 0; n < count; n++)
+        {
+            KalmanFilter& kf = singles[n];
+            if (predictMask.at<uchar>(n))
+                kf.predict(control.col(n).clone());
+            if (correctMask.at<uchar>(n))
+                kf.correct(measurement.col(n).clone());
+            Mat state, errorCov;
+            batch.getTrack(n, state, errorCov);
+            EXPECT_LE(cvtest::norm(state, kf.statePost, NORM_INF), 1e-3 * (1 + cvtest::norm(kf.statePost, NORM_INF)))
+                << "step=" << step << " track=" << n;
+            EXPECT_LE(cvtest::norm(errorCov, kf.errorCovPost, NORM_INF), 1e-4 * (1 + cvtest::norm(kf.errorCovPost, NORM_INF)))
+                << "step=" << step << " track=" << n;
+            if (correctMask.at<uchar>(n))
+            {
+                for (int i = 0; i < DP; i++)
+                    for (int j = 0; j < MP; j++)
+                        EXPECT_NEAR(kf.gain.at<float>(i, j), batch.gain.at<float>(i * MP + j, n), 1e-4)
+                            << "step=" << step << " track=" << n;
+            }
+        }
+    }
+}
+
 }} // namespace
 /* End of file. */
@@ -249,4 +249,96 @@ TEST(Video_OpticalFlowPyrLK, submat)
     ASSERT_NO_THROW(cv::calcOpticalFlowPyrLK(img1, img2, prev, next, status, error));
 }
 
+TEST(Video_OpticalFlowPyrLK, pyramid_cache)
+{
+    RNG rng(123123);
+    Mat noise(360, 640, CV_8UC1);
+    rng.fill(noise, RNG::UNIFORM, 0, 256);
+    Mat frame0, frame1;
+    GaussianBlur(noise, frame0, Size(9, 9), 2);
+    Mat shift = (Mat_<double>(2, 3) << 1, 0, 3.5, 0, 1, -2.25);
+    warpAffine(frame0, frame1, shift, frame0.size(), INTER_LINEAR, BORDER_REFLECT_101);
+
+    std::vector<Point2f> prev;
+    for (int i = 0; i < 50; ++i)
+        prev.push_back(Point2f((float)rng.uniform(40, 600), (float)rng.uniform(40, 320)));
+
+    Ptr<FramePyramidCache> cache = FramePyramidCache::create(Size(21, 21), 3, 2);
+    cache->addFrame(10, frame0);
+    cache->addFrame(11, frame1);
+
+    // users with different windows share the cache
+    Size winSizes[] = { Size(21, 21), Size(15, 15) };
+    for (int k = 0; k < 2; k++)
+    {
+        Ptr<SparsePyrLKOpticalFlow> lk = SparsePyrLKOpticalFlow::create(winSizes[k], 3);
+        std::vector<Point2f> next, nextCached;
+        std::vector<uchar> status, statusCached;
+        std::vector<float> err, errCached;
+        lk->calc(frame0, frame1, prev, next, status, err);
+        lk->calcWithCache(cache, 10, 11, prev, nextCached, statusCached, errCached);
+
+        ASSERT_EQ(next.size(), nextCached.size());
+        EXPECT_EQ(0, cvtest::norm(status, statusCached, NORM_INF));
+        EXPECT_LE(cvtest::norm(Mat(next).reshape(1), Mat(nextCached).reshape(1), NORM_INF), 1e-4);
+        EXPECT_LE(cvtest::norm(err, errCached, NORM_INF), 1e-4);
+        for (size_t i = 0; i < next.size(); i++)
+        {
+            if (status[i])
+            {
+                EXPECT_LE(cv::norm(next[i] - prev[i] - Point2f(3.5f, -2.25f)), 0.1) << i;
+            }
+        }
+    }
+
+    // the oldest frame is dropped
+    cache->addFrame(12, frame0);
+    std::vector<Mat> pyramid;
+    EXPECT_FALSE(cache->getPyramid(10, pyramid));
+    EXPECT_TRUE(cache->getPyramid(12, pyramid));
+    std::vector<Point2f> next;
+    std::vector<uchar> status;
+    Ptr<SparsePyrLKOpticalFlow> lk = SparsePyrLKOpticalFlow::create();
+    EXPECT_THROW(lk->calcWithCache(cache, 10, 11, prev, next, status), cv::Exception);
+
+    // the window of the cache is too small
+    lk->setWinSize(Size(31, 31));
+    EXPECT_THROW(lk->calcWithCache(cache, 11, 12, prev, next, status), cv::Exception);
+}
+
+TEST(Video_OpticalFlowPyrLK, repeated_calc_same_result)
+{
+    RNG rng(123123);
+    Mat noise(240, 320, CV_8UC1);
+    rng.fill(noise, RNG::UNIFORM, 0, 256);
+    Mat frame0, frame1;
+    GaussianBlur(noise, frame0, Size(9, 9), 2);
+    Mat shift = (Mat_<double>(2, 3) << 1, 0, 2.3, 0, 1, -1.7);
+    warpAffine(frame0, frame1, shift, frame0.size(), INTER_LINEAR, BORDER_REFLECT_101);
+
+    std::vector<Point2f> prev;
+    for (int i = 0; i < 50; ++i)
+        prev.push_back(Point2f((float)rng.uniform(30, 290), (float)rng.uniform(30, 210)));
+
+    // the termination criteria of the object are not changed by the calls
+    Ptr<SparsePyrLKOpticalFlow> lk = SparsePyrLKOpticalFlow::create(Size(21, 21), 3,
+            TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 30, 0.3));
+    std::vector<Point2f> next0;
+    std::vector<uchar> status0;
+    std::vector<float> err0;
+    lk->calc(frame0, frame1, prev, next0, status0, err0);
+    for (int k = 0; k < 3; k++)
+    {
+        std::vector<Point2f> next;
+        std::vector<uchar> status;
+        std::vector<float> err;
+        lk->calc(frame0, frame1, prev, next, status, err);
+        EXPECT_EQ(0.3, lk->getTermCriteria().epsilon);
+        ASSERT_EQ(next0.size(), next.size());
+        EXPECT_EQ(0, cvtest::norm(status0, status, NORM_INF)) << k;
+        EXPECT_EQ(0, cvtest::norm(Mat(next0).reshape(1), Mat(next).reshape(1), NORM_INF)) << k;
+        EXPECT_EQ(0, cvtest::norm(err0, err, NORM_INF)) << k;
+    }
+}
+
 }} // namespace
@@ -160,6 +160,80 @@ TEST(NanoTrack, accuracy_NanoTrack_V2)
     checkTrackingAccuracy(tracker, 0.69);
 }
 
+TEST(NanoTrack, updateBatch)
+{
+    std::string backbonePath = cvtest::findDataFile("dnn/onnx/models/nanotrack_backbone_sim_v2.onnx", false);
+    std::string neckheadPath = cvtest::findDataFile("dnn/onnx/models/nanotrack_head_sim_v2.onnx", false);
+
+    cv::TrackerNano::Params params;
+    params.backbone = backbonePath;
+    params.neckhead = neckheadPath;
+
+    Mat img0 = imread(findDataFile("tracking/bag/00000001.jpg"), 1);
+    std::vector<Rect> rois;
+    rois.push_back(Rect(325, 164, 100, 100));
+    rois.push_back(Rect(100, 200, 80, 60));
+
+    std::vector<Ptr<TrackerNano> > batched, single;
+    for (size_t i = 0; i < rois.size(); i++)
+    {
+        batched.push_back(TrackerNano::create(params));
+        batched.back()->init(img0, rois[i]);
+        single.push_back(TrackerNano::create(params));
+        single.back()->init(img0, rois[i]);
+    }
+
+    for (int frame = 2; frame <= 6; frame++)
+    {
+        Mat img = imread(findDataFile(cv::format("tracking/bag/%08d.jpg", frame)), 1);
+        std::vector<Rect> boxes;
+        TrackerNano::updateBatch(img, batched, boxes);
+        ASSERT_EQ(rois.size(), boxes.size());
+        for (size_t i = 0; i < rois.size(); i++)
+        {
+            Rect box;
+            ASSERT_TRUE(single[i]->update(img, box));
+            ASSERT_TRUE(checkIOU(boxes[i], box, 0.95)) << cv::format("Fail at img %d, target %d.", frame, (int)i);
+        }
+    }
+}
+
+TEST(vittrack, updateBatch)
+{
+    std::string model = cvtest::findDataFile("dnn/onnx/models/vitTracker.onnx", false);
+    cv::TrackerVit::Params params;
+    params.net = model;
+
+    Mat img0 = imread(findDataFile("tracking/bag/00000001.jpg"), 1);
+    std::vector<Rect> rois;
+    rois.push_back(Rect(325, 164, 100, 100));
+    rois.push_back(Rect(100, 200, 80, 60));
+
+    // the model may have a fixed batch size, the trackers are updated one by one then
+    std::vector<Ptr<TrackerVit> > batched, single;
+    for (size_t i = 0; i < rois.size(); i++)
+    {
+        batched.push_back(TrackerVit::create(params));
+        batched.back()->init(img0, rois[i]);
+        single.push_back(TrackerVit::create(params));
+        single.back()->init(img0, rois[i]);
+    }
+
+    for (int frame = 2; frame <= 6; frame++)
+    {
+        Mat img = imread(findDataFile(cv::format("tracking/bag/%08d.jpg", frame)), 1);
+        std::vector<Rect> boxes;
+        TrackerVit::updateBatch(img, batched, boxes);
+        ASSERT_EQ(rois.size(), boxes.size());
+        for (size_t i = 0; i < rois.size(); i++)
+        {
+            Rect box;
+            ASSERT_TRUE(single[i]->update(img, box));
+            ASSERT_TRUE(checkIOU(boxes[i], box, 0.95)) << cv::format("Fail at img %d, target %d.", frame, (int)i);
+        }
+    }
+}
+
 TEST(vittrack, accuracy_vittrack)
 {
     std::string model = cvtest::findDataFile("dnn/onnx/models/vitTracker.onnx");
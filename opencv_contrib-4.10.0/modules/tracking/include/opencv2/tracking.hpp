@@ -73,6 +73,8 @@ public:
         CV_PROP_RW float scale_step;
 
         CV_PROP_RW float psr_threshold; //!< we lost the target, if the psr is lower than this.
+        CV_PROP_RW bool use_real_dft; //!< store feature and filter spectra in the packed CCS format (see cv::dft), roughly halving the spectral work
+        CV_PROP_RW bool use_fp16_model; //!< store the filter and scale model spectra in half precision, computations stay in single precision
     };
 
     /** @brief Create CSRT tracker instance
@@ -122,6 +124,19 @@ public:
     */
     CV_WRAP virtual bool isTargetLost() const = 0;
 
+    /** @brief Stages of update(), the per-stage timings of TrackingStats are indexed by them */
+    enum Stage
+    {
+        STAGE_FEATURES = 0,     //!< patch extraction and feature computation
+        STAGE_RESPONSE = 1,     //!< correlation response of the filter
+        STAGE_SEGMENTATION = 2, //!< histogram update and segmentation of the filter mask
+        STAGE_ADMM = 3,         //!< ADMM optimization of the new filter
+        STAGE_FILTER = 4,       //!< channel weights and filter model update
+        STAGE_SCALE = 5,        //!< DSST scale estimation and scale model update
+        STAGE_TOTAL = 6,        //!< the whole update() call
+        STAGE_COUNT = 7
+    };
+
     /** @brief Get detailed tracking statistics
     @return Structure containing PSR statistics and success rates
     */
@@ -134,9 +149,49 @@ public:
         CV_PROP_RW int successful_frames;
         CV_PROP_RW int total_frames;
         CV_PROP_RW double success_rate;
+
+        // milliseconds per Stage, empty unless enabled by setStageTiming()
+        CV_PROP_RW std::vector<double> stage_last_ms; //!< the last update()
+        CV_PROP_RW std::vector<double> stage_p50_ms;  //!< median over the recent updates
+        CV_PROP_RW std::vector<double> stage_p90_ms;  //!< 90th percentile over the recent updates
+        CV_PROP_RW std::vector<double> stage_p99_ms;  //!< 99th percentile over the recent updates
     };
 
     CV_WRAP virtual TrackingStats getTrackingStats() const = 0;
+
+    /** @brief Enables the timing of the update() stages, reported by getTrackingStats()
+
+    The percentiles are computed over the same window of recent updates as the PSR statistics.
+    Enabling the timing resets the collected timings. The stages are also marked as trace regions,
+    see cv::utils::trace, regardless of this setting.
+    */
+    CV_WRAP virtual void setStageTiming(bool enable) = 0;
+
+    /** @brief Stores the complete state of an initialized tracker, including the learned model
+    @param fs storage opened for writing, the fields are written into the current map
+
+    The state is restored by readState() and the tracker continues exactly as the stored one would.
+    Open the storage with FileStorage::BASE64 to keep the matrices compact. The default implementation
+    throws Error::StsNotImplemented.
+    */
+    CV_WRAP virtual void writeState(FileStorage& fs) const;
+
+    /** @brief Restores the state stored by writeState(), the tracker does not need to be initialized
+    @param node map containing the state
+
+    If the state is invalid, an exception is thrown and the tracker is left unchanged.
+    */
+    CV_WRAP virtual void readState(const FileNode& node);
+
+    /** @brief Packs the complete tracker state into a raw buffer
+
+    The buffer is cheaper to produce than the FileStorage representation and is meant for frequent
+    checkpoints, it can be restored only by the same OpenCV version on the same platform.
+    */
+    CV_WRAP virtual void exportState(CV_OUT std::vector<uchar>& buffer) const;
+
+    /** @brief Restores the state packed by exportState() */
+    CV_WRAP virtual void importState(const std::vector<uchar>& buffer);
 };
 
 
@@ -199,6 +254,34 @@ public:
     // FIXIT use interface
     typedef void (*FeatureExtractorCallbackFN)(const Mat, const Rect, Mat&);
     virtual void setFeatureExtractor(FeatureExtractorCallbackFN callback, bool pca_func = false) = 0;
+
+    /** @brief Stores the complete state of an initialized tracker, including the learned model
+    @param fs storage opened for writing, the fields are written into the current map
+
+    The state is restored by readState() and the tracker continues exactly as the stored one would.
+    Open the storage with FileStorage::BASE64 to keep the matrices compact. The default implementation
+    throws Error::StsNotImplemented.
+    */
+    CV_WRAP virtual void writeState(FileStorage& fs) const;
+
+    /** @brief Restores the state stored by writeState(), the tracker does not need to be initialized
+    @param node map containing the state
+
+    If the state is invalid, an exception is thrown and the tracker is left unchanged.
+    The custom feature extractors are not a part of the state, they have to be set with
+    setFeatureExtractor() before the state is restored.
+    */
+    CV_WRAP virtual void readState(const FileNode& node);
+
+    /** @brief Packs the complete tracker state into a raw buffer
+
+    The buffer is cheaper to produce than the FileStorage representation and is meant for frequent
+    checkpoints, it can be restored only by the same OpenCV version on the same platform.
+    */
+    CV_WRAP virtual void exportState(CV_OUT std::vector<uchar>& buffer) const;
+
+    /** @brief Restores the state packed by exportState() */
+    CV_WRAP virtual void importState(const std::vector<uchar>& buffer);
 };
 
 
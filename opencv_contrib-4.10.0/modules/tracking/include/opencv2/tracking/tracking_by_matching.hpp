@@ -176,6 +176,18 @@ public:
     virtual std::vector<float> compute(const std::vector<cv::Mat> &descrs1,
                                        const std::vector<cv::Mat> &descrs2) = 0;
 
+    ///
+    /// \brief Computes distances between every pair of descriptors of two sets.
+    /// The default implementation calls compute() for each pair.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \param[out] distances CV_32F matrix of descrs1.size() rows and
+    /// descrs2.size() columns with the distances.
+    ///
+    virtual void computeMatrix(const std::vector<cv::Mat> &descrs1,
+                               const std::vector<cv::Mat> &descrs2,
+                               CV_OUT cv::Mat &distances);
+
     virtual ~IDescriptorDistance() {}
 };
 
@@ -209,6 +221,18 @@ public:
         const std::vector<cv::Mat> &descrs1,
         const std::vector<cv::Mat> &descrs2) override;
 
+    ///
+    /// \brief Computes distances between every pair of descriptors of two sets
+    /// with a single matrix product.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \param[out] distances CV_32F matrix of descrs1.size() rows and
+    /// descrs2.size() columns with the distances.
+    ///
+    void computeMatrix(const std::vector<cv::Mat> &descrs1,
+                       const std::vector<cv::Mat> &descrs2,
+                       CV_OUT cv::Mat &distances) override;
+
 private:
     cv::Size descriptor_size_;
 };
@@ -306,6 +330,11 @@ struct CV_EXPORTS TrackerParams {
                                    /// restricted by this parameter. If it is negative or zero, the max number of
                                    /// objects in track is not restricted.
 
+    float gating_thr;  ///< Track and detection are not associated if their shape,
+                       /// motion and time affinity is not greater than this
+                       /// threshold. The appearance distance is computed only for
+                       /// the pairs that pass it.
+
     ///
     /// Default constructor.
     ///
@@ -239,6 +239,26 @@ class CV_EXPORTS_W TrackerTLD : public cv::legacy::Tracker
     void write( FileStorage& /*fs*/ ) const;
   };
 
+  /** @brief Counters of the detector cascade for the last frame
+
+  Every scan window is rejected by the first stage it fails: the variance filter, the ensemble of ferns
+  or the nearest neighbour classifier.
+   */
+  struct CV_EXPORTS CascadeStats
+  {
+    CascadeStats() : windows(0), variance_rejected(0), ensemble_rejected(0), nn_rejected(0) {}
+    int windows;            //!< scan windows of all scales
+    int variance_rejected;  //!< windows rejected by the variance filter
+    int ensemble_rejected;  //!< windows rejected by the ensemble classifier
+    int nn_rejected;        //!< windows rejected by the nearest neighbour classifier
+  };
+
+  /** @brief Returns the detector cascade counters of the last update()
+
+  The default implementation returns zero counters.
+   */
+  virtual CascadeStats getCascadeStats() const;
+
   /** @brief Constructor
     @param parameters TLD parameters TrackerTLD::Params
      */
@@ -411,6 +431,119 @@ protected:
   std::vector<Rect2d> objects;
 };
 
+/** @brief Batched multi-target CSRT tracker.
+
+* Unlike %MultiTracker, which calls every tracker independently, %MultiTrackerCSRT shares per-frame work
+* across all of its targets: the input frame is converted to BGR once per update, and the ADMM filter
+* optimization of all targets runs as a single parallel loop over targets x feature channels. If
+* segmentation is enabled, each target converts to HSV only the region of the frame around it which is
+* read by its histograms. All targets share the same TrackerCSRT::Params.
+*/
+class CV_EXPORTS_W MultiTrackerCSRT : public Algorithm
+{
+protected:
+  MultiTrackerCSRT();  // use ::create()
+public:
+  virtual ~MultiTrackerCSRT() CV_OVERRIDE;
+
+  /**
+  * \brief Add a new object to be tracked.
+  *
+  * @param image input image
+  * @param boundingBox a rectangle represents ROI of the tracked object
+  * @return false if the image is empty or the box is empty or outside of the image, the object is not added then
+  */
+  CV_WRAP virtual bool add(InputArray image, const Rect2d& boundingBox) = 0;
+
+  /**
+  * \brief Update the current tracking status.
+  * The result will be saved in the internal storage.
+  * @param image input image
+  * @return true if all of the targets were located in the current frame
+  */
+  virtual bool update(InputArray image) = 0;
+
+  /**
+  * \brief Update the current tracking status.
+  * @param image input image
+  * @param boundingBox the tracking result, represent a list of ROIs of the tracked objects.
+  * @return true if all of the targets were located in the current frame
+  */
+  CV_WRAP virtual bool update(InputArray image, CV_OUT std::vector<Rect2d> & boundingBox) = 0;
+
+  /**
+  * \brief Returns a reference to a storage for the tracked objects
+  */
+  CV_WRAP virtual const std::vector<Rect2d>& getObjects() const = 0;
+
+  /**
+  * \brief Returns the per-target result of the last update (true if the target was located)
+  */
+  virtual const std::vector<bool>& getStatus() const = 0;
+
+  /**
+  * \brief Returns a pointer to a new instance of MultiTrackerCSRT
+  * @param parameters CSRT parameters shared by all of the targets
+  */
+  CV_WRAP static Ptr<MultiTrackerCSRT> create(const cv::tracking::TrackerCSRT::Params &parameters = cv::tracking::TrackerCSRT::Params());
+};
+
+/** @brief Multi-target Median Flow tracker.
+
+* The input frame is converted to gray and its optical flow pyramid is built once per update for all
+* of the targets, and the pyramid is kept as the previous frame of the next update instead of being
+* rebuilt. The targets are tracked in parallel and share the same TrackerMedianFlow::Params.
+*/
+class CV_EXPORTS_W MultiTrackerMedianFlow : public Algorithm
+{
+protected:
+  MultiTrackerMedianFlow();  // use ::create()
+public:
+  virtual ~MultiTrackerMedianFlow() CV_OVERRIDE;
+
+  /**
+  * \brief Add a new object to be tracked.
+  *
+  * @param image input image
+  * @param boundingBox a rectangle represents ROI of the tracked object
+  */
+  CV_WRAP virtual bool add(InputArray image, const Rect2d& boundingBox) = 0;
+
+  /**
+  * \brief Update the current tracking status.
+  * The result will be saved in the internal storage.
+  * @param image input image
+  * @return true if all of the targets were located in the current frame
+  */
+  virtual bool update(InputArray image) = 0;
+
+  /**
+  * \brief Update the current tracking status.
+  * @param image input image
+  * @param boundingBox the tracking result, represent a list of ROIs of the tracked objects.
+  * @return true if all of the targets were located in the current frame
+  */
+  CV_WRAP virtual bool update(InputArray image, CV_OUT std::vector<Rect2d> & boundingBox) = 0;
+
+  /**
+  * \brief Returns a reference to a storage for the tracked objects
+  */
+  CV_WRAP virtual const std::vector<Rect2d>& getObjects() const = 0;
+
+  /**
+  * \brief Returns the per-target result of the last update (true if the target was located)
+  */
+  virtual const std::vector<bool>& getStatus() const = 0;
+
+  /**
+  * \brief Returns a pointer to a new instance of MultiTrackerMedianFlow
+  * @param parameters Median Flow parameters shared by all of the targets
+  */
+  static Ptr<MultiTrackerMedianFlow> create(const TrackerMedianFlow::Params &parameters);
+
+  CV_WRAP static Ptr<MultiTrackerMedianFlow> create();
+};
+
 /************************************ Multi-Tracker Classes ---By Tyan Vladimir---************************************/
 
 /** @brief Base abstract class for the long-term Multi Object Trackers:
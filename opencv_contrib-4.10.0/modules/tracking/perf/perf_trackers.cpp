@@ -99,4 +99,48 @@ PERF_TEST_P(Tracking, TLD, testing::ValuesIn(getTrackingParams()))
     runTrackingTest(tracker, GetParam());
 }
 
+PERF_TEST_P(Tracking, CSRT, testing::ValuesIn(getTrackingParams()))
+{
+    auto tracker = TrackerCSRT::create();
+    runTrackingTest<Rect>(tracker, GetParam());
+}
+
+PERF_TEST_P(Tracking, CSRT_real_dft, testing::ValuesIn(getTrackingParams()))
+{
+    TrackerCSRT::Params params;
+    params.use_real_dft = true;
+    auto tracker = TrackerCSRT::create(params);
+    runTrackingTest<Rect>(tracker, GetParam());
+}
+
+PERF_TEST_P(Tracking, CSRT_fp16_model, testing::ValuesIn(getTrackingParams()))
+{
+    TrackerCSRT::Params params;
+    params.use_fp16_model = true;
+    auto tracker = TrackerCSRT::create(params);
+    runTrackingTest<Rect>(tracker, GetParam());
+}
+
+// Large targets, where the DSST scale samples are a noticeable part of the update
+typedef perf::TestBaseWithParam<int> CSRT_ScaleSearch;
+
+PERF_TEST_P(CSRT_ScaleSearch, update, testing::Values(64, 128, 256))
+{
+    const int target_size = GetParam();
+    Mat frame(720, 1280, CV_8UC3);
+    RNG rng(0x5ca1e);
+    rng.fill(frame, RNG::UNIFORM, Scalar::all(0), Scalar::all(255));
+    GaussianBlur(frame, frame, Size(7, 7), 0);
+    Rect target((frame.cols - target_size) / 2, (frame.rows - target_size) / 2, target_size, target_size);
+
+    Ptr<TrackerCSRT> tracker = TrackerCSRT::create();
+    tracker->init(frame, target);
+    Rect box;
+    declare.in(frame);
+
+    TEST_CYCLE() tracker->update(frame, box);
+
+    SANITY_CHECK_NOTHING();
+}
+
 }} // namespace
@@ -46,6 +46,72 @@ std::vector<size_t> KuhnMunkres::Solve(const cv::Mat& dissimilarity_matrix) {
     return results;
 }
 
+static int FindRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+std::vector<size_t> KuhnMunkres::SolveSparse(const cv::Mat& dissimilarity_matrix, float max_val) {
+    CV_Assert(dissimilarity_matrix.type() == CV_32F);
+    const int rows = dissimilarity_matrix.rows;
+    const int cols = dissimilarity_matrix.cols;
+
+    // Rows are the nodes [0, rows), columns are the nodes [rows, rows + cols).
+    std::vector<int> parent(rows + cols);
+    for (int i = 0; i < rows + cols; i++) {
+        parent[i] = i;
+    }
+    for (int i = 0; i < rows; i++) {
+        const auto ptr = dissimilarity_matrix.ptr<float>(i);
+        for (int j = 0; j < cols; j++) {
+            if (ptr[j] < max_val) {
+                parent[FindRoot(parent, i)] = FindRoot(parent, rows + j);
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> group_rows(rows + cols), group_cols(rows + cols);
+    for (int i = 0; i < rows; i++) {
+        group_rows[FindRoot(parent, i)].push_back(i);
+    }
+    for (int j = 0; j < cols; j++) {
+        group_cols[FindRoot(parent, rows + j)].push_back(j);
+    }
+
+    std::vector<size_t> results(static_cast<size_t>(rows), static_cast<size_t>(-1));
+    for (int g = 0; g < rows + cols; g++) {
+        const auto& r = group_rows[g];
+        const auto& c = group_cols[g];
+        if (r.empty() || c.empty()) {
+            continue;
+        }
+        if (r.size() == 1 && c.size() == 1) {
+            results[r[0]] = c[0];
+            continue;
+        }
+
+        cv::Mat dm(static_cast<int>(r.size()), static_cast<int>(c.size()), CV_32F);
+        for (size_t i = 0; i < r.size(); i++) {
+            const auto src = dissimilarity_matrix.ptr<float>(r[i]);
+            auto dst = dm.ptr<float>(static_cast<int>(i));
+            for (size_t j = 0; j < c.size(); j++) {
+                dst[j] = src[c[j]];
+            }
+        }
+
+        auto res = Solve(dm);
+        for (size_t i = 0; i < r.size(); i++) {
+            if (res[i] < c.size() && dm.at<float>(static_cast<int>(i), static_cast<int>(res[i])) < max_val) {
+                results[r[i]] = c[res[i]];
+            }
+        }
+    }
+    return results;
+}
+
 void KuhnMunkres::TrySimpleCase() {
     auto is_row_visited = std::vector<int>(n_, 0);
     auto is_col_visited = std::vector<int>(n_, 0);
@@ -34,6 +34,19 @@ public:
     ///
     std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix);
 
+    ///
+    /// \brief Solves the assignment problem for a dissimilarity matrix in which
+    /// most of the pairs are not allowed (their dissimilarity is max_val).
+    /// Rows and columns are split into groups connected by the allowed pairs
+    /// and every group is solved separately, so the cost depends on the
+    /// group sizes rather than on the matrix size.
+    /// \param dissimilarity_matrix CV_32F dissimilarity matrix.
+    /// \param max_val Dissimilarity of the pairs that are not allowed.
+    /// \return Optimal column index for each row. -1 means that there is no
+    /// allowed column for row.
+    ///
+    std::vector<size_t> SolveSparse(const cv::Mat &dissimilarity_matrix, float max_val);
+
 private:
     static constexpr int kStar = 1;
     static constexpr int kPrime = 2;
@@ -52,6 +52,148 @@ public:
     }
 };
 
+typedef cv::tracking::impl::TrackerCSRTImpl CSRTTarget;
+
+class ParallelEstimateCSRTTargets : public ParallelLoopBody
+{
+public:
+    ParallelEstimateCSRTTargets(std::vector<Ptr<CSRTTarget> > &targets_, const Mat &image_,
+            std::vector<uchar> &found_) :
+        targets(targets_), image(image_), found(found_)
+    {}
+    virtual void operator ()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++) {
+            found[i] = targets[i]->estimate_target(image);
+            if (found[i])
+                targets[i]->prepare_filter_update(image);
+        }
+    }
+private:
+    std::vector<Ptr<CSRTTarget> > &targets;
+    const Mat &image;
+    std::vector<uchar> &found;
+};
+
+class ParallelUpdateCSRTFilterChannels : public ParallelLoopBody
+{
+public:
+    ParallelUpdateCSRTFilterChannels(std::vector<Ptr<CSRTTarget> > &targets_, const std::vector<Point> &jobs_) :
+        targets(targets_), jobs(jobs_)
+    {}
+    virtual void operator ()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++) {
+            targets[jobs[i].x]->compute_filter_update_channel(jobs[i].y);
+        }
+    }
+private:
+    std::vector<Ptr<CSRTTarget> > &targets;
+    const std::vector<Point> &jobs;
+};
+
+class ParallelFinishCSRTTargets : public ParallelLoopBody
+{
+public:
+    ParallelFinishCSRTTargets(std::vector<Ptr<CSRTTarget> > &targets_, const Mat &image_,
+            const std::vector<uchar> &found_, std::vector<Rect2d> &objects_) :
+        targets(targets_), image(image_), found(found_), objects(objects_)
+    {}
+    virtual void operator ()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++) {
+            if (!found[i])
+                continue;
+            Rect bb;
+            targets[i]->finish_filter_update(image, bb);
+            objects[i] = bb;
+        }
+    }
+private:
+    std::vector<Ptr<CSRTTarget> > &targets;
+    const Mat &image;
+    const std::vector<uchar> &found;
+    std::vector<Rect2d> &objects;
+};
+
+class MultiTrackerCSRTImpl CV_FINAL : public legacy::MultiTrackerCSRT
+{
+public:
+    MultiTrackerCSRTImpl(const cv::tracking::TrackerCSRT::Params &parameters)
+        : params(parameters)
+    {}
+
+    bool add(InputArray image, const Rect2d& boundingBox) CV_OVERRIDE
+    {
+        // the target is added only if it can be initialized on the frame
+        if (image.empty())
+            return false;
+        Size size = image.size();
+        Rect2d frame(0, 0, size.width, size.height);
+        if (boundingBox.width <= 0 || boundingBox.height <= 0 || (boundingBox & frame).area() <= 0)
+            return false;
+
+        Ptr<CSRTTarget> target = makePtr<CSRTTarget>(params);
+        target->init(image, boundingBox);
+        targets.push_back(target);
+        objects.push_back(boundingBox);
+        status.push_back(true);
+        return true;
+    }
+
+    bool update(InputArray image_) CV_OVERRIDE
+    {
+        if (targets.empty())
+            return true;
+
+        // per-frame work shared by all targets
+        Mat image = CSRTTarget::prepare_frame(image_);
+
+        const int ntargets = static_cast<int>(targets.size());
+        found.assign(targets.size(), 0);
+        parallel_for_(Range(0, ntargets), ParallelEstimateCSRTTargets(targets, image, found));
+
+        // ADMM optimization of all (target, channel) pairs in a single parallel region
+        std::vector<Point> jobs;
+        for (int i = 0; i < ntargets; i++) {
+            if (!found[i])
+                continue;
+            for (int c = 0; c < targets[i]->filter_update_channels(); c++)
+                jobs.push_back(Point(i, c));
+        }
+        parallel_for_(Range(0, static_cast<int>(jobs.size())), ParallelUpdateCSRTFilterChannels(targets, jobs));
+
+        parallel_for_(Range(0, ntargets), ParallelFinishCSRTTargets(targets, image, found, objects));
+
+        status.assign(found.begin(), found.end());
+        return std::find(found.begin(), found.end(), 0) == found.end();
+    }
+
+    bool update(InputArray image, std::vector<Rect2d> & boundingBox) CV_OVERRIDE
+    {
+        bool res = update(image);
+        boundingBox = objects;
+        return res;
+    }
+
+    const std::vector<Rect2d>& getObjects() const CV_OVERRIDE
+    {
+        return objects;
+    }
+
+    const std::vector<bool>& getStatus() const CV_OVERRIDE
+    {
+        return status;
+    }
+
+protected:
+    cv::tracking::TrackerCSRT::Params params;
+    std::vector<Ptr<CSRTTarget> > targets;
+    std::vector<Rect2d> objects;
+    std::vector<bool> status;
+    std::vector<uchar> found;
+};
+
 }  // namespace
 
 void legacy::TrackerCSRT::Params::read(const FileNode& fn)
@@ -111,6 +253,10 @@ void legacy::TrackerCSRT::Params::read(const FileNode& fn)
         fn["histogram_lr"] >> histogram_lr;
     if(!fn["psr_threshold"].empty())
         fn["psr_threshold"] >> psr_threshold;
+    if(!fn["use_real_dft"].empty())
+        fn["use_real_dft"] >> use_real_dft;
+    if(!fn["use_fp16_model"].empty())
+        fn["use_fp16_model"] >> use_fp16_model;
     CV_Assert(number_of_scales % 2 == 1);
     CV_Assert(use_gray || use_color_names || use_hog || use_rgb);
 }
@@ -143,6 +289,8 @@ void legacy::TrackerCSRT::Params::write(FileStorage& fs) const
     fs << "background_ratio" << background_ratio;
     fs << "histogram_lr" << histogram_lr;
     fs << "psr_threshold" << psr_threshold;
+    fs << "use_real_dft" << use_real_dft;
+    fs << "use_fp16_model" << use_fp16_model;
 }
 
 }}  // namespace
@@ -156,4 +304,19 @@ Ptr<legacy::TrackerCSRT> legacy::TrackerCSRT::create()
     return create(legacy::TrackerCSRT::Params());
 }
 
+legacy::MultiTrackerCSRT::MultiTrackerCSRT()
+{
+    // nothing
+}
+
+legacy::MultiTrackerCSRT::~MultiTrackerCSRT()
+{
+    // nothing
+}
+
+Ptr<legacy::MultiTrackerCSRT> legacy::MultiTrackerCSRT::create(const cv::tracking::TrackerCSRT::Params &parameters)
+{
+    return makePtr<legacy::tracking::impl::MultiTrackerCSRTImpl>(parameters);
+}
+
 }  // namespace
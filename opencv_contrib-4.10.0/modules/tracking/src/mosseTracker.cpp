@@ -16,6 +16,7 @@
 #include "precomp.hpp"
 
 #include "opencv2/tracking/tracking_legacy.hpp"
+#include "tracking_spectrums.hpp"
 
 namespace cv {
 inline namespace tracking {
@@ -43,35 +44,15 @@ protected:
     Mat hanWin;
     Mat G;          //goal
     Mat H, A, B;    //state
+    mutable DFTPlan dft_plan, idft_plan; // transforms of the window size
 
     //  Element-wise division of complex numbers in src1 and src2
     Mat divDFTs( const Mat &src1, const Mat &src2 ) const
     {
-        Mat c1[2],c2[2],a1,a2,s1,s2,denom,re,im;
-
-        // split into re and im per src
-        cv::split(src1, c1);
-        cv::split(src2, c2);
-
-        // (Re2*Re2 + Im2*Im2) = denom
-        //   denom is same for both channels
-        cv::multiply(c2[0], c2[0], s1);
-        cv::multiply(c2[1], c2[1], s2);
-        cv::add(s1, s2, denom);
-
-        // (Re1*Re2 + Im1*Im1)/(Re2*Re2 + Im2*Im2) = Re
-        cv::multiply(c1[0], c2[0], a1);
-        cv::multiply(c1[1], c2[1], a2);
-        cv::divide(a1+a2, denom, re, 1.0 );
-
-        // (Im1*Re2 - Re1*Im2)/(Re2*Re2 + Im2*Im2) = Im
-        cv::multiply(c1[1], c2[0], a1);
-        cv::multiply(c1[0], c2[1], a2);
-        cv::divide(a1+a2, denom, im, -1.0);
-
-        // Merge Re and Im back into a complex matrix
-        Mat dst, chn[] = {re,im};
-        cv::merge(chn, 2, dst);
+        // src2 is a power spectrum (its imaginary part is zero), so the result
+        // is the conjugated quotient
+        Mat dst;
+        tracking_internal::divSpectrums(src1, src2, dst, 0, true);
         return dst;
     }
 
@@ -95,9 +76,9 @@ protected:
     {
         Mat IMAGE_SUB, RESPONSE, response;
         // filter in dft space
-        dft(image_sub, IMAGE_SUB, DFT_COMPLEX_OUTPUT);
+        dft_plan.execute(image_sub, IMAGE_SUB);
         mulSpectrums(IMAGE_SUB, H, RESPONSE, 0, true );
-        idft(RESPONSE, response, DFT_SCALE|DFT_REAL_OUTPUT);
+        idft_plan.execute(RESPONSE, response);
         // update center position
         double maxVal; Point maxLoc;
         minMaxLoc(response, 0, &maxVal, 0, &maxLoc);
@@ -158,6 +139,8 @@ protected:
         Mat window;
         getRectSubPix(img, size, center, window);
         createHanningWindow(hanWin, size, CV_32F);
+        dft_plan.create(size, CV_32FC1, DFT_COMPLEX_OUTPUT);
+        idft_plan.create(size, CV_32FC2, DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
 
         // goal
         Mat g=Mat::zeros(size,CV_32F);
@@ -166,7 +149,7 @@ protected:
         double maxVal;
         minMaxLoc(g, 0, &maxVal);
         g = g / maxVal;
-        dft(g, G, DFT_COMPLEX_OUTPUT);
+        dft_plan.execute(g, G);
 
         // initial A,B and H
         A = Mat::zeros(G.size(), G.type());
@@ -177,7 +160,7 @@ protected:
             preProcess(window_warp);
 
             Mat WINDOW_WARP, A_i, B_i;
-            dft(window_warp, WINDOW_WARP, DFT_COMPLEX_OUTPUT);
+            dft_plan.execute(window_warp, WINDOW_WARP);
             mulSpectrums(G          , WINDOW_WARP, A_i, 0, true);
             mulSpectrums(WINDOW_WARP, WINDOW_WARP, B_i, 0, true);
             A+=A_i;
@@ -216,7 +199,7 @@ protected:
 
         // new state for A and B
         Mat F, A_new, B_new;
-        dft(img_sub_new, F, DFT_COMPLEX_OUTPUT);
+        dft_plan.execute(img_sub_new, F);
         mulSpectrums(G, F, A_new, 0, true );
         mulSpectrums(F, F, B_new, 0, true );
 
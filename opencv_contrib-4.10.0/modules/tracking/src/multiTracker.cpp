@@ -294,32 +294,13 @@ namespace impl {
 		blurred_imgs.push_back(imgBlurred);
 		do
 		{
-			Mat_<double> intImgP, intImgP2;
-			tld::TLDDetector::computeIntegralImages(resized_imgs[scaleID], intImgP, intImgP2);
-			for (int i = 0, imax = cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx); i < imax; i++)
+			Mat_<double> variances;
+			tld::TLDDetector::windowVariances(resized_imgs[scaleID], initSize, dx, dy, variances);
+			for (int i = 0; i < variances.cols; i++)
 			{
-				for (int j = 0, jmax = cvFloor((0.0 + resized_imgs[scaleID].rows - initSize.height) / dy); j < jmax; j++)
+				for (int j = 0; j < variances.rows; j++)
 				{
-					//Optimized variance calculation
-					int x = dx * i,
-						y = dy * j,
-						width = initSize.width,
-						height = initSize.height;
-					double p = 0, p2 = 0;
-					double A, B, C, D;
-
-					A = intImgP(y, x);
-					B = intImgP(y, x + width);
-					C = intImgP(y + height, x);
-					D = intImgP(y + height, x + width);
-					p = (A + D - B - C) / (width * height);
-
-					A = intImgP2(y, x);
-					B = intImgP2(y, x + width);
-					C = intImgP2(y + height, x);
-					D = intImgP2(y + height, x + width);
-					p2 = (A + D - B - C) / (width * height);
-					double windowVar = p2 - p * p;
+					double windowVar = variances(j, i);
 
 					//Loop for on all objects
 					for (int k = 0; k < (int)trackers.size(); k++)
@@ -330,7 +311,6 @@ namespace impl {
 						//TLD Model Extraction
 						tldModel = ((tld::TrackerTLDModel*)static_cast<TrackerModel*>(tracker->getModel()));
 
-						//Optimized variance calculation
 						bool varPass = (windowVar > tld::VARIANCE_THRESHOLD * *tldModel->detector->originalVariancePtr);
 
 						if (!varPass)
@@ -349,7 +329,8 @@ namespace impl {
 			blurred_imgs.push_back(tmp);
 		} while (size.width >= initSize.width && size.height >= initSize.height);
 
-		//Encsemble classification
+		//Encsemble classification, the windows of one scale are classified at once
+		std::vector<double> ensProbabilities;
 		for (int k = 0; k < (int)trackers.size(); k++)
 		{
 			//TLD Tracker data extraction
@@ -358,33 +339,18 @@ namespace impl {
 			//TLD Model Extraction
 			tldModel = ((tld::TrackerTLDModel*)static_cast<TrackerModel*>(tracker->getModel()));
 
-
-			for (int i = 0; i < (int)varBuffer[k].size(); i++)
+			const int numOfWindows = (int)varBuffer[k].size();
+			ensProbabilities.resize(numOfWindows);
+			for (int begin = 0, end = 0; begin < numOfWindows; begin = end)
 			{
-				tldModel->detector->prepareClassifiers(static_cast<int> (blurred_imgs[varScaleIDs[k][i]].step[0]));
-
-				double ensRes = 0;
-				uchar* data = &blurred_imgs[varScaleIDs[k][i]].at<uchar>(varBuffer[k][i].y, varBuffer[k][i].x);
-				for (int x = 0; x < (int)tldModel->detector->classifiers.size(); x++)
-				{
-					int position = 0;
-					for (int n = 0; n < (int)tldModel->detector->classifiers[x].measurements.size(); n++)
-					{
-						position = position << 1;
-						if (data[tldModel->detector->classifiers[x].offset[n].x] < data[tldModel->detector->classifiers[x].offset[n].y])
-							position++;
-					}
-					double posNum = (double)tldModel->detector->classifiers[x].posAndNeg[position].x;
-					double negNum = (double)tldModel->detector->classifiers[x].posAndNeg[position].y;
-					if (posNum == 0.0 && negNum == 0.0)
-						continue;
-					else
-						ensRes += posNum / (posNum + negNum);
-				}
-				ensRes /= tldModel->detector->classifiers.size();
-				ensRes = tldModel->detector->ensembleClassifierNum(&blurred_imgs[varScaleIDs[k][i]].at<uchar>(varBuffer[k][i].y, varBuffer[k][i].x));
+				while (end < numOfWindows && varScaleIDs[k][end] == varScaleIDs[k][begin])
+					end++;
+				tldModel->detector->ensembleClassifierBatch(blurred_imgs[varScaleIDs[k][begin]], &varBuffer[k][begin], end - begin, &ensProbabilities[begin]);
+			}
 
-				if ( ensRes <= tld::ENSEMBLE_THRESHOLD)
+			for (int i = 0; i < numOfWindows; i++)
+			{
+				if (ensProbabilities[i] <= tld::ENSEMBLE_THRESHOLD)
 					continue;
 				ensBuffer[k].push_back(varBuffer[k][i]);
 				ensScaleIDs[k].push_back(varScaleIDs[k][i]);
@@ -479,32 +445,13 @@ namespace impl {
 		blurred_imgs.push_back(imgBlurred);
 		do
 		{
-			Mat_<double> intImgP, intImgP2;
-			tld::TLDDetector::computeIntegralImages(resized_imgs[scaleID], intImgP, intImgP2);
-			for (int i = 0, imax = cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx); i < imax; i++)
+			Mat_<double> variances;
+			tld::TLDDetector::windowVariances(resized_imgs[scaleID], initSize, dx, dy, variances);
+			for (int i = 0; i < variances.cols; i++)
 			{
-				for (int j = 0, jmax = cvFloor((0.0 + resized_imgs[scaleID].rows - initSize.height) / dy); j < jmax; j++)
+				for (int j = 0; j < variances.rows; j++)
 				{
-					//Optimized variance calculation
-					int x = dx * i,
-						y = dy * j,
-						width = initSize.width,
-						height = initSize.height;
-					double p = 0, p2 = 0;
-					double A, B, C, D;
-
-					A = intImgP(y, x);
-					B = intImgP(y, x + width);
-					C = intImgP(y + height, x);
-					D = intImgP(y + height, x + width);
-					p = (A + D - B - C) / (width * height);
-
-					A = intImgP2(y, x);
-					B = intImgP2(y, x + width);
-					C = intImgP2(y + height, x);
-					D = intImgP2(y + height, x + width);
-					p2 = (A + D - B - C) / (width * height);
-					double windowVar = p2 - p * p;
+					double windowVar = variances(j, i);
 
 					//Loop for on all objects
 					for (int k = 0; k < (int)trackers.size(); k++)
@@ -515,7 +462,6 @@ namespace impl {
 						//TLD Model Extraction
 						tldModel = ((tld::TrackerTLDModel*)static_cast<TrackerModel*>(tracker->getModel()));
 
-						//Optimized variance calculation
 						bool varPass = (windowVar > tld::VARIANCE_THRESHOLD * *tldModel->detector->originalVariancePtr);
 
 						if (!varPass)
@@ -534,7 +480,8 @@ namespace impl {
 			blurred_imgs.push_back(tmp);
 		} while (size.width >= initSize.width && size.height >= initSize.height);
 
-		//Encsemble classification
+		//Encsemble classification, the windows of one scale are classified at once
+		std::vector<double> ensProbabilities;
 		for (int k = 0; k < (int)trackers.size(); k++)
 		{
 			//TLD Tracker data extraction
@@ -543,33 +490,18 @@ namespace impl {
 			//TLD Model Extraction
 			tldModel = ((tld::TrackerTLDModel*)static_cast<TrackerModel*>(tracker->getModel()));
 
-
-			for (int i = 0; i < (int)varBuffer[k].size(); i++)
+			const int numOfWindows = (int)varBuffer[k].size();
+			ensProbabilities.resize(numOfWindows);
+			for (int begin = 0, end = 0; begin < numOfWindows; begin = end)
 			{
-				tldModel->detector->prepareClassifiers(static_cast<int> (blurred_imgs[varScaleIDs[k][i]].step[0]));
-
-				double ensRes = 0;
-				uchar* data = &blurred_imgs[varScaleIDs[k][i]].at<uchar>(varBuffer[k][i].y, varBuffer[k][i].x);
-				for (int x = 0; x < (int)tldModel->detector->classifiers.size(); x++)
-				{
-					int position = 0;
-					for (int n = 0; n < (int)tldModel->detector->classifiers[x].measurements.size(); n++)
-					{
-						position = position << 1;
-						if (data[tldModel->detector->classifiers[x].offset[n].x] < data[tldModel->detector->classifiers[x].offset[n].y])
-							position++;
-					}
-					double posNum = (double)tldModel->detector->classifiers[x].posAndNeg[position].x;
-					double negNum = (double)tldModel->detector->classifiers[x].posAndNeg[position].y;
-					if (posNum == 0.0 && negNum == 0.0)
-						continue;
-					else
-						ensRes += posNum / (posNum + negNum);
-				}
-				ensRes /= tldModel->detector->classifiers.size();
-				ensRes = tldModel->detector->ensembleClassifierNum(&blurred_imgs[varScaleIDs[k][i]].at<uchar>(varBuffer[k][i].y, varBuffer[k][i].x));
+				while (end < numOfWindows && varScaleIDs[k][end] == varScaleIDs[k][begin])
+					end++;
+				tldModel->detector->ensembleClassifierBatch(blurred_imgs[varScaleIDs[k][begin]], &varBuffer[k][begin], end - begin, &ensProbabilities[begin]);
+			}
 
-				if (ensRes <= tld::ENSEMBLE_THRESHOLD)
+			for (int i = 0; i < numOfWindows; i++)
+			{
+				if (ensProbabilities[i] <= tld::ENSEMBLE_THRESHOLD)
 					continue;
 				ensBuffer[k].push_back(varBuffer[k][i]);
 				ensScaleIDs[k].push_back(varScaleIDs[k][i]);
@@ -43,6 +43,7 @@
 
 #include "tldDetector.hpp"
 #include "tracking_utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv {
 inline namespace tracking {
@@ -65,6 +66,81 @@ namespace tld {
 			return p;
 		}
 
+		class EnsembleBatchParallelLoopBody : public cv::ParallelLoopBody
+		{
+		public:
+			EnsembleBatchParallelLoopBody(const std::vector<TLDEnsembleClassifier>& classifiers, const uchar* data, const int* offsets, double* p) :
+				classifiers_(classifiers), data_(data), offsets_(offsets), p_(p)
+			{
+			}
+
+			virtual void operator () (const cv::Range& r) const CV_OVERRIDE
+			{
+				for (int i = r.start; i < r.end; i++)
+					p_[i] = 0;
+
+				int i = r.start;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+				// the pixels of a measurement are gathered for as many windows as there are 8-bit lanes,
+				// the fern codes of these windows are built in two 16-bit vectors
+				const int vlanes = VTraits<v_uint8>::vlanes(), vlanes16 = VTraits<v_uint16>::vlanes();
+				ushort codes[VTraits<v_uint8>::max_nlanes];
+				const v_uint16 v_one = vx_setall_u16(1);
+				for (; i <= r.end - vlanes; i += vlanes)
+				{
+					const int* offs = offsets_ + i;
+					for (size_t k = 0; k < classifiers_.size(); k++)
+					{
+						const TLDEnsembleClassifier& classifier = classifiers_[k];
+						v_uint16 code0 = vx_setzero_u16(), code1 = vx_setzero_u16();
+						for (size_t n = 0; n < classifier.offset.size(); n++)
+						{
+							v_uint8 lt = v_lt(vx_lut(data_ + classifier.offset[n].x, offs), vx_lut(data_ + classifier.offset[n].y, offs));
+							v_uint16 lt0, lt1;
+							v_expand(lt, lt0, lt1);
+							code0 = v_add(v_shl<1>(code0), v_and(lt0, v_one));
+							code1 = v_add(v_shl<1>(code1), v_and(lt1, v_one));
+						}
+						v_store(codes, code0);
+						v_store(codes + vlanes16, code1);
+						for (int l = 0; l < vlanes; l++)
+							p_[i + l] += classifier.posteriorProbabilityOfCode(codes[l]);
+					}
+				}
+#endif
+				for (; i < r.end; i++)
+				{
+					for (size_t k = 0; k < classifiers_.size(); k++)
+						p_[i] += classifiers_[k].posteriorProbabilityFast(data_ + offsets_[i]);
+				}
+
+				for (i = r.start; i < r.end; i++)
+					p_[i] /= classifiers_.size();
+			}
+
+		private:
+			const std::vector<TLDEnsembleClassifier>& classifiers_;
+			const uchar* data_;
+			const int* offsets_;
+			double* p_;
+
+			EnsembleBatchParallelLoopBody(const EnsembleBatchParallelLoopBody&);
+			EnsembleBatchParallelLoopBody& operator= (const EnsembleBatchParallelLoopBody&);
+		};
+
+		// Calculate posterior probabilities of the windows of one image, same as ensembleClassifierNum() for each of them
+		void TLDDetector::ensembleClassifierBatch(const Mat& img, const Point* windows, int count, double* p)
+		{
+			CV_Assert(img.type() == CV_8UC1);
+			if (count <= 0)
+				return;
+			prepareClassifiers(static_cast<int> (img.step[0]));
+			std::vector<int> offsets(count);
+			for (int i = 0; i < count; i++)
+				offsets[i] = static_cast<int> (windows[i].y * img.step[0]) + windows[i].x;
+			cv::parallel_for_(cv::Range(0, count), EnsembleBatchParallelLoopBody(classifiers, img.data, &offsets[0], p));
+		}
+
         double TLDDetector::computeSminus(const Mat_<uchar>& patch) const
         {
             double sminus = 0.0;
@@ -360,57 +436,10 @@ namespace tld {
 		bool TLDDetector::detect(const Mat& img, const Mat& imgBlurred, Rect2d& res, std::vector<LabeledPatch>& patches, Size initSize)
 		{
 			patches.clear();
-			Mat tmp;
-			int dx = initSize.width / 10, dy = initSize.height / 10;
-			Size2d size = img.size();
 			double maxSc = -5.0;
 			Rect2d maxScRect;
-			int scaleID;
 
-			resized_imgs.clear ();
-			blurred_imgs.clear ();
-			varBuffer.clear ();
-			ensBuffer.clear ();
-			varScaleIDs.clear ();
-			ensScaleIDs.clear ();
-
-			//Detection part
-			//Generate windows and filter by variance
-			scaleID = 0;
-			resized_imgs.push_back(img);
-			blurred_imgs.push_back(imgBlurred);
-			do
-			{
-				Mat_<double> intImgP, intImgP2;
-				computeIntegralImages(resized_imgs[scaleID], intImgP, intImgP2);
-				for (int i = 0, imax = cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx); i < imax; i++)
-				{
-					for (int j = 0, jmax = cvFloor((0.0 + resized_imgs[scaleID].rows - initSize.height) / dy); j < jmax; j++)
-					{
-						if (!patchVariance(intImgP, intImgP2, originalVariancePtr, Point(dx * i, dy * j), initSize))
-							continue;
-						varBuffer.push_back(Point(dx * i, dy * j));
-						varScaleIDs.push_back(scaleID);
-					}
-				}
-				scaleID++;
-				size.width /= SCALE_STEP;
-				size.height /= SCALE_STEP;
-				resize(img, tmp, size, 0, 0, DOWNSCALE_MODE);
-				resized_imgs.push_back(tmp);
-				GaussianBlur(resized_imgs[scaleID], tmp, GaussBlurKernelSize, 0.0f);
-				blurred_imgs.push_back(tmp);
-			} while (size.width >= initSize.width && size.height >= initSize.height);
-
-			//Encsemble classification
-			for (int i = 0; i < (int)varBuffer.size(); i++)
-			{
-				prepareClassifiers(static_cast<int> (blurred_imgs[varScaleIDs[i]].step[0]));
-				if (ensembleClassifierNum(&blurred_imgs[varScaleIDs[i]].at<uchar>(varBuffer[i].y, varBuffer[i].x)) <= ENSEMBLE_THRESHOLD)
-					continue;
-				ensBuffer.push_back(varBuffer[i]);
-				ensScaleIDs.push_back(varScaleIDs[i]);
-			}
+			scanCascade(img, imgBlurred, initSize);
 
 			//Batch preparation
 			srValues.resize (ensBuffer.size());
@@ -450,6 +479,7 @@ namespace tld {
 
 				if (!labPatch.isObject)
 				{
+					cascadeCounters.nnRejected++;
 					continue;
 				}
 
@@ -474,53 +504,10 @@ namespace tld {
 		{
 			patches.clear();
 			Mat_<uchar> standardPatch(STANDARD_PATCH_SIZE, STANDARD_PATCH_SIZE);
-			Mat tmp;
-			int dx = initSize.width / 10, dy = initSize.height / 10;
-			Size2d size = img.size();
 			double maxSc = -5.0;
 			Rect2d maxScRect;
-			int scaleID;
-			std::vector <Mat> resized_imgs, blurred_imgs;
-			std::vector <Point> varBuffer, ensBuffer;
-			std::vector <int> varScaleIDs, ensScaleIDs;
 
-			//Detection part
-			//Generate windows and filter by variance
-			scaleID = 0;
-			resized_imgs.push_back(img);
-			blurred_imgs.push_back(imgBlurred);
-			do
-			{
-				Mat_<double> intImgP, intImgP2;
-				computeIntegralImages(resized_imgs[scaleID], intImgP, intImgP2);
-				for (int i = 0, imax = cvFloor((0.0 + resized_imgs[scaleID].cols - initSize.width) / dx); i < imax; i++)
-				{
-					for (int j = 0, jmax = cvFloor((0.0 + resized_imgs[scaleID].rows - initSize.height) / dy); j < jmax; j++)
-					{
-						if (!patchVariance(intImgP, intImgP2, originalVariancePtr, Point(dx * i, dy * j), initSize))
-							continue;
-						varBuffer.push_back(Point(dx * i, dy * j));
-						varScaleIDs.push_back(scaleID);
-					}
-				}
-				scaleID++;
-				size.width /= SCALE_STEP;
-				size.height /= SCALE_STEP;
-				resize(img, tmp, size, 0, 0, DOWNSCALE_MODE);
-				resized_imgs.push_back(tmp);
-				GaussianBlur(resized_imgs[scaleID], tmp, GaussBlurKernelSize, 0.0f);
-				blurred_imgs.push_back(tmp);
-			} while (size.width >= initSize.width && size.height >= initSize.height);
-
-			//Encsemble classification
-			for (int i = 0; i < (int)varBuffer.size(); i++)
-			{
-				prepareClassifiers((int)blurred_imgs[varScaleIDs[i]].step[0]);
-				if (ensembleClassifierNum(&blurred_imgs[varScaleIDs[i]].at<uchar>(varBuffer[i].y, varBuffer[i].x)) <= ENSEMBLE_THRESHOLD)
-					continue;
-				ensBuffer.push_back(varBuffer[i]);
-				ensScaleIDs.push_back(varScaleIDs[i]);
-			}
+			scanCascade(img, imgBlurred, initSize);
 
 			//NN classification
 			//Prepare batch of patches
@@ -561,6 +548,7 @@ namespace tld {
 
 				if (!labPatch.isObject)
 				{
+					cascadeCounters.nnRejected++;
 					continue;
 				}
 				scValue = resultSc[i];
@@ -578,29 +566,120 @@ namespace tld {
 		}
 #endif // HAVE_OPENCL
 
-		// Computes the variance of subimage given by box, with the help of two integral
-		// images intImgP and intImgP2 (sum of squares), which should be also provided.
-		bool TLDDetector::patchVariance(Mat_<double>& intImgP, Mat_<double>& intImgP2, double *originalVariance, Point pt, Size size)
+		// Generate the scan windows of all scales and keep the ones passing the variance filter and the ensemble classifier
+		void TLDDetector::scanCascade(const Mat& img, const Mat& imgBlurred, Size initSize)
+		{
+			Mat tmp;
+			int dx = initSize.width / 10, dy = initSize.height / 10;
+			Size2d size = img.size();
+			int scaleID;
+
+			resized_imgs.clear ();
+			blurred_imgs.clear ();
+			varBuffer.clear ();
+			ensBuffer.clear ();
+			varScaleIDs.clear ();
+			ensScaleIDs.clear ();
+			cascadeCounters = CascadeCounters();
+
+			//Generate windows and filter by variance
+			const double varianceThreshold = VARIANCE_THRESHOLD * *originalVariancePtr;
+			Mat_<double> variances;
+			scaleID = 0;
+			resized_imgs.push_back(img);
+			blurred_imgs.push_back(imgBlurred);
+			do
+			{
+				windowVariances(resized_imgs[scaleID], initSize, dx, dy, variances);
+				cascadeCounters.windows += (int)variances.total();
+				for (int i = 0; i < variances.cols; i++)
+				{
+					for (int j = 0; j < variances.rows; j++)
+					{
+						if (!(variances(j, i) > varianceThreshold))
+							continue;
+						varBuffer.push_back(Point(dx * i, dy * j));
+						varScaleIDs.push_back(scaleID);
+					}
+				}
+				scaleID++;
+				size.width /= SCALE_STEP;
+				size.height /= SCALE_STEP;
+				resize(img, tmp, size, 0, 0, DOWNSCALE_MODE);
+				resized_imgs.push_back(tmp);
+				GaussianBlur(resized_imgs[scaleID], tmp, GaussBlurKernelSize, 0.0f);
+				blurred_imgs.push_back(tmp);
+			} while (size.width >= initSize.width && size.height >= initSize.height);
+			cascadeCounters.varianceRejected = cascadeCounters.windows - (int)varBuffer.size();
+
+			//Encsemble classification, the windows of one scale are classified at once
+			const int numOfWindows = (int)varBuffer.size();
+			ensProbabilities.resize(numOfWindows);
+			for (int begin = 0, end = 0; begin < numOfWindows; begin = end)
+			{
+				while (end < numOfWindows && varScaleIDs[end] == varScaleIDs[begin])
+					end++;
+				ensembleClassifierBatch(blurred_imgs[varScaleIDs[begin]], &varBuffer[begin], end - begin, &ensProbabilities[begin]);
+			}
+			for (int i = 0; i < numOfWindows; i++)
+			{
+				if (ensProbabilities[i] <= ENSEMBLE_THRESHOLD)
+					continue;
+				ensBuffer.push_back(varBuffer[i]);
+				ensScaleIDs.push_back(varScaleIDs[i]);
+			}
+			cascadeCounters.ensembleRejected = numOfWindows - (int)ensBuffer.size();
+		}
+
+		// Computes the variances of the scan windows of the given size placed with steps dx, dy,
+		// variances(j, i) is the variance of the window at (dx * i, dy * j).
+		// Uses the integral image and the integral of squares, the corners of the windows of one row are gathered
+		// into SIMD lanes.
+		void TLDDetector::windowVariances(const Mat& img, Size size, int dx, int dy, Mat_<double>& variances)
 		{
-			int x = (pt.x), y = (pt.y), width = (size.width), height = (size.height);
-			CV_Assert(0 <= x && (x + width) < intImgP.cols && (x + width) < intImgP2.cols);
-			CV_Assert(0 <= y && (y + height) < intImgP.rows && (y + height) < intImgP2.rows);
-			double p = 0, p2 = 0;
-			double A, B, C, D;
-
-			A = intImgP(y, x);
-			B = intImgP(y, x + width);
-			C = intImgP(y + height, x);
-			D = intImgP(y + height, x + width);
-			p = (A + D - B - C) / (width * height);
-
-			A = intImgP2(y, x);
-			B = intImgP2(y, x + width);
-			C = intImgP2(y + height, x);
-			D = intImgP2(y + height, x + width);
-			p2 = (A + D - B - C) / (width * height);
-
-			return ((p2 - p * p) > VARIANCE_THRESHOLD * *originalVariance);
+			CV_Assert(dx > 0 && dy > 0);
+			const int imax = std::max(cvFloor((0.0 + img.cols - size.width) / dx), 0);
+			const int jmax = std::max(cvFloor((0.0 + img.rows - size.height) / dy), 0);
+			variances.create(jmax, imax);
+			if (variances.empty())
+				return;
+
+			Mat_<double> intImgP, intImgP2;
+			computeIntegralImages(img, intImgP, intImgP2);
+			const int width = size.width, height = size.height;
+			const double area = (double)(width * height);
+			std::vector<int> xs(imax);
+			for (int i = 0; i < imax; i++)
+				xs[i] = dx * i;
+
+			for (int j = 0; j < jmax; j++)
+			{
+				const int y = dy * j;
+				const double *p0 = intImgP[y], *p1 = intImgP[y + height];
+				const double *q0 = intImgP2[y], *q1 = intImgP2[y + height];
+				double* var = variances[j];
+				int i = 0;
+#if (CV_SIMD_64F || CV_SIMD_SCALABLE_64F)
+				const int vlanes = VTraits<v_float64>::vlanes();
+				const v_float64 v_area = vx_setall_f64(area);
+				for (; i <= imax - vlanes; i += vlanes)
+				{
+					const int* idx = &xs[i];
+					v_float64 p = v_div(v_sub(v_sub(v_add(vx_lut(p0, idx), vx_lut(p1 + width, idx)),
+					                                vx_lut(p0 + width, idx)), vx_lut(p1, idx)), v_area);
+					v_float64 p2 = v_div(v_sub(v_sub(v_add(vx_lut(q0, idx), vx_lut(q1 + width, idx)),
+					                                 vx_lut(q0 + width, idx)), vx_lut(q1, idx)), v_area);
+					v_store(var + i, v_sub(p2, v_mul(p, p)));
+				}
+#endif
+				for (; i < imax; i++)
+				{
+					const int x = xs[i];
+					double p = (p0[x] + p1[x + width] - p0[x + width] - p1[x]) / area;
+					double p2 = (q0[x] + q1[x + width] - q0[x + width] - q1[x]) / area;
+					var[i] = p2 - p * p;
+				}
+			}
 		}
 
 }}}}  // namespace
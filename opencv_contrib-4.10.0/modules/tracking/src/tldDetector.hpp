@@ -75,6 +75,7 @@ namespace tld {
 			TLDDetector(){}
 			~TLDDetector(){}
 			double ensembleClassifierNum(const uchar* data);
+			void ensembleClassifierBatch(const Mat& img, const Point* windows, int count, double* p);
 			void prepareClassifiers(int rowstep);
 			double Sr(const Mat_<uchar>& patch) const;
 			double Sc(const Mat_<uchar>& patch) const;
@@ -97,6 +98,15 @@ namespace tld {
 			std::vector <Mat> resized_imgs, blurred_imgs;
 			std::vector <Point> varBuffer, ensBuffer;
 			std::vector <int> varScaleIDs, ensScaleIDs;
+			std::vector <double> ensProbabilities;
+
+			// Windows of the last detection and the ones rejected by each stage of the cascade
+			struct CascadeCounters
+			{
+				CascadeCounters() : windows(0), varianceRejected(0), ensembleRejected(0), nnRejected(0) {}
+				int windows, varianceRejected, ensembleRejected, nnRejected;
+			};
+			CascadeCounters cascadeCounters;
 
 			static void generateScanGrid(int rows, int cols, Size initBox, std::vector<Rect2d>& res, bool withScaling = false);
 			struct LabeledPatch
@@ -106,10 +116,11 @@ namespace tld {
 			};
 			bool detect(const Mat& img, const Mat& imgBlurred, Rect2d& res, std::vector<LabeledPatch>& patches, Size initSize);
 			bool ocl_detect(const Mat& img, const Mat& imgBlurred, Rect2d& res, std::vector<LabeledPatch>& patches,  Size initSize);
+			void scanCascade(const Mat& img, const Mat& imgBlurred, Size initSize);
 
 			friend class MyMouseCallbackDEBUG;
 			static void computeIntegralImages(const Mat& img, Mat_<double>& intImgP, Mat_<double>& intImgP2){ integral(img, intImgP, intImgP2, CV_64F); }
-			static inline bool patchVariance(Mat_<double>& intImgP, Mat_<double>& intImgP2, double *originalVariance, Point pt, Size size);
+			static void windowVariances(const Mat& img, Size size, int dx, int dy, Mat_<double>& variances);
 
         protected:
             double computeSminus(const Mat_<uchar>& patch) const;
@@ -121,16 +121,14 @@ namespace tld {
 		// Calculate posterior probability on the patch
 		double TLDEnsembleClassifier::posteriorProbability(const uchar* data, int rowstep) const
 		{
-			int position = code(data, rowstep);
-			double posNum = (double)posAndNeg[position].x, negNum = (double)posAndNeg[position].y;
-			if (posNum == 0.0 && negNum == 0.0)
-				return 0.0;
-			else
-				return posNum / (posNum + negNum);
+			return posteriorProbabilityOfCode(code(data, rowstep));
 		}
 		double TLDEnsembleClassifier::posteriorProbabilityFast(const uchar* data) const
 		{
-			int position = codeFast(data);
+			return posteriorProbabilityOfCode(codeFast(data));
+		}
+		double TLDEnsembleClassifier::posteriorProbabilityOfCode(int position) const
+		{
 			double posNum = (double)posAndNeg[position].x, negNum = (double)posAndNeg[position].y;
 			if (posNum == 0.0 && negNum == 0.0)
 				return 0.0;
@@ -53,6 +53,7 @@ namespace tld {
 			void integrate(const Mat_<uchar>& patch, bool isPositive);
 			double posteriorProbability(const uchar* data, int rowstep) const;
 			double posteriorProbabilityFast(const uchar* data) const;
+			double posteriorProbabilityOfCode(int position) const;
 			void prepareClassifier(int rowstep);
 
 			TLDEnsembleClassifier(const std::vector<Vec4b>& meas, int beg, int end);
@@ -65,6 +65,11 @@ Ptr<TrackerTLD> TrackerTLD::create()
     return Ptr<tld::TrackerTLDImpl>(new tld::TrackerTLDImpl());
 }
 
+TrackerTLD::CascadeStats TrackerTLD::getCascadeStats() const
+{
+    return CascadeStats();
+}
+
 }}  // namespace
 
 inline namespace tracking {
@@ -250,6 +255,20 @@ bool TrackerTLDImpl::updateImpl(const Mat& image, Rect2d& boundingBox)
     return true;
 }
 
+TrackerTLD::CascadeStats TrackerTLDImpl::getCascadeStats() const
+{
+    CascadeStats stats;
+    if (!model)
+        return stats;
+    const TrackerTLDModel* tldModel = ((const TrackerTLDModel*)static_cast<TrackerModel*>(model));
+    const TLDDetector::CascadeCounters& counters = tldModel->detector->cascadeCounters;
+    stats.windows = counters.windows;
+    stats.variance_rejected = counters.varianceRejected;
+    stats.ensemble_rejected = counters.ensembleRejected;
+    stats.nn_rejected = counters.nnRejected;
+    return stats;
+}
+
 
 int TrackerTLDImpl::Pexpert::additionalExamples(std::vector<Mat_<uchar> >& examplesForModel, std::vector<Mat_<uchar> >& examplesForEnsemble)
 {
@@ -160,6 +160,7 @@ public:
 
 	bool initImpl(const Mat& image, const Rect2d& boundingBox) CV_OVERRIDE;
 	bool updateImpl(const Mat& image, Rect2d& boundingBox) CV_OVERRIDE;
+	CascadeStats getCascadeStats() const CV_OVERRIDE;
 
 	TrackerTLD::Params params;
 	Ptr<Data> data;
@@ -4,16 +4,53 @@
 // of this distribution and at http://opencv.org/license.html.
 
 #include "precomp.hpp"
+#include "opencv2/core/utils/trace.hpp"
 
 #include "trackerCSRTSegmentation.hpp"
 #include "trackerCSRTUtils.hpp"
 #include "trackerCSRTScaleEstimation.hpp"
+#include "tracking_spectrums.hpp"
+#include "tracking_features.hpp"
+#include "tracking_state.hpp"
 #include <deque>
 
 namespace cv {
 inline namespace tracking {
 namespace impl {
 
+/**
+* \brief Per-channel buffers of the ADMM filter optimization, reused between frames
+*/
+struct CSRFilterWorkspace
+{
+    Mat Sxy, Sxx;   // cross- and auto-correlation spectra of the features
+    Mat num;        // scratch spectrum
+    Mat G, L, H;    // unconstrained filter, Lagrangian multiplier and constrained filter
+    Mat h;          // spatial domain filter
+    DFTPlan dft_plan, idft_plan;
+};
+
+/**
+* \brief Adds the duration of its scope to one of the update stage times, if the times are given
+*/
+class StageTimer
+{
+public:
+    StageTimer(double *times_, int stage_) :
+        times(times_), stage(stage_), start(times_ ? getTickCount() : 0) {}
+    ~StageTimer() { stop(); }
+    void stop()
+    {
+        if(times)
+            times[stage] += (getTickCount() - start) * 1000.0 / getTickFrequency();
+        times = NULL;
+    }
+private:
+    double *times;
+    int stage;
+    int64 start;
+};
+
 /**
 * \brief Implementation of TrackerModel for CSRT algorithm
 */
@@ -46,23 +83,48 @@ public:
     bool getTargetLostStatus() const { return target_lost_; }
     void updatePSRTracking(const Mat& image);
 
+    // Staged update API, shared by update() and legacy::MultiTrackerCSRT.
+    // The image is expected to be BGR.
+    static Mat prepare_frame(InputArray image);
+    bool estimate_target(const Mat &image);
+    void prepare_filter_update(const Mat &image);
+    int filter_update_channels() const { return static_cast<int>(feature_spectra.size()); }
+    void compute_filter_update_channel(int channel);
+    void finish_filter_update(const Mat &image, Rect &boundingBox);
+
+    // Complete state of an initialized tracker, used by TrackerCSRTV2 to write and to restore it.
+    // The const overload only writes the state.
+    void serialize_state(tracking_internal::StateArchive &archive);
+    void serialize_state(tracking_internal::StateArchive &archive) const;
+
+    // Optional timing of the update() stages, in milliseconds, indexed by TrackerCSRTV2::Stage
+    void set_stage_timing(bool enable) { stage_timing = enable; }
+    const double* get_stage_times() const { return stage_times; }
+
 protected:
     // PSR tracking variables
     mutable double last_psr_value_;
     mutable bool target_lost_;
-    void update_csr_filter(const Mat &image, const Mat &my_mask);
-    void update_histograms(const Mat &image, const Rect &region);
-    void extract_histograms(const Mat &image, cv::Rect region, Histogram &hf, Histogram &hb);
-    std::vector<Mat> create_csr_filter(const std::vector<cv::Mat>
-            img_features, const cv::Mat Y, const cv::Mat P);
-    Mat calculate_response(const Mat &image, const std::vector<Mat> filter);
+    bool stage_timing;
+    double stage_times[TrackerCSRTV2::STAGE_COUNT];
+    double* stage_clock() { return stage_timing ? stage_times : NULL; }
+    void extract_filter_update_features(const Mat &image, const Mat &mask);
+    void update_histograms(const Size &image_size, const Rect &region);
+    template<typename Self> static void serialize_fields(tracking_internal::StateArchive &archive, Self &self);
+    void extract_histograms(const Size &image_size, cv::Rect region, Histogram &hf, Histogram &hb);
+    void create_csr_filter(const std::vector<cv::Mat> &img_features, const cv::Mat &Y, const cv::Mat &P);
+    const Mat& calculate_response(const Mat &image, const std::vector<Mat> &filter);
     Mat get_location_prior(const Rect roi, const Size2f target_size, const Size img_sz);
-    Mat segment_region(const Mat &image, const Point2f &object_center,
+    void convert_segmentation_roi(const Mat &image, const Rect &region, const Point2f &object_center,
+            const Size2f &template_size, float scale_factor);
+    Mat segment_region(const Point2f &object_center,
             const Size2f &template_size, const Size &target_size, float scale_factor);
     Point2f estimate_new_position(const Mat &image);
-    std::vector<Mat> get_features(const Mat &patch, const Size2i &feature_size);
+    void extract_patch_features(const Mat &image);
+    void get_features(const Mat &patch, const Size2i &feature_size, std::vector<Mat> &features);
 
     bool check_mask_area(const Mat &mat, const double obj_area);
+    int spectrum_dft_flags() const { return params.use_real_dft ? 0 : DFT_COMPLEX_OUTPUT; }
     float current_scale_factor;
     Mat window;
     Mat yf;
@@ -85,12 +147,30 @@ protected:
     Mat default_mask;
     float default_mask_area;
     int cell_size;
+
+    // buffers reused between frames to avoid per-frame allocations
+    Rect hsv_roi;                  // part of the frame used by the segmentation
+    std::vector<Mat> hsv_channels; // HSV channels of the frame inside hsv_roi
+    std::vector<Mat> segment_patch;
+    Mat subwindow;
+    Mat patch;
+    tracking_internal::CorrelationFeatures feature_extractor;
+    std::vector<Mat> feature_planes;
+    std::vector<Mat> feature_spectra;
+    std::vector<CSRFilterWorkspace> admm_workspace;
+    Mat resp_spectrum;
+    Mat filter_channel;
+    Mat resp_channel;
+    Mat response;
+    DFTPlan feature_dft;
+    DFTPlan response_idft;
+    std::vector<float> new_filter_weights;
 };
 
 TrackerCSRTImpl::TrackerCSRTImpl(const TrackerCSRT::Params &parameters) :
-    params(parameters), last_psr_value_(-1.0), target_lost_(false)
+    params(parameters), last_psr_value_(-1.0), target_lost_(false), stage_timing(false)
 {
-    // nothing
+    std::fill(stage_times, stage_times + TrackerCSRTV2::STAGE_COUNT, 0.0);
 }
 
 void TrackerCSRTImpl::setInitialMask(InputArray mask)
@@ -108,55 +188,54 @@ bool TrackerCSRTImpl::check_mask_area(const Mat &mat, const double obj_area)
     return true;
 }
 
-Mat TrackerCSRTImpl::calculate_response(const Mat &image, const std::vector<Mat> filter)
+void TrackerCSRTImpl::extract_patch_features(const Mat &image)
 {
-    Mat patch = get_subwindow(image, object_center, cvFloor(current_scale_factor * template_size.width),
-        cvFloor(current_scale_factor * template_size.height));
-    resize(patch, patch, rescaled_template_size, 0, 0, INTER_CUBIC);
+    CV_TRACE_REGION("features");
+    StageTimer timer(stage_clock(), TrackerCSRTV2::STAGE_FEATURES);
+    get_subwindow(image, object_center, cvFloor(current_scale_factor * template_size.width),
+        cvFloor(current_scale_factor * template_size.height), subwindow);
+    resize(subwindow, patch, rescaled_template_size, 0, 0, INTER_CUBIC);
+
+    get_features(patch, yf.size(), feature_planes);
+    fourier_transform_features(feature_planes, feature_spectra, feature_dft);
+}
 
-    std::vector<Mat> ftrs = get_features(patch, yf.size());
-    std::vector<Mat> Ffeatures = fourier_transform_features(ftrs);
-    Mat resp, res;
-    if(params.use_channel_weights){
-        res = Mat::zeros(Ffeatures[0].size(), CV_32FC2);
-        Mat resp_ch;
-        Mat mul_mat;
-        for(size_t i = 0; i < Ffeatures.size(); ++i) {
-            mulSpectrums(Ffeatures[i], filter[i], resp_ch, 0, true);
-            res += (resp_ch * filter_weights[i]);
-        }
-        idft(res, res, DFT_SCALE | DFT_REAL_OUTPUT);
-    } else {
-        res = Mat::zeros(Ffeatures[0].size(), CV_32FC2);
-        Mat resp_ch;
-        for(size_t i = 0; i < Ffeatures.size(); ++i) {
-            mulSpectrums(Ffeatures[i], filter[i], resp_ch, 0 , true);
-            res = res + resp_ch;
-        }
-        idft(res, res, DFT_SCALE | DFT_REAL_OUTPUT);
+const Mat& TrackerCSRTImpl::calculate_response(const Mat &image, const std::vector<Mat> &filter)
+{
+    extract_patch_features(image);
+
+    CV_TRACE_REGION("response");
+    StageTimer timer(stage_clock(), TrackerCSRTV2::STAGE_RESPONSE);
+    resp_spectrum.create(feature_spectra[0].size(), feature_spectra[0].type());
+    resp_spectrum.setTo(Scalar::all(0));
+    for(size_t i = 0; i < feature_spectra.size(); ++i) {
+        tracking_internal::loadModelSpectrum(filter[i], filter_channel);
+        tracking_internal::mulAddSpectrums(feature_spectra[i], filter_channel, resp_spectrum,
+                params.use_channel_weights ? filter_weights[i] : 1.0f, 0, true);
     }
-    return res;
+    response_idft.execute(resp_spectrum, response);
+    return response;
 }
 
-void TrackerCSRTImpl::update_csr_filter(const Mat &image, const Mat &mask)
+void TrackerCSRTImpl::extract_filter_update_features(const Mat &image, const Mat &mask)
 {
-    Mat patch = get_subwindow(image, object_center, cvFloor(current_scale_factor * template_size.width),
-        cvFloor(current_scale_factor * template_size.height));
-    resize(patch, patch, rescaled_template_size, 0, 0, INTER_CUBIC);
+    extract_patch_features(image);
+    filter_mask = mask;
+}
 
-    std::vector<Mat> ftrs = get_features(patch, yf.size());
-    std::vector<Mat> Fftrs = fourier_transform_features(ftrs);
-    std::vector<Mat> new_csr_filter = create_csr_filter(Fftrs, yf, mask);
+void TrackerCSRTImpl::finish_filter_update(const Mat &image, Rect &boundingBox)
+{
+    CV_TRACE_REGION("filter");
+    StageTimer filter_timer(stage_clock(), TrackerCSRTV2::STAGE_FILTER);
     //calculate per channel weights
     if(params.use_channel_weights) {
-        Mat current_resp;
         double max_val;
         float sum_weights = 0;
-        std::vector<float> new_filter_weights = std::vector<float>(new_csr_filter.size());
-        for(size_t i = 0; i < new_csr_filter.size(); ++i) {
-            mulSpectrums(Fftrs[i], new_csr_filter[i], current_resp, 0, true);
-            idft(current_resp, current_resp, DFT_SCALE | DFT_REAL_OUTPUT);
-            minMaxLoc(current_resp, NULL, &max_val, NULL, NULL);
+        new_filter_weights.resize(admm_workspace.size());
+        for(size_t i = 0; i < admm_workspace.size(); ++i) {
+            mulSpectrums(feature_spectra[i], admm_workspace[i].H, resp_channel, 0, true);
+            response_idft.execute(resp_channel, response);
+            minMaxLoc(response, NULL, &max_val, NULL, NULL);
             sum_weights += static_cast<float>(max_val);
             new_filter_weights[i] = static_cast<float>(max_val);
         }
@@ -173,92 +252,79 @@ void TrackerCSRTImpl::update_csr_filter(const Mat &image, const Mat &mask)
         }
     }
     for(size_t i = 0; i < csr_filter.size(); ++i) {
-        csr_filter[i] = (1.0f - params.filter_lr)*csr_filter[i] + params.filter_lr * new_csr_filter[i];
+        tracking_internal::updateModelSpectrum(csr_filter[i], admm_workspace[i].H, params.filter_lr);
     }
-    std::vector<Mat>().swap(ftrs);
-    std::vector<Mat>().swap(Fftrs);
-}
+    filter_timer.stop();
 
+    CV_TRACE_REGION_NEXT("scale");
+    StageTimer scale_timer(stage_clock(), TrackerCSRTV2::STAGE_SCALE);
+    dsst.update(image, object_center);
+    boundingBox = bounding_box;
+}
 
-std::vector<Mat> TrackerCSRTImpl::get_features(const Mat &patch, const Size2i &feature_size)
+void TrackerCSRTImpl::get_features(const Mat &patch, const Size2i &feature_size,
+        std::vector<Mat> &features)
 {
-    std::vector<Mat> features;
-    if (params.use_hog) {
-        std::vector<Mat> hog = get_features_hog(patch, cell_size);
-        features.insert(features.end(), hog.begin(),
-                hog.begin()+params.num_hog_channels_used);
-    }
-    if (params.use_color_names) {
-        std::vector<Mat> cn;
-        cn = get_features_cn(patch, feature_size);
-        features.insert(features.end(), cn.begin(), cn.end());
-    }
-    if(params.use_gray) {
-        Mat gray_m;
-        cvtColor(patch, gray_m, COLOR_BGR2GRAY);
-        resize(gray_m, gray_m, feature_size, 0, 0, INTER_CUBIC);
-        gray_m.convertTo(gray_m, CV_32FC1, 1.0/255.0, -0.5);
-        features.push_back(gray_m);
-    }
-    if(params.use_rgb) {
-        std::vector<Mat> rgb_features = get_features_rgb(patch, feature_size);
-        features.insert(features.end(), rgb_features.begin(), rgb_features.end());
-    }
+    // all of the channels are extracted in one pass, already multiplied by the cosine window
+    CV_DbgAssert(feature_size == window.size());
+    CV_UNUSED(feature_size);
+    feature_extractor.compute(patch, window, features);
+}
 
-    for (size_t i = 0; i < features.size(); ++i) {
-        features.at(i) = features.at(i).mul(window);
+static void create_csr_filter_channel(const Mat &F, const Mat &Y, const Mat &P, int admm_iterations,
+        CSRFilterWorkspace &ws)
+{
+    float mu = 5.0f;
+    float beta = 3.0f;
+    float mu_max = 20.0f;
+    float lambda = mu / 100.0f;
+    // F is either a full complex or a CCS packed spectrum, the filter uses the same layout
+    const int dft_flags = F.channels() == 2 ? DFT_COMPLEX_OUTPUT : 0;
+    ws.dft_plan.create(F.size(), CV_32FC1, dft_flags);
+    ws.idft_plan.create(F.size(), F.type(), DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
+
+    mulSpectrums(F, Y, ws.Sxy, 0, true);
+    mulSpectrums(F, F, ws.Sxx, 0, true);
+
+    tracking_internal::regularizedDivSpectrums(ws.Sxy, ws.Sxx, lambda, ws.H);
+    ws.idft_plan.execute(ws.H, ws.h);
+    multiply(ws.h, P, ws.h);
+    ws.dft_plan.execute(ws.h, ws.H);
+    //Lagrangian multiplier
+    ws.L.create(ws.H.size(), ws.H.type());
+    ws.L.setTo(Scalar::all(0));
+    for(int iteration = 0; iteration < admm_iterations; ++iteration) {
+        // G = (Sxy + mu * H - L) / (Sxx + mu)
+        tracking_internal::admmSolveSpectrums(ws.Sxy, ws.Sxx, ws.H, ws.L, mu, ws.G);
+        // H = P .* idft(mu * G + L) / (lambda + mu)
+        scaleAdd(ws.G, mu, ws.L, ws.num);
+        ws.idft_plan.execute(ws.num, ws.h);
+        float lm = 1.0f / (lambda+mu);
+        multiply(ws.h, P, ws.h, lm);
+        ws.dft_plan.execute(ws.h, ws.H);
+
+        //Update variables for next iteration: L = L + mu * (G - H)
+        tracking_internal::admmUpdateMultiplier(ws.L, ws.G, ws.H, mu);
+        mu = min(mu_max, beta*mu);
     }
-    return features;
 }
 
 class ParallelCreateCSRFilter : public ParallelLoopBody {
 public:
     ParallelCreateCSRFilter(
-        const std::vector<cv::Mat> img_features,
-        const cv::Mat Y,
-        const cv::Mat P,
-        int admm_iterations,
-        std::vector<Mat> &result_filter_):
-        result_filter(result_filter_)
+        const std::vector<cv::Mat> &img_features_,
+        const cv::Mat &Y_,
+        const cv::Mat &P_,
+        int admm_iterations_,
+        std::vector<CSRFilterWorkspace> &workspace_):
+        img_features(img_features_), Y(Y_), P(P_), admm_iterations(admm_iterations_),
+        workspace(workspace_)
     {
-        this->img_features = img_features;
-        this->Y = Y;
-        this->P = P;
-        this->admm_iterations = admm_iterations;
     }
     virtual void operator ()(const Range& range) const CV_OVERRIDE
     {
         for (int i = range.start; i < range.end; i++) {
-            float mu = 5.0f;
-            float beta = 3.0f;
-            float mu_max = 20.0f;
-            float lambda = mu / 100.0f;
-
-            Mat F = img_features[i];
-
-            Mat Sxy, Sxx;
-            mulSpectrums(F, Y, Sxy, 0, true);
-            mulSpectrums(F, F, Sxx, 0, true);
-
-            Mat H;
-            H = divide_complex_matrices(Sxy, (Sxx + lambda));
-            idft(H, H, DFT_SCALE|DFT_REAL_OUTPUT);
-            H = H.mul(P);
-            dft(H, H, DFT_COMPLEX_OUTPUT);
-            Mat L = Mat::zeros(H.size(), H.type()); //Lagrangian multiplier
-            Mat G;
-            for(int iteration = 0; iteration < admm_iterations; ++iteration) {
-                G = divide_complex_matrices((Sxy + (mu * H) - L) , (Sxx + mu));
-                idft((mu * G) + L, H, DFT_SCALE | DFT_REAL_OUTPUT);
-                float lm = 1.0f / (lambda+mu);
-                H = H.mul(P*lm);
-                dft(H, H, DFT_COMPLEX_OUTPUT);
-
-                //Update variables for next iteration
-                L = L + mu * (G - H);
-                mu = min(mu_max, beta*mu);
-            }
-            result_filter[i] = H;
+            create_csr_filter_channel(img_features[i], Y, P, admm_iterations, workspace[i]);
         }
     }
 
@@ -267,26 +333,30 @@ public:
     }
 
 private:
+    const std::vector<Mat> &img_features;
+    const Mat &Y;
+    const Mat &P;
     int admm_iterations;
-    Mat Y;
-    Mat P;
-    std::vector<Mat> img_features;
-    std::vector<Mat> &result_filter;
+    std::vector<CSRFilterWorkspace> &workspace;
 };
 
 
-std::vector<Mat> TrackerCSRTImpl::create_csr_filter(
-        const std::vector<cv::Mat> img_features,
-        const cv::Mat Y,
-        const cv::Mat P)
+// the resulting filters are stored in admm_workspace[i].H
+void TrackerCSRTImpl::create_csr_filter(
+        const std::vector<cv::Mat> &img_features,
+        const cv::Mat &Y,
+        const cv::Mat &P)
 {
-    std::vector<Mat> result_filter;
-    result_filter.resize(img_features.size());
+    admm_workspace.resize(img_features.size());
     ParallelCreateCSRFilter parallelCreateCSRFilter(img_features, Y, P,
-            params.admm_iterations, result_filter);
-    parallel_for_(Range(0, static_cast<int>(result_filter.size())), parallelCreateCSRFilter);
+            params.admm_iterations, admm_workspace);
+    parallel_for_(Range(0, static_cast<int>(img_features.size())), parallelCreateCSRFilter);
+}
 
-    return result_filter;
+void TrackerCSRTImpl::compute_filter_update_channel(int channel)
+{
+    create_csr_filter_channel(feature_spectra[channel], yf, filter_mask,
+            params.admm_iterations, admm_workspace[channel]);
 }
 
 Mat TrackerCSRTImpl::get_location_prior(
@@ -325,25 +395,68 @@ Mat TrackerCSRTImpl::get_location_prior(
     return fg_prior;
 }
 
-Mat TrackerCSRTImpl::segment_region(
+// Foreground region of the color histograms (inclusive coordinates) and the background region
+// around it, both clamped to the image.
+static void get_histogram_regions(const Rect &region, const Size &image_size, int background_ratio,
+        Rect &fg, Rect &bg)
+{
+    // get coordinates of the region
+    int x1 = std::min(std::max(0, region.x), image_size.width-1);
+    int y1 = std::min(std::max(0, region.y), image_size.height-1);
+    int x2 = std::min(std::max(0, region.x + region.width), image_size.width-1);
+    int y2 = std::min(std::max(0, region.y + region.height), image_size.height-1);
+
+    // calculate coordinates of the background region
+    int offsetX = (x2-x1+1) / background_ratio;
+    int offsetY = (y2-y1+1) / background_ratio;
+    int outer_y1 = std::max(0, (int)(y1-offsetY));
+    int outer_y2 = std::min(image_size.height, (int)(y2+offsetY+1));
+    int outer_x1 = std::max(0, (int)(x1-offsetX));
+    int outer_x2 = std::min(image_size.width, (int)(x2+offsetX+1));
+
+    fg = Rect(x1, y1, x2-x1+1, y2-y1+1);
+    bg = Rect(outer_x1, outer_y1, outer_x2-outer_x1, outer_y2-outer_y1);
+}
+
+// Converts to HSV only the part of the frame read by the histograms and the segmentation,
+// so that the cost does not depend on the frame resolution.
+void TrackerCSRTImpl::convert_segmentation_roi(
         const Mat &image,
+        const Rect &region,
+        const Point2f &object_center,
+        const Size2f &template_size,
+        float scale_factor)
+{
+    Rect fg, bg;
+    get_histogram_regions(region, image.size(), params.background_ratio, fg, bg);
+    Rect window = get_subwindow_rect(object_center, cvFloor(scale_factor * template_size.width),
+            cvFloor(scale_factor * template_size.height));
+    window &= Rect(Point(), image.size());
+    hsv_roi = window.empty() ? bg : (bg | window);
+    bgr2hsv(image(hsv_roi), hsv_channels);
+}
+
+Mat TrackerCSRTImpl::segment_region(
         const Point2f &object_center,
         const Size2f &template_size,
         const Size &target_size,
         float scale_factor)
 {
+    // the window is clipped to the frame inside hsv_roi, so its border is replicated the same way
     Rect valid_pixels;
-    Mat patch = get_subwindow(image, object_center, cvFloor(scale_factor * template_size.width),
-        cvFloor(scale_factor * template_size.height), &valid_pixels);
+    const Point2f center = object_center - Point2f(hsv_roi.tl());
+    segment_patch.resize(hsv_channels.size());
+    for (size_t i = 0; i < hsv_channels.size(); i++)
+        get_subwindow(hsv_channels[i], center, cvFloor(scale_factor * template_size.width),
+                cvFloor(scale_factor * template_size.height), segment_patch[i], &valid_pixels);
+    const Size patch_size = segment_patch[0].size();
     Size2f scaled_target = Size2f(target_size.width * scale_factor,
             target_size.height * scale_factor);
     Mat fg_prior = get_location_prior(
-            Rect(0,0, patch.size().width, patch.size().height),
-            scaled_target , patch.size());
+            Rect(0,0, patch_size.width, patch_size.height),
+            scaled_target , patch_size);
 
-    std::vector<Mat> img_channels;
-    split(patch, img_channels);
-    std::pair<Mat, Mat> probs = Segment::computePosteriors2(img_channels, 0, 0, patch.cols, patch.rows,
+    std::pair<Mat, Mat> probs = Segment::computePosteriors2(segment_patch, 0, 0, patch_size.width, patch_size.height,
                     p_b, fg_prior, 1.0-fg_prior, hist_foreground, hist_background);
 
     Mat mask = Mat::zeros(probs.first.size(), probs.first.type());
@@ -355,45 +468,31 @@ Mat TrackerCSRTImpl::segment_region(
 }
 
 
-void TrackerCSRTImpl::extract_histograms(const Mat &image, cv::Rect region, Histogram &hf, Histogram &hb)
+// the histograms are computed from hsv_channels, see convert_segmentation_roi()
+void TrackerCSRTImpl::extract_histograms(const Size &image_size, cv::Rect region, Histogram &hf, Histogram &hb)
 {
-    // get coordinates of the region
-    int x1 = std::min(std::max(0, region.x), image.cols-1);
-    int y1 = std::min(std::max(0, region.y), image.rows-1);
-    int x2 = std::min(std::max(0, region.x + region.width), image.cols-1);
-    int y2 = std::min(std::max(0, region.y + region.height), image.rows-1);
-
-    // calculate coordinates of the background region
-    int offsetX = (x2-x1+1) / params.background_ratio;
-    int offsetY = (y2-y1+1) / params.background_ratio;
-    int outer_y1 = std::max(0, (int)(y1-offsetY));
-    int outer_y2 = std::min(image.rows, (int)(y2+offsetY+1));
-    int outer_x1 = std::max(0, (int)(x1-offsetX));
-    int outer_x2 = std::min(image.cols, (int)(x2+offsetX+1));
+    Rect fg, bg;
+    get_histogram_regions(region, image_size, params.background_ratio, fg, bg);
 
     // calculate probability for the background
-    p_b = 1.0 - ((x2-x1+1) * (y2-y1+1)) /
-        ((double) (outer_x2-outer_x1+1) * (outer_y2-outer_y1+1));
-
-    // split multi-channel image into the std::vector of matrices
-    std::vector<Mat> img_channels(image.channels());
-    split(image, img_channels);
-    for(size_t k=0; k<img_channels.size(); k++) {
-        img_channels.at(k).convertTo(img_channels.at(k), CV_8UC1);
-    }
-
-    hf.extractForegroundHistogram(img_channels, Mat(), false, x1, y1, x2, y2);
-    hb.extractBackGroundHistogram(img_channels, x1, y1, x2, y2,
-        outer_x1, outer_y1, outer_x2, outer_y2);
-    std::vector<Mat>().swap(img_channels);
+    p_b = 1.0 - (fg.width * fg.height) /
+        ((double) (bg.width+1) * (bg.height+1));
+
+    // coordinates relative to the converted part of the frame
+    fg -= hsv_roi.tl();
+    bg -= hsv_roi.tl();
+    hf.extractForegroundHistogram(hsv_channels, Mat(), false, fg.x, fg.y, fg.x+fg.width-1, fg.y+fg.height-1);
+    hb.extractBackGroundHistogram(hsv_channels, fg.x, fg.y, fg.x+fg.width-1, fg.y+fg.height-1,
+        bg.x, bg.y, bg.x+bg.width, bg.y+bg.height);
 }
 
-void TrackerCSRTImpl::update_histograms(const Mat &image, const Rect &region)
+void TrackerCSRTImpl::update_histograms(const Size &image_size, const Rect &region)
 {
     // create temporary histograms
-    Histogram hf(image.channels(), params.histogram_bins);
-    Histogram hb(image.channels(), params.histogram_bins);
-    extract_histograms(image, region, hf, hb);
+    const int channels = static_cast<int>(hsv_channels.size());
+    Histogram hf(channels, params.histogram_bins);
+    Histogram hb(channels, params.histogram_bins);
+    extract_histograms(image_size, region, hf, hb);
 
     // get histogram vectors from temporary histograms
     std::vector<double> hf_vect_new = hf.getHistogramVector();
@@ -421,7 +520,7 @@ void TrackerCSRTImpl::update_histograms(const Mat &image, const Rect &region)
 Point2f TrackerCSRTImpl::estimate_new_position(const Mat &image)
 {
 
-    Mat resp = calculate_response(image, csr_filter);
+    const Mat &resp = calculate_response(image, csr_filter);
 
     double max_val;
     Point max_loc;
@@ -459,46 +558,79 @@ Point2f TrackerCSRTImpl::estimate_new_position(const Mat &image)
     return new_center;
 }
 
-// *********************************************************************
-// *                        Update API function                        *
-// *********************************************************************
-bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
+Mat TrackerCSRTImpl::prepare_frame(InputArray image_)
 {
     Mat image;
     if(image_.channels() == 1)    //treat gray image as color image
         cvtColor(image_, image, COLOR_GRAY2BGR);
     else
         image = image_.getMat();
+    return image;
+}
 
+bool TrackerCSRTImpl::estimate_target(const Mat &image)
+{
     object_center = estimate_new_position(image);
     if (object_center.x < 0 && object_center.y < 0)
         return false;
 
-    current_scale_factor = dsst.getScale(image, object_center);
+    {
+        CV_TRACE_REGION("scale");
+        StageTimer timer(stage_clock(), TrackerCSRTV2::STAGE_SCALE);
+        current_scale_factor = dsst.getScale(image, object_center);
+    }
     //update bouding_box according to new scale and location
     bounding_box.x = object_center.x - current_scale_factor * original_target_size.width / 2.0f;
     bounding_box.y = object_center.y - current_scale_factor * original_target_size.height / 2.0f;
     bounding_box.width = current_scale_factor * original_target_size.width;
     bounding_box.height = current_scale_factor * original_target_size.height;
+    return true;
+}
 
-    //update tracker
+void TrackerCSRTImpl::prepare_filter_update(const Mat &image)
+{
+    Mat mask;
     if(params.use_segmentation) {
-        Mat hsv_img = bgr2hsv(image);
-        update_histograms(hsv_img, bounding_box);
-        filter_mask = segment_region(hsv_img, object_center,
+        CV_TRACE_REGION("segmentation");
+        StageTimer timer(stage_clock(), TrackerCSRTV2::STAGE_SEGMENTATION);
+        convert_segmentation_roi(image, bounding_box, object_center, template_size, current_scale_factor);
+        update_histograms(image.size(), bounding_box);
+        mask = segment_region(object_center,
                 template_size,original_target_size, current_scale_factor);
-        resize(filter_mask, filter_mask, yf.size(), 0, 0, INTER_NEAREST);
-        if(check_mask_area(filter_mask, default_mask_area)) {
-            dilate(filter_mask , filter_mask, erode_element);
+        resize(mask, mask, yf.size(), 0, 0, INTER_NEAREST);
+        if(check_mask_area(mask, default_mask_area)) {
+            dilate(mask , mask, erode_element);
         } else {
-            filter_mask = default_mask;
+            mask = default_mask;
         }
     } else {
-        filter_mask = default_mask;
+        mask = default_mask;
     }
-    update_csr_filter(image, filter_mask);
-    dsst.update(image, object_center);
-    boundingBox = bounding_box;
+    extract_filter_update_features(image, mask);
+}
+
+// *********************************************************************
+// *                        Update API function                        *
+// *********************************************************************
+bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
+{
+    CV_TRACE_FUNCTION();
+    std::fill(stage_times, stage_times + TrackerCSRTV2::STAGE_COUNT, 0.0);
+    StageTimer timer(stage_clock(), TrackerCSRTV2::STAGE_TOTAL);
+
+    Mat image = prepare_frame(image_);
+
+    if (!estimate_target(image))
+        return false;
+
+    //update tracker
+    prepare_filter_update(image);
+    {
+        CV_TRACE_REGION("admm");
+        StageTimer admm_timer(stage_clock(), TrackerCSRTV2::STAGE_ADMM);
+        create_csr_filter(feature_spectra, yf, filter_mask);
+    }
+    finish_filter_update(image, boundingBox);
     return true;
 }
 
@@ -507,11 +639,7 @@ bool TrackerCSRTImpl::update(InputArray image_, Rect& boundingBox)
 // *********************************************************************
 void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
 {
-    Mat image;
-    if(image_.channels() == 1)    //treat gray image as color image
-        cvtColor(image_, image, COLOR_GRAY2BGR);
-    else
-        image = image_.getMat();
+    Mat image = prepare_frame(image_);
 
     current_scale_factor = 1.0;
     image_size = image.size();
@@ -536,7 +664,10 @@ void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
             static_cast<float>(boundingBox.y) + original_target_size.height / 2.0f);
 
     yf = gaussian_shaped_labels(params.gsl_sigma,
-            rescaled_template_size.width / cell_size, rescaled_template_size.height / cell_size);
+            rescaled_template_size.width / cell_size, rescaled_template_size.height / cell_size,
+            spectrum_dft_flags());
+    feature_dft.create(yf.size(), CV_32FC1, spectrum_dft_flags());
+    response_idft.create(yf.size(), yf.type(), DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
     if(params.window_function.compare("hann") == 0) {
         window = get_hann_win(Size(yf.cols,yf.rows));
     } else if(params.window_function.compare("cheb") == 0) {
@@ -546,6 +677,8 @@ void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
     } else {
         CV_Error(Error::StsBadArg, "Not a valid window function");
     }
+    feature_extractor.configure(cell_size, params.use_hog ? params.num_hog_channels_used : 0,
+            params.use_color_names, params.use_gray, params.use_rgb);
 
     Size2i scaled_obj_size = Size2i(cvFloor(original_target_size.width * rescale_ratio / cell_size),
             cvFloor(original_target_size.height * rescale_ratio / cell_size));
@@ -558,11 +691,12 @@ void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
 
     //initalize segmentation
     if(params.use_segmentation) {
-        Mat hsv_img = bgr2hsv(image);
-        hist_foreground = Histogram(hsv_img.channels(), params.histogram_bins);
-        hist_background = Histogram(hsv_img.channels(), params.histogram_bins);
-        extract_histograms(hsv_img, bounding_box, hist_foreground, hist_background);
-        filter_mask = segment_region(hsv_img, object_center, template_size,
+        convert_segmentation_roi(image, bounding_box, object_center, template_size, current_scale_factor);
+        const int channels = static_cast<int>(hsv_channels.size());
+        hist_foreground = Histogram(channels, params.histogram_bins);
+        hist_background = Histogram(channels, params.histogram_bins);
+        extract_histograms(image.size(), bounding_box, hist_foreground, hist_background);
+        filter_mask = segment_region(object_center, template_size,
                 original_target_size, current_scale_factor);
         //update calculated mask with preset mask
         if(preset_mask.data){
@@ -586,22 +720,21 @@ void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
     }
 
     //initialize filter
-    Mat patch = get_subwindow(image, object_center, cvFloor(current_scale_factor * template_size.width),
-        cvFloor(current_scale_factor * template_size.height));
-    resize(patch, patch, rescaled_template_size, 0, 0, INTER_CUBIC);
-    std::vector<Mat> patch_ftrs = get_features(patch, yf.size());
-    std::vector<Mat> Fftrs = fourier_transform_features(patch_ftrs);
-    csr_filter = create_csr_filter(Fftrs, yf, filter_mask);
+    extract_patch_features(image);
+    create_csr_filter(feature_spectra, yf, filter_mask);
+    csr_filter.resize(admm_workspace.size());
+    for (size_t i = 0; i < admm_workspace.size(); ++i) {
+        tracking_internal::storeModelSpectrum(admm_workspace[i].H, csr_filter[i], params.use_fp16_model);
+    }
 
     if(params.use_channel_weights) {
-        Mat current_resp;
         filter_weights = std::vector<float>(csr_filter.size());
         float chw_sum = 0;
         for (size_t i = 0; i < csr_filter.size(); ++i) {
-            mulSpectrums(Fftrs[i], csr_filter[i], current_resp, 0, true);
-            idft(current_resp, current_resp, DFT_SCALE | DFT_REAL_OUTPUT);
+            mulSpectrums(feature_spectra[i], admm_workspace[i].H, resp_channel, 0, true);
+            response_idft.execute(resp_channel, response);
             double max_val;
-            minMaxLoc(current_resp, NULL, &max_val, NULL , NULL);
+            minMaxLoc(response, NULL, &max_val, NULL , NULL);
             chw_sum += static_cast<float>(max_val);
             filter_weights[i] = static_cast<float>(max_val);
         }
@@ -612,11 +745,131 @@ void TrackerCSRTImpl::init(InputArray image_, const Rect& boundingBox)
 
     //initialize scale search
     dsst = DSST(image, bounding_box, template_size, params.number_of_scales, params.scale_step,
-            params.scale_model_max_area, params.scale_sigma_factor, params.scale_lr);
+            params.scale_model_max_area, params.scale_sigma_factor, params.scale_lr,
+            params.use_real_dft, params.use_fp16_model);
 
     model=makePtr<TrackerCSRTModel>();
 }
 
+template<typename P>
+static void serialize_params(tracking_internal::StateArchive &archive, P &params)
+{
+    archive.beginStruct("params");
+    archive.io("use_hog", params.use_hog);
+    archive.io("use_color_names", params.use_color_names);
+    archive.io("use_gray", params.use_gray);
+    archive.io("use_rgb", params.use_rgb);
+    archive.io("use_channel_weights", params.use_channel_weights);
+    archive.io("use_segmentation", params.use_segmentation);
+    archive.io("window_function", params.window_function);
+    archive.io("kaiser_alpha", params.kaiser_alpha);
+    archive.io("cheb_attenuation", params.cheb_attenuation);
+    archive.io("template_size", params.template_size);
+    archive.io("gsl_sigma", params.gsl_sigma);
+    archive.io("hog_orientations", params.hog_orientations);
+    archive.io("hog_clip", params.hog_clip);
+    archive.io("padding", params.padding);
+    archive.io("filter_lr", params.filter_lr);
+    archive.io("weights_lr", params.weights_lr);
+    archive.io("num_hog_channels_used", params.num_hog_channels_used);
+    archive.io("admm_iterations", params.admm_iterations);
+    archive.io("histogram_bins", params.histogram_bins);
+    archive.io("histogram_lr", params.histogram_lr);
+    archive.io("background_ratio", params.background_ratio);
+    archive.io("number_of_scales", params.number_of_scales);
+    archive.io("scale_sigma_factor", params.scale_sigma_factor);
+    archive.io("scale_model_max_area", params.scale_model_max_area);
+    archive.io("scale_lr", params.scale_lr);
+    archive.io("scale_step", params.scale_step);
+    archive.io("psr_threshold", params.psr_threshold);
+    archive.io("use_real_dft", params.use_real_dft);
+    archive.io("use_fp16_model", params.use_fp16_model);
+    archive.endStruct();
+}
+
+static void serialize_histogram(tracking_internal::StateArchive &archive, const char *name, const Histogram &hist)
+{
+    archive.beginStruct(name);
+    archive.io("dims", hist.m_numDim);
+    archive.io("bins", hist.m_numBinsPerDim);
+    archive.io("values", hist.getHistogramVector());
+    archive.endStruct();
+}
+
+static void serialize_histogram(tracking_internal::StateArchive &archive, const char *name, Histogram &hist)
+{
+    if (!archive.reading()) {
+        serialize_histogram(archive, name, static_cast<const Histogram&>(hist));
+        return;
+    }
+    int dims = 0, bins = 0;
+    std::vector<double> values;
+    archive.beginStruct(name);
+    archive.io("dims", dims);
+    archive.io("bins", bins);
+    archive.io("values", values);
+    archive.endStruct();
+    hist = dims > 0 ? Histogram(dims, bins) : Histogram();
+    CV_Assert(hist.getHistogramVector().size() == values.size());
+    if (!values.empty())
+        hist.setHistogramVector(&values[0]);
+}
+
+template<typename Self>
+void TrackerCSRTImpl::serialize_fields(tracking_internal::StateArchive &archive, Self &self)
+{
+    serialize_params(archive, self.params);
+    archive.io("cell_size", self.cell_size);
+    archive.io("current_scale_factor", self.current_scale_factor);
+    archive.io("rescale_ratio", self.rescale_ratio);
+    archive.io("bounding_box", self.bounding_box);
+    archive.io("original_target_size", self.original_target_size);
+    archive.io("image_size", self.image_size);
+    archive.io("template_size", self.template_size);
+    archive.io("rescaled_template_size", self.rescaled_template_size);
+    archive.io("object_center", self.object_center);
+    archive.io("window", self.window);
+    archive.io("yf", self.yf);
+    archive.io("csr_filter", self.csr_filter);
+    archive.io("filter_weights", self.filter_weights);
+    archive.io("filter_mask", self.filter_mask);
+    archive.io("preset_mask", self.preset_mask);
+    archive.io("default_mask", self.default_mask);
+    archive.io("default_mask_area", self.default_mask_area);
+    serialize_histogram(archive, "hist_foreground", self.hist_foreground);
+    serialize_histogram(archive, "hist_background", self.hist_background);
+    archive.io("p_b", self.p_b);
+    archive.io("last_psr_value", self.last_psr_value_);
+    archive.io("target_lost", self.target_lost_);
+    archive.beginStruct("dsst");
+    self.dsst.serialize(archive);
+    archive.endStruct();
+}
+
+void TrackerCSRTImpl::serialize_state(tracking_internal::StateArchive &archive) const
+{
+    serialize_fields(archive, *this);
+}
+
+void TrackerCSRTImpl::serialize_state(tracking_internal::StateArchive &archive)
+{
+    serialize_fields(archive, *this);
+
+    if (archive.reading()) {
+        // the buffers derived from the state are rebuilt, the per-frame ones are allocated by update()
+        CV_Assert(!yf.empty() && window.size() == yf.size() && filter_mask.size() == yf.size());
+        feature_dft.create(yf.size(), CV_32FC1, spectrum_dft_flags());
+        response_idft.create(yf.size(), yf.type(), DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
+        feature_extractor.configure(cell_size, params.use_hog ? params.num_hog_channels_used : 0,
+                params.use_color_names, params.use_gray, params.use_rgb);
+        CV_Assert(static_cast<int>(csr_filter.size()) == feature_extractor.channels());
+        CV_Assert(!params.use_channel_weights || filter_weights.size() == csr_filter.size());
+        erode_element = getStructuringElement(MORPH_ELLIPSE, Size(3,3), Point(1,1));
+        admm_workspace.clear();
+        model = makePtr<TrackerCSRTModel>();
+    }
+}
+
 }  // namespace impl
 
 TrackerCSRT::Params::Params()
@@ -648,6 +901,8 @@ TrackerCSRT::Params::Params()
     background_ratio = 2;
     histogram_lr = 0.04f;
     psr_threshold = 0.035f;
+    use_real_dft = false;
+    use_fp16_model = false;
 }
 
 TrackerCSRT::TrackerCSRT()
@@ -686,6 +941,11 @@ public:
     virtual double getRawPSR() const CV_OVERRIDE;
     virtual bool isTargetLost() const CV_OVERRIDE;
     virtual TrackingStats getTrackingStats() const CV_OVERRIDE;
+    virtual void setStageTiming(bool enable) CV_OVERRIDE;
+    virtual void writeState(FileStorage& fs) const CV_OVERRIDE;
+    virtual void readState(const FileNode& node) CV_OVERRIDE;
+    virtual void exportState(std::vector<uchar>& buffer) const CV_OVERRIDE;
+    virtual void importState(const std::vector<uchar>& buffer) CV_OVERRIDE;
 
 private:
     // Internal CSRT implementation with PSR access
@@ -696,10 +956,15 @@ private:
     mutable int successful_frames_;
     mutable int total_frames_;
     static constexpr size_t MAX_HISTORY_SIZE = 100;
+
+    // Recent update() stage times, empty if the timing is disabled
+    std::vector<std::deque<double> > stage_history_;
     
     // Internal methods
     void updateTrackingStatistics(double psr, bool success) const;
     double normalizeTrackingScore(double psr) const;
+    void saveState(tracking_internal::StateArchive& archive) const;
+    void restoreState(tracking_internal::StateArchive& archive);
 };
 
 TrackerCSRTV2Impl::TrackerCSRTV2Impl(const TrackerCSRT::Params &parameters)
@@ -729,6 +994,15 @@ bool TrackerCSRTV2Impl::update(InputArray image, Rect& boundingBox)
 {
     // Call the original update method (which now updates PSR internally)
     bool success = csrt_impl_->update(image, boundingBox);
+
+    if (!stage_history_.empty()) {
+        const double* times = csrt_impl_->get_stage_times();
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            stage_history_[i].push_back(times[i]);
+            if (stage_history_[i].size() > MAX_HISTORY_SIZE)
+                stage_history_[i].pop_front();
+        }
+    }
     
     total_frames_++;
     
@@ -788,10 +1062,36 @@ TrackerCSRTV2::TrackingStats TrackerCSRTV2Impl::getTrackingStats() const
     } else {
         stats.avg_psr = stats.min_psr = stats.max_psr = 0.0;
     }
-    
+
+    if (!stage_history_.empty() && !stage_history_[0].empty()) {
+        const double* times = csrt_impl_->get_stage_times();
+        stats.stage_last_ms.assign(times, times + STAGE_COUNT);
+        stats.stage_p50_ms.resize(STAGE_COUNT);
+        stats.stage_p90_ms.resize(STAGE_COUNT);
+        stats.stage_p99_ms.resize(STAGE_COUNT);
+        std::vector<double> sorted;
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            sorted.assign(stage_history_[i].begin(), stage_history_[i].end());
+            std::sort(sorted.begin(), sorted.end());
+            // nearest-rank percentiles
+            const size_t n = sorted.size();
+            stats.stage_p50_ms[i] = sorted[(n * 50 + 99) / 100 - 1];
+            stats.stage_p90_ms[i] = sorted[(n * 90 + 99) / 100 - 1];
+            stats.stage_p99_ms[i] = sorted[(n * 99 + 99) / 100 - 1];
+        }
+    }
+
     return stats;
 }
 
+void TrackerCSRTV2Impl::setStageTiming(bool enable)
+{
+    csrt_impl_->set_stage_timing(enable);
+    stage_history_.clear();
+    if (enable)
+        stage_history_.resize(STAGE_COUNT);
+}
+
 double TrackerCSRTV2Impl::normalizeTrackingScore(double psr) const
 {
     TrackerCSRTImpl* impl = static_cast<TrackerCSRTImpl*>(csrt_impl_.get());
@@ -814,6 +1114,65 @@ void TrackerCSRTV2Impl::updateTrackingStatistics(double psr, bool success) const
     }
 }
 
+void TrackerCSRTV2Impl::saveState(tracking_internal::StateArchive& archive) const
+{
+    archive.header("TrackerCSRTV2", 1);
+    const TrackerCSRTImpl& impl = *csrt_impl_;
+    impl.serialize_state(archive);
+
+    archive.beginStruct("stats");
+    archive.io("psr_history", std::vector<double>(psr_history_.begin(), psr_history_.end()));
+    archive.io("successful_frames", successful_frames_);
+    archive.io("total_frames", total_frames_);
+    archive.endStruct();
+}
+
+void TrackerCSRTV2Impl::restoreState(tracking_internal::StateArchive& archive)
+{
+    // the state is decoded into a new tracker, this one is left unchanged if the state is invalid
+    archive.header("TrackerCSRTV2", 1);
+    Ptr<TrackerCSRTImpl> impl = makePtr<TrackerCSRTImpl>(csrt_impl_->params);
+    impl->set_stage_timing(!stage_history_.empty());
+    impl->serialize_state(archive);
+
+    std::vector<double> psr_history;
+    int successful_frames = 0, total_frames = 0;
+    archive.beginStruct("stats");
+    archive.io("psr_history", psr_history);
+    archive.io("successful_frames", successful_frames);
+    archive.io("total_frames", total_frames);
+    archive.endStruct();
+
+    csrt_impl_ = impl;
+    psr_history_.assign(psr_history.begin(), psr_history.end());
+    successful_frames_ = successful_frames;
+    total_frames_ = total_frames;
+}
+
+void TrackerCSRTV2Impl::writeState(FileStorage& fs) const
+{
+    tracking_internal::FileStorageStateWriter writer(fs);
+    saveState(writer);
+}
+
+void TrackerCSRTV2Impl::readState(const FileNode& node)
+{
+    tracking_internal::FileNodeStateReader reader(node);
+    restoreState(reader);
+}
+
+void TrackerCSRTV2Impl::exportState(std::vector<uchar>& buffer) const
+{
+    tracking_internal::BufferStateWriter writer(buffer);
+    saveState(writer);
+}
+
+void TrackerCSRTV2Impl::importState(const std::vector<uchar>& buffer)
+{
+    tracking_internal::BufferStateReader reader(buffer);
+    restoreState(reader);
+}
+
 // TrackerCSRTV2 public interface
 TrackerCSRTV2::TrackerCSRTV2()
 {
@@ -825,6 +1184,26 @@ TrackerCSRTV2::~TrackerCSRTV2()
     // nothing
 }
 
+void TrackerCSRTV2::writeState(FileStorage&) const
+{
+    CV_Error(Error::StsNotImplemented, "writeState is not implemented by this tracker");
+}
+
+void TrackerCSRTV2::readState(const FileNode&)
+{
+    CV_Error(Error::StsNotImplemented, "readState is not implemented by this tracker");
+}
+
+void TrackerCSRTV2::exportState(std::vector<uchar>&) const
+{
+    CV_Error(Error::StsNotImplemented, "exportState is not implemented by this tracker");
+}
+
+void TrackerCSRTV2::importState(const std::vector<uchar>&)
+{
+    CV_Error(Error::StsNotImplemented, "importState is not implemented by this tracker");
+}
+
 Ptr<TrackerCSRTV2> TrackerCSRTV2::create(const TrackerCSRT::Params &parameters)
 {
     return makePtr<TrackerCSRTV2Impl>(parameters);
@@ -6,67 +6,54 @@
 
 #include "trackerCSRTScaleEstimation.hpp"
 #include "trackerCSRTUtils.hpp"
+#include "tracking_spectrums.hpp"
+#include "tracking_state.hpp"
 
 //Discriminative Scale Space Tracking
 namespace cv
 {
 
-class ParallelGetScaleFeatures : public ParallelLoopBody
+// HOG of the scale samples, each one cropped from the largest sample window (the windows of
+// all scales are centered at the same position, so the smaller ones are nested in it)
+class ParallelScaleSamples : public ParallelLoopBody
 {
 public:
-    ParallelGetScaleFeatures(
-        Mat img,
-        Point2f pos,
-        Size2f base_target_sz,
-        float current_scale,
-        std::vector<float> &scale_factors,
-        Mat scale_window,
-        Size scale_model_sz,
-        int col_len,
-        Mat &result)
+    ParallelScaleSamples(
+        const Mat &base_patch_,
+        const std::vector<Rect> &rects_,
+        const std::vector<int> &columns_,
+        Size scale_model_sz_,
+        Mat &samples_) :
+        base_patch(base_patch_), rects(rects_), columns(columns_),
+        scale_model_sz(scale_model_sz_), samples(samples_)
     {
-        this->img = img;
-        this->pos = pos;
-        this->base_target_sz = base_target_sz;
-        this->current_scale = current_scale;
-        this->scale_factors = scale_factors;
-        this->scale_window = scale_window;
-        this->scale_model_sz = scale_model_sz;
-        this->col_len = col_len;
-        this->result = result;
     }
     virtual void operator ()(const Range& range) const CV_OVERRIDE
     {
-        for (int s = range.start; s < range.end; s++) {
-            Size patch_sz = Size(static_cast<int>(current_scale * scale_factors[s] * base_target_sz.width),
-                    static_cast<int>(current_scale * scale_factors[s] * base_target_sz.height));
-            Mat img_patch = get_subwindow(img, pos, patch_sz.width, patch_sz.height);
-            img_patch.convertTo(img_patch, CV_32FC3);
-            resize(img_patch, img_patch, Size(scale_model_sz.width, scale_model_sz.height),0,0,INTER_LINEAR);
-            std::vector<Mat> hog;
-            hog = get_features_hog(img_patch, 4);
+        Mat img_patch;
+        for (int k = range.start; k < range.end; k++) {
+            const int s = columns[k];
+            resize(base_patch(rects[k]), img_patch, scale_model_sz, 0, 0, INTER_LINEAR);
+            std::vector<Mat> hog = get_features_hog(img_patch, 4);
+            const int col_len = hog[0].cols * hog[0].rows;
+            CV_Assert(col_len * static_cast<int>(hog.size()) == samples.rows);
             for (int i = 0; i < static_cast<int>(hog.size()); ++i) {
-                hog[i] = hog[i].t();
-                hog[i] = scale_window.at<float>(0,s) * hog[i].reshape(0, col_len);
-                hog[i].copyTo(result(Rect(Point(s, i*col_len), hog[i].size())));
+                Mat cells = hog[i].t();
+                cells.reshape(0, col_len).copyTo(samples(Rect(s, i*col_len, 1, col_len)));
             }
         }
     }
 
-    ParallelGetScaleFeatures& operator=(const ParallelGetScaleFeatures &) {
+    ParallelScaleSamples& operator=(const ParallelScaleSamples &) {
         return *this;
     }
 
 private:
-    Mat img;
-    Point2f pos;
-    Size2f base_target_sz;
-    float current_scale;
-    std::vector<float> scale_factors;
-    Mat scale_window;
+    const Mat &base_patch;
+    const std::vector<Rect> &rects;
+    const std::vector<int> &columns;
     Size scale_model_sz;
-    int col_len;
-    Mat result;
+    Mat &samples;
 };
 
 
@@ -77,10 +64,14 @@ DSST::DSST(const Mat &image,
         float scaleStep,
         float maxModelArea,
         float sigmaFactor,
-        float scaleLearnRate):
+        float scaleLearnRate,
+        bool useRealDFT,
+        bool halfModel):
     scales_count(numberOfScales), scale_step(scaleStep), max_model_area(maxModelArea),
     sigma_factor(sigmaFactor), learn_rate(scaleLearnRate)
 {
+    // the per-row spectra are either full complex or CCS packed ones
+    dft_flags = DFT_ROWS | (useRealDFT ? 0 : DFT_COMPLEX_OUTPUT);
     original_targ_sz = bounding_box.size();
     Point2f object_center = Point2f(bounding_box.x + original_targ_sz.width / 2,
             bounding_box.y + original_targ_sz.height / 2);
@@ -116,17 +107,22 @@ DSST::DSST(const Mat &image,
     scale_model_sz = Size(cvFloor(template_size.width * scale_model_factor),
             cvFloor(template_size.height * scale_model_factor));
 
-    Mat scale_resp = get_scale_features(image, object_center, original_targ_sz,
-            current_scale_factor, scale_factors, scale_window, scale_model_sz);
+    // length of the feature vector of one scale sample
+    std::vector<Mat> hog = get_features_hog(Mat::zeros(scale_model_sz, CV_32FC3), 4);
+    const int feature_len = static_cast<int>(hog.size()) * hog[0].rows * hog[0].cols;
 
-    Mat ysf_row = Mat(ys.size(), CV_32FC2);
-    dft(ys, ysf_row, DFT_ROWS | DFT_COMPLEX_OUTPUT, 0);
-    ysf = repeat(ysf_row, scale_resp.rows, 1);
-    Mat Fscale_resp;
-    dft(scale_resp, Fscale_resp, DFT_ROWS | DFT_COMPLEX_OUTPUT);
-    mulSpectrums(ysf, Fscale_resp, sf_num, 0 , true);
+    Mat ysf_row;
+    dft(ys, ysf_row, dft_flags, 0);
+    ysf = repeat(ysf_row, feature_len, 1);
+    features_dft.create(ysf.size(), CV_32FC1, dft_flags);
+    response_idft.create(ysf_row.size(), ysf_row.type(), DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
+
+    samples_reusable = false;
+    compute_scale_features(image, object_center, false);
+    mulSpectrums(ysf, scale_spectrum, sf_num_f32, DFT_ROWS, true);
+    tracking_internal::storeModelSpectrum(sf_num_f32, sf_num, halfModel);
     Mat sf_den_all;
-    mulSpectrums(Fscale_resp, Fscale_resp, sf_den_all, 0, true);
+    mulSpectrums(scale_spectrum, scale_spectrum, sf_den_all, DFT_ROWS, true);
     reduce(sf_den_all, sf_den, 0, REDUCE_SUM, -1);
 }
 
@@ -134,71 +130,90 @@ DSST::~DSST()
 {
 }
 
-Mat DSST::get_scale_features(
-        Mat img,
-        Point2f pos,
-        Size2f base_target_sz,
-        float current_scale,
-        std::vector<float> &scale_factors,
-        Mat scale_window,
-        Size scale_model_sz)
+void DSST::compute_scale_features(const Mat &img, const Point2f pos, bool reuse)
 {
-    Mat result;
-    int col_len = 0;
-    Size patch_sz = Size(cvFloor(current_scale * scale_factors[0] * base_target_sz.width),
-            cvFloor(current_scale * scale_factors[0] * base_target_sz.height));
-    Mat img_patch = get_subwindow(img, pos, patch_sz.width, patch_sz.height);
-    img_patch.convertTo(img_patch, CV_32FC3);
-    resize(img_patch, img_patch, Size(scale_model_sz.width, scale_model_sz.height),0,0,INTER_LINEAR);
-    std::vector<Mat> hog;
-    hog = get_features_hog(img_patch, 4);
-    result = Mat(Size((int)scale_factors.size(), hog[0].cols * hog[0].rows * (int)hog.size()), CV_32F);
-    col_len = hog[0].cols * hog[0].rows;
-    for (int i = 0; i < static_cast<int>(hog.size()); ++i) {
-        hog[i] = hog[i].t();
-        hog[i] = scale_window.at<float>(0,0) * hog[i].reshape(0, col_len);
-        hog[i].copyTo(result(Rect(Point(0, i*col_len), hog[i].size())));
+    std::swap(samples, prev_samples);
+    std::swap(sample_sizes, prev_sample_sizes);
+    samples.create(ysf.rows, scales_count, CV_32FC1);
+    sample_sizes.resize(scales_count);
+
+    // the features of a sample depend only on its patch size at the given position
+    std::vector<int> columns;
+    for (int s = 0; s < scales_count; s++) {
+        const float scale = current_scale_factor * scale_factors[s];
+        const Size patch_sz(cvFloor(scale * static_cast<float>(original_targ_sz.width)),
+                cvFloor(scale * static_cast<float>(original_targ_sz.height)));
+        sample_sizes[s] = patch_sz;
+        int j = 0;
+        if (reuse) {
+            while (j < scales_count && prev_sample_sizes[j] != patch_sz)
+                j++;
+        }
+        if (reuse && j < scales_count)
+            prev_samples.col(j).copyTo(samples.col(s));
+        else
+            columns.push_back(s);
+    }
+
+    if (!columns.empty()) {
+        // the scale factors decrease with the column, the first window contains all of the others
+        const Size base_sz = sample_sizes[columns[0]];
+        const Rect base_rect = get_subwindow_rect(pos, base_sz.width, base_sz.height);
+        std::vector<Rect> rects(columns.size());
+        for (size_t k = 0; k < columns.size(); k++) {
+            const Size sz = sample_sizes[columns[k]];
+            rects[k] = get_subwindow_rect(pos, sz.width, sz.height) - base_rect.tl();
+            CV_Assert((rects[k] & Rect(Point(), base_sz)) == rects[k]);
+        }
+        get_subwindow(img, pos, base_sz.width, base_sz.height, base_patch);
+        base_patch.convertTo(base_patch, CV_32F);
+
+        ParallelScaleSamples parallelScaleSamples(base_patch, rects, columns, scale_model_sz, samples);
+        parallel_for_(Range(0, static_cast<int>(columns.size())), parallelScaleSamples);
     }
 
-    ParallelGetScaleFeatures parallelGetScaleFeatures(img, pos, base_target_sz,
-            current_scale, scale_factors, scale_window, scale_model_sz, col_len, result);
-    parallel_for_(Range(1, static_cast<int>(scale_factors.size())), parallelGetScaleFeatures);
-    return result;
+    scale_features.create(samples.size(), CV_32FC1);
+    const float *w = scale_window.ptr<float>();
+    for (int r = 0; r < samples.rows; r++) {
+        const float *src = samples.ptr<float>(r);
+        float *dst = scale_features.ptr<float>(r);
+        for (int c = 0; c < samples.cols; c++)
+            dst[c] = src[c] * w[c];
+    }
+    features_dft.execute(scale_features, scale_spectrum);
 }
 
 void DSST::update(const Mat &image, const Point2f object_center)
 {
-    Mat scale_features = get_scale_features(image, object_center, original_targ_sz,
-            current_scale_factor, scale_factors, scale_window, scale_model_sz);
-    Mat Fscale_features;
-    dft(scale_features, Fscale_features, DFT_ROWS | DFT_COMPLEX_OUTPUT);
+    compute_scale_features(image, object_center, samples_reusable && object_center == samples_center);
+    samples_reusable = false;
     Mat new_sf_num;
     Mat new_sf_den;
     Mat new_sf_den_all;
-    mulSpectrums(ysf, Fscale_features, new_sf_num, DFT_ROWS, true);
-    Mat sf_den_all;
-    mulSpectrums(Fscale_features, Fscale_features, new_sf_den_all, DFT_ROWS, true);
+    mulSpectrums(ysf, scale_spectrum, new_sf_num, DFT_ROWS, true);
+    mulSpectrums(scale_spectrum, scale_spectrum, new_sf_den_all, DFT_ROWS, true);
     reduce(new_sf_den_all, new_sf_den, 0, REDUCE_SUM, -1);
 
-    sf_num = (1 - learn_rate) * sf_num + learn_rate * new_sf_num;
+    tracking_internal::updateModelSpectrum(sf_num, new_sf_num, learn_rate);
     sf_den = (1 - learn_rate) * sf_den + learn_rate * new_sf_den;
 }
 
 float DSST::getScale(const Mat &image, const Point2f object_center)
 {
-    Mat scale_features = get_scale_features(image, object_center, original_targ_sz,
-            current_scale_factor, scale_factors, scale_window, scale_model_sz);
+    compute_scale_features(image, object_center, false);
+    samples_center = object_center;
+    samples_reusable = true;
 
+    tracking_internal::loadModelSpectrum(sf_num, sf_num_f32);
     Mat Fscale_features;
-    dft(scale_features, Fscale_features, DFT_ROWS | DFT_COMPLEX_OUTPUT);
-
-    mulSpectrums(Fscale_features, sf_num, Fscale_features, 0, false);
+    mulSpectrums(scale_spectrum, sf_num_f32, Fscale_features, DFT_ROWS, false);
     Mat scale_resp;
     reduce(Fscale_features, scale_resp, 0, REDUCE_SUM, -1);
-    scale_resp = divide_complex_matrices(scale_resp, sf_den + 0.01f);
-    idft(scale_resp, scale_resp, DFT_REAL_OUTPUT|DFT_SCALE);
+    tracking_internal::regularizedDivSpectrums(scale_resp, sf_den, 0.01f, scale_resp, DFT_ROWS);
+    Mat scale_response;
+    response_idft.execute(scale_resp, scale_response);
     Point max_loc;
-    minMaxLoc(scale_resp, NULL, NULL, NULL, &max_loc);
+    minMaxLoc(scale_response, NULL, NULL, NULL, &max_loc);
 
     current_scale_factor *= scale_factors[max_loc.x];
     if(current_scale_factor < min_scale_factor)
@@ -208,4 +223,45 @@ float DSST::getScale(const Mat &image, const Point2f object_center)
 
     return current_scale_factor;
 }
+
+template<typename Self>
+void DSST::serialize_fields(tracking_internal::StateArchive &archive, Self &self)
+{
+    archive.io("scale_model_sz", self.scale_model_sz);
+    archive.io("ys", self.ys);
+    archive.io("ysf", self.ysf);
+    archive.io("scale_window", self.scale_window);
+    archive.io("scale_factors", self.scale_factors);
+    archive.io("sf_num", self.sf_num);
+    archive.io("sf_den", self.sf_den);
+    archive.io("scale_sigma", self.scale_sigma);
+    archive.io("min_scale_factor", self.min_scale_factor);
+    archive.io("max_scale_factor", self.max_scale_factor);
+    archive.io("current_scale_factor", self.current_scale_factor);
+    archive.io("scales_count", self.scales_count);
+    archive.io("scale_step", self.scale_step);
+    archive.io("max_model_area", self.max_model_area);
+    archive.io("sigma_factor", self.sigma_factor);
+    archive.io("learn_rate", self.learn_rate);
+    archive.io("dft_flags", self.dft_flags);
+    archive.io("original_targ_sz", self.original_targ_sz);
+}
+
+void DSST::serialize(tracking_internal::StateArchive &archive) const
+{
+    serialize_fields(archive, *this);
+}
+
+void DSST::serialize(tracking_internal::StateArchive &archive)
+{
+    serialize_fields(archive, *this);
+
+    if (archive.reading())
+    {
+        CV_Assert(!ysf.empty() && sf_num.size() == ysf.size() && sf_den.cols == ysf.cols);
+        features_dft.create(ysf.size(), CV_32FC1, dft_flags);
+        response_idft.create(Size(ysf.cols, 1), ysf.type(), DFT_INVERSE | DFT_SCALE | DFT_REAL_OUTPUT);
+        samples_reusable = false;
+    }
+}
 } /* namespace cv */
@@ -7,26 +7,36 @@
 
 namespace cv
 {
+namespace tracking_internal {
+class StateArchive;
+}
 
 class DSST {
 public:
-    DSST() {};
+    DSST() : samples_reusable(false) {};
     DSST(const Mat &image, Rect2f bounding_box, Size2f template_size, int numberOfScales,
-            float scaleStep, float maxModelArea, float sigmaFactor, float scaleLearnRate);
+            float scaleStep, float maxModelArea, float sigmaFactor, float scaleLearnRate,
+            bool useRealDFT = false, bool halfModel = false);
     ~DSST();
     void update(const Mat &image, const Point2f objectCenter);
     float getScale(const Mat &image, const Point2f objecCenter);
+    // Complete state, the const overload only writes it
+    void serialize(tracking_internal::StateArchive &archive);
+    void serialize(tracking_internal::StateArchive &archive) const;
 private:
-    Mat get_scale_features(Mat img, Point2f pos, Size2f base_target_sz, float current_scale,
-            std::vector<float> &scale_factors, Mat scale_window, Size scale_model_sz);
+    template<typename Self> static void serialize_fields(tracking_internal::StateArchive &archive, Self &self);
+    // Computes the windowed scale samples around pos and their spectrum (scale_spectrum). With reuse,
+    // the samples of the previous call with the same patch size are copied instead of recomputed.
+    void compute_scale_features(const Mat &img, const Point2f pos, bool reuse);
 
     Size scale_model_sz;
     Mat ys;
     Mat ysf;
     Mat scale_window;
     std::vector<float> scale_factors;
-    Mat sf_num;
-    Mat sf_den;
+    Mat sf_num;     // CV_16F if the model is stored in half precision
+    Mat sf_den;     // a single row, always in single precision
+    Mat sf_num_f32;
     float scale_sigma;
     float min_scale_factor;
     float max_scale_factor;
@@ -36,6 +46,21 @@ private:
     float max_model_area;
     float sigma_factor;
     float learn_rate;
+    int dft_flags;
+    DFTPlan features_dft;
+    DFTPlan response_idft;
+
+    // update() is called at the position given to the preceding getScale() in the same frame,
+    // so the samples are computed once per frame and the ones with the same patch size are reused
+    Mat samples;        // HOG of the scale samples, one column per scale, not multiplied by the window
+    Mat prev_samples;
+    std::vector<Size> sample_sizes;
+    std::vector<Size> prev_sample_sizes;
+    Point2f samples_center;
+    bool samples_reusable;
+    Mat base_patch;
+    Mat scale_features;
+    Mat scale_spectrum;
 
     Size original_targ_sz;
 };
@@ -132,7 +132,7 @@ cv::Mat Histogram::backProject(std::vector<cv::Mat> & imgChannels)
 }
 
 // add new methods
-std::vector<double> Histogram::getHistogramVector() {
+std::vector<double> Histogram::getHistogramVector() const {
     return p_bins;
 }
 
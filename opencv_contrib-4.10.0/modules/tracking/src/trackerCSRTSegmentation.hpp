@@ -21,7 +21,7 @@ public:
             int x1, int y1, int x2, int y2, int outer_x1, int outer_y1,
             int outer_x2, int outer_y2);
     cv::Mat backProject(std::vector<cv::Mat> & imgChannels);
-    std::vector<double> getHistogramVector();
+    std::vector<double> getHistogramVector() const;
     void setHistogramVector(double *vector);
 
 private:
@@ -5,6 +5,7 @@
 #include "precomp.hpp"
 
 #include "trackerCSRTUtils.hpp"
+#include "tracking_spectrums.hpp"
 
 namespace cv {
 
@@ -23,7 +24,7 @@ Mat circshift(Mat matrix, int dx, int dy)
     return matrix_out;
 }
 
-Mat gaussian_shaped_labels(const float sigma, const int w, const int h)
+Mat gaussian_shaped_labels(const float sigma, const int w, const int h, int dft_flags)
 {
     // create 2D Gaussian peak, convert to Fourier space and stores it into the yf
     Mat y = Mat::zeros(h, w, CV_32F);
@@ -39,48 +40,55 @@ Mat gaussian_shaped_labels(const float sigma, const int w, const int h)
     // wrap-around with the circulat shifting
     y = circshift(y, -cvFloor(y.cols / 2), -cvFloor(y.rows / 2));
     Mat yf;
-    dft(y, yf, DFT_COMPLEX_OUTPUT);
+    dft(y, yf, dft_flags);
     return yf;
 }
 
 std::vector<Mat> fourier_transform_features(const std::vector<Mat> &M)
 {
-    std::vector<Mat> out(M.size());
+    std::vector<Mat> out;
+    if(!M.empty()) {
+        DFTPlan plan(M[0].size(), CV_32FC1, DFT_COMPLEX_OUTPUT);
+        fourier_transform_features(M, out, plan);
+    }
+    return out;
+}
+
+void fourier_transform_features(const std::vector<Mat> &M, std::vector<Mat> &out, DFTPlan &plan)
+{
+    out.resize(M.size());
     Mat channel;
-    // iterate over channels and convert them to Fourier domain
+    // iterate over channels and convert them to Fourier domain with the CV_32FC1 plan,
+    // the output spectra are reused if they already have the right size
     for(size_t k = 0; k < M.size(); k++) {
-        M[k].convertTo(channel, CV_32F);
-        dft(channel, channel, DFT_COMPLEX_OUTPUT);
-        out[k] = (channel);
+        if(M[k].type() == CV_32FC1) {
+            plan.execute(M[k], out[k]);
+        } else {
+            M[k].convertTo(channel, CV_32F);
+            plan.execute(channel, out[k]);
+        }
     }
-    return out;
 }
 
 Mat divide_complex_matrices(const Mat &A, const Mat &B)
 {
-    std::vector<Mat> va,vb;
-    split(A, va);
-    split(B, vb);
-
-    Mat a = va.at(0);
-    Mat b = va.at(1);
-    Mat c = vb.at(0);
-    Mat d = vb.at(1);
-
-    Mat div = c.mul(c) + d.mul(d);
-    Mat real_part = (a.mul(c) + b.mul(d));
-    Mat im_part = (b.mul(c) - a.mul(d));
-    divide(real_part, div, real_part);
-    divide(im_part, div, im_part);
-
-    std::vector<Mat> tmp(2);
-    tmp[0] = real_part;
-    tmp[1] = im_part;
     Mat res;
-    merge(tmp, res);
+    divide_complex_matrices(A, B, res);
     return res;
 }
 
+void divide_complex_matrices(const Mat &A, const Mat &B, Mat &dst)
+{
+    tracking_internal::divSpectrums(A, B, dst);
+}
+
+Rect get_subwindow_rect(const Point2f center, const int w, const int h)
+{
+    int startx = cvFloor(center.x) + 1 - (cvFloor(w/2));
+    int starty = cvFloor(center.y) + 1 - (cvFloor(h/2));
+    return Rect(startx, starty, w, h);
+}
+
 Mat get_subwindow(
         const Mat &image,
         const Point2f center,
@@ -88,9 +96,20 @@ Mat get_subwindow(
         const int h,
         Rect *valid_pixels)
 {
-    int startx = cvFloor(center.x) + 1 - (cvFloor(w/2));
-    int starty = cvFloor(center.y) + 1 - (cvFloor(h/2));
-    Rect roi(startx, starty, w, h);
+    Mat subwin;
+    get_subwindow(image, center, w, h, subwin, valid_pixels);
+    return subwin;
+}
+
+void get_subwindow(
+        const Mat &image,
+        const Point2f center,
+        const int w,
+        const int h,
+        Mat &dst,
+        Rect *valid_pixels)
+{
+    Rect roi = get_subwindow_rect(center, w, h);
     int padding_left = 0, padding_right = 0, padding_top = 0, padding_bottom = 0;
     if(roi.x < 0) {
         padding_left = -roi.x;
@@ -110,13 +129,13 @@ Mat get_subwindow(
         padding_bottom = roi.y + roi.height - image.rows;
         roi.height = image.rows - roi.y;
     }
-    Mat subwin = image(roi).clone();
-    copyMakeBorder(subwin, subwin, padding_top, padding_bottom, padding_left, padding_right, BORDER_REPLICATE);
+    // BORDER_ISOLATED: replicate the ROI border, not the pixels of the parent image
+    copyMakeBorder(image(roi), dst, padding_top, padding_bottom, padding_left, padding_right,
+            BORDER_REPLICATE | BORDER_ISOLATED);
 
     if(valid_pixels != NULL) {
         *valid_pixels = Rect(padding_left, padding_top, roi.width, roi.height);
     }
-    return subwin;
 }
 
 float subpixel_peak(const Mat &response, const std::string &s, const Point2f &p)
@@ -495,46 +514,6 @@ std::vector<Mat> get_features_hog(const Mat &im, const int bin_size)
     return features;
 }
 
-std::vector<Mat> get_features_cn(const Mat &ppatch_data, const Size &output_size) {
-    Mat patch_data = ppatch_data.clone();
-    Vec3b & pixel = patch_data.at<Vec3b>(0,0);
-    unsigned index;
-
-    Mat cnFeatures = Mat::zeros(patch_data.rows,patch_data.cols,CV_32FC(10));
-
-    for(int i=0;i<patch_data.rows;i++){
-        for(int j=0;j<patch_data.cols;j++){
-            pixel=patch_data.at<Vec3b>(i,j);
-            index=(unsigned)(cvFloor((float)pixel[2]/8)+32*cvFloor((float)pixel[1]/8)+32*32*cvFloor((float)pixel[0]/8));
-
-            //copy the values
-            for(int k=0;k<10;k++){
-                cnFeatures.at<Vec<float,10> >(i,j)[k]=(float)ColorNames[index][k];
-            }
-        }
-    }
-    std::vector<Mat> result;
-    split(cnFeatures, result);
-    for (size_t i = 0; i < result.size(); i++) {
-        if (output_size.width > 0 && output_size.height > 0) {
-            resize(result.at(i), result.at(i), output_size, INTER_CUBIC);
-        }
-    }
-    return result;
-}
-
-std::vector<Mat> get_features_rgb(const Mat &patch, const Size &output_size)
-{
-    std::vector<Mat> channels;
-    split(patch, channels);
-    for(size_t k=0; k<channels.size(); k++) {
-        channels[k].convertTo(channels[k], CV_32F, 1.0/255.0, -0.5);
-        channels[k] = channels[k] - mean(channels[k])[0];
-        resize(channels[k], channels[k], output_size, INTER_CUBIC);
-    }
-    return channels;
-}
-
 double get_max(const Mat &m)
 {
     double val;
@@ -549,15 +528,12 @@ double get_min(const Mat &m)
     return val;
 }
 
-Mat bgr2hsv(const Mat &img)
+void bgr2hsv(const Mat &img, std::vector<Mat> &hsv_channels)
 {
     Mat hsv_img;
     cvtColor(img, hsv_img, COLOR_BGR2HSV);
-    std::vector<Mat> hsv_img_channels;
-    split(hsv_img, hsv_img_channels);
-    hsv_img_channels.at(0).convertTo(hsv_img_channels.at(0), CV_8UC1, 255.0 / 180.0);
-    merge(hsv_img_channels, hsv_img);
-    return hsv_img;
+    split(hsv_img, hsv_channels);
+    hsv_channels.at(0).convertTo(hsv_channels.at(0), CV_8UC1, 255.0 / 180.0);
 }
 
 } //cv namespace
@@ -27,11 +27,17 @@ inline double kernel_epan(double x)
 }
 
 Mat circshift(Mat matrix, int dx, int dy);
-Mat gaussian_shaped_labels(const float sigma, const int w, const int h);
+Mat gaussian_shaped_labels(const float sigma, const int w, const int h,
+        int dft_flags = DFT_COMPLEX_OUTPUT);
 std::vector<Mat> fourier_transform_features(const std::vector<Mat> &M);
+void fourier_transform_features(const std::vector<Mat> &M, std::vector<Mat> &out, DFTPlan &plan);
 Mat divide_complex_matrices(const Mat &A, const Mat &B);
+void divide_complex_matrices(const Mat &A, const Mat &B, Mat &dst);
+Rect get_subwindow_rect(const Point2f center, const int w, const int h);
 Mat get_subwindow(const Mat &image, const Point2f center,
         const int w, const int h,Rect *valid_pixels = NULL);
+void get_subwindow(const Mat &image, const Point2f center,
+        const int w, const int h, Mat &dst, Rect *valid_pixels = NULL);
 
 float subpixel_peak(const Mat &response, const std::string &s, const Point2f &p);
 double get_max(const Mat &m);
@@ -41,11 +47,9 @@ Mat get_hann_win(Size sz);
 Mat get_kaiser_win(Size sz, float alpha);
 Mat get_chebyshev_win(Size sz, float attenuation);
 
-std::vector<Mat> get_features_rgb(const Mat &patch, const Size &output_size);
 std::vector<Mat> get_features_hog(const Mat &im, const int bin_size);
-std::vector<Mat> get_features_cn(const Mat &im, const Size &output_size);
 
-Mat bgr2hsv(const Mat &img);
+void bgr2hsv(const Mat &img, std::vector<Mat> &hsv_channels);
 
 } //cv namespace
 
@@ -42,6 +42,9 @@
 #include "precomp.hpp"
 
 #include "opencl_kernels_tracking.hpp"
+#include "tracking_spectrums.hpp"
+#include "tracking_features.hpp"
+#include "tracking_state.hpp"
 #include <complex>
 #include <cmath>
 
@@ -79,6 +82,10 @@ public:
     virtual void init(InputArray image, const Rect& boundingBox) CV_OVERRIDE;
     virtual bool update(InputArray image, Rect& boundingBox) CV_OVERRIDE;
     void setFeatureExtractor(void (*f)(const Mat, const Rect, Mat&), bool pca_func = false) CV_OVERRIDE;
+    void writeState(FileStorage& fs) const CV_OVERRIDE;
+    void readState(const FileNode& node) CV_OVERRIDE;
+    void exportState(std::vector<uchar>& buffer) const CV_OVERRIDE;
+    void importState(const std::vector<uchar>& buffer) CV_OVERRIDE;
 
     TrackerKCF::Params params;
     Ptr<TrackerKCFModel> model;
@@ -104,6 +111,9 @@ protected:
     void shiftRows(Mat& mat) const;
     void shiftRows(Mat& mat, int n) const;
     void shiftCols(Mat& mat, int n) const;
+    template<typename Self> static void serializeFields(tracking_internal::StateArchive& archive, Self& self);
+    void saveState(tracking_internal::StateArchive& archive) const;
+    void restoreState(tracking_internal::StateArchive& archive);
 #ifdef HAVE_OPENCL
     bool inline oclTransposeMM(const Mat src, float alpha, UMat &dst);
 #endif
@@ -112,7 +122,6 @@ private:
     float output_sigma;
     Rect2d roi;
     Mat hann; 	//hann window filter
-    Mat hann_cn; //10 dimensional hann-window filter for CN features,
 
     Mat y,yf; 	// training response and its FFT
     Mat x; 	// observation and its FFT
@@ -126,6 +135,7 @@ private:
 
     // pre-defined Mat variables for optimization of private functions
     Mat spec, spec2;
+    mutable DFTPlan fft_plan, ifft_plan;
     std::vector<Mat> layers;
     std::vector<Mat> vxf,vyf,vxyf;
     Mat xy_data,xyf_data;
@@ -220,10 +230,6 @@ private:
     // initialize the hann window filter
     createHanningWindow(hann, roi.size(), CV_32F);
 
-    // hann window filter for CN feature
-    Mat _layer[] = {hann, hann, hann, hann, hann, hann, hann, hann, hann, hann};
-    merge(_layer, 10, hann_cn);
-
     // create gaussian response
     y=Mat::zeros((int)roi.height,(int)roi.width,CV_32F);
     for(int i=0;i<int(roi.height);i++){
@@ -432,21 +438,11 @@ private:
     fft2(k,kf);
     kf_lambda=kf+params.lambda;
 
-    float den;
     if(params.split_coeff){
       mulSpectrums(yf,kf,new_alphaf,0);
       mulSpectrums(kf,kf_lambda,new_alphaf_den,0);
     }else{
-      for(int i=0;i<yf.rows;i++){
-        for(int j=0;j<yf.cols;j++){
-          den = 1.0f/(kf_lambda.at<Vec2f>(i,j)[0]*kf_lambda.at<Vec2f>(i,j)[0]+kf_lambda.at<Vec2f>(i,j)[1]*kf_lambda.at<Vec2f>(i,j)[1]);
-
-          new_alphaf.at<Vec2f>(i,j)[0]=
-          (yf.at<Vec2f>(i,j)[0]*kf_lambda.at<Vec2f>(i,j)[0]+yf.at<Vec2f>(i,j)[1]*kf_lambda.at<Vec2f>(i,j)[1])*den;
-          new_alphaf.at<Vec2f>(i,j)[1]=
-          (yf.at<Vec2f>(i,j)[1]*kf_lambda.at<Vec2f>(i,j)[0]-yf.at<Vec2f>(i,j)[0]*kf_lambda.at<Vec2f>(i,j)[1])*den;
-        }
-      }
+      tracking_internal::divSpectrums(yf,kf_lambda,new_alphaf);
     }
 
     // update the RLS model
@@ -517,14 +513,16 @@ private:
    * simplification of fourier transform function in opencv
    */
   void inline TrackerKCFImpl::fft2(const Mat src, Mat & dest) const {
-    dft(src,dest,DFT_COMPLEX_OUTPUT);
+    // the plans are prepared once, all of the transforms have the roi size
+    fft_plan.create(src.size(),src.type(),DFT_COMPLEX_OUTPUT);
+    fft_plan.execute(src,dest);
   }
 
   void inline TrackerKCFImpl::fft2(const Mat src, std::vector<Mat> & dest, std::vector<Mat> & layers_data) const {
     split(src, layers_data);
 
     for(int i=0;i<src.channels();i++){
-      dft(layers_data[i],dest[i],DFT_COMPLEX_OUTPUT);
+      fft2(layers_data[i],dest[i]);
     }
   }
 
@@ -532,7 +530,8 @@ private:
    * simplification of inverse fourier transform function in opencv
    */
   void inline TrackerKCFImpl::ifft2(const Mat src, Mat & dest) const {
-    idft(src,dest,DFT_SCALE+DFT_REAL_OUTPUT);
+    ifft_plan.create(src.size(),src.type(),DFT_INVERSE+DFT_SCALE+DFT_REAL_OUTPUT);
+    ifft_plan.execute(src,dest);
   }
 
   /*
@@ -686,8 +685,7 @@ private:
     switch(desc){
       case CN:
         CV_Assert(img.channels() == 3);
-        extractCN(patch,feat);
-        feat=feat.mul(hann_cn); // hann window filter
+        extractCN(patch,feat); // hann window filter is applied by the lookup
         break;
       default: // GRAY
         if(img.channels()>1)
@@ -737,27 +735,10 @@ private:
     return true;
   }
 
-  /* Convert BGR to ColorNames
+  /* Convert BGR to ColorNames, multiplied by the hann window
    */
   void TrackerKCFImpl::extractCN(Mat patch_data, Mat & cnFeatures) const {
-    Vec3b & pixel = patch_data.at<Vec3b>(0,0);
-    unsigned index;
-
-    if(cnFeatures.type() != CV_32FC(10))
-      cnFeatures = Mat::zeros(patch_data.rows,patch_data.cols,CV_32FC(10));
-
-    for(int i=0;i<patch_data.rows;i++){
-      for(int j=0;j<patch_data.cols;j++){
-        pixel=patch_data.at<Vec3b>(i,j);
-        index=(unsigned)(floor((float)pixel[2]/8)+32*floor((float)pixel[1]/8)+32*32*floor((float)pixel[0]/8));
-
-        //copy the values
-        for(int _k=0;_k<10;_k++){
-          cnFeatures.at<Vec<float,10> >(i,j)[_k]=ColorNames[index][_k];
-        }
-      }
-    }
-
+    tracking_internal::extractColorNames(patch_data, hann, cnFeatures);
   }
 
   /*
@@ -869,16 +850,7 @@ private:
     mulSpectrums(alphaf_data,kf_data,spec_data,0,false);
 
     //z=(a+bi)/(c+di)=[(ac+bd)+i(bc-ad)]/(c^2+d^2)
-    float den;
-    for(int i=0;i<kf_data.rows;i++){
-      for(int j=0;j<kf_data.cols;j++){
-        den=1.0f/(_alphaf_den.at<Vec2f>(i,j)[0]*_alphaf_den.at<Vec2f>(i,j)[0]+_alphaf_den.at<Vec2f>(i,j)[1]*_alphaf_den.at<Vec2f>(i,j)[1]);
-        spec2_data.at<Vec2f>(i,j)[0]=
-          (spec_data.at<Vec2f>(i,j)[0]*_alphaf_den.at<Vec2f>(i,j)[0]+spec_data.at<Vec2f>(i,j)[1]*_alphaf_den.at<Vec2f>(i,j)[1])*den;
-        spec2_data.at<Vec2f>(i,j)[1]=
-          (spec_data.at<Vec2f>(i,j)[1]*_alphaf_den.at<Vec2f>(i,j)[0]-spec_data.at<Vec2f>(i,j)[0]*_alphaf_den.at<Vec2f>(i,j)[1])*den;
-      }
-    }
+    tracking_internal::divSpectrums(spec_data,_alphaf_den,spec2_data);
 
     ifft2(spec2_data,response_data);
   }
@@ -892,6 +864,119 @@ private:
       use_custom_extractor_npca = true;
     }
   }
+
+  /*
+   * Complete tracker state: the parameters, the learned model and the buffers sized at the first frame
+   */
+  static void serializeModes(tracking_internal::StateArchive& archive, const char* name, const std::vector<TrackerKCF::MODE>& modes){
+    archive.io(name, std::vector<int>(modes.begin(), modes.end()));
+  }
+
+  static void serializeModes(tracking_internal::StateArchive& archive, const char* name, std::vector<TrackerKCF::MODE>& modes){
+    std::vector<int> values(modes.begin(), modes.end());
+    archive.io(name, values);
+    modes.resize(values.size());
+    for(size_t i=0;i<values.size();i++)modes[i]=static_cast<TrackerKCF::MODE>(values[i]);
+  }
+
+  template<typename Self>
+  void TrackerKCFImpl::serializeFields(tracking_internal::StateArchive& archive, Self& self){
+    archive.header("TrackerKCF", 1);
+
+    archive.beginStruct("params");
+    archive.io("detect_thresh", self.params.detect_thresh);
+    archive.io("sigma", self.params.sigma);
+    archive.io("lambda", self.params.lambda);
+    archive.io("interp_factor", self.params.interp_factor);
+    archive.io("output_sigma_factor", self.params.output_sigma_factor);
+    archive.io("pca_learning_rate", self.params.pca_learning_rate);
+    archive.io("resize", self.params.resize);
+    archive.io("split_coeff", self.params.split_coeff);
+    archive.io("wrap_kernel", self.params.wrap_kernel);
+    archive.io("compress_feature", self.params.compress_feature);
+    archive.io("max_patch_size", self.params.max_patch_size);
+    archive.io("compressed_size", self.params.compressed_size);
+    archive.io("desc_pca", self.params.desc_pca);
+    archive.io("desc_npca", self.params.desc_npca);
+    archive.endStruct();
+
+    archive.io("frame", self.frame);
+    archive.io("output_sigma", self.output_sigma);
+    archive.io("roi", self.roi);
+    archive.io("resize_image", self.resizeImage);
+    archive.io("hann", self.hann);
+    archive.io("y", self.y);
+    archive.io("yf", self.yf);
+    archive.io("alphaf", self.alphaf);
+    archive.io("alphaf_den", self.alphaf_den);
+    archive.io("z_pca", self.Z[0]);
+    archive.io("z_npca", self.Z[1]);
+    archive.io("old_cov_mtx", self.old_cov_mtx);
+    archive.io("proj_mtx", self.proj_mtx);
+    serializeModes(archive, "descriptors_pca", self.descriptors_pca);
+    serializeModes(archive, "descriptors_npca", self.descriptors_npca);
+  }
+
+  void TrackerKCFImpl::saveState(tracking_internal::StateArchive& archive) const {
+    serializeFields(archive, *this);
+    archive.io("channels", x.channels());
+  }
+
+  void TrackerKCFImpl::restoreState(tracking_internal::StateArchive& archive){
+    // the state is decoded into a new tracker, this one is left unchanged if the state is invalid
+    TrackerKCFImpl restored(params);
+    restored.use_custom_extractor_pca = use_custom_extractor_pca;
+    restored.use_custom_extractor_npca = use_custom_extractor_npca;
+    restored.extractor_pca = extractor_pca;
+    restored.extractor_npca = extractor_npca;
+    serializeFields(archive, restored);
+    int channels = 0;
+    archive.io("channels", channels);
+
+    // the custom extractors can't be stored, the restored tracker must have the same ones
+    CV_Assert((size_t)std::count(restored.descriptors_pca.begin(), restored.descriptors_pca.end(), CUSTOM) == extractor_pca.size());
+    CV_Assert((size_t)std::count(restored.descriptors_npca.begin(), restored.descriptors_npca.end(), CUSTOM) == extractor_npca.size());
+    CV_Assert(!restored.yf.empty() && restored.hann.size() == restored.yf.size() && restored.frame >= 0 && channels >= 0);
+    restored.features_pca.resize(restored.descriptors_pca.size());
+    restored.features_npca.resize(restored.descriptors_npca.size());
+    restored.model = makePtr<TrackerKCFModel>();
+
+    // update() allocates these at the first two frames only
+    if(restored.frame>0){
+      if(restored.params.desc_pca !=0 || use_custom_extractor_pca){
+        restored.layers_pca_data.resize(restored.Z[0].channels());
+        restored.average_data.resize(restored.Z[0].channels());
+      }
+      restored.layers.resize(channels);
+      restored.vxf.resize(channels);
+      restored.vyf.resize(channels);
+      restored.vxyf.resize(channels);
+      restored.new_alphaf=Mat_<Vec2f >(restored.yf.rows, restored.yf.cols);
+      restored.spec2=Mat_<Vec2f >(restored.yf.rows, restored.yf.cols);
+    }
+
+    *this = restored;
+  }
+
+  void TrackerKCFImpl::writeState(FileStorage& fs) const {
+    tracking_internal::FileStorageStateWriter writer(fs);
+    saveState(writer);
+  }
+
+  void TrackerKCFImpl::readState(const FileNode& node){
+    tracking_internal::FileNodeStateReader reader(node);
+    restoreState(reader);
+  }
+
+  void TrackerKCFImpl::exportState(std::vector<uchar>& buffer) const {
+    tracking_internal::BufferStateWriter writer(buffer);
+    saveState(writer);
+  }
+
+  void TrackerKCFImpl::importState(const std::vector<uchar>& buffer){
+    tracking_internal::BufferStateReader reader(buffer);
+    restoreState(reader);
+  }
   /*----------------------------------------------------------------------*/
 
 
@@ -928,6 +1013,26 @@ TrackerKCF::~TrackerKCF()
     // nothing
 }
 
+void TrackerKCF::writeState(FileStorage&) const
+{
+    CV_Error(Error::StsNotImplemented, "writeState is not implemented by this tracker");
+}
+
+void TrackerKCF::readState(const FileNode&)
+{
+    CV_Error(Error::StsNotImplemented, "readState is not implemented by this tracker");
+}
+
+void TrackerKCF::exportState(std::vector<uchar>&) const
+{
+    CV_Error(Error::StsNotImplemented, "exportState is not implemented by this tracker");
+}
+
+void TrackerKCF::importState(const std::vector<uchar>&)
+{
+    CV_Error(Error::StsNotImplemented, "importState is not implemented by this tracker");
+}
+
 Ptr<TrackerKCF> TrackerKCF::create(const TrackerKCF::Params &parameters)
 {
     return makePtr<TrackerKCFImpl>(parameters);
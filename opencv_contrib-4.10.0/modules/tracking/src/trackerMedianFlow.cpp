@@ -72,26 +72,47 @@ namespace impl {
  * optimize (allocation<-->reallocation)
  */
 
+/*
+ * The gray image and its optical flow pyramid. A frame is built once per image and is shared by all of
+ * the targets tracked on it, and it becomes the previous frame of the next update.
+ */
+struct MedianFlowFrame
+{
+    MedianFlowFrame(const Mat& image, const legacy::TrackerMedianFlow::Params& params)
+    {
+        if (image.channels() != 1)
+            cvtColor(image, gray, COLOR_BGR2GRAY);
+        else
+            image.copyTo(gray);
+        buildOpticalFlowPyramid(gray, pyramid, params.winSize, params.maxLevel, false);
+    }
+
+    Mat gray;
+    std::vector<Mat> pyramid;
+};
+
 class TrackerMedianFlowImpl : public legacy::TrackerMedianFlow
 {
 public:
     TrackerMedianFlowImpl(TrackerMedianFlow::Params paramsIn = TrackerMedianFlow::Params()) {params=paramsIn;isInit=false;}
     void read( const FileNode& fn ) CV_OVERRIDE;
     void write( FileStorage& fs ) const CV_OVERRIDE;
+
+    // does not modify the tracker, so the targets of MultiTrackerMedianFlow are tracked in parallel
+    bool medianFlowImpl(const MedianFlowFrame& oldFrame,const MedianFlowFrame& newFrame,Rect2d& oldBox) const;
 private:
     bool initImpl( const Mat& image, const Rect2d& boundingBox ) CV_OVERRIDE;
     bool updateImpl( const Mat& image, Rect2d& boundingBox ) CV_OVERRIDE;
-    bool medianFlowImpl(Mat oldImage,Mat newImage,Rect2d& oldBox);
-    Rect2d vote(const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,const Rect2d& oldRect,Point2f& mD);
+    Rect2d vote(const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,const Rect2d& oldRect,Point2f& mD) const;
     float dist(Point2f p1,Point2f p2);
     std::string type2str(int type);
 #if 0
     void computeStatistics(std::vector<float>& data,int size=-1);
 #endif
     void check_FB(const std::vector<Mat>& oldImagePyr,const std::vector<Mat>& newImagePyr,
-                  const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,std::vector<bool>& status);
+                  const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,std::vector<bool>& status) const;
     void check_NCC(const Mat& oldImage,const Mat& newImage,
-                   const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,std::vector<bool>& status);
+                   const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,std::vector<bool>& status) const;
 
     TrackerMedianFlow::Params params;
 };
@@ -124,11 +145,11 @@ public:
     TrackerMedianFlowModel(legacy::TrackerMedianFlow::Params /*params*/){}
     Rect2d getBoundingBox(){return boundingBox_;}
     void setBoudingBox(Rect2d boundingBox){boundingBox_=boundingBox;}
-    Mat getImage(){return image_;}
-    void setImage(const Mat& image){image.copyTo(image_);}
+    const MedianFlowFrame& getFrame(){return *frame_;}
+    void setFrame(const Ptr<MedianFlowFrame>& frame){frame_=frame;}
 protected:
     Rect2d boundingBox_;
-    Mat image_;
+    Ptr<MedianFlowFrame> frame_;
     void modelEstimationImpl( const std::vector<Mat>& /*responses*/ ) CV_OVERRIDE {}
     void modelUpdateImpl() CV_OVERRIDE {}
 };
@@ -145,20 +166,21 @@ void TrackerMedianFlowImpl::write( cv::FileStorage& fs ) const
 
 bool TrackerMedianFlowImpl::initImpl( const Mat& image, const Rect2d& boundingBox ){
     model=Ptr<TrackerMedianFlowModel>(new TrackerMedianFlowModel(params));
-    ((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->setImage(image);
+    ((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->setFrame(makePtr<MedianFlowFrame>(image, params));
     ((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->setBoudingBox(boundingBox);
     return true;
 }
 
 bool TrackerMedianFlowImpl::updateImpl( const Mat& image, Rect2d& boundingBox ){
-    Mat oldImage=((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->getImage();
+    const MedianFlowFrame& oldFrame=((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->getFrame();
+    Ptr<MedianFlowFrame> newFrame=makePtr<MedianFlowFrame>(image, params);
 
     Rect2d oldBox=((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->getBoundingBox();
-    if(!medianFlowImpl(oldImage,image,oldBox)){
+    if(!medianFlowImpl(oldFrame,*newFrame,oldBox)){
         return false;
     }
     boundingBox=oldBox;
-    ((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->setImage(image);
+    ((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->setFrame(newFrame);
     ((TrackerMedianFlowModel*)static_cast<TrackerModel*>(model))->setBoudingBox(oldBox);
     return true;
 }
@@ -196,20 +218,9 @@ size_t filterPointsInVectors(std::vector<T>& status, std::vector<Point2f>& vec1,
     return first_bad_idx;
 }
 
-bool TrackerMedianFlowImpl::medianFlowImpl(Mat oldImage,Mat newImage,Rect2d& oldBox){
+bool TrackerMedianFlowImpl::medianFlowImpl(const MedianFlowFrame& oldFrame,const MedianFlowFrame& newFrame,Rect2d& oldBox) const{
     std::vector<Point2f> pointsToTrackOld,pointsToTrackNew;
 
-    Mat oldImage_gray,newImage_gray;
-    if (oldImage.channels() != 1)
-        cvtColor( oldImage, oldImage_gray, COLOR_BGR2GRAY );
-    else
-        oldImage.copyTo(oldImage_gray);
-
-    if (newImage.channels() != 1)
-        cvtColor( newImage, newImage_gray, COLOR_BGR2GRAY );
-    else
-        newImage.copyTo(newImage_gray);
-
     //"open ended" grid
     for(int i=0;i<params.pointsInGrid;i++){
         for(int j=0;j<params.pointsInGrid;j++){
@@ -222,11 +233,8 @@ bool TrackerMedianFlowImpl::medianFlowImpl(Mat oldImage,Mat newImage,Rect2d& old
     std::vector<uchar> status(pointsToTrackOld.size());
     std::vector<float> errors(pointsToTrackOld.size());
 
-    std::vector<Mat> oldImagePyr;
-    buildOpticalFlowPyramid(oldImage_gray, oldImagePyr, params.winSize, params.maxLevel, false);
-
-    std::vector<Mat> newImagePyr;
-    buildOpticalFlowPyramid(newImage_gray, newImagePyr, params.winSize, params.maxLevel, false);
+    const std::vector<Mat>& oldImagePyr = oldFrame.pyramid;
+    const std::vector<Mat>& newImagePyr = newFrame.pyramid;
 
     calcOpticalFlowPyrLK(oldImagePyr,newImagePyr,pointsToTrackOld,pointsToTrackNew,status,errors,
                          params.winSize, params.maxLevel, params.termCriteria, 0);
@@ -250,7 +258,7 @@ bool TrackerMedianFlowImpl::medianFlowImpl(Mat oldImage,Mat newImage,Rect2d& old
 
     std::vector<bool> filter_status(pointsToTrackOld.size(), true);
     check_FB(oldImagePyr, newImagePyr, pointsToTrackOld, pointsToTrackNew, filter_status);
-    check_NCC(oldImage_gray, newImage_gray, pointsToTrackOld, pointsToTrackNew, filter_status);
+    check_NCC(oldFrame.gray, newFrame.gray, pointsToTrackOld, pointsToTrackNew, filter_status);
 
     // filter
     size_t num_good_points_after_filtering = filterPointsInVectors(filter_status, pointsToTrackOld, pointsToTrackNew, true);
@@ -289,7 +297,7 @@ bool TrackerMedianFlowImpl::medianFlowImpl(Mat oldImage,Mat newImage,Rect2d& old
     return true;
 }
 
-Rect2d TrackerMedianFlowImpl::vote(const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,const Rect2d& oldRect,Point2f& mD){
+Rect2d TrackerMedianFlowImpl::vote(const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,const Rect2d& oldRect,Point2f& mD) const{
     Rect2d newRect;
     Point2d newCenter(oldRect.x+oldRect.width/2.0,oldRect.y+oldRect.height/2.0);
     const size_t n=oldPoints.size();
@@ -352,7 +360,7 @@ void TrackerMedianFlowImpl::computeStatistics(std::vector<float>& data,int size)
 }
 #endif
 void TrackerMedianFlowImpl::check_FB(const std::vector<Mat>& oldImagePyr, const std::vector<Mat>& newImagePyr,
-                                     const std::vector<Point2f>& oldPoints, const std::vector<Point2f>& newPoints, std::vector<bool>& status){
+                                     const std::vector<Point2f>& oldPoints, const std::vector<Point2f>& newPoints, std::vector<bool>& status) const{
 
     if(status.empty()) {
         status=std::vector<bool>(oldPoints.size(),true);
@@ -376,7 +384,7 @@ void TrackerMedianFlowImpl::check_FB(const std::vector<Mat>& oldImagePyr, const
     }
 }
 void TrackerMedianFlowImpl::check_NCC(const Mat& oldImage,const Mat& newImage,
-                                      const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,std::vector<bool>& status){
+                                      const std::vector<Point2f>& oldPoints,const std::vector<Point2f>& newPoints,std::vector<bool>& status) const{
 
     std::vector<float> NCC(oldPoints.size(),0.0);
     Mat p1,p2;
@@ -393,6 +401,94 @@ void TrackerMedianFlowImpl::check_NCC(const Mat& oldImage,const Mat& newImage,
     }
 }
 
+class ParallelMedianFlowTargets : public ParallelLoopBody
+{
+public:
+    ParallelMedianFlowTargets(const TrackerMedianFlowImpl &tracker_, std::vector<Ptr<MedianFlowFrame> > &frames_,
+            const Ptr<MedianFlowFrame> &newFrame_, std::vector<Rect2d> &objects_, std::vector<uchar> &found_) :
+        tracker(tracker_), frames(frames_), newFrame(newFrame_), objects(objects_), found(found_)
+    {}
+    virtual void operator ()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++) {
+            Rect2d box = objects[i];
+            found[i] = tracker.medianFlowImpl(*frames[i], *newFrame, box);
+            if (found[i]) {
+                objects[i] = box;
+                frames[i] = newFrame;
+            }
+        }
+    }
+private:
+    const TrackerMedianFlowImpl &tracker;
+    std::vector<Ptr<MedianFlowFrame> > &frames;
+    const Ptr<MedianFlowFrame> &newFrame;
+    std::vector<Rect2d> &objects;
+    std::vector<uchar> &found;
+};
+
+class MultiTrackerMedianFlowImpl CV_FINAL : public legacy::MultiTrackerMedianFlow
+{
+public:
+    MultiTrackerMedianFlowImpl(const legacy::TrackerMedianFlow::Params &parameters)
+        : params(parameters), tracker(parameters)
+    {}
+
+    bool add(InputArray image, const Rect2d& boundingBox) CV_OVERRIDE
+    {
+        if (image.empty())
+            return false;
+        frames.push_back(makePtr<MedianFlowFrame>(image.getMat(), params));
+        objects.push_back(boundingBox);
+        status.push_back(true);
+        return true;
+    }
+
+    bool update(InputArray image) CV_OVERRIDE
+    {
+        if (frames.empty())
+            return true;
+        if (image.empty())
+            return false;
+
+        // the gray image and the pyramid are computed once for all targets
+        Ptr<MedianFlowFrame> newFrame = makePtr<MedianFlowFrame>(image.getMat(), params);
+
+        found.assign(frames.size(), 0);
+        parallel_for_(Range(0, static_cast<int>(frames.size())),
+                      ParallelMedianFlowTargets(tracker, frames, newFrame, objects, found));
+
+        status.assign(found.begin(), found.end());
+        return std::find(found.begin(), found.end(), 0) == found.end();
+    }
+
+    bool update(InputArray image, std::vector<Rect2d> & boundingBox) CV_OVERRIDE
+    {
+        bool res = update(image);
+        boundingBox = objects;
+        return res;
+    }
+
+    const std::vector<Rect2d>& getObjects() const CV_OVERRIDE
+    {
+        return objects;
+    }
+
+    const std::vector<bool>& getStatus() const CV_OVERRIDE
+    {
+        return status;
+    }
+
+protected:
+    legacy::TrackerMedianFlow::Params params;
+    TrackerMedianFlowImpl tracker;
+    // the previous frame of every target, shared by the targets located in the same frame
+    std::vector<Ptr<MedianFlowFrame> > frames;
+    std::vector<Rect2d> objects;
+    std::vector<bool> status;
+    std::vector<uchar> found;
+};
+
 }}  // namespace
 
 namespace legacy {
@@ -454,4 +550,23 @@ Ptr<TrackerMedianFlow> TrackerMedianFlow::create()
     return create(TrackerMedianFlow::Params());
 }
 
+MultiTrackerMedianFlow::MultiTrackerMedianFlow()
+{
+    // nothing
+}
+
+MultiTrackerMedianFlow::~MultiTrackerMedianFlow()
+{
+    // nothing
+}
+
+Ptr<MultiTrackerMedianFlow> MultiTrackerMedianFlow::create(const TrackerMedianFlow::Params &parameters)
+{
+    return makePtr<impl::MultiTrackerMedianFlowImpl>(parameters);
+}
+Ptr<MultiTrackerMedianFlow> MultiTrackerMedianFlow::create()
+{
+    return create(TrackerMedianFlow::Params());
+}
+
 }}}  // namespace
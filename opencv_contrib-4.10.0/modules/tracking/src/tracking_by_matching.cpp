@@ -64,6 +64,67 @@ std::vector<float> CosDistance::compute(const std::vector<cv::Mat> &descrs1,
     return distances;
 }
 
+namespace {
+// Stacks the descriptors as CV_32F rows of a matrix.
+cv::Mat StackDescriptors(const std::vector<cv::Mat> &descrs) {
+    const int len = static_cast<int>(descrs[0].total() * descrs[0].channels());
+    cv::Mat rows(static_cast<int>(descrs.size()), len, CV_32F);
+    for (size_t i = 0; i < descrs.size(); i++) {
+        const cv::Mat &d = descrs[i];
+        TBM_CHECK_EQ(static_cast<int>(d.total() * d.channels()), len);
+        cv::Mat row = rows.row(static_cast<int>(i));
+        (d.isContinuous() ? d : d.clone()).reshape(1, 1).convertTo(row, CV_32F);
+    }
+    return rows;
+}
+}  // anonymous namespace
+
+void CosDistance::computeMatrix(const std::vector<cv::Mat> &descrs1,
+                                const std::vector<cv::Mat> &descrs2,
+                                cv::Mat &distances) {
+    distances.create(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    if (distances.empty()) {
+        return;
+    }
+    for (const auto &d : descrs1) {
+        TBM_CHECK(d.size() == descriptor_size_);
+    }
+    for (const auto &d : descrs2) {
+        TBM_CHECK(d.size() == descriptor_size_);
+    }
+
+    cv::Mat x = StackDescriptors(descrs1), y = StackDescriptors(descrs2);
+    TBM_CHECK_EQ(x.cols, y.cols);
+    cv::Mat xy;
+    cv::gemm(x, y, 1, cv::noArray(), 0, xy, cv::GEMM_2_T);
+
+    std::vector<double> yy(y.rows);
+    for (int j = 0; j < y.rows; j++) {
+        yy[j] = y.row(j).dot(y.row(j));
+    }
+    for (int i = 0; i < x.rows; i++) {
+        double xx = x.row(i).dot(x.row(i));
+        const auto xy_ptr = xy.ptr<float>(i);
+        auto ptr = distances.ptr<float>(i);
+        for (int j = 0; j < y.rows; j++) {
+            double norm = sqrt(xx * yy[j]) + 1e-6;
+            ptr[j] = 0.5f * static_cast<float>(1.0 - xy_ptr[j] / norm);
+        }
+    }
+}
+
+void IDescriptorDistance::computeMatrix(const std::vector<cv::Mat> &descrs1,
+                                        const std::vector<cv::Mat> &descrs2,
+                                        cv::Mat &distances) {
+    distances.create(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    for (int i = 0; i < distances.rows; i++) {
+        auto ptr = distances.ptr<float>(i);
+        for (int j = 0; j < distances.cols; j++) {
+            ptr[j] = compute(descrs1[i], descrs2[j]);
+        }
+    }
+}
+
 
 float MatchTemplateDistance::compute(const cv::Mat &descr1,
                                      const cv::Mat &descr2) {
@@ -178,6 +239,9 @@ void ValidateParams(const TrackerParams &p) {
     TBM_CHECK_GE(p.reid_thr, 0.0f);
     TBM_CHECK_LE(p.reid_thr, 1.0f);
 
+    TBM_CHECK_GE(p.gating_thr, 0.0f);
+    TBM_CHECK_LE(p.gating_thr, 1.0f);
+
 
     if (p.max_num_objects_in_track > 0) {
         int min_required_track_length = static_cast<int>(p.forget_delay);
@@ -200,8 +264,9 @@ void ValidateParams(const TrackerParams &p) {
 /// detections. The affinity equals to
 ///       appearance_affinity * motion_affinity * shape_affinity.
 /// Where appearance is 1 - distance(tracklet_fast_dscr, detection_fast_dscr).
-/// Second step is to solve the assignment problem using Kuhn-Munkres
-/// algorithm. If correspondence between some tracklet and detection is
+/// Only the pairs with high enough shape, motion and time affinity are
+/// considered. Second step is to solve the assignment problem using Kuhn-Munkres
+/// algorithm for each group of tracklets and detections connected by such pairs. If correspondence between some tracklet and detection is
 /// established with low confidence (affinity) then the strong descriptor is
 /// used to determine if there is correspondence between tracklet and detection.
 ///
@@ -427,8 +492,9 @@ private:
     std::vector<std::pair<size_t, size_t>> GetTrackToDetectionIds(
         const std::set<std::tuple<size_t, size_t, float>> &matches);
 
-    float AffinityFast(const cv::Mat &descriptor1, const TrackedObject &obj1,
-                       const cv::Mat &descriptor2, const TrackedObject &obj2);
+    // Returns shape, motion and time affinity, or 0 if the pair does not pass
+    // the gate.
+    float AffinityGated(const TrackedObject &obj1, const TrackedObject &obj2);
 
     float Affinity(const TrackedObject &obj1, const TrackedObject &obj2);
 
@@ -561,7 +627,8 @@ TrackerParams::TrackerParams()
     strong_affinity_thr(0.2805f),
     reid_thr(0.61f),
     drop_forgotten_tracks(true),
-    max_num_objects_in_track(300) {}
+    max_num_objects_in_track(300),
+    gating_thr(0.0f) {}
 
 // Returns confusion matrix as:
 //   |tp fn|
@@ -691,7 +758,7 @@ void TrackerByMatching::SolveAssignmentProblem(
     ComputeDissimilarityMatrix(track_ids, detections, descriptors,
                                dissimilarity);
 
-    auto res = KuhnMunkres().Solve(dissimilarity);
+    auto res = KuhnMunkres().SolveSparse(dissimilarity, 1.0f);
 
     for (size_t i = 0; i < detections.size(); i++) {
         unmatched_detections.insert(i);
@@ -996,17 +1063,81 @@ void TrackerByMatching::ComputeDissimilarityMatrix(
     const std::vector<cv::Mat> &descriptors_fast,
     cv::Mat& dissimilarity_matrix) {
     cv::Mat am(static_cast<int>(active_tracks.size()), static_cast<int>(detections.size()), CV_32F, cv::Scalar(0));
+
+    // The appearance distance is computed only for the pairs passing the gate.
+    std::vector<const cv::Mat*> track_descriptors;
+    std::vector<cv::Point> pairs;
+    std::vector<int> gated_rows, gated_cols(am.cols, 0);
     int i = 0;
     for (auto id : active_tracks) {
+        const auto &track = tracks_.at(id);
+        auto last_det = track.objects.back();
+        last_det.rect = track.predicted_rect;
+        track_descriptors.push_back(&track.descriptor_fast);
+
         auto ptr = am.ptr<float>(i);
-        for (size_t j = 0; j < descriptors_fast.size(); j++) {
-            auto last_det = tracks_.at(id).objects.back();
-            last_det.rect = tracks_.at(id).predicted_rect;
-            ptr[j] = AffinityFast(tracks_.at(id).descriptor_fast, last_det,
-                                  descriptors_fast[j], detections[j]);
+        bool gated = false;
+        for (int j = 0; j < am.cols; j++) {
+            ptr[j] = AffinityGated(last_det, detections[j]);
+            if (ptr[j] > 0) {
+                pairs.emplace_back(j, i);
+                gated_cols[j] = 1;
+                gated = true;
+            }
+        }
+        if (gated) {
+            gated_rows.push_back(i);
         }
         i++;
     }
+
+    if (pairs.empty()) {
+        dissimilarity_matrix = 1.0 - am;
+        return;
+    }
+
+    std::vector<int> cols;
+    for (int j = 0; j < am.cols; j++) {
+        if (gated_cols[j]) {
+            cols.push_back(j);
+        }
+    }
+
+    // A single matrix of distances is much cheaper per pair than the distances
+    // of separate pairs, so it is used unless the gated pairs are sparse.
+    if (pairs.size() * 4 > gated_rows.size() * cols.size()) {
+        std::vector<cv::Mat> descrs1, descrs2;
+        for (int r : gated_rows) {
+            descrs1.push_back(*track_descriptors[r]);
+        }
+        for (int c : cols) {
+            descrs2.push_back(descriptors_fast[c]);
+        }
+        cv::Mat distances;
+        distance_fast_->computeMatrix(descrs1, descrs2, distances);
+        TBM_CHECK(distances.size() == cv::Size(static_cast<int>(cols.size()), static_cast<int>(gated_rows.size())));
+        for (size_t r = 0; r < gated_rows.size(); r++) {
+            auto ptr = am.ptr<float>(gated_rows[r]);
+            const auto dist_ptr = distances.ptr<float>(static_cast<int>(r));
+            for (size_t c = 0; c < cols.size(); c++) {
+                ptr[cols[c]] *= 1.0f - dist_ptr[c];
+            }
+        }
+    } else {
+        std::vector<cv::Mat> descrs1, descrs2;
+        for (const auto &p : pairs) {
+            descrs1.push_back(*track_descriptors[p.y]);
+            descrs2.push_back(descriptors_fast[p.x]);
+        }
+        std::vector<float> distances = distance_fast_->compute(descrs1, descrs2);
+        TBM_CHECK_EQ(distances.size(), pairs.size());
+        for (size_t k = 0; k < pairs.size(); k++) {
+            am.at<float>(pairs[k].y, pairs[k].x) *= 1.0f - distances[k];
+        }
+    }
+
+    // A negative affinity is no better than no association at all.
+    am = cv::max(am, 0);
     dissimilarity_matrix = 1.0 - am;
 }
 
@@ -1198,10 +1329,8 @@ void TrackerByMatching::AppendToTrack(const cv::Mat &frame,
     }
 }
 
-float TrackerByMatching::AffinityFast(const cv::Mat &descriptor1,
-                                      const TrackedObject &obj1,
-                                      const cv::Mat &descriptor2,
-                                      const TrackedObject &obj2) {
+float TrackerByMatching::AffinityGated(const TrackedObject &obj1,
+                                       const TrackedObject &obj2) {
     const float eps = static_cast<float>(1e-6);
     float shp_aff = ShapeAffinity(params_.shape_affinity_w, obj1.rect, obj2.rect);
     if (shp_aff < eps) return 0.0;
@@ -1214,9 +1343,8 @@ float TrackerByMatching::AffinityFast(const cv::Mat &descriptor1,
 
     if (time_aff < eps) return 0.0;
 
-    float app_aff = static_cast<float>(1.0 - distance_fast_->compute(descriptor1, descriptor2));
-
-    return shp_aff * mot_aff * app_aff * time_aff;
+    float aff = shp_aff * mot_aff * time_aff;
+    return aff > params_.gating_thr ? aff : 0.0f;
 }
 
 float TrackerByMatching::Affinity(const TrackedObject &obj1,
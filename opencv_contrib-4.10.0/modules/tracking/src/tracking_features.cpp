@@ -0,0 +1,555 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "tracking_features.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+namespace tracking_internal {
+
+static const int CN_CHANNELS = 10;
+static const int HOG_ORIENTATIONS = 18;
+static const int HOG_CHANNELS = 32;
+
+// unit vectors to snap the gradient orientation to one of the HOG bins
+static const float hogUU[HOG_ORIENTATIONS/2] = {1.000f, 0.9397f, 0.7660f, 0.5000f, 0.1736f, -0.1736f, -0.5000f, -0.7660f, -0.9397f};
+static const float hogVV[HOG_ORIENTATIONS/2] = {0.000f, 0.3420f, 0.6428f, 0.8660f, 0.9848f,  0.9848f,  0.8660f,  0.6428f,  0.3420f};
+
+static inline int colorNameIndex(const uchar* bgr)
+{
+    return (bgr[2] >> 3) + ((bgr[1] >> 3) << 5) + ((bgr[0] >> 3) << 10);
+}
+
+static void colorNameIndices(const uchar* bgr, ushort* idx, int n)
+{
+    int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_uint8>::vlanes();
+    const int hlanes = VTraits<v_uint16>::vlanes();
+    for (; x <= n - vlanes; x += vlanes)
+    {
+        v_uint8 b, g, r;
+        v_load_deinterleave(bgr + 3*x, b, g, r);
+        v_uint16 b0, b1, g0, g1, r0, r1;
+        v_expand(b, b0, b1);
+        v_expand(g, g0, g1);
+        v_expand(r, r0, r1);
+        v_store(idx + x, v_add(v_shr<3>(r0), v_add(v_shl<5>(v_shr<3>(g0)), v_shl<10>(v_shr<3>(b0)))));
+        v_store(idx + x + hlanes, v_add(v_shr<3>(r1), v_add(v_shl<5>(v_shr<3>(g1)), v_shl<10>(v_shr<3>(b1)))));
+    }
+#endif
+    for (; x < n; x++)
+        idx[x] = (ushort)colorNameIndex(bgr + 3*x);
+}
+
+void extractColorNames(const Mat& bgr, const Mat& window, Mat& dst)
+{
+    CV_Assert(bgr.type() == CV_8UC3);
+    CV_Assert(window.empty() || (window.type() == CV_32FC1 && window.size() == bgr.size()));
+
+    dst.create(bgr.size(), CV_32FC(CN_CHANNELS));
+    AutoBuffer<ushort> _idx(bgr.cols);
+    ushort* idx = _idx.data();
+    for (int y = 0; y < bgr.rows; y++)
+    {
+        colorNameIndices(bgr.ptr<uchar>(y), idx, bgr.cols);
+        const float* w = window.empty() ? 0 : window.ptr<float>(y);
+        float* d = dst.ptr<float>(y);
+        for (int x = 0; x < bgr.cols; x++, d += CN_CHANNELS)
+        {
+            const float* cn = detail::ColorNames[idx[x]];
+            const float s = w ? w[x] : 1.f;
+#if CV_SIMD128
+            // 10 channels are written by three overlapping stores
+            const v_float32x4 vs = v_setall_f32(s);
+            v_store(d, v_mul(v_load(cn), vs));
+            v_store(d + 4, v_mul(v_load(cn + 4), vs));
+            v_store(d + 6, v_mul(v_load(cn + 6), vs));
+#else
+            for (int k = 0; k < CN_CHANNELS; k++)
+                d[k] = cn[k] * s;
+#endif
+        }
+    }
+}
+
+// offsets of the ColorNames table entries of a BGR row, idx is a buffer of n elements
+static void colorNameOffsets(const uchar* bgr, ushort* idx, int* ofs, int n)
+{
+    colorNameIndices(bgr, idx, n);
+    int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_uint16>::vlanes();
+    const int qlanes = VTraits<v_uint32>::vlanes();
+    for (; x <= n - vlanes; x += vlanes)
+    {
+        v_uint32 i0, i1;
+        v_expand(vx_load(idx + x), i0, i1);
+        // CN_CHANNELS == 10
+        v_store(ofs + x, v_reinterpret_as_s32(v_add(v_shl<3>(i0), v_shl<1>(i0))));
+        v_store(ofs + x + qlanes, v_reinterpret_as_s32(v_add(v_shl<3>(i1), v_shl<1>(i1))));
+    }
+#endif
+    for (; x < n; x++)
+        ofs[x] = idx[x] * CN_CHANNELS;
+}
+
+// Bilinear interpolation of the ColorNames of two source rows, multiplied by the window.
+// ofs0 and ofs1 are the table offsets of the rows, x0 and x1 the left and right source columns.
+static void resampleColorNamesRow(const int* ofs0, const int* ofs1, const int* x0, const int* x1,
+        const float* alpha, float fy, const float* w, float* const* cn, int n)
+{
+    const float* table = detail::ColorNames[0];
+    const float wy0 = 1.f - fy;
+    int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    const v_float32 v_one = vx_setall_f32(1.f), v_wy0 = vx_setall_f32(wy0), v_fy = vx_setall_f32(fy);
+    for (; x <= n - vlanes; x += vlanes)
+    {
+        const v_int32 vx0 = vx_load(x0 + x), vx1 = vx_load(x1 + x);
+        const v_int32 o00 = v_lut(ofs0, vx0), o01 = v_lut(ofs0, vx1);
+        const v_int32 o10 = v_lut(ofs1, vx0), o11 = v_lut(ofs1, vx1);
+        const v_float32 fx = vx_load(alpha + x), wx0 = v_sub(v_one, fx), vw = vx_load(w + x);
+        for (int k = 0; k < CN_CHANNELS; k++)
+        {
+            const float* t = table + k;
+            v_float32 top = v_add(v_mul(wx0, v_lut(t, o00)), v_mul(fx, v_lut(t, o01)));
+            v_float32 bottom = v_add(v_mul(wx0, v_lut(t, o10)), v_mul(fx, v_lut(t, o11)));
+            v_store(cn[k] + x, v_mul(v_add(v_mul(v_wy0, top), v_mul(v_fy, bottom)), vw));
+        }
+    }
+#endif
+    for (; x < n; x++)
+    {
+        const float* c00 = table + ofs0[x0[x]];
+        const float* c01 = table + ofs0[x1[x]];
+        const float* c10 = table + ofs1[x0[x]];
+        const float* c11 = table + ofs1[x1[x]];
+        const float fx = alpha[x], wx0 = 1.f - fx;
+        for (int k = 0; k < CN_CHANNELS; k++)
+            cn[k][x] = (wy0*(wx0*c00[k] + fx*c01[k]) + fy*(wx0*c10[k] + fx*c11[k])) * w[x];
+    }
+}
+
+static void mulRow(const float* a, const float* b, float* dst, int n)
+{
+    int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    for (; x <= n - vlanes; x += vlanes)
+        v_store(dst + x, v_mul(vx_load(a + x), vx_load(b + x)));
+#endif
+    for (; x < n; x++)
+        dst[x] = a[x] * b[x];
+}
+
+// BGR row to three planes of floats
+static void splitRow(const uchar* src, float* dst, int n)
+{
+    for (int x = 0; x < n; x++, src += 3)
+    {
+        dst[x] = src[0];
+        dst[x + n] = src[1];
+        dst[x + 2*n] = src[2];
+    }
+}
+
+// Magnitude and orientation bin of the strongest color gradient for the pixels [x, end) of a row.
+// rows[c*3 + r] is the plane c (B, G, R) of the previous, current and next row of the patch.
+static void hogGradientRow(const float* const* rows, int x, int end, float* mag, int* ori)
+{
+    const float scale = 1.f / 255;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int vlanes = VTraits<v_float32>::vlanes();
+    const v_float32 v_scale = vx_setall_f32(scale), v_zero = vx_setzero_f32();
+    for (; x <= end - vlanes; x += vlanes)
+    {
+        // pick the channel with the strongest gradient, starting with red
+        v_float32 dy = v_sub(vx_load(rows[8] + x), vx_load(rows[6] + x));
+        v_float32 dx = v_sub(vx_load(rows[7] + x + 1), vx_load(rows[7] + x - 1));
+        v_float32 v = v_muladd(dx, dx, v_mul(dy, dy));
+        for (int c = 1; c >= 0; c--)
+        {
+            v_float32 cdy = v_sub(vx_load(rows[c*3 + 2] + x), vx_load(rows[c*3] + x));
+            v_float32 cdx = v_sub(vx_load(rows[c*3 + 1] + x + 1), vx_load(rows[c*3 + 1] + x - 1));
+            v_float32 cv = v_muladd(cdx, cdx, v_mul(cdy, cdy));
+            v_float32 m = v_gt(cv, v);
+            dx = v_select(m, cdx, dx);
+            dy = v_select(m, cdy, dy);
+            v = v_select(m, cv, v);
+        }
+
+        // snap to one of the 18 orientations
+        v_float32 best = v_zero, bin = v_zero;
+        for (int o = 0; o < HOG_ORIENTATIONS/2; o++)
+        {
+            v_float32 dot = v_muladd(vx_setall_f32(hogUU[o]), dx, v_mul(vx_setall_f32(hogVV[o]), dy));
+            v_float32 m = v_gt(dot, best);
+            best = v_select(m, dot, best);
+            bin = v_select(m, vx_setall_f32((float)o), bin);
+            dot = v_sub(v_zero, dot);
+            m = v_gt(dot, best);
+            best = v_select(m, dot, best);
+            bin = v_select(m, vx_setall_f32((float)(o + HOG_ORIENTATIONS/2)), bin);
+        }
+        v_store(mag + x, v_mul(v_sqrt(v), v_scale));
+        v_store(ori + x, v_round(bin));
+    }
+#endif
+    for (; x < end; x++)
+    {
+        float dy = rows[8][x] - rows[6][x];
+        float dx = rows[7][x + 1] - rows[7][x - 1];
+        float v = dx*dx + dy*dy;
+        for (int c = 1; c >= 0; c--)
+        {
+            float cdy = rows[c*3 + 2][x] - rows[c*3][x];
+            float cdx = rows[c*3 + 1][x + 1] - rows[c*3 + 1][x - 1];
+            float cv = cdx*cdx + cdy*cdy;
+            if (cv > v) { v = cv; dx = cdx; dy = cdy; }
+        }
+
+        float best = 0;
+        int bin = 0;
+        for (int o = 0; o < HOG_ORIENTATIONS/2; o++)
+        {
+            float dot = hogUU[o]*dx + hogVV[o]*dy;
+            if (dot > best)
+            {
+                best = dot;
+                bin = o;
+            }
+            else if (-dot > best)
+            {
+                best = -dot;
+                bin = o + HOG_ORIENTATIONS/2;
+            }
+        }
+        mag[x] = std::sqrt(v) * scale;
+        ori[x] = bin;
+    }
+}
+
+// inverse norm of the 2x2 block of cells starting at the given one
+static inline float hogBlockNorm(const float* norm, int stride)
+{
+    return 1.f / std::sqrt(norm[0] + norm[1] + norm[stride] + norm[stride + 1] + 0.0001f);
+}
+
+// same source coordinates as cv::resize with INTER_LINEAR
+static void linearResizeCoeffs(int ssize, int dsize, std::vector<int>& ofs, std::vector<float>& alpha)
+{
+    const double scale = (double)ssize / dsize;
+    ofs.resize(dsize);
+    alpha.resize(dsize);
+    for (int x = 0; x < dsize; x++)
+    {
+        float fx = (float)((x + 0.5) * scale - 0.5);
+        int sx = cvFloor(fx);
+        fx -= sx;
+        if (sx < 0)
+        {
+            sx = 0;
+            fx = 0;
+        }
+        if (sx >= ssize - 1)
+        {
+            sx = ssize - 1;
+            fx = 0;
+        }
+        ofs[x] = sx;
+        alpha[x] = fx;
+    }
+}
+
+CorrelationFeatures::CorrelationFeatures() :
+    cellSize(1), numHogChannels(0), useColorNames(false), useGray(false), useRgb(false)
+{
+    // nothing
+}
+
+void CorrelationFeatures::configure(int cellSize_, int numHogChannels_, bool useColorNames_,
+        bool useGray_, bool useRgb_)
+{
+    CV_Assert(cellSize_ > 0);
+    CV_Assert(0 <= numHogChannels_ && numHogChannels_ <= HOG_CHANNELS);
+    cellSize = cellSize_;
+    numHogChannels = numHogChannels_;
+    useColorNames = useColorNames_;
+    useGray = useGray_;
+    useRgb = useRgb_;
+}
+
+int CorrelationFeatures::channels() const
+{
+    return numHogChannels + (useColorNames ? CN_CHANNELS : 0) + (useGray ? 1 : 0) + (useRgb ? 3 : 0);
+}
+
+void CorrelationFeatures::compute(const Mat& patch, const Mat& window, std::vector<Mat>& planes)
+{
+    CV_Assert(patch.type() == CV_8UC3 && !patch.empty());
+    CV_Assert(window.type() == CV_32FC1);
+
+    planes.resize(channels());
+    for (size_t i = 0; i < planes.size(); i++)
+        planes[i].create(window.size(), CV_32FC1);
+
+    Mat* p = planes.empty() ? 0 : &planes[0];
+    if (numHogChannels > 0)
+    {
+        computeHog(patch, window, p);
+        p += numHogChannels;
+    }
+    Mat* cnPlanes = 0;
+    if (useColorNames)
+    {
+        cnPlanes = p;
+        p += CN_CHANNELS;
+    }
+    Mat* grayPlane = 0;
+    if (useGray)
+        grayPlane = p++;
+    Mat* rgbPlanes = useRgb ? p : 0;
+
+    if (cnPlanes || rgbPlanes)
+        computeResampled(patch, window, cnPlanes, rgbPlanes);
+    if (grayPlane)
+        computeGray(patch, window, *grayPlane);
+}
+
+// Felzenszwalb's HOG with one cell of padding, see computeHOG32D in trackerCSRTUtils.cpp.
+// Only numHogChannels leading channels of the descriptor are written.
+void CorrelationFeatures::computeHog(const Mat& patch, const Mat& window, Mat* planes)
+{
+    const int sbin = cellSize;
+    const int bW = patch.cols / sbin, bH = patch.rows / sbin;
+    const int outW = std::max(bW - 2, 0) + 2, outH = std::max(bH - 2, 0) + 2;
+    CV_Assert(window.cols == outW && window.rows == outH);
+    const int visW = bW*sbin, visH = bH*sbin;
+    const int histStride = bW*HOG_ORIENTATIONS;
+    const int n = patch.cols;
+
+    hist.assign((size_t)histStride*bH, 0.f);
+    norm.resize((size_t)bW*bH);
+    magnitude.resize(n);
+    orientation.resize(n);
+    cellOfs.resize(n);
+    cellAlpha.resize(n);
+    srcRows.resize((size_t)9*n);
+
+    for (int x = 1; x < visW - 1; x++)
+    {
+        float xp = (x + 0.5f) / sbin - 0.5f;
+        int ixp = cvFloor(xp);
+        cellOfs[x] = ixp;
+        cellAlpha[x] = xp - ixp;
+    }
+
+    // orientation histograms, the gradients are computed from a ring buffer of three rows
+    const float* rows[9];
+    for (int y = 1; y < visH - 1; y++)
+    {
+        for (int r = (y == 1 ? -1 : 1); r <= 1; r++)
+            splitRow(patch.ptr<uchar>(y + r), &srcRows[(size_t)((y + r) % 3)*3*n], n);
+        for (int r = 0; r < 3; r++)
+        {
+            const float* p = &srcRows[(size_t)((y + r - 1) % 3)*3*n];
+            for (int c = 0; c < 3; c++)
+                rows[c*3 + r] = p + c*n;
+        }
+        hogGradientRow(rows, 1, visW - 1, &magnitude[0], &orientation[0]);
+
+        // add to 4 histograms around the pixel using bilinear interpolation
+        float yp = (y + 0.5f) / sbin - 0.5f;
+        int iyp = cvFloor(yp);
+        float vy0 = yp - iyp, vy1 = 1.f - vy0;
+        float* h0 = iyp >= 0 ? &hist[(size_t)iyp*histStride] : 0;
+        float* h1 = iyp + 1 < bH ? &hist[(size_t)(iyp + 1)*histStride] : 0;
+        for (int x = 1; x < visW - 1; x++)
+        {
+            const int ixp = cellOfs[x], o = orientation[x];
+            const float vx0 = cellAlpha[x], vx1 = 1.f - vx0, v = magnitude[x];
+            if (h0)
+            {
+                if (ixp >= 0)
+                    h0[ixp*HOG_ORIENTATIONS + o] += vy1*vx1*v;
+                if (ixp + 1 < bW)
+                    h0[(ixp + 1)*HOG_ORIENTATIONS + o] += vy1*vx0*v;
+            }
+            if (h1)
+            {
+                if (ixp >= 0)
+                    h1[ixp*HOG_ORIENTATIONS + o] += vy0*vx1*v;
+                if (ixp + 1 < bW)
+                    h1[(ixp + 1)*HOG_ORIENTATIONS + o] += vy0*vx0*v;
+            }
+        }
+    }
+
+    // energy of each cell
+    for (int i = 0; i < bW*bH; i++)
+    {
+        const float* h = &hist[(size_t)i*HOG_ORIENTATIONS];
+        float s = 0;
+        for (int o = 0; o < HOG_ORIENTATIONS/2; o++)
+        {
+            float t = h[o] + h[o + HOG_ORIENTATIONS/2];
+            s += t*t;
+        }
+        norm[i] = s;
+    }
+
+    // the descriptor is built row by row for all of the channels, then windowed into the planes
+    rowFeatures.resize((size_t)HOG_CHANNELS*outW);
+    for (int y = 0; y < outH; y++)
+    {
+        std::fill(rowFeatures.begin(), rowFeatures.end(), 0.f);
+        float* truncation = &rowFeatures[(size_t)(HOG_CHANNELS - 1)*outW];
+        if (y == 0 || y == outH - 1)
+        {
+            std::fill(truncation, truncation + outW, 1.f);
+        }
+        else
+        {
+            truncation[0] = truncation[outW - 1] = 1.f;
+            for (int x = 1; x < outW - 1; x++)
+            {
+                const float n1 = hogBlockNorm(&norm[(size_t)y*bW + x], bW);
+                const float n2 = hogBlockNorm(&norm[(size_t)(y - 1)*bW + x], bW);
+                const float n3 = hogBlockNorm(&norm[(size_t)y*bW + x - 1], bW);
+                const float n4 = hogBlockNorm(&norm[(size_t)(y - 1)*bW + x - 1], bW);
+                const float* h = &hist[(size_t)y*histStride + x*HOG_ORIENTATIONS];
+                float* dst = &rowFeatures[x];
+                float t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+
+                // contrast-sensitive features
+                for (int o = 0; o < HOG_ORIENTATIONS; o++, dst += outW)
+                {
+                    float h1 = std::min(h[o]*n1, 0.2f);
+                    float h2 = std::min(h[o]*n2, 0.2f);
+                    float h3 = std::min(h[o]*n3, 0.2f);
+                    float h4 = std::min(h[o]*n4, 0.2f);
+                    *dst = 0.5f * (h1 + h2 + h3 + h4);
+                    t1 += h1;
+                    t2 += h2;
+                    t3 += h3;
+                    t4 += h4;
+                }
+
+                // contrast-insensitive features
+                for (int o = 0; o < HOG_ORIENTATIONS/2; o++, dst += outW)
+                {
+                    float sum = h[o] + h[o + HOG_ORIENTATIONS/2];
+                    float h1 = std::min(sum*n1, 0.2f);
+                    float h2 = std::min(sum*n2, 0.2f);
+                    float h3 = std::min(sum*n3, 0.2f);
+                    float h4 = std::min(sum*n4, 0.2f);
+                    *dst = 0.5f * (h1 + h2 + h3 + h4);
+                }
+
+                // texture features
+                dst[0] = 0.2357f * t1;
+                dst[outW] = 0.2357f * t2;
+                dst[2*outW] = 0.2357f * t3;
+                dst[3*outW] = 0.2357f * t4;
+            }
+        }
+
+        const float* w = window.ptr<float>(y);
+        for (int c = 0; c < numHogChannels; c++)
+            mulRow(&rowFeatures[(size_t)c*outW], w, planes[c].ptr<float>(y), outW);
+    }
+}
+
+// ColorNames and RGB channels sampled at the window resolution, the same as looking them up
+// in the full patch and downscaling with cv::resize(INTER_LINEAR), but with 4 lookups per output
+// pixel. The ColorNames of a source row are indexed once and gathered for the vector of outputs.
+// The RGB channels are centered on the mean of the whole patch.
+void CorrelationFeatures::computeResampled(const Mat& patch, const Mat& window, Mat* cnPlanes, Mat* rgbPlanes)
+{
+    const Size dsize = window.size();
+    linearResizeCoeffs(patch.cols, dsize.width, xofs, xalpha);
+    if (cnPlanes)
+    {
+        xofsNext.resize(dsize.width);
+        for (int x = 0; x < dsize.width; x++)
+            xofsNext[x] = std::min(xofs[x] + 1, patch.cols - 1);
+        cnIndex.resize(patch.cols);
+        cnOffsets.resize((size_t)2*patch.cols);
+    }
+
+    float bias[3] = {0.f, 0.f, 0.f};
+    if (rgbPlanes)
+    {
+        Scalar m = mean(patch);
+        for (int c = 0; c < 3; c++)
+            bias[c] = (float)(m[c] / 255);
+    }
+
+    const double scaleY = (double)patch.rows / dsize.height;
+    for (int y = 0; y < dsize.height; y++)
+    {
+        float fy = (float)((y + 0.5) * scaleY - 0.5);
+        int sy = cvFloor(fy);
+        fy -= sy;
+        if (sy < 0)
+        {
+            sy = 0;
+            fy = 0;
+        }
+        if (sy >= patch.rows - 1)
+        {
+            sy = patch.rows - 1;
+            fy = 0;
+        }
+        const uchar* s0 = patch.ptr<uchar>(sy);
+        const uchar* s1 = patch.ptr<uchar>(std::min(sy + 1, patch.rows - 1));
+        const float* w = window.ptr<float>(y);
+        const float wy0 = 1.f - fy;
+
+        float* cn[CN_CHANNELS];
+        float* rgb[3];
+        for (int k = 0; cnPlanes && k < CN_CHANNELS; k++)
+            cn[k] = cnPlanes[k].ptr<float>(y);
+        for (int c = 0; rgbPlanes && c < 3; c++)
+            rgb[c] = rgbPlanes[c].ptr<float>(y);
+
+        if (cnPlanes)
+        {
+            int* ofs0 = &cnOffsets[0];
+            int* ofs1 = &cnOffsets[patch.cols];
+            colorNameOffsets(s0, &cnIndex[0], ofs0, patch.cols);
+            colorNameOffsets(s1, &cnIndex[0], ofs1, patch.cols);
+            resampleColorNamesRow(ofs0, ofs1, &xofs[0], &xofsNext[0], &xalpha[0], fy, w, cn, dsize.width);
+        }
+        for (int x = 0; rgbPlanes && x < dsize.width; x++)
+        {
+            const int x0 = xofs[x]*3, x1 = std::min(xofs[x] + 1, patch.cols - 1)*3;
+            const float fx = xalpha[x], wx0 = 1.f - fx;
+            for (int c = 0; c < 3; c++)
+            {
+                float v = wy0*(wx0*s0[x0 + c] + fx*s0[x1 + c]) + fy*(wx0*s1[x0 + c] + fx*s1[x1 + c]);
+                rgb[c][x] = (v * (1.f / 255) - bias[c]) * w[x];
+            }
+        }
+    }
+}
+
+void CorrelationFeatures::computeGray(const Mat& patch, const Mat& window, Mat& plane)
+{
+    cvtColor(patch, gray, COLOR_BGR2GRAY);
+    resize(gray, grayResized, window.size(), 0, 0, INTER_CUBIC);
+    for (int y = 0; y < window.rows; y++)
+    {
+        const uchar* g = grayResized.ptr<uchar>(y);
+        const float* w = window.ptr<float>(y);
+        float* d = plane.ptr<float>(y);
+        for (int x = 0; x < window.cols; x++)
+            d[x] = (g[x] * (1.f / 255) - 0.5f) * w[x];
+    }
+}
+
+}}  // namespace
@@ -0,0 +1,62 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#ifndef OPENCV_TRACKING_FEATURES_HPP
+#define OPENCV_TRACKING_FEATURES_HPP
+
+namespace cv {
+namespace tracking_internal {
+
+/** Looks up the ColorNames descriptor of every pixel of a CV_8UC3 BGR image into a CV_32FC(10)
+ matrix of the same size. If window is not empty (CV_32FC1 of the image size), all of the channels
+ are multiplied by it in the same pass.
+ */
+void extractColorNames(const Mat& bgr, const Mat& window, Mat& dst);
+
+/** Computes the feature channels of the correlation filter trackers in a single pass over the patch.
+
+ The channels are written in the order HOG, ColorNames, gray, RGB into CV_32FC1 planes of the window
+ size, each of them already multiplied by the window. The planes are reused if they are allocated.
+ The HOG cells are cellSize x cellSize pixels, the other channels are resampled from the patch
+ with bilinear interpolation (gray with bicubic interpolation).
+ */
+class CorrelationFeatures
+{
+public:
+    CorrelationFeatures();
+
+    void configure(int cellSize, int numHogChannels, bool useColorNames, bool useGray, bool useRgb);
+    int channels() const;
+    void compute(const Mat& patch, const Mat& window, std::vector<Mat>& planes);
+
+private:
+    void computeHog(const Mat& patch, const Mat& window, Mat* planes);
+    void computeResampled(const Mat& patch, const Mat& window, Mat* cnPlanes, Mat* rgbPlanes);
+    void computeGray(const Mat& patch, const Mat& window, Mat& plane);
+
+    int cellSize;
+    int numHogChannels;
+    bool useColorNames;
+    bool useGray;
+    bool useRgb;
+
+    // buffers reused between the calls
+    std::vector<float> srcRows;
+    std::vector<float> magnitude;
+    std::vector<int> orientation;
+    std::vector<int> cellOfs;
+    std::vector<float> cellAlpha;
+    std::vector<float> hist;
+    std::vector<float> norm;
+    std::vector<float> rowFeatures;
+    std::vector<int> xofs;
+    std::vector<int> xofsNext;
+    std::vector<float> xalpha;
+    std::vector<ushort> cnIndex;
+    std::vector<int> cnOffsets;
+    Mat gray;
+    Mat grayResized;
+};
+
+}}  // namespace
+#endif
@@ -0,0 +1,361 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "tracking_spectrums.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+namespace tracking_internal {
+
+static const int MAX_SPECTRUM_ARGS = 4;
+
+static inline void checkSpectrums(const Mat& a, const Mat& b)
+{
+    CV_Assert((a.type() == CV_32FC2 || a.type() == CV_32FC1) && a.type() == b.type() && a.size() == b.size());
+}
+
+// Each of the operations below processes n complex numbers stored as interleaved (re, im) pairs.
+// dst may also be read by the operation.
+
+struct DivSpectrumsOp
+{
+    DivSpectrumsOp(float bias_, bool conjDst) : bias(bias_), sign(conjDst ? -1.f : 1.f) {}
+
+    // dst = a / (b + bias)
+    void operator()(const float* const* src, float* pd, int n) const
+    {
+        const float* pa = src[0];
+        const float* pb = src[1];
+        int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const int vlanes = VTraits<v_float32>::vlanes();
+        const v_float32 v_sign = vx_setall_f32(sign), v_bias = vx_setall_f32(bias);
+        for (; x <= n - vlanes; x += vlanes)
+        {
+            v_float32 ar, ai, br, bi;
+            v_load_deinterleave(pa + 2*x, ar, ai);
+            v_load_deinterleave(pb + 2*x, br, bi);
+            br = v_add(br, v_bias);
+            v_float32 den = v_muladd(br, br, v_mul(bi, bi));
+            v_float32 re = v_div(v_muladd(ar, br, v_mul(ai, bi)), den);
+            v_float32 im = v_div(v_mul(v_sub(v_mul(ai, br), v_mul(ar, bi)), v_sign), den);
+            v_store_interleave(pd + 2*x, re, im);
+        }
+#endif
+        for (; x < n; x++)
+        {
+            float ar = pa[2*x], ai = pa[2*x + 1];
+            float br = pb[2*x] + bias, bi = pb[2*x + 1];
+            float den = br*br + bi*bi;
+            pd[2*x] = (ar*br + ai*bi) / den;
+            pd[2*x + 1] = sign * (ai*br - ar*bi) / den;
+        }
+    }
+
+    float bias, sign;
+};
+
+struct MulAddSpectrumsOp
+{
+    MulAddSpectrumsOp(float scale_, bool conjB) : scale(scale_), bsign(conjB ? -1.f : 1.f) {}
+
+    // dst += scale * a * b
+    void operator()(const float* const* src, float* pd, int n) const
+    {
+        const float* pa = src[0];
+        const float* pb = src[1];
+        int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const int vlanes = VTraits<v_float32>::vlanes();
+        const v_float32 v_scale = vx_setall_f32(scale);
+        const v_float32 v_bsign = vx_setall_f32(bsign);
+        for (; x <= n - vlanes; x += vlanes)
+        {
+            v_float32 ar, ai, br, bi, dr, di;
+            v_load_deinterleave(pa + 2*x, ar, ai);
+            v_load_deinterleave(pb + 2*x, br, bi);
+            v_load_deinterleave(pd + 2*x, dr, di);
+            bi = v_mul(bi, v_bsign);
+            v_float32 re = v_sub(v_mul(ar, br), v_mul(ai, bi));
+            v_float32 im = v_muladd(ar, bi, v_mul(ai, br));
+            dr = v_muladd(re, v_scale, dr);
+            di = v_muladd(im, v_scale, di);
+            v_store_interleave(pd + 2*x, dr, di);
+        }
+#endif
+        for (; x < n; x++)
+        {
+            float ar = pa[2*x], ai = pa[2*x + 1];
+            float br = pb[2*x], bi = bsign * pb[2*x + 1];
+            pd[2*x] += scale * (ar*br - ai*bi);
+            pd[2*x + 1] += scale * (ar*bi + ai*br);
+        }
+    }
+
+    float scale, bsign;
+};
+
+struct AdmmSolveSpectrumsOp
+{
+    AdmmSolveSpectrumsOp(float mu_) : mu(mu_) {}
+
+    // g = (sxy + mu * h - l) / (sxx + mu)
+    void operator()(const float* const* src, float* pg, int n) const
+    {
+        const float* pxy = src[0];
+        const float* pxx = src[1];
+        const float* ph = src[2];
+        const float* pl = src[3];
+        int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const int vlanes = VTraits<v_float32>::vlanes();
+        const v_float32 v_mu = vx_setall_f32(mu);
+        for (; x <= n - vlanes; x += vlanes)
+        {
+            v_float32 xyr, xyi, xxr, xxi, hr, hi, lr, li;
+            v_load_deinterleave(pxy + 2*x, xyr, xyi);
+            v_load_deinterleave(pxx + 2*x, xxr, xxi);
+            v_load_deinterleave(ph + 2*x, hr, hi);
+            v_load_deinterleave(pl + 2*x, lr, li);
+            // numerator
+            v_float32 ar = v_sub(v_muladd(v_mu, hr, xyr), lr);
+            v_float32 ai = v_sub(v_muladd(v_mu, hi, xyi), li);
+            // denominator
+            v_float32 br = v_add(xxr, v_mu);
+            v_float32 den = v_muladd(br, br, v_mul(xxi, xxi));
+            v_float32 re = v_div(v_muladd(ar, br, v_mul(ai, xxi)), den);
+            v_float32 im = v_div(v_sub(v_mul(ai, br), v_mul(ar, xxi)), den);
+            v_store_interleave(pg + 2*x, re, im);
+        }
+#endif
+        for (; x < n; x++)
+        {
+            float ar = pxy[2*x] + mu*ph[2*x] - pl[2*x];
+            float ai = pxy[2*x + 1] + mu*ph[2*x + 1] - pl[2*x + 1];
+            float br = pxx[2*x] + mu, bi = pxx[2*x + 1];
+            float den = br*br + bi*bi;
+            pg[2*x] = (ar*br + ai*bi) / den;
+            pg[2*x + 1] = (ai*br - ar*bi) / den;
+        }
+    }
+
+    float mu;
+};
+
+// Gathers the vertically packed column c of a CCS spectrum (rows y0..y0+h-1) into
+// interleaved pairs. The first element and, for even heights, the last one are real.
+static void gatherPackedColumn(const Mat& m, int c, int y0, int h, float* buf)
+{
+    int n = 0;
+    buf[n++] = m.at<float>(y0, c);
+    buf[n++] = 0.f;
+    for (int y = 1; y + 1 < h; y += 2)
+    {
+        buf[n++] = m.at<float>(y0 + y, c);
+        buf[n++] = m.at<float>(y0 + y + 1, c);
+    }
+    if (h % 2 == 0)
+    {
+        buf[n++] = m.at<float>(y0 + h - 1, c);
+        buf[n++] = 0.f;
+    }
+}
+
+static void scatterPackedColumn(const float* buf, int c, int y0, int h, Mat& m)
+{
+    int n = 0;
+    m.at<float>(y0, c) = buf[n];
+    n += 2;
+    for (int y = 1; y + 1 < h; y += 2, n += 2)
+    {
+        m.at<float>(y0 + y, c) = buf[n];
+        m.at<float>(y0 + y + 1, c) = buf[n + 1];
+    }
+    if (h % 2 == 0)
+        m.at<float>(y0 + h - 1, c) = buf[n];
+}
+
+// Applies op to the rows y0..y0+h-1 of CCS packed spectra holding a single 2D (or 1D if h == 1) transform
+template<typename Op>
+static void processPackedSpectrums(const Op& op, const Mat** src, int nsrc, Mat& dst, int y0, int h)
+{
+    const float* sptr[MAX_SPECTRUM_ARGS];
+    const int w = dst.cols;
+
+    // columns 1 .. (w-1)/2*2 hold interleaved complex numbers in every row
+    for (int y = y0; y < y0 + h; y++)
+    {
+        for (int k = 0; k < nsrc; k++)
+            sptr[k] = src[k]->ptr<float>(y) + 1;
+        op(sptr, dst.ptr<float>(y) + 1, (w - 1) / 2);
+    }
+
+    // the first column, and the last one for even widths, are packed vertically
+    const int npairs = h / 2 + 1;
+    AutoBuffer<float> _buf((nsrc + 1) * npairs * 2);
+    float* buf = _buf.data();
+    const int packed_cols[] = { 0, w - 1 };
+    const int npacked = (w % 2 == 0) ? 2 : 1;
+    for (int i = 0; i < npacked; i++)
+    {
+        const int c = packed_cols[i];
+        for (int k = 0; k < nsrc; k++)
+        {
+            gatherPackedColumn(*src[k], c, y0, h, buf + k * npairs * 2);
+            sptr[k] = buf + k * npairs * 2;
+        }
+        float* dbuf = buf + nsrc * npairs * 2;
+        gatherPackedColumn(dst, c, y0, h, dbuf);
+        op(sptr, dbuf, npairs);
+        scatterPackedColumn(dbuf, c, y0, h, dst);
+    }
+}
+
+template<typename Op>
+static void processSpectrums(const Op& op, const Mat** src, int nsrc, Mat& dst, int flags)
+{
+    CV_Assert(nsrc <= MAX_SPECTRUM_ARGS);
+    if (dst.type() == CV_32FC1)
+    {
+        // CCS packed spectra
+        if ((flags & DFT_ROWS) || dst.rows == 1)
+        {
+            for (int y = 0; y < dst.rows; y++)
+                processPackedSpectrums(op, src, nsrc, dst, y, 1);
+        }
+        else
+        {
+            processPackedSpectrums(op, src, nsrc, dst, 0, dst.rows);
+        }
+        return;
+    }
+
+    // process continuous matrices as a single row
+    bool continuous = dst.isContinuous();
+    for (int k = 0; k < nsrc; k++)
+        continuous = continuous && src[k]->isContinuous();
+    const Size sz = continuous ? Size(dst.cols * dst.rows, 1) : dst.size();
+
+    const float* sptr[MAX_SPECTRUM_ARGS];
+    for (int y = 0; y < sz.height; y++)
+    {
+        for (int k = 0; k < nsrc; k++)
+            sptr[k] = src[k]->ptr<float>(y);
+        op(sptr, dst.ptr<float>(y), sz.width);
+    }
+}
+
+void divSpectrums(const Mat& a, const Mat& b, Mat& dst, int flags, bool conjDst)
+{
+    checkSpectrums(a, b);
+    dst.create(a.size(), a.type());
+    const Mat* src[] = { &a, &b };
+    processSpectrums(DivSpectrumsOp(0.f, conjDst), src, 2, dst, flags);
+}
+
+void regularizedDivSpectrums(const Mat& a, const Mat& b, float lambda, Mat& dst, int flags)
+{
+    checkSpectrums(a, b);
+    dst.create(a.size(), a.type());
+    const Mat* src[] = { &a, &b };
+    processSpectrums(DivSpectrumsOp(lambda, false), src, 2, dst, flags);
+}
+
+void mulAddSpectrums(const Mat& a, const Mat& b, Mat& dst, float scale, int flags, bool conjB)
+{
+    checkSpectrums(a, b);
+    checkSpectrums(a, dst);
+    const Mat* src[] = { &a, &b };
+    processSpectrums(MulAddSpectrumsOp(scale, conjB), src, 2, dst, flags);
+}
+
+void admmSolveSpectrums(const Mat& sxy, const Mat& sxx, const Mat& h, const Mat& l, float mu, Mat& g, int flags)
+{
+    checkSpectrums(sxy, sxx);
+    checkSpectrums(sxy, h);
+    checkSpectrums(sxy, l);
+    g.create(sxy.size(), sxy.type());
+    const Mat* src[] = { &sxy, &sxx, &h, &l };
+    processSpectrums(AdmmSolveSpectrumsOp(mu), src, 4, g, flags);
+}
+
+void admmUpdateMultiplier(Mat& l, const Mat& g, const Mat& h, float mu)
+{
+    checkSpectrums(l, g);
+    checkSpectrums(l, h);
+    // the update is element-wise and real, so the spectrum layout does not matter
+    const bool continuous = l.isContinuous() && g.isContinuous() && h.isContinuous();
+    const Size sz = continuous ? Size(l.cols * l.rows * l.channels(), 1) : Size(l.cols * l.channels(), l.rows);
+
+    for (int y = 0; y < sz.height; y++)
+    {
+        const float* pg = g.ptr<float>(y);
+        const float* ph = h.ptr<float>(y);
+        float* pl = l.ptr<float>(y);
+        int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const int vlanes = VTraits<v_float32>::vlanes();
+        const v_float32 v_mu = vx_setall_f32(mu);
+        for (; x <= sz.width - vlanes; x += vlanes)
+        {
+            v_float32 d = v_sub(vx_load(pg + x), vx_load(ph + x));
+            v_store(pl + x, v_muladd(v_mu, d, vx_load(pl + x)));
+        }
+#endif
+        for (; x < sz.width; x++)
+            pl[x] += mu * (pg[x] - ph[x]);
+    }
+}
+
+void storeModelSpectrum(const Mat& src, Mat& model, bool half)
+{
+    CV_Assert(src.depth() == CV_32F);
+    if (half)
+        src.convertTo(model, CV_16F);
+    else
+        src.copyTo(model);
+}
+
+void loadModelSpectrum(const Mat& model, Mat& dst)
+{
+    CV_Assert(model.depth() == CV_32F || model.depth() == CV_16F);
+    if (model.depth() == CV_32F)
+        dst = model;
+    else
+        model.convertTo(dst, CV_32F);
+}
+
+void updateModelSpectrum(Mat& model, const Mat& update, float rate)
+{
+    CV_Assert(update.depth() == CV_32F && model.size() == update.size() && model.channels() == update.channels());
+    if (model.depth() == CV_32F)
+    {
+        addWeighted(model, 1.0f - rate, update, rate, 0, model);
+        return;
+    }
+    CV_Assert(model.depth() == CV_16F);
+
+    // single precision blend of the half precision model, element-wise and real
+    const bool continuous = model.isContinuous() && update.isContinuous();
+    const Size sz = continuous ? Size(model.cols * model.rows * model.channels(), 1)
+                               : Size(model.cols * model.channels(), model.rows);
+    const float a = 1.0f - rate;
+    for (int y = 0; y < sz.height; y++)
+    {
+        const float* pu = update.ptr<float>(y);
+        hfloat* pm = model.ptr<hfloat>(y);
+        int x = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const int vlanes = VTraits<v_float32>::vlanes();
+        const v_float32 v_a = vx_setall_f32(a), v_rate = vx_setall_f32(rate);
+        for (; x <= sz.width - vlanes; x += vlanes)
+            v_pack_store(pm + x, v_muladd(vx_load_expand(pm + x), v_a, v_mul(vx_load(pu + x), v_rate)));
+#endif
+        for (; x < sz.width; x++)
+            pm[x] = hfloat((float)pm[x] * a + pu[x] * rate);
+    }
+}
+
+}}  // namespace
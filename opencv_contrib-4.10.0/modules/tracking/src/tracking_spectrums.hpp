@@ -0,0 +1,44 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#ifndef OPENCV_TRACKING_SPECTRUMS_HPP
+#define OPENCV_TRACKING_SPECTRUMS_HPP
+
+namespace cv {
+namespace tracking_internal {
+
+// Element-wise kernels for the complex spectra used by the correlation filter trackers.
+// The spectra are either full complex matrices (CV_32FC2, interleaved re/im) or CCS packed
+// real transforms (CV_32FC1, see cv::dft). In the latter case flags may contain DFT_ROWS, as for
+// cv::mulSpectrums. All of the inputs must have the same size and type.
+
+/** dst = a / b, or conj(a / b) if conjDst is set */
+void divSpectrums(const Mat& a, const Mat& b, Mat& dst, int flags = 0, bool conjDst = false);
+
+/** dst = a / (b + lambda) */
+void regularizedDivSpectrums(const Mat& a, const Mat& b, float lambda, Mat& dst, int flags = 0);
+
+/** dst += scale * a * b, or dst += scale * a * conj(b) if conjB is set. dst must be allocated */
+void mulAddSpectrums(const Mat& a, const Mat& b, Mat& dst, float scale, int flags, bool conjB);
+
+/** CSRT ADMM step for the unconstrained filter: g = (sxy + mu * h - l) / (sxx + mu) */
+void admmSolveSpectrums(const Mat& sxy, const Mat& sxx, const Mat& h, const Mat& l, float mu, Mat& g,
+                        int flags = 0);
+
+/** CSRT ADMM update of the Lagrangian multiplier: l += mu * (g - h) */
+void admmUpdateMultiplier(Mat& l, const Mat& g, const Mat& h, float mu);
+
+// Model spectra kept between frames may be stored in half precision (CV_16F) to reduce the memory
+// footprint, the computations are done in single precision.
+
+/** model = src, stored in CV_16F if half is set */
+void storeModelSpectrum(const Mat& src, Mat& model, bool half);
+
+/** dst = model in CV_32F, dst shares the data if the model is already in single precision */
+void loadModelSpectrum(const Mat& model, Mat& dst);
+
+/** model = (1 - rate) * model + rate * update, update is CV_32F and model either CV_32F or CV_16F */
+void updateModelSpectrum(Mat& model, const Mat& update, float rate);
+
+}}  // namespace
+#endif
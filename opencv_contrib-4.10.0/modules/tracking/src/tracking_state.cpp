@@ -0,0 +1,290 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "tracking_state.hpp"
+
+namespace cv {
+namespace tracking_internal {
+
+static const char stateMagic[4] = { 'C', 'V', 'T', 'S' };
+
+void StateArchive::read(const char* name, bool& value)
+{
+    int v = 0;
+    read(name, v);
+    value = v != 0;
+}
+
+void StateArchive::write(const char* name, const bool& value)
+{
+    write(name, value ? 1 : 0);
+}
+
+static void notReadable() { CV_Error(Error::StsError, "The tracker state archive is not readable"); }
+static void notWritable() { CV_Error(Error::StsError, "The tracker state archive is not writable"); }
+
+void StateArchive::read(const char*, int&) { notReadable(); }
+void StateArchive::read(const char*, float&) { notReadable(); }
+void StateArchive::read(const char*, double&) { notReadable(); }
+void StateArchive::read(const char*, std::string&) { notReadable(); }
+void StateArchive::read(const char*, Mat&) { notReadable(); }
+void StateArchive::read(const char*, std::vector<Mat>&) { notReadable(); }
+void StateArchive::read(const char*, std::vector<int>&) { notReadable(); }
+void StateArchive::read(const char*, std::vector<float>&) { notReadable(); }
+void StateArchive::read(const char*, std::vector<double>&) { notReadable(); }
+
+void StateArchive::write(const char*, const int&) { notWritable(); }
+void StateArchive::write(const char*, const float&) { notWritable(); }
+void StateArchive::write(const char*, const double&) { notWritable(); }
+void StateArchive::write(const char*, const std::string&) { notWritable(); }
+void StateArchive::write(const char*, const Mat&) { notWritable(); }
+void StateArchive::write(const char*, const std::vector<Mat>&) { notWritable(); }
+void StateArchive::write(const char*, const std::vector<int>&) { notWritable(); }
+void StateArchive::write(const char*, const std::vector<float>&) { notWritable(); }
+void StateArchive::write(const char*, const std::vector<double>&) { notWritable(); }
+
+void StateArchive::header(const char* tracker, int version)
+{
+    std::string name = tracker;
+    int v = version;
+    io("tracker", name);
+    io("version", v);
+    if (name != tracker)
+        CV_Error(Error::StsBadArg, format("The state belongs to %s, not to %s", name.c_str(), tracker));
+    if (v != version)
+        CV_Error(Error::StsUnsupportedFormat, format("Unsupported %s state version %d", tracker, v));
+}
+
+//
+// FileStorage
+//
+
+FileStorageStateWriter::FileStorageStateWriter(FileStorage& fs_) : fs(fs_)
+{
+    CV_Assert(fs.isOpened());
+}
+
+void FileStorageStateWriter::beginStruct(const char* name) { fs << name << "{"; }
+void FileStorageStateWriter::endStruct() { fs << "}"; }
+void FileStorageStateWriter::write(const char* name, const int& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const float& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const double& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const std::string& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const Mat& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const std::vector<int>& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const std::vector<float>& value) { fs << name << value; }
+void FileStorageStateWriter::write(const char* name, const std::vector<double>& value) { fs << name << value; }
+
+void FileStorageStateWriter::write(const char* name, const std::vector<Mat>& value)
+{
+    fs << name << "[";
+    for (size_t i = 0; i < value.size(); i++)
+        fs << value[i];
+    fs << "]";
+}
+
+FileNodeStateReader::FileNodeStateReader(const FileNode& node)
+{
+    nodes.push_back(node);
+}
+
+FileNode FileNodeStateReader::field(const char* name) const
+{
+    FileNode node = nodes.back()[name];
+    if (node.empty())
+        CV_Error(Error::StsParseError, format("Missing '%s' in the tracker state", name));
+    return node;
+}
+
+void FileNodeStateReader::beginStruct(const char* name)
+{
+    FileNode node = field(name);
+    if (!node.isMap())
+        CV_Error(Error::StsParseError, format("'%s' in the tracker state is not a map", name));
+    nodes.push_back(node);
+}
+
+void FileNodeStateReader::endStruct()
+{
+    CV_Assert(nodes.size() > 1);
+    nodes.pop_back();
+}
+
+void FileNodeStateReader::read(const char* name, int& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, float& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, double& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, std::string& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, Mat& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, std::vector<int>& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, std::vector<float>& value) { field(name) >> value; }
+void FileNodeStateReader::read(const char* name, std::vector<double>& value) { field(name) >> value; }
+
+void FileNodeStateReader::read(const char* name, std::vector<Mat>& value)
+{
+    FileNode node = field(name);
+    if (!node.isSeq())
+        CV_Error(Error::StsParseError, format("'%s' in the tracker state is not a sequence", name));
+    value.resize(node.size());
+    FileNodeIterator it = node.begin();
+    for (size_t i = 0; i < value.size(); i++, ++it)
+        *it >> value[i];
+}
+
+//
+// Raw buffer
+//
+
+BufferStateWriter::BufferStateWriter(std::vector<uchar>& buffer_) : buffer(buffer_)
+{
+    buffer.assign(stateMagic, stateMagic + sizeof(stateMagic));
+}
+
+void BufferStateWriter::put(const void* data, size_t size)
+{
+    const uchar* p = static_cast<const uchar*>(data);
+    buffer.insert(buffer.end(), p, p + size);
+}
+
+void BufferStateWriter::write(const char*, const int& value) { put(&value, sizeof(value)); }
+void BufferStateWriter::write(const char*, const float& value) { put(&value, sizeof(value)); }
+void BufferStateWriter::write(const char*, const double& value) { put(&value, sizeof(value)); }
+
+void BufferStateWriter::write(const char*, const std::string& value)
+{
+    int count = static_cast<int>(value.size());
+    put(&count, sizeof(count));
+    put(value.data(), value.size());
+}
+
+void BufferStateWriter::write(const char*, const Mat& value)
+{
+    CV_Assert(value.dims <= 2);
+    int header[3] = { value.type(), value.rows, value.cols };
+    put(header, sizeof(header));
+    const size_t rowSize = (size_t)value.cols * value.elemSize();
+    for (int i = 0; i < value.rows; i++)
+        put(value.ptr(i), rowSize);
+}
+
+void BufferStateWriter::write(const char* name, const std::vector<Mat>& value)
+{
+    int count = static_cast<int>(value.size());
+    put(&count, sizeof(count));
+    for (size_t i = 0; i < value.size(); i++)
+        write(name, value[i]);
+}
+
+void BufferStateWriter::write(const char*, const std::vector<int>& value)
+{
+    int count = static_cast<int>(value.size());
+    put(&count, sizeof(count));
+    if (!value.empty())
+        put(&value[0], value.size() * sizeof(int));
+}
+
+void BufferStateWriter::write(const char*, const std::vector<float>& value)
+{
+    int count = static_cast<int>(value.size());
+    put(&count, sizeof(count));
+    if (!value.empty())
+        put(&value[0], value.size() * sizeof(float));
+}
+
+void BufferStateWriter::write(const char*, const std::vector<double>& value)
+{
+    int count = static_cast<int>(value.size());
+    put(&count, sizeof(count));
+    if (!value.empty())
+        put(&value[0], value.size() * sizeof(double));
+}
+
+BufferStateReader::BufferStateReader(const std::vector<uchar>& buffer_) : buffer(buffer_), pos(0)
+{
+    char magic[sizeof(stateMagic)];
+    if (buffer.size() < sizeof(magic))
+        CV_Error(Error::StsParseError, "The buffer does not contain a tracker state");
+    get(magic, sizeof(magic));
+    if (memcmp(magic, stateMagic, sizeof(magic)) != 0)
+        CV_Error(Error::StsParseError, "The buffer does not contain a tracker state");
+}
+
+void BufferStateReader::get(void* data, size_t size)
+{
+    if (size > buffer.size() - pos)
+        CV_Error(Error::StsParseError, "The tracker state is truncated");
+    if (size > 0)
+        memcpy(data, &buffer[pos], size);
+    pos += size;
+}
+
+size_t BufferStateReader::getCount(size_t elemSize)
+{
+    int count = 0;
+    get(&count, sizeof(count));
+    if (count < 0 || (elemSize > 0 && static_cast<size_t>(count) > (buffer.size() - pos) / elemSize))
+        CV_Error(Error::StsParseError, "The tracker state is truncated");
+    return static_cast<size_t>(count);
+}
+
+void BufferStateReader::read(const char*, int& value) { get(&value, sizeof(value)); }
+void BufferStateReader::read(const char*, float& value) { get(&value, sizeof(value)); }
+void BufferStateReader::read(const char*, double& value) { get(&value, sizeof(value)); }
+
+void BufferStateReader::read(const char*, std::string& value)
+{
+    value.resize(getCount(1));
+    if (!value.empty())
+        get(&value[0], value.size());
+}
+
+void BufferStateReader::read(const char*, Mat& value)
+{
+    int header[3];
+    get(header, sizeof(header));
+    const int type = header[0], rows = header[1], cols = header[2];
+    if (type != CV_MAT_TYPE(type) || rows < 0 || cols < 0)
+        CV_Error(Error::StsParseError, "Invalid matrix in the tracker state");
+    if (rows == 0 || cols == 0)
+    {
+        value.release();
+        return;
+    }
+    const size_t rowSize = (size_t)cols * CV_ELEM_SIZE(type);
+    if (static_cast<size_t>(rows) > (buffer.size() - pos) / rowSize)
+        CV_Error(Error::StsParseError, "The tracker state is truncated");
+    value.create(rows, cols, type);
+    for (int i = 0; i < rows; i++)
+        get(value.ptr(i), rowSize);
+}
+
+void BufferStateReader::read(const char* name, std::vector<Mat>& value)
+{
+    value.resize(getCount(3 * sizeof(int)));
+    for (size_t i = 0; i < value.size(); i++)
+        read(name, value[i]);
+}
+
+void BufferStateReader::read(const char*, std::vector<int>& value)
+{
+    value.resize(getCount(sizeof(int)));
+    if (!value.empty())
+        get(&value[0], value.size() * sizeof(int));
+}
+
+void BufferStateReader::read(const char*, std::vector<float>& value)
+{
+    value.resize(getCount(sizeof(float)));
+    if (!value.empty())
+        get(&value[0], value.size() * sizeof(float));
+}
+
+void BufferStateReader::read(const char*, std::vector<double>& value)
+{
+    value.resize(getCount(sizeof(double)));
+    if (!value.empty())
+        get(&value[0], value.size() * sizeof(double));
+}
+
+}}  // namespace
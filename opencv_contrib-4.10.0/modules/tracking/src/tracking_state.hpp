@@ -0,0 +1,240 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#ifndef OPENCV_TRACKING_STATE_HPP
+#define OPENCV_TRACKING_STATE_HPP
+
+namespace cv {
+namespace tracking_internal {
+
+/** Serialization of the complete tracker state.
+
+ A tracker lists its fields once, in a function taking a StateArchive, and the same function is used
+ to write and to read the state. The archive either maps the fields to FileStorage nodes or packs
+ them into a raw buffer, which stores only the field values (in the native byte order) and is
+ meant for frequent checkpoints within the same build.
+ */
+class StateArchive
+{
+public:
+    virtual ~StateArchive() {}
+
+    virtual bool reading() const = 0;
+
+    /** Groups the following fields into a map, until the matching endStruct() */
+    virtual void beginStruct(const char* name) = 0;
+    virtual void endStruct() = 0;
+
+    /** Reads the field if the archive is reading, writes it otherwise */
+    template<typename T> void io(const char* name, T& value)
+    {
+        if (reading())
+            read(name, value);
+        else
+            write(name, value);
+    }
+
+    /** Writes a field of a const object, the archive must not be reading */
+    template<typename T> void io(const char* name, const T& value)
+    {
+        CV_Assert(!reading());
+        write(name, value);
+    }
+
+    /** Stores the tracker name and the state version, and checks them when reading */
+    void header(const char* tracker, int version);
+
+protected:
+    // a reading archive implements only read(), a writing one only write()
+    virtual void read(const char* name, int& value);
+    virtual void read(const char* name, float& value);
+    virtual void read(const char* name, double& value);
+    virtual void read(const char* name, std::string& value);
+    virtual void read(const char* name, Mat& value);
+    virtual void read(const char* name, std::vector<Mat>& value);
+    virtual void read(const char* name, std::vector<int>& value);
+    virtual void read(const char* name, std::vector<float>& value);
+    virtual void read(const char* name, std::vector<double>& value);
+
+    virtual void write(const char* name, const int& value);
+    virtual void write(const char* name, const float& value);
+    virtual void write(const char* name, const double& value);
+    virtual void write(const char* name, const std::string& value);
+    virtual void write(const char* name, const Mat& value);
+    virtual void write(const char* name, const std::vector<Mat>& value);
+    virtual void write(const char* name, const std::vector<int>& value);
+    virtual void write(const char* name, const std::vector<float>& value);
+    virtual void write(const char* name, const std::vector<double>& value);
+
+    void read(const char* name, bool& value);
+    void write(const char* name, const bool& value);
+    template<typename T> void read(const char* name, Point_<T>& value);
+    template<typename T> void write(const char* name, const Point_<T>& value);
+    template<typename T> void read(const char* name, Size_<T>& value);
+    template<typename T> void write(const char* name, const Size_<T>& value);
+    template<typename T> void read(const char* name, Rect_<T>& value);
+    template<typename T> void write(const char* name, const Rect_<T>& value);
+};
+
+template<typename T> inline
+void StateArchive::read(const char* name, Point_<T>& value)
+{
+    std::vector<double> v;
+    read(name, v);
+    CV_Assert(v.size() == 2);
+    value = Point_<T>(saturate_cast<T>(v[0]), saturate_cast<T>(v[1]));
+}
+
+template<typename T> inline
+void StateArchive::write(const char* name, const Point_<T>& value)
+{
+    std::vector<double> v(2);
+    v[0] = value.x; v[1] = value.y;
+    write(name, v);
+}
+
+template<typename T> inline
+void StateArchive::read(const char* name, Size_<T>& value)
+{
+    std::vector<double> v;
+    read(name, v);
+    CV_Assert(v.size() == 2);
+    value = Size_<T>(saturate_cast<T>(v[0]), saturate_cast<T>(v[1]));
+}
+
+template<typename T> inline
+void StateArchive::write(const char* name, const Size_<T>& value)
+{
+    std::vector<double> v(2);
+    v[0] = value.width; v[1] = value.height;
+    write(name, v);
+}
+
+template<typename T> inline
+void StateArchive::read(const char* name, Rect_<T>& value)
+{
+    std::vector<double> v;
+    read(name, v);
+    CV_Assert(v.size() == 4);
+    value = Rect_<T>(saturate_cast<T>(v[0]), saturate_cast<T>(v[1]),
+                     saturate_cast<T>(v[2]), saturate_cast<T>(v[3]));
+}
+
+template<typename T> inline
+void StateArchive::write(const char* name, const Rect_<T>& value)
+{
+    std::vector<double> v(4);
+    v[0] = value.x; v[1] = value.y; v[2] = value.width; v[3] = value.height;
+    write(name, v);
+}
+
+/** Writes the fields as FileStorage nodes of the current map */
+class FileStorageStateWriter CV_FINAL : public StateArchive
+{
+public:
+    explicit FileStorageStateWriter(FileStorage& fs);
+
+    bool reading() const CV_OVERRIDE { return false; }
+    void beginStruct(const char* name) CV_OVERRIDE;
+    void endStruct() CV_OVERRIDE;
+
+protected:
+    void write(const char* name, const int& value) CV_OVERRIDE;
+    void write(const char* name, const float& value) CV_OVERRIDE;
+    void write(const char* name, const double& value) CV_OVERRIDE;
+    void write(const char* name, const std::string& value) CV_OVERRIDE;
+    void write(const char* name, const Mat& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<Mat>& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<int>& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<float>& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<double>& value) CV_OVERRIDE;
+
+private:
+    FileStorage& fs;
+};
+
+/** Reads the fields from a FileStorage map, a missing field is an error */
+class FileNodeStateReader CV_FINAL : public StateArchive
+{
+public:
+    explicit FileNodeStateReader(const FileNode& node);
+
+    bool reading() const CV_OVERRIDE { return true; }
+    void beginStruct(const char* name) CV_OVERRIDE;
+    void endStruct() CV_OVERRIDE;
+
+protected:
+    void read(const char* name, int& value) CV_OVERRIDE;
+    void read(const char* name, float& value) CV_OVERRIDE;
+    void read(const char* name, double& value) CV_OVERRIDE;
+    void read(const char* name, std::string& value) CV_OVERRIDE;
+    void read(const char* name, Mat& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<Mat>& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<int>& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<float>& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<double>& value) CV_OVERRIDE;
+
+private:
+    FileNode field(const char* name) const;
+
+    std::vector<FileNode> nodes;
+};
+
+/** Appends the field values to a buffer, the field names are not stored */
+class BufferStateWriter CV_FINAL : public StateArchive
+{
+public:
+    explicit BufferStateWriter(std::vector<uchar>& buffer);
+
+    bool reading() const CV_OVERRIDE { return false; }
+    void beginStruct(const char*) CV_OVERRIDE {}
+    void endStruct() CV_OVERRIDE {}
+
+protected:
+    void write(const char* name, const int& value) CV_OVERRIDE;
+    void write(const char* name, const float& value) CV_OVERRIDE;
+    void write(const char* name, const double& value) CV_OVERRIDE;
+    void write(const char* name, const std::string& value) CV_OVERRIDE;
+    void write(const char* name, const Mat& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<Mat>& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<int>& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<float>& value) CV_OVERRIDE;
+    void write(const char* name, const std::vector<double>& value) CV_OVERRIDE;
+
+private:
+    void put(const void* data, size_t size);
+
+    std::vector<uchar>& buffer;
+};
+
+/** Reads the field values written by BufferStateWriter, a truncated buffer is an error */
+class BufferStateReader CV_FINAL : public StateArchive
+{
+public:
+    explicit BufferStateReader(const std::vector<uchar>& buffer);
+
+    bool reading() const CV_OVERRIDE { return true; }
+    void beginStruct(const char*) CV_OVERRIDE {}
+    void endStruct() CV_OVERRIDE {}
+
+protected:
+    void read(const char* name, int& value) CV_OVERRIDE;
+    void read(const char* name, float& value) CV_OVERRIDE;
+    void read(const char* name, double& value) CV_OVERRIDE;
+    void read(const char* name, std::string& value) CV_OVERRIDE;
+    void read(const char* name, Mat& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<Mat>& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<int>& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<float>& value) CV_OVERRIDE;
+    void read(const char* name, std::vector<double>& value) CV_OVERRIDE;
+
+private:
+    void get(void* data, size_t size);
+    size_t getCount(size_t elemSize);
+
+    const std::vector<uchar>& buffer;
+    size_t pos;
+};
+
+}}  // namespace
+#endif
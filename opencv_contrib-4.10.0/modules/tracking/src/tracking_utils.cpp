@@ -4,6 +4,7 @@
 
 #include "precomp.hpp"
 #include "tracking_utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv {
 
@@ -20,37 +21,52 @@ double tracking_internal::computeNCC(const Mat& patch1, const Mat& patch2)
         unsigned n1 = 0, n2 = 0;
         unsigned prod = 0;
 
+        Size size = patch1.size();
         if(patch1.isContinuous() && patch2.isContinuous())
         {
-            const uchar* p1Ptr = patch1.ptr<uchar>(0);
-            const uchar* p2Ptr = patch2.ptr<uchar>(0);
+            size.width = N;
+            size.height = 1;
+        }
 
-            for(int j = 0; j < N; j++)
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        // N <= 1000, so the sums of the 8-bit products fit 32 bits
+        const int vlanes = VTraits<v_uint8>::vlanes();
+        const v_uint8 v_one = vx_setall_u8(1);
+        v_uint32 v_s1 = vx_setzero_u32(), v_s2 = vx_setzero_u32();
+        v_uint32 v_n1 = vx_setzero_u32(), v_n2 = vx_setzero_u32(), v_prod = vx_setzero_u32();
+#endif
+        for(int i = 0; i < size.height; i++)
+        {
+            const uchar* p1Ptr = patch1.ptr<uchar>(i);
+            const uchar* p2Ptr = patch2.ptr<uchar>(i);
+            int j = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+            for(; j <= size.width - vlanes; j += vlanes)
             {
-              s1 += p1Ptr[j];
-              s2 += p2Ptr[j];
-              n1 += p1Ptr[j]*p1Ptr[j];
-              n2 += p2Ptr[j]*p2Ptr[j];
-              prod += p1Ptr[j]*p2Ptr[j];
+                v_uint8 a = vx_load(p1Ptr + j), b = vx_load(p2Ptr + j);
+                v_s1 = v_add(v_s1, v_dotprod_expand_fast(a, v_one));
+                v_s2 = v_add(v_s2, v_dotprod_expand_fast(b, v_one));
+                v_n1 = v_add(v_n1, v_dotprod_expand_fast(a, a));
+                v_n2 = v_add(v_n2, v_dotprod_expand_fast(b, b));
+                v_prod = v_add(v_prod, v_dotprod_expand_fast(a, b));
             }
-        }
-        else
-        {
-            for(int i = 0; i < patch1.rows; i++)
+#endif
+            for(; j < size.width; j++)
             {
-              const uchar* p1Ptr = patch1.ptr<uchar>(i);
-              const uchar* p2Ptr = patch2.ptr<uchar>(i);
-
-              for(int j = 0; j < patch1.cols; j++)
-              {
                 s1 += p1Ptr[j];
                 s2 += p2Ptr[j];
                 n1 += p1Ptr[j]*p1Ptr[j];
                 n2 += p2Ptr[j]*p2Ptr[j];
                 prod += p1Ptr[j]*p2Ptr[j];
-              }
             }
         }
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        s1 += v_reduce_sum(v_s1);
+        s2 += v_reduce_sum(v_s2);
+        n1 += v_reduce_sum(v_n1);
+        n2 += v_reduce_sum(v_n2);
+        prod += v_reduce_sum(v_prod);
+#endif
 
         double sq1 = sqrt(std::max(0.0, n1 - 1.0 * s1 * s1 / N));
         double sq2 = sqrt(std::max(0.0, n2 - 1.0 * s2 * s2 / N));
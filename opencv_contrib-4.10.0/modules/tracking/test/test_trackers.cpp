@@ -94,6 +94,13 @@ TEST_P(DistanceAndOverlap, KCF)
   TrackerTest<Tracker, Rect> test(TrackerKCF::create(), dataset, 20, .35f, NoTransform, 5);
   test.run();
 }
+TEST_P(DistanceAndOverlap, KCF_no_split_coeff)
+{
+  TrackerKCF::Params params;
+  params.split_coeff = false;
+  TrackerTest<Tracker, Rect> test(TrackerKCF::create(params), dataset, 20, .35f, NoTransform, 5);
+  test.run();
+}
 #ifdef TEST_LEGACY
 TEST_P(DistanceAndOverlap, KCF_legacy)
 {
@@ -119,6 +126,14 @@ TEST_P(DistanceAndOverlap, CSRT)
   TrackerTest<Tracker, Rect> test(TrackerCSRT::create(), dataset, 22, .7f, NoTransform);
   test.run();
 }
+
+TEST_P(DistanceAndOverlap, CSRT_fp16_model)
+{
+  TrackerCSRT::Params params;
+  params.use_fp16_model = true;
+  TrackerTest<Tracker, Rect> test(TrackerCSRT::create(params), dataset, 22, .7f, NoTransform);
+  test.run();
+}
 #ifdef TEST_LEGACY
 TEST_P(DistanceAndOverlap, CSRT_legacy)
 {
@@ -231,6 +246,338 @@ TEST_P(DistanceAndOverlap, Scaled_Data_CSRT_legacy)
 }
 #endif
 
+/***************************************************************************************/
+//Tests comparing trackers on the first frames of the sequences
+
+static void readTestSequence(const string& video, int numFrames, std::vector<Mat>& frames, Rect& initBox)
+{
+  string path = cvtest::TS::ptr()->get_data_path() + TRACKING_DIR + "/" + video + "/";
+  int startFrame = 0;
+  FileStorage fs(path + video + ".yml", FileStorage::READ);
+  fs["start"] >> startFrame;
+  fs.release();
+
+  string gtFile = path + "gt.txt";
+  std::ifstream gt(gtFile.c_str());
+  ASSERT_TRUE(gt.is_open()) << gtFile;
+  string line;
+  ASSERT_TRUE((bool)getline(gt, line)) << gtFile;
+  vector<string> tokens = splitString(line, ",");
+  ASSERT_EQ((size_t)4, tokens.size()) << "Incorrect ground truth file " << gtFile;
+  initBox = Rect(atoi(tokens[0].c_str()), atoi(tokens[1].c_str()), atoi(tokens[2].c_str()), atoi(tokens[3].c_str()));
+
+  string videoPath = path + FOLDER_IMG + "/" + video + ".webm";
+  VideoCapture c(videoPath);
+  if (!c.isOpened())
+    throw SkipTestException("Can't open video file");
+  frames.clear();
+  for (int i = 0; i < startFrame + numFrames; i++)
+  {
+    Mat frame;
+    c >> frame;
+    ASSERT_FALSE(frame.empty()) << i << ": " << videoPath;
+    if (i >= startFrame)
+      frames.push_back(frame.clone());
+  }
+}
+
+TEST_P(DistanceAndOverlap, MultiTrackerCSRT_same_as_single)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 20, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  // the ground truth box and the same box scaled by 0.8
+  std::vector<Rect> objects;
+  objects.push_back(bb);
+  objects.push_back(Rect(bb.x + bb.width / 10, bb.y + bb.height / 10, bb.width - bb.width / 5, bb.height - bb.height / 5));
+
+  Ptr<legacy::MultiTrackerCSRT> multi = legacy::MultiTrackerCSRT::create();
+  std::vector<Ptr<TrackerCSRT> > singles;
+  for (size_t i = 0; i < objects.size(); i++)
+  {
+    ASSERT_TRUE(multi->add(frames[0], objects[i]));
+    singles.push_back(TrackerCSRT::create());
+    singles.back()->init(frames[0], objects[i]);
+  }
+
+  for (size_t f = 1; f < frames.size(); f++)
+  {
+    std::vector<Rect2d> boxes;
+    bool multi_ok = multi->update(frames[f], boxes);
+    ASSERT_EQ(objects.size(), boxes.size());
+    ASSERT_EQ(objects.size(), multi->getStatus().size());
+    bool singles_ok = true;
+    for (size_t i = 0; i < singles.size(); i++)
+    {
+      Rect single_box;
+      bool ok = singles[i]->update(frames[f], single_box);
+      singles_ok = singles_ok && ok;
+      EXPECT_EQ(ok, (bool)multi->getStatus()[i]) << "frame=" << f << " target=" << i;
+      if (ok)
+      {
+        EXPECT_EQ(Rect2d(single_box), boxes[i]) << "frame=" << f << " target=" << i;
+      }
+    }
+    EXPECT_EQ(singles_ok, multi_ok) << "frame=" << f;
+  }
+}
+
+TEST(MultiTrackerCSRT, add_invalid_target)
+{
+  Mat frame(240, 320, CV_8UC3, Scalar::all(128));
+  Ptr<legacy::MultiTrackerCSRT> multi = legacy::MultiTrackerCSRT::create();
+  EXPECT_FALSE(multi->add(Mat(), Rect2d(10, 10, 50, 50)));
+  EXPECT_FALSE(multi->add(frame, Rect2d(10, 10, 0, 50)));
+  EXPECT_FALSE(multi->add(frame, Rect2d(400, 10, 50, 50)));
+  EXPECT_TRUE(multi->getObjects().empty());
+  EXPECT_TRUE(multi->getStatus().empty());
+
+  EXPECT_TRUE(multi->add(frame, Rect2d(10, 10, 50, 50)));
+  EXPECT_EQ(1u, multi->getObjects().size());
+}
+
+TEST_P(DistanceAndOverlap, MultiTrackerMedianFlow_same_as_single)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 20, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  // the ground truth box and the same box scaled by 0.8
+  std::vector<Rect> objects;
+  objects.push_back(bb);
+  objects.push_back(Rect(bb.x + bb.width / 10, bb.y + bb.height / 10, bb.width - bb.width / 5, bb.height - bb.height / 5));
+
+  Ptr<legacy::MultiTrackerMedianFlow> multi = legacy::MultiTrackerMedianFlow::create();
+  std::vector<Ptr<legacy::TrackerMedianFlow> > singles;
+  for (size_t i = 0; i < objects.size(); i++)
+  {
+    ASSERT_TRUE(multi->add(frames[0], objects[i]));
+    singles.push_back(legacy::TrackerMedianFlow::create());
+    ASSERT_TRUE(singles.back()->init(frames[0], objects[i]));
+  }
+
+  for (size_t f = 1; f < frames.size(); f++)
+  {
+    std::vector<Rect2d> boxes;
+    bool multi_ok = multi->update(frames[f], boxes);
+    ASSERT_EQ(objects.size(), boxes.size());
+    ASSERT_EQ(objects.size(), multi->getStatus().size());
+    bool singles_ok = true;
+    for (size_t i = 0; i < singles.size(); i++)
+    {
+      Rect2d single_box;
+      bool ok = singles[i]->update(frames[f], single_box);
+      singles_ok = singles_ok && ok;
+      EXPECT_EQ(ok, (bool)multi->getStatus()[i]) << "frame=" << f << " target=" << i;
+      if (ok)
+      {
+        EXPECT_EQ(single_box, boxes[i]) << "frame=" << f << " target=" << i;
+      }
+    }
+    EXPECT_EQ(singles_ok, multi_ok) << "frame=" << f;
+  }
+}
+
+TEST_P(DistanceAndOverlap, CSRT_real_dft_same_as_complex)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 20, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  TrackerCSRT::Params params;
+  Ptr<TrackerCSRT> complex_tracker = TrackerCSRT::create(params);
+  params.use_real_dft = true;
+  Ptr<TrackerCSRT> real_tracker = TrackerCSRT::create(params);
+  complex_tracker->init(frames[0], bb);
+  real_tracker->init(frames[0], bb);
+  for (size_t f = 1; f < frames.size(); f++)
+  {
+    Rect complex_box, real_box;
+    ASSERT_EQ(complex_tracker->update(frames[f], complex_box), real_tracker->update(frames[f], real_box)) << "frame=" << f;
+    EXPECT_LE(cvtest::norm(Mat(complex_box.tl()), Mat(real_box.tl()), NORM_INF), 1) << "frame=" << f;
+    EXPECT_LE(cvtest::norm(Mat(complex_box.br()), Mat(real_box.br()), NORM_INF), 1) << "frame=" << f;
+  }
+}
+
+TEST_P(DistanceAndOverlap, CSRT_fp16_model_close_to_fp32)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 20, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  for (int real_dft = 0; real_dft < 2; real_dft++)
+  {
+    TrackerCSRT::Params params;
+    params.use_real_dft = real_dft != 0;
+    Ptr<TrackerCSRT> fp32_tracker = TrackerCSRT::create(params);
+    params.use_fp16_model = true;
+    Ptr<TrackerCSRT> fp16_tracker = TrackerCSRT::create(params);
+    fp32_tracker->init(frames[0], bb);
+    fp16_tracker->init(frames[0], bb);
+    for (size_t f = 1; f < frames.size(); f++)
+    {
+      Rect fp32_box, fp16_box;
+      ASSERT_EQ(fp32_tracker->update(frames[f], fp32_box), fp16_tracker->update(frames[f], fp16_box))
+          << "frame=" << f << " real_dft=" << real_dft;
+      EXPECT_LE(cvtest::norm(Mat(fp32_box.tl()), Mat(fp16_box.tl()), NORM_INF), 1) << "frame=" << f << " real_dft=" << real_dft;
+      EXPECT_LE(cvtest::norm(Mat(fp32_box.br()), Mat(fp16_box.br()), NORM_INF), 1) << "frame=" << f << " real_dft=" << real_dft;
+    }
+  }
+}
+
+// The tracker restored from a state saved after a few frames continues exactly as the original one
+template <typename T, typename Params>
+static void checkStateRestore(const std::vector<Mat>& frames, const Rect& bb, const Params& params)
+{
+  const size_t restoreFrame = frames.size() / 2;
+  Ptr<T> tracker = T::create(params);
+  tracker->init(frames[0], bb);
+  Rect box;
+  for (size_t f = 1; f < restoreFrame; f++)
+    tracker->update(frames[f], box);
+
+  std::vector<uchar> buffer;
+  tracker->exportState(buffer);
+  Ptr<T> from_buffer = T::create();
+  from_buffer->importState(buffer);
+
+  FileStorage fs_write(".yml", FileStorage::WRITE + FileStorage::MEMORY);
+  tracker->writeState(fs_write);
+  FileStorage fs_read(fs_write.releaseAndGetString(), FileStorage::READ + FileStorage::MEMORY);
+  Ptr<T> from_storage = T::create();
+  from_storage->readState(fs_read.root());
+
+  for (size_t f = restoreFrame; f < frames.size(); f++)
+  {
+    Rect buffer_box, storage_box;
+    bool ok = tracker->update(frames[f], box);
+    EXPECT_EQ(ok, from_buffer->update(frames[f], buffer_box)) << "frame=" << f;
+    EXPECT_EQ(ok, from_storage->update(frames[f], storage_box)) << "frame=" << f;
+    EXPECT_EQ(box, buffer_box) << "frame=" << f;
+    EXPECT_EQ(box, storage_box) << "frame=" << f;
+  }
+
+  std::vector<uchar> restored;
+  from_buffer->exportState(restored);
+  tracker->exportState(buffer);
+  EXPECT_TRUE(buffer == restored);
+
+  // an invalid state leaves the tracker unchanged
+  buffer.resize(buffer.size() / 2);
+  EXPECT_ANY_THROW(from_buffer->importState(buffer));
+  std::vector<uchar> unchanged;
+  from_buffer->exportState(unchanged);
+  EXPECT_TRUE(unchanged == restored);
+}
+
+TEST_P(DistanceAndOverlap, CSRTV2_state_restore)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 20, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  TrackerCSRT::Params params;
+  checkStateRestore<TrackerCSRTV2>(frames, bb, params);
+  params.use_real_dft = true;
+  params.use_fp16_model = true;
+  checkStateRestore<TrackerCSRTV2>(frames, bb, params);
+}
+
+TEST_P(DistanceAndOverlap, KCF_state_restore)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 20, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  TrackerKCF::Params params;
+  checkStateRestore<TrackerKCF>(frames, bb, params);
+  params.desc_pca = TrackerKCF::GRAY | TrackerKCF::CN;
+  params.compressed_size = 3;
+  params.split_coeff = false;
+  checkStateRestore<TrackerKCF>(frames, bb, params);
+}
+
+TEST_P(DistanceAndOverlap, CSRTV2_stage_timing)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 10, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  Ptr<TrackerCSRTV2> tracker = TrackerCSRTV2::create();
+  tracker->init(frames[0], bb);
+  Rect box;
+  tracker->update(frames[1], box);
+  EXPECT_TRUE(tracker->getTrackingStats().stage_last_ms.empty());
+
+  tracker->setStageTiming(true);
+  for (size_t f = 2; f < frames.size() - 1; f++)
+    ASSERT_TRUE(tracker->update(frames[f], box)) << "frame=" << f;
+
+  TrackerCSRTV2::TrackingStats stats = tracker->getTrackingStats();
+  ASSERT_EQ((size_t)TrackerCSRTV2::STAGE_COUNT, stats.stage_last_ms.size());
+  ASSERT_EQ((size_t)TrackerCSRTV2::STAGE_COUNT, stats.stage_p50_ms.size());
+  ASSERT_EQ((size_t)TrackerCSRTV2::STAGE_COUNT, stats.stage_p90_ms.size());
+  ASSERT_EQ((size_t)TrackerCSRTV2::STAGE_COUNT, stats.stage_p99_ms.size());
+  double stages_sum = 0;
+  for (int i = 0; i < TrackerCSRTV2::STAGE_COUNT; i++)
+  {
+    EXPECT_GT(stats.stage_last_ms[i], 0) << "stage=" << i;
+    EXPECT_LE(stats.stage_p50_ms[i], stats.stage_p90_ms[i]) << "stage=" << i;
+    EXPECT_LE(stats.stage_p90_ms[i], stats.stage_p99_ms[i]) << "stage=" << i;
+    if (i != TrackerCSRTV2::STAGE_TOTAL)
+      stages_sum += stats.stage_last_ms[i];
+  }
+  EXPECT_LE(stages_sum, stats.stage_last_ms[TrackerCSRTV2::STAGE_TOTAL]);
+  // the ADMM solve is timed apart from the channel weights and the model update on every frame
+  EXPECT_GT(stats.stage_p50_ms[TrackerCSRTV2::STAGE_ADMM], 0);
+  EXPECT_GT(stats.stage_p50_ms[TrackerCSRTV2::STAGE_FILTER], 0);
+
+  tracker->setStageTiming(false);
+  tracker->update(frames.back(), box);
+  EXPECT_TRUE(tracker->getTrackingStats().stage_last_ms.empty());
+}
+
+TEST_P(DistanceAndOverlap, TLD_cascade_stats)
+{
+  std::vector<Mat> frames;
+  Rect bb;
+  readTestSequence(dataset, 1, frames, bb);
+  if (HasFatalFailure())
+    return;
+
+  Ptr<legacy::TrackerTLD> tracker = legacy::TrackerTLD::create();
+  ASSERT_TRUE(tracker->init(frames[0], bb));
+  EXPECT_EQ(0, tracker->getCascadeStats().windows);
+
+  // the object stays in place, the windows around it pass the whole cascade
+  for (int f = 1; f < 4; f++)
+  {
+    Rect2d box;
+    tracker->update(frames[0], box);
+    legacy::TrackerTLD::CascadeStats stats = tracker->getCascadeStats();
+    EXPECT_GT(stats.windows, 0) << "frame=" << f;
+    EXPECT_GT(stats.variance_rejected, 0) << "frame=" << f;
+    EXPECT_GT(stats.ensemble_rejected, 0) << "frame=" << f;
+    EXPECT_GE(stats.nn_rejected, 0) << "frame=" << f;
+    EXPECT_LT(stats.variance_rejected + stats.ensemble_rejected + stats.nn_rejected, stats.windows) << "frame=" << f;
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(Tracking, DistanceAndOverlap, TESTSET_NAMES);
 
 }} // namespace
@@ -0,0 +1,87 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+#include "opencv2/tracking/tracking_by_matching.hpp"
+
+namespace opencv_test
+{
+namespace
+{
+
+using namespace cv::detail::tracking::tbm;
+
+TEST(TrackerByMatching, CosDistance_computeMatrix)
+{
+    const cv::Size size(8, 16);
+    cv::RNG& rng = cv::theRNG();
+    std::vector<cv::Mat> descrs1(5), descrs2(7);
+    for (auto& d : descrs1)
+    {
+        d.create(size, CV_8UC3);
+        rng.fill(d, cv::RNG::UNIFORM, 0, 256);
+    }
+    for (auto& d : descrs2)
+    {
+        d.create(size, CV_8UC3);
+        rng.fill(d, cv::RNG::UNIFORM, 0, 256);
+    }
+
+    CosDistance distance(size);
+    cv::Mat distances;
+    distance.computeMatrix(descrs1, descrs2, distances);
+    ASSERT_EQ(CV_32F, distances.type());
+    ASSERT_EQ(cv::Size((int)descrs2.size(), (int)descrs1.size()), distances.size());
+    for (size_t i = 0; i < descrs1.size(); i++)
+        for (size_t j = 0; j < descrs2.size(); j++)
+            EXPECT_NEAR(distance.compute(descrs1[i], descrs2[j]), distances.at<float>((int)i, (int)j), 1e-5);
+}
+
+TEST(TrackerByMatching, keeps_ids_of_moving_objects)
+{
+    const cv::Size descr_size(16, 32);
+    TrackerParams params;
+    params.min_track_duration = 500;
+    cv::Ptr<ITrackerByMatching> tracker = createTrackerByMatching(params);
+    tracker->setDescriptorFast(std::make_shared<ResizedImageDescriptor>(descr_size, cv::INTER_LINEAR));
+    tracker->setDistanceFast(std::make_shared<CosDistance>(descr_size));
+
+    // two objects close to each other and one far away
+    const cv::Rect start[] = { cv::Rect(100, 100, 40, 80), cv::Rect(150, 110, 40, 80), cv::Rect(500, 300, 40, 80) };
+    const cv::Scalar colors[] = { cv::Scalar(255, 0, 0), cv::Scalar(0, 255, 0), cv::Scalar(0, 0, 255) };
+    const int num_objects = 3;
+    std::vector<int> ids(num_objects, -1);
+
+    for (int frame_idx = 0; frame_idx < 30; frame_idx++)
+    {
+        cv::Mat frame(480, 640, CV_8UC3, cv::Scalar::all(128));
+        TrackedObjects detections;
+        for (int k = 0; k < num_objects; k++)
+        {
+            cv::Rect rect = start[k] + cv::Point(2 * frame_idx, frame_idx);
+            cv::rectangle(frame, rect, colors[k], cv::FILLED);
+            detections.emplace_back(rect, 1.f, frame_idx, -1);
+        }
+        tracker->process(frame, detections, 1 + 40 * (uint64_t)frame_idx);
+
+        TrackedObjects tracked = tracker->trackedDetections();
+        if (frame_idx * 40 < (int)params.min_track_duration)
+            continue;
+        ASSERT_EQ((size_t)num_objects, tracked.size()) << "frame " << frame_idx;
+        for (const auto& obj : tracked)
+        {
+            int k = 0;
+            while (k < num_objects && obj.rect != detections[k].rect)
+                k++;
+            ASSERT_LT(k, num_objects);
+            if (ids[k] < 0)
+                ids[k] = obj.object_id;
+            EXPECT_EQ(ids[k], obj.object_id) << "frame " << frame_idx;
+        }
+    }
+    EXPECT_EQ((size_t)num_objects, tracker->count());
+}
+
+}}  // namespace
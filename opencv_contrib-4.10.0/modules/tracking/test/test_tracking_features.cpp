@@ -0,0 +1,144 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+// the feature extraction is internal, it is compiled into the test together with the reference code
+#include "../src/featureColorName.cpp"
+#include "../src/tracking_spectrums.cpp"
+#include "../src/trackerCSRTUtils.cpp"
+#include "../src/tracking_features.cpp"
+
+namespace opencv_test { namespace {
+
+using namespace cv::tracking_internal;
+
+// smooth colored texture, the color channels differ in every pixel
+static Mat makePatch(const Size& size, RNG& rng)
+{
+    Mat noise(size, CV_32FC3), patch;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    GaussianBlur(noise, noise, Size(5, 5), 1.5);
+    normalize(noise, noise, 0, 255, NORM_MINMAX);
+    noise.convertTo(patch, CV_8UC3);
+    return patch;
+}
+
+// the ColorNames of every pixel in 10 planes, as the trackers computed them before
+static std::vector<Mat> referenceColorNames(const Mat& patch)
+{
+    Mat cn(patch.size(), CV_32FC(10));
+    for (int y = 0; y < patch.rows; y++)
+    {
+        for (int x = 0; x < patch.cols; x++)
+        {
+            const Vec3b& p = patch.at<Vec3b>(y, x);
+            const int index = p[2]/8 + 32*(p[1]/8) + 32*32*(p[0]/8);
+            for (int k = 0; k < 10; k++)
+                cn.at<Vec<float, 10> >(y, x)[k] = cv::detail::ColorNames[index][k];
+        }
+    }
+    std::vector<Mat> planes;
+    split(cn, planes);
+    return planes;
+}
+
+static std::vector<Mat> referenceFeatures(const Mat& patch, const Mat& window)
+{
+    std::vector<Mat> features;
+    std::vector<Mat> cn = referenceColorNames(patch);
+    for (size_t i = 0; i < cn.size(); i++)
+    {
+        resize(cn[i], cn[i], window.size(), 0, 0, INTER_LINEAR);
+        features.push_back(cn[i].mul(window));
+    }
+
+    Mat gray;
+    cvtColor(patch, gray, COLOR_BGR2GRAY);
+    resize(gray, gray, window.size(), 0, 0, INTER_CUBIC);
+    gray.convertTo(gray, CV_32F, 1.0/255, -0.5);
+    features.push_back(gray.mul(window));
+
+    std::vector<Mat> rgb;
+    split(patch, rgb);
+    for (size_t i = 0; i < rgb.size(); i++)
+    {
+        rgb[i].convertTo(rgb[i], CV_32F, 1.0/255, -0.5);
+        rgb[i] -= mean(rgb[i])[0];
+        resize(rgb[i], rgb[i], window.size(), 0, 0, INTER_LINEAR);
+        features.push_back(rgb[i].mul(window));
+    }
+    return features;
+}
+
+typedef testing::TestWithParam<tuple<int, Size> > Tracking_CorrelationFeatures;
+
+TEST_P(Tracking_CorrelationFeatures, same_as_reference)
+{
+    const int cellSize = get<0>(GetParam());
+    const Size patchSize = get<1>(GetParam());
+    const int numHog = 32;
+    RNG& rng = theRNG();
+    Mat patch = makePatch(patchSize, rng);
+    Mat window = get_hann_win(Size(patchSize.width / cellSize, patchSize.height / cellSize));
+    CorrelationFeatures extractor;
+    std::vector<Mat> features;
+
+    // HOG takes the gradient of the strongest color channel, the old code broke the ties between
+    // the channels on rounding errors, so only one of them is textured
+    Mat hogPatch;
+    int fromTo[] = { 1, 1 };
+    hogPatch.create(patchSize, CV_8UC3);
+    hogPatch.setTo(Scalar(64, 0, 192));
+    mixChannels(&patch, 1, &hogPatch, 1, fromTo, 1);
+    extractor.configure(cellSize, numHog, false, false, false);
+    extractor.compute(hogPatch, window, features);
+    std::vector<Mat> hog = get_features_hog(hogPatch, cellSize);
+    ASSERT_EQ((size_t)numHog, features.size());
+    for (int i = 0; i < numHog; i++)
+    {
+        ASSERT_EQ(window.size(), features[i].size()) << "channel=" << i;
+        // single instead of double precision
+        EXPECT_LE(cvtest::norm(hog[i].mul(window), features[i], NORM_INF), 1e-5) << "channel=" << i;
+    }
+
+    extractor.configure(cellSize, 0, true, true, true);
+    extractor.compute(patch, window, features);
+    std::vector<Mat> reference = referenceFeatures(patch, window);
+    ASSERT_EQ(reference.size(), features.size());
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        ASSERT_EQ(window.size(), features[i].size()) << "channel=" << i;
+        // the interpolation is rounded differently
+        EXPECT_LE(cvtest::norm(reference[i], features[i], NORM_INF), 1e-5) << "channel=" << i;
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Tracking_CorrelationFeatures, testing::Combine(
+    testing::Values(1, 2, 4),
+    testing::Values(Size(200, 200), Size(148, 116), Size(37, 23))));
+
+TEST(Tracking_ColorNames, same_as_reference)
+{
+    RNG& rng = theRNG();
+    Mat patch = makePatch(Size(67, 35), rng);
+    Mat window(patch.size(), CV_32FC1);
+    rng.fill(window, RNG::UNIFORM, 0, 1);
+
+    std::vector<Mat> reference = referenceColorNames(patch);
+    Mat cn, windowed;
+    extractColorNames(patch, Mat(), cn);
+    extractColorNames(patch, window, windowed);
+    std::vector<Mat> planes, windowedPlanes;
+    split(cn, planes);
+    split(windowed, windowedPlanes);
+    ASSERT_EQ(reference.size(), planes.size());
+    for (size_t i = 0; i < planes.size(); i++)
+    {
+        EXPECT_EQ(0, cvtest::norm(reference[i], planes[i], NORM_INF)) << "channel=" << i;
+        EXPECT_EQ(0, cvtest::norm(reference[i].mul(window), windowedPlanes[i], NORM_INF)) << "channel=" << i;
+    }
+}
+
+}}  // namespace